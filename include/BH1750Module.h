@@ -31,12 +31,12 @@ public:
   virtual const String     getModuleWebpage();
   virtual const String     getStatusWebpage();
   // A generic getData/setData interface
-  virtual const String     getString( const String& key );
-  virtual ResultData       setString( const String& key, const String& value );
+  virtual const String     getString( const StringView& key );
+  virtual ResultData       setString( const StringView& key, const String& value );
 
 protected:
   virtual ResultData       handleOption( const String& key, const String& value, Options::Action action );
-  virtual void             resolveTemplateKey( const String& key, String& out );
+  virtual void             resolveTemplateKey( const StringView& key, String& out );
 
 private:
   uint16_t                 getPollOption();
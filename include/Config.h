@@ -36,6 +36,15 @@ namespace Config {
   const uint16_t         BACKLIGHT_PIXELS_COUNT     = 45;                               // Number of LEDs in a strip.
   const uint8_t          BACKLIGHT_PIN              = 23;                               // A strip control pin number.
   const bool             BACKLIGHT_WS8212B_ECO      = true;                             // True if WS8212B-ECO LED strip is used. Affects to the power consumption calculation.
+  const float            BACKLIGHT_GAMMA            = 2.2;                              // Output gamma correction, 1.0 means linear output.
+  const bool             BACKLIGHT_DITHER           = true;                             // Temporal dithering of the low brightness levels.
+  const char* const      BACKLIGHT_REALTIME         = "off";                            // Realtime UDP input protocol: "ddp", "e131" or "off".
+  const uint16_t         BACKLIGHT_REALTIME_TIMEOUT = 2500;                             // Return to the effect after xx milliseconds without realtime frames.
+  const uint16_t         BACKLIGHT_E131_UNIVERSE    = 1;                                // The first E1.31 universe mapped to the strip.
+  const uint16_t         BACKLIGHT_MATRIX_WIDTH     = 0;                                // LEDs in a matrix row, zero means a plain strip.
+  const uint16_t         BACKLIGHT_MATRIX_HEIGHT    = 0;                                // Rows of a matrix, zero means a plain strip.
+  const bool             BACKLIGHT_MATRIX_SERPENTINE = true;                            // True if every odd matrix row is wired in reverse.
+  const uint16_t         BACKLIGHT_MATRIX_ROTATION  = 0;                                // Matrix rotation: 0, 90, 180 or 270 degrees clockwise.
 
   // -- BH1750 lux sensor ---------------------------
   const float            BH1750_LUX_DELTA           = 10.0;                             // Send an event if the lux changed more than delta.
@@ -79,6 +88,9 @@ namespace Config {
   const uint8_t          MINI_DISPLAY_DOWN_PIN      = 35;                               // Keyboard "down" pin
   const uint8_t          MINI_DISPLAY_UP_PIN        = 36;                               // Keyboard "up" pin
   const uint16_t         MINI_DISPLAY_TIMEOUT       = 120;                              // Timeout to turn off display, seconds
+  const uint8_t          MINI_DISPLAY_DEBOUNCE      = 25;                               // Keyboard debounce and held key sampling period, milliseconds
+  const uint16_t         MINI_DISPLAY_LONG_PRESS    = 600;                              // Key hold time to detect a long press, milliseconds
+  const uint16_t         MINI_DISPLAY_REPEAT        = 150;                              // Key repeat interval after a long press, milliseconds
 
   // -- MQTT module -------------------------------
   const char* const      MQTT_CLIENT_ID             = "ESP32_#MAC4";                    // [clientid] MQTT client ID. Also a MQTT fallback topic.
@@ -110,7 +122,18 @@ namespace Config {
   const uint8_t          WEATHER_UNITS              = WeatherUnits::METRIC;
 
   // -- Relays module -------------------------------
-  const uint8_t          RELAY_MAX_RELAYS           = 8;
+  const uint8_t          RELAY_MAX_RELAYS           = 64;                               // Max number of relays, the count is set by the relay data
+  const char* const      RELAY_BACKEND              = "gpio";                           // Relay outputs: "gpio", "mcp23017" or "74hc595"
+  const uint8_t          RELAY_MCP23017_ADDRESS     = 0x20;                             // I2C address of the first MCP23017 chip
+  const uint8_t          RELAY_HC595_LATCH_PIN      = 0;                                // 74HC595 chain latch (RCLK) pin, 0 - not set: no output pin is left free by the display and I2C
+  const uint32_t         RELAY_HC595_SPI_CLOCK      = 4000000;                          // 74HC595 chain SPI clock, Hz
+  const uint8_t          RELAY_MAX_SCENES           = 16;                               // Max number of named relay scenes
+  const uint8_t          RELAY_MAX_SCENE_NAME       = 15;                               // Max length of a relay scene name
+  const uint8_t          RELAY_MAX_SCHEDULES        = 32;                               // Max number of relay schedules
+  const uint32_t         RELAY_SCHEDULE_MAX_PERIOD  = 31 * 86400;                       // Max interval of a relay schedule, seconds
+  const uint32_t         RELAY_SCHEDULE_MAX_DRIFT   = 300;                              // Larger clock steps forward are handled as missed schedules, seconds
+  const uint32_t         RELAY_SCHEDULE_LOOKBACK    = 86400;                            // Missed schedules older than this aren't caught up, seconds
+  const uint32_t         RELAY_SCHEDULE_SAVE_PERIOD = 60;                               // How often the scheduler clock is saved for catching up after a reboot, seconds
   const uint8_t          RELAY1_PIN                 = 32;                               // Relay control pins
   const uint8_t          RELAY2_PIN                 = 33;
   const uint8_t          RELAY3_PIN                 = 25;
@@ -147,6 +170,14 @@ namespace Config {
   const uint8_t          ST7796_D5_PIN              = 16;
   const uint8_t          ST7796_D6_PIN              = 27;
   const uint8_t          ST7796_D7_PIN              = 14;
+  const bool             ST7796_I2S_DMA             = true;                             // Flush pixels with the I2S peripheral in LCD mode and DMA, false - bit-bang.
+  const uint8_t          ST7796_I2S_CLOCK_DIV       = 4;                                // WR strobe is 40MHz / divider; ST7796 write cycle is 66ns at least.
+  const uint8_t          ST7796_BUFFER_LINES        = 32;                               // Height of the LVGL render band, in display lines.
+  const bool             ST7796_BUFFER_PSRAM        = false;                            // Allocate render buffers in PSRAM. It's not DMA-capable, so pixels are bit-banged.
+  const uint8_t          ST7796_GUI_CORE            = 1;                                // CPU core of the LVGL task.
+  const uint8_t          ST7796_GUI_PRIORITY        = 1;                                // Priority of the LVGL task, the Arduino loop task has 1.
+  const uint16_t         ST7796_GUI_STACK_SIZE      = 4096;
+  const uint8_t          ST7796_GUI_MAX_SLEEP       = 50;                               // Max LVGL task sleep time, milliseconds.
 
   const int8_t           ST7796_BACKLIGHT_PIN       = 2;
   const uint8_t          ST7796_TOUCH_CS_PIN        = 5;
@@ -162,9 +193,11 @@ namespace Config {
   const uint16_t         ST7796_TOUCH_Y_MIN         = 110;
   const uint16_t         ST7796_TOUCH_X_MAX         = 1980;
   const uint16_t         ST7796_TOUCH_Y_MAX         = 1980;
-  const uint8_t          ST7796_TOUCH_AVG           = 4;
+  const uint8_t          ST7796_TOUCH_SAMPLES       = 7;                                // Samples per axis taken in one SPI transfer, the median is used.
+  const uint8_t          ST7796_TOUCH_PERIOD        = 10;                               // Sampling period while the panel is pressed, milliseconds.
 
   const uint8_t          ST7796_SDCARD_CS_PIN       = 21;
+  const uint8_t          ST7796_CACHE_SIZE          = 48;                               // SD card assets cache budget, kilobytes.
 
   // -- System --------------------------------------
   const uint8_t          SYSTEM_SLEEP_TIME          = 15;                               // [sleeptime] Sleep time to lower energy consumption (0 = Off .. 1-250 mSec)
@@ -209,6 +242,7 @@ namespace Config {
   const unsigned int     JSON_CONFIG_SIZE           = 1536;
   const unsigned int     JSON_EXPORT_CONFIG_SIZE    = JSON_CONFIG_SIZE * 4;
   const unsigned int     JSON_MESSAGE_SIZE          = 256;
+  const unsigned int     SCRATCH_ARENA_SIZE         = JSON_EXPORT_CONFIG_SIZE + 2048;   // The main loop scratch arena (JSON documents, etc).
   const unsigned int     MAX_PREFERENCES_KEY_LENGTH = 15;
   const unsigned int     MAX_STRING_KEY_SIZE        = 9;                                // Max length of string key (settings, etc)
   const unsigned int     MAX_STRING_LINE_SIZE       = 100;                              // Max number of chars in a settings line
@@ -36,6 +36,8 @@ private:
   uint8_t        reconfig_delay_counter = 0;       // Seconds, delay before issued reconfigure or restart.
   UploadHandler* uploadHandler = nullptr;
 
+  static const Commands::Entry<CoreModule> COMMANDS[];
+
 public:
   CoreModule();
   virtual ~CoreModule();
@@ -46,8 +48,8 @@ public:
   // Module Web interface
   virtual const String getModuleWebpage();
   // A generic getData/setData interface
-  virtual const String getString( const String& key );
-  virtual ResultData   setString( const String& key, const String& value );
+  virtual const String getString( const StringView& key );
+  virtual ResultData   setString( const StringView& key, const String& value );
   // Data upload interface. Used by WebServerModule to upload firmware.
   virtual ResultData   onDataUploadBegin( const String& action, int data_size );
   virtual ResultData   onDataUploadNextBlock( const char* data, const uint16_t size );
@@ -58,9 +60,23 @@ public:
 protected:
   virtual bool         handleCommand( const String& cmd, const String& args );
   virtual ResultData   handleOption( const String& key, const String& value, Options::Action action );
-  virtual void         resolveTemplateKey( const String& key, String& out );
+  virtual void         resolveTemplateKey( const StringView& key, String& out );
 
 private:
+  // Commands
+  void                 cmdHeapStat( const Commands::Args& args );
+  void                 cmdModules( const Commands::Args& args );
+  void                 cmdNetInfo( const Commands::Args& args );
+  void                 cmdNvs( const Commands::Args& args );
+  void                 cmdNvsStat( const Commands::Args& args );
+  void                 cmdPowerInfo( const Commands::Args& args );
+  void                 cmdResetInfo( const Commands::Args& args );
+  void                 cmdRestart( const Commands::Args& args );
+  void                 cmdTelemetry( const Commands::Args& args );
+  void                 cmdTimeInfo( const Commands::Args& args );
+  void                 cmdVersion( const Commands::Args& args );
+  void                 cmdWifiInfo( const Commands::Args& args );
+
   ResultData           applyExtraOptions( const String& options );
   void                 finalizeDataUpload();
   String               prepareManageModulesHTML();
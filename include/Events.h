@@ -2,6 +2,8 @@
 #include <EventBus.h>
 #include <WString.h>
 #include "Module.h"
+#include "core/InlineString.h"
+#include "core/StatusData.h"
 
 // https://github.com/gelldur/EventBus
 
@@ -10,10 +12,11 @@
 
 /* CommandResponseEvent */
 
+// The topic and results are borrowed from the sender for the notify() call only.
 struct CommandResponseEvent {
-  Module* const module;
-  const String& topic;
-  const String& results;
+  Module* const    module;
+  const StringView topic;
+  const StringView results;
 };
 
 /* ConnectivityEvent */
@@ -32,10 +35,46 @@ struct LogUpdateEvent {};
 /* StatusChangedEvent */
 
 struct StatusChangedEvent {
-  Module* const module;       // The module ID.
-  const String& payload;      // An optional payload. The data format is module-specific.
+  Module* const    module;    // The module ID.
+  const StatusData data;      // Typed status data, TYPE_TEXT if the module publishes a string payload only.
+
+  StatusChangedEvent( Module* module, const String& payload ) : module( module ), text( &payload ) {}
+  StatusChangedEvent( Module* module, const StatusData& data ) : module( module ), data( data ) {}
+
+  // The status in a text form. The data format is module-specific, typically JSON.
+  // Typed data is serialized by the module on the first call only.
+  const String& getPayload() const;
+
+private:
+  const String*  text = nullptr;
+  mutable String serialized;
 };
 
+/* Event filters */
+
+// Listeners may be registered for a source module and/or an event subtype only:
+//   Bus.listen<StatusChangedEvent>( EventFilter::of( RTC_MODULE, StatusData::TYPE_TIME ), ... );
+
+using Dexode::EventFilter;
+
+namespace Dexode {
+
+  template <>
+  struct EventFilterTraits<StatusChangedEvent> {
+    static const bool enabled = true;
+    static uint32_t source( const StatusChangedEvent& event )   { return EventFilter::hash( event.module->getId() ); }
+    static uint32_t subtype( const StatusChangedEvent& event )  { return event.data.type; }
+  };
+
+  template <>
+  struct EventFilterTraits<ConnectivityEvent> {
+    static const bool enabled = true;
+    static uint32_t source( const ConnectivityEvent& event )    { return EventFilter::ANY; }
+    static uint32_t subtype( const ConnectivityEvent& event )   { return event.type; }
+  };
+
+} // namespace Dexode
+
 /* SystemEvent */
 
 struct SystemEvent {
@@ -1,11 +1,27 @@
 #pragma once
-#include <Ticker.h>
+#include <esp_attr.h>
+#include <esp32-hal-timer.h>
 #include "Module.h"
 
 class LedClock1Module : public Module {
 
 private:
-  const int      REFRESH_RATE = 3;
+  // The display is multiplexed by a hardware timer. Every digit is shown for SLOT_TICKS timer
+  // ticks (3.2 ms, ~78 Hz refresh), its brightness is the number of ticks it's actually lit.
+  static const uint8_t  TIMER_NUMBER   = 3;
+  static const uint16_t TIMER_DIVIDER  = 80;        // 1 MHz timer clock.
+  static const uint16_t TICK_US        = 200;
+  static const uint8_t  SLOT_TICKS     = 16;
+
+  static constexpr const char* const BRIGHTNESS_OPTION_KEY = "Bright";
+
+  // GPIO set/clear masks of a digit, for the GPIO 0-31 and 32-39 registers.
+  struct DigitMasks {
+    uint32_t set[2];
+    uint32_t clear[2];
+    uint8_t  litTicks;
+  };
+
   const uint8_t  DIGIT_OFF = 11;
   const char     DIGIT_DASH = 10;
 
@@ -62,10 +78,21 @@ private:
   uint8_t   displayBuffer[4];
   bool      showDots = false;
   bool      showAlarm = false;
-  uint8_t   currentPosition = 0;
-  Ticker    ticker;
+  uint8_t   brightness[4];                // Per digit brightness, 0..255.
   int       eventBusToken;
 
+  // Written by the module, read by the timer ISR. The ISR picks up the other frame
+  // at the next digit slot after activeFrame is switched.
+  DigitMasks frames[2][4];
+  uint32_t   digitsOffMask[2];
+  volatile uint8_t activeFrame = 0;
+  uint8_t    position = 0;
+  uint8_t    tick = 0;
+  uint8_t    litTicks = 0;
+  hw_timer_t* timer = nullptr;
+
+  static LedClock1Module* instance;
+
 public:
   LedClock1Module();
   virtual ~LedClock1Module();
@@ -74,13 +101,15 @@ public:
   virtual const char*   getId()    { return CLOCK1_MODULE; }
   virtual const char*   getName()  { return Messages::TITLE_CLOCK1_MODULE; }
 
+protected:
+  virtual ResultData   handleOption( const String& key, const String& value, Options::Action action );
+
 private:
   void clearDisplay();
-  void showNextSymbol();
-  void showSymbol( uint8_t symbol, uint8_t position );
+  void rebuildFrame();
+  void setBrightness( uint32_t packed );
+  uint8_t getSymbolBitset( uint8_t symbol, uint8_t position );
 
-  static char digitToSymbol( unsigned char digit );
-  static void ticker_callback( LedClock1Module* pThis ) {
-    pThis->showNextSymbol();
-  }
+  static void addPin( uint32_t* masks, uint8_t pin );
+  static void IRAM_ATTR onTimer();
 };
\ No newline at end of file
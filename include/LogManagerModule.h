@@ -43,6 +43,8 @@ private:
   bool newline;
   bool modified;
 
+  static int level;               // The current log level, LOG_LEVEL_SILENT until the module is created.
+
 public:
   LogManagerModule();
   virtual ~LogManagerModule();
@@ -51,8 +53,15 @@ public:
   virtual const char* getName()  { return "Log Manager"; }
 
   virtual size_t write( uint8_t symbol );
+  virtual size_t write( const uint8_t* data, size_t size );
 
   String getLogString();
   void setListenCommandEvents( bool value );
   void setLogLevel( int level );
+
+  // True if the messages of the level are printed, to skip preparing the arguments of others.
+  static bool isLogged( int messageLevel ) { return messageLevel <= level; }
+
+private:
+  bool store( uint8_t symbol );
 };
\ No newline at end of file
@@ -40,7 +40,12 @@ namespace Messages {
   constexpr const char* OK                            = "Ok";
   constexpr const char* OTA_DONE                      = "Firmware upload done!";
   constexpr const char* PALETTE_SELECT                = "Select a palette";
+  constexpr const char* REALTIME_DISABLED             = "Realtime input is disabled";
   constexpr const char* REQUEST_PARAMETER_MISSED      = "Request parameter is missed: ";
+  constexpr const char* SCENE_UNKNOWN                 = "Unknown scene";
+  constexpr const char* SCENES_LIMIT                  = "Too many scenes or invalid scene name";
+  constexpr const char* SCHEDULES_LIMIT               = "Too many schedules";
+  constexpr const char* SD_CARD_MISSED                = "SD card is not mounted";
   constexpr const char* SETTINGS_MISSED_VALUE         = "Missed value: ";
   constexpr const char* SETTINGS_INVALID_VALUE        = ": invalid value";
   constexpr const char* SETTINGS_SAVED_OK             = "Settings are applied";
@@ -6,7 +6,10 @@
 #include <ArduinoJson.h>
 #include "ModuleId.h"
 #include "Options.h"
+#include "core/CommandTable.h"
+#include "core/InlineString.h"
 #include "core/ResultData.h"
+#include "core/StatusData.h"
 
 // ====================================
 /* Module */
@@ -62,11 +65,14 @@ public:
 
   // A generic getData/setData interface
   virtual const uint8_t getByte( const String& key );
-  virtual const String  getString( const String& key ) {return "";}
+  virtual const String  getString( const StringView& key ) {return "";}
   virtual void          setByte( const String& key, const uint8_t value );
-  virtual ResultData    setString( const String& key, const String& value );
+  virtual ResultData    setString( const StringView& key, const String& value );
 
-  bool                  dispatchCommand( const String& command );
+  // Typed status data to text conversion, used for StatusChangedEvent text payloads.
+  virtual const String  serializeStatus( const StatusData& data );
+
+  bool                  dispatchCommand( const StringView& command );
   ResultData            dispatchSettings( const std::map<String,String>& map );
   const Properties      getProperties()  { return properties; }
   virtual void          reinitModule() {;}
@@ -75,10 +81,36 @@ protected:
   virtual bool          handleCommand( const String& cmd, const String& args )  { return false; }
   virtual void          handleCommandResults( const String& cmd, const String& args, const String& result );
   virtual ResultData    handleOption( const String& key, const String& value, Options::Action action ) { return UNKNOWN_OPTION; }
-  virtual void          resolveTemplateKey( const String& key, String& out ) {;}
+  virtual void          resolveTemplateKey( const StringView& key, String& out ) {;}
 
   // Non-virtual protected methods
 
+  /**
+   * Dispatch the command using a command table, see core/CommandTable.h. The "help" command
+   * lists the table commands. Invalid arguments are reported with the command usage.
+   * @return false if the command isn't in the table.
+   */
+  template <typename Table, typename M>
+  bool dispatchCommandTable( M& module, const String& cmd, const String& args ) {
+    switch( Table::dispatch( module, cmd, args )) {
+      case Commands::HANDLED:
+        return true;
+      case Commands::INVALID_ARGS: {
+        String s = Messages::COMMAND_INVALID_VALUE;
+        s += ": ";
+        s += Table::usage( cmd );
+        handleCommandResults( cmd, args, s );
+        return true;
+      }
+      default:
+        if( cmd == "help" ) {
+          handleCommandResults( cmd, args, Table::help() );
+          return true;
+        }
+        return false;
+    }
+  }
+
   const String          getMacroOption( const String& optionKey, const String& defValue = "" ) {
     return getMacroOptionOf( getId(), optionKey, defValue );
   }
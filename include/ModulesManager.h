@@ -30,7 +30,7 @@ public:
   void iterator( ModuleCallback callback );
   void remove( const String& moduleId );
 
-  void dispatchCommand( const String& command );
+  void dispatchCommand( const StringView& command );
 
 private:
   static Module* create( const String& moduleId );
@@ -36,6 +36,8 @@ private:
 
   static MqttClientModule* instance;
 
+  static const Commands::Entry<MqttClientModule> COMMANDS[];
+
 public:
   MqttClientModule();
   virtual ~MqttClientModule();
@@ -48,15 +50,15 @@ public:
   virtual const String  getModuleWebpage();
   virtual const String  getStatusWebpage();
   // A generic getData/setData interface
-  virtual const String  getString( const String& key );
-  virtual ResultData    setString( const String& key, const String& value );
+  virtual const String  getString( const StringView& key );
+  virtual ResultData    setString( const StringView& key, const String& value );
 
   bool                  getDebugLog()  { return flags.debug_log_enabled; }
   const String          getDeviceTopic()  { return getStringOption("Topic", Config::MQTT_DEVICE_TOPIC); }
   bool                  isConnected()  { return connectionState == CONNECTED; }
-  void                  publish( TopicPrefix prefix, const String& subtopic, const JsonDocument& json );
-  void                  publish( TopicPrefix prefix, const String& subtopic, const String& data );
-  void                  publish( const String& topic, const String& data, boolean retained );
+  void                  publish( TopicPrefix prefix, const StringView& subtopic, const JsonDocument& json );
+  void                  publish( TopicPrefix prefix, const StringView& subtopic, const StringView& data );
+  void                  publish( const String& topic, const StringView& data, boolean retained );
   void                  reconnect();
   virtual void          reinitModule() { reconnect(); }
   void                  setDebugLog( bool enabled )  { flags.debug_log_enabled = enabled; }
@@ -64,10 +66,15 @@ public:
 protected:
   virtual bool          handleCommand( const String& cmd, const String& args );
   virtual ResultData    handleOption( const String& key, const String& value, Options::Action action );
-  virtual void          resolveTemplateKey( const String& key, String& out );
+  virtual void          resolveTemplateKey( const StringView& key, String& out );
 
 private:
-  String                buildTopicName( TopicPrefix prefix, const String& topic, const String& subtopic );
+  // Commands
+  void                  cmdDebug( const Commands::Args& args );
+  void                  cmdReconnect( const Commands::Args& args );
+
+  String                buildTopicName( TopicPrefix prefix, const String& topic, const StringView& subtopic );
+  void                  logPublish( const String& topic, const StringView& data, const char* suffix );
   void                  mqttEventsHandler( struct mg_connection* nc, int ev, void* data );
   String                toString( const TopicPrefix prefix );
 
@@ -18,6 +18,8 @@ private:
   uint32_t pollIntervalMs;
   OpenWeather::WeatherData weatherData;
 
+  static const Commands::Entry<OpenWeatherMapModule> COMMANDS[];
+
 public:
   OpenWeatherMapModule();
   virtual ~OpenWeatherMapModule();
@@ -33,9 +35,12 @@ public:
 protected:
   virtual bool                handleCommand( const String& cmd, const String& args );
   virtual ResultData          handleOption( const String& key, const String& value, Options::Action action );
-  virtual void                resolveTemplateKey( const String& key, String& out );
+  virtual void                resolveTemplateKey( const StringView& key, String& out );
 
 private:
+  // Commands
+  void                        cmdUpdate( const Commands::Args& args );
+
   String                      formatTemperature( float value );
   String                      getAppIDOption();
   uint16_t                    getAutoUpdateOption();
@@ -21,14 +21,18 @@ namespace Options {
   extern uint8_t     sleep_time;
 
   void           clear();
+  void           remove( const String& moduleId, const String& key );
   void           setupPreferences();
   const String   makeKey( const String& moduleId, const String& key );
 
+  size_t         getBlob( const String& moduleId, const String& key, void* buf, size_t len );
+  size_t         getBlobLength( const String& moduleId, const String& key );
   const uint8_t  getByte( const String& moduleId, const String& key, uint8_t defValue = 0 );
   const uint32_t getLong( const String& moduleId, const String& key, uint32_t defValue = 0 );
   const uint16_t getShort( const String& moduleId, const String& key, uint16_t defValue = 0 );
   const String   getString( const String& moduleId, const String& key, const String& defValue = "" );
 
+  void           setBlob( const String& moduleId, const String& key, const void* buf, size_t len );
   void           setByte( const String& moduleId, const String& key, uint8_t value );
   void           setLong( const String& moduleId, const String& key, uint32_t value );
   void           setShort( const String& moduleId, const String& key, uint16_t value );
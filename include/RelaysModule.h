@@ -2,6 +2,8 @@
 #include <ArduinoJson.h>
 #include "Messages.h"
 #include "Module.h"
+#include "relays/Backend.h"
+#include "relays/Scheduler.h"
 
 class RelaysModule : public Module {
 private:
@@ -12,19 +14,29 @@ private:
 
   struct RelayInfo {
     String  alias;
-    uint8_t pin;
+    uint8_t pin;                        // GPIO number or expander output (1-based), 0 - no pin.
     bool    inverse;
     bool    persistent;
+    int8_t  channel;                    // The backend channel of the pin, Relays::NO_CHANNEL if none.
   };
 
   static const RelayConfig DEFAULT_CONFIG[];
+  static const uint64_t ALL_RELAYS = ~0ULL;
+  Relays::Backend* backend = nullptr;
+  Relays::Scheduler scheduler;
   RelayInfo relays[Config::RELAY_MAX_RELAYS];
-  uint8_t pendingStateDelay = 0;
-  String pendingState;
+  uint8_t  relaysCount = 0;
+  uint8_t  pendingStateDelay = 0;
+  uint8_t  pendingRelay = 0;
+  uint64_t pendingChanged = 0;          // Relays switched while the status event is pending.
+  time_t   savedScheduleTime = 0;       // The scheduler clock last saved to options.
+
+  static const Commands::Entry<RelaysModule> COMMANDS[];
 
 public:
   RelaysModule();
   virtual ~RelaysModule();
+  virtual void          reinitModule();
   virtual void          tick_100mS( uint8_t phase );
   // Module identification
   virtual const char*   getId()  { return RELAYS_MODULE; }
@@ -33,26 +45,58 @@ public:
   virtual const String  getModuleWebpage();
   virtual const String  getStatusWebpage();
   // A generic getData/setData interface
-  virtual const String  getString( const String& key );
-  virtual ResultData    setString( const String& key, const String& value );
+  virtual const String  getString( const StringView& key );
+  virtual ResultData    setString( const StringView& key, const String& value );
+  virtual const String  serializeStatus( const StatusData& data );
+  // Relay alias, or relay ID if the alias is empty.
+  String                getRelayName( const uint8_t index );
+  // The number of configured relays.
+  uint8_t               getRelaysCount()  { return relaysCount; }
 
 protected:
   virtual bool          handleCommand( const String& cmd, const String& args );
   virtual void          handleCommandResults( const String& cmd, const String& args, const String& result );
-  virtual void          resolveTemplateKey( const String& key, String& out );
+  virtual ResultData    handleOption( const String& key, const String& value, Options::Action action );
+  virtual void          resolveTemplateKey( const StringView& key, String& out );
 
 private:
+  // Commands
+  void                  cmdMask( const Commands::Args& args );
+  void                  cmdScene( const Commands::Args& args );
+  void                  cmdSchedule( const Commands::Args& args );
+
+  uint64_t              applyRelays( uint64_t value, uint64_t select, bool persist );
   ResultData            buildRelayData( const String& data );
+  void                  createBackend();
+  String                getBackendOption();
   String                getDefaultRelayData();
   String                getRelayData();
-  String                getRelayName( const uint8_t index );
+  uint64_t              getRelaysMask();
+  String                getScenes();
+  String                getSchedules();
+  StatusData            getStatusData( const uint8_t index, const uint64_t changed );
+  String                handleSceneCommand( const String& args );
+  String                handleScheduleCommand( const String& args );
   void                  initializeHardware();
-  void                  saveRelayValue( const uint8_t index, const RelayInfo info, const uint8_t value );
-  void                  switchRelay( const uint8_t index, const RelayInfo info, const uint8_t value );
+  uint64_t              loadRelayValues();
+  void                  loadSchedules();
+  bool                  parseMask( const StringView& s, uint64_t& mask, const bool inRange = true );
+  void                  postStatusChange( const uint8_t index, const uint64_t changed );
+  void                  runSchedule( const Relays::Schedule& schedule );
+  void                  saveRelayValues( const uint64_t states );
+  ResultData            saveScenes( const String& scenes );
+  void                  saveSchedules();
+  void                  saveScheduleTime( const bool force );
+  uint64_t              switchRelay( const uint8_t index, const uint8_t value );
+  String                toJsonString( const uint8_t index );
+  bool                  toMask( const JsonVariant value, uint64_t& mask );
+  String                toMaskJson( const uint64_t mask, const uint64_t changed );
+  void                  toMaskString( const uint64_t mask, char* buffer );
   uint8_t               toRelayIndex( const String& value );
+  uint8_t               toTemplateIndex( const StringView& key );
 
-  static String         getRelayHtmlStatus( const RelayInfo info );
+  static const char*    getRelayHtmlStatus( const RelayInfo& info, const bool on );
   static String         getRelayId( const uint8_t index );
+  static bool           isValidSceneName( const char* name );
   static uint8_t        parseRelayPayload( const String& payload );
-  static String         toJsonString( const uint8_t index, const RelayInfo info );
-};
\ No newline at end of file
+};
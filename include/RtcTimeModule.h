@@ -18,6 +18,8 @@ private:
   uint16_t   reconfigureTimeout = 0;
   int        eventBusToken;
 
+  static const Commands::Entry<RtcTimeModule> COMMANDS[];
+
 public:
   RtcTimeModule();
   virtual ~RtcTimeModule();
@@ -28,13 +30,15 @@ public:
   virtual const String  getModuleWebpage();
   virtual const String  getStatusWebpage();
   // A generic getData/setData interface
-  virtual const String  getString( const String& key );
-  virtual ResultData    setString( const String& key, const String& value );
+  virtual const String  getString( const StringView& key );
+  virtual ResultData    setString( const StringView& key, const String& value );
 
   virtual void          reinitModule() { reconfigureNtp(); }
 
   const String          getLocalTimeString();
   const String          getLocalTimeIsoString();
+  // The clock, 0 until it's synchronized.
+  time_t                getLocalTime()  { return local_time; }
   const String          getUptimeString();
   const uint32_t        getUptimeSeconds()  { return uptime; }
   bool                  isMidnightNow();
@@ -43,9 +47,12 @@ public:
 protected:
   virtual bool          handleCommand( const String& cmd, const String& args );
   virtual ResultData    handleOption( const String& key, const String& value, Options::Action action );
-  virtual void          resolveTemplateKey( const String& key, String& out );
+  virtual void          resolveTemplateKey( const StringView& key, String& out );
 
 private:
+  // Commands
+  void                  cmdReconfig( const Commands::Args& args );
+
   void                  handleTickEverySecond( void );
   static String         getIsoDateTime( time_t value );
   static void           tickerCallback( RtcTimeModule* pThis );
@@ -1,19 +1,60 @@
 #pragma once
 #include <lvgl.h>
-#include <Ticker.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include "Module.h"
 #include "lvgl/DisplayDriver.h"
+#include "lvgl/SdFileSystem.h"
+
+/**
+ * A UI update posted to the LVGL task. The callback is called in the LVGL task context,
+ * so it may use any LVGL functions; the payload is copied with the message.
+ */
+struct GuiMessage {
+  void      (*callback)( const GuiMessage& message );
+  void*     target;               // E.g. an LVGL object to update.
+  int32_t   value;
+  char      text[24];
+};
 
 /**
  * The ST7796 480x320 TFT display module.
  */
 class ST7796Module : public Module {
 private:
+  static const uint8_t GUI_QUEUE_LENGTH = 16;
+
+  static constexpr const char* const CACHE_OPTION_KEY = "CacheKb";
+  static constexpr const char* const LINES_OPTION_KEY = "Lines";
+  static constexpr const char* const PSRAM_OPTION_KEY = "Psram";
+  static constexpr const char* const TOUCH_CAL_OPTION_KEY = "TouchCal";
+
+  // Rendering statistics collected by the LVGL callbacks.
+  struct RenderStats {
+    int64_t  windowStart;         // Start of the statistics window, microseconds.
+    uint32_t refreshes;           // Number of completed screen refreshes.
+    uint32_t refreshTime;         // Sum of refresh times reported by LVGL, milliseconds.
+    uint32_t waitTime;            // Microseconds LVGL was blocked by the flushing buffer.
+    int64_t  waitStart;           // Start of the current wait, zero if LVGL doesn't wait.
+    int64_t  waitLast;
+  };
+
   lv_disp_buf_t         bufferInfo;
-  lv_color_t            displayBuffer1[LV_HOR_RES_MAX * LV_VER_RES_MAX / 10];
-  Ticker                ticker_1ms;
-  Ticker                ticker_20ms;
+  lv_color_t*           displayBuffer1 = nullptr;
+  lv_color_t*           displayBuffer2 = nullptr;
+  uint16_t              bufferLines;
+  bool                  bufferInPsram;
+  TaskHandle_t          guiTask = nullptr;
+  SdFileSystem*         sdFileSystem = nullptr;
   static DisplayDriver* driver;
+  static RenderStats    stats;
+  static QueueHandle_t  guiQueue;
+  static SemaphoreHandle_t guiMutex;
+
+  static const Commands::Entry<ST7796Module> COMMANDS[];
 
 public:
   ST7796Module();
@@ -22,14 +63,29 @@ public:
   // Module identification
   virtual const char*   getId()    { return ST7796_MODULE; }
   virtual const char*   getName()  { return Messages::TITLE_ST7796_MODULE; }
+  // Thread-safe UI access from other tasks
+  static bool           post( const GuiMessage& message );
+  static bool           lock()     { return guiMutex && xSemaphoreTakeRecursive( guiMutex, portMAX_DELAY ) == pdTRUE; }
+  static void           unlock()   { if( guiMutex ) xSemaphoreGiveRecursive( guiMutex ); }
 
 protected:
   virtual bool          handleCommand( const String& cmd, const String& args );
+  virtual ResultData    handleOption( const String& key, const String& value, Options::Action action );
 
 private:
+  // Commands
+  void                  cmdBright( const Commands::Args& args );
+  void                  cmdCache( const Commands::Args& args );
+  void                  cmdStats( const Commands::Args& args );
+  void                  cmdTouch( const Commands::Args& args );
+
+  bool                  allocateBuffers( uint16_t lines, bool psram );
   void                  demo_create( void );
+  TouchCalibration      getTouchCalibration();
+  const String          takeStats();
 
   static void flushDisplay( lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p ) {
+    endWait();
     driver->flushArea( drv, area, color_p );
   }
 
@@ -37,11 +93,26 @@ private:
     return driver->readTouch( drv, data );
   }
 
-  static void ticker_1ms_callback( ST7796Module* pThis ) {
-    lv_tick_inc( 1 );
+  static void monitorDisplay( lv_disp_drv_t* drv, uint32_t time, uint32_t px ) {
+    endWait();
+    stats.refreshes++;
+    stats.refreshTime += time;
   }
 
-  static void ticker_20ms_callback( ST7796Module* pThis ) {
-    lv_task_handler();
+  // Called by LVGL in a loop while it waits for the buffer being flushed.
+  static void waitDisplay( lv_disp_drv_t* drv ) {
+    stats.waitLast = esp_timer_get_time();
+    if( stats.waitStart == 0 ) {
+      stats.waitStart = stats.waitLast;
+    }
   }
-};
\ No newline at end of file
+
+  static void endWait() {
+    if( stats.waitStart ) {
+      stats.waitTime += stats.waitLast - stats.waitStart;
+      stats.waitStart = 0;
+    }
+  }
+
+  static void guiTaskFunction( void* arg );
+};
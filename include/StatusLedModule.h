@@ -26,6 +26,8 @@ private:
   uint8_t cycleRepeatCount;
   int8_t  bitPosition;
 
+  static const Commands::Entry<StatusLedModule> COMMANDS[];
+
 public:
   StatusLedModule();
   virtual ~StatusLedModule();
@@ -43,6 +45,9 @@ protected:
   virtual bool         handleCommand( const String& cmd, const String& args );
 
 private:
+  // Commands
+  void                 cmdMode( const Commands::Args& args );
+
   void                 reset();
   void                 setState( bool state );
   String               toJsonString();
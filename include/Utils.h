@@ -20,13 +20,9 @@ namespace Utils {
   int        getWifiRssiAsQuality( int rssi );
 
   // String conversions
-  String     format( const char* fmt, const char* arg1 );
-  String     format( const char* fmt, const String& arg1 );
-  String     format( const char* fmt, const String& arg1, const String& arg2 );
   String     formatModuleSettingsTitle( const char* id, const char* name );
   bool       parseIpString( const char* str, uint32_t* dst );
   uint32_t   parseIpString( const char* str );
-  std::pair<String,String> split( const String& str, const char separator = ' ' );
   String     toJsonString( const char* key, const bool value );
   String     toJsonString( const char* key, const char* value );
   String     toJsonString( const char* key, const int value );
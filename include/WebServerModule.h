@@ -42,6 +42,8 @@ private:
 
   static WebServerModule* instance;
 
+  static const Commands::Entry<WebServerModule> COMMANDS[];
+
 public:
   WebServerModule();
   virtual ~WebServerModule();
@@ -52,15 +54,18 @@ public:
   // Module Web interface
   virtual const String getModuleWebpage();
   // A generic getData/setData interface
-  virtual const String getString( const String& key );
-  virtual ResultData   setString( const String& key, const String& value );
+  virtual const String getString( const StringView& key );
+  virtual ResultData   setString( const StringView& key, const String& value );
 
 protected:
   virtual bool         handleCommand( const String& cmd, const String& args );
   virtual ResultData   handleOption( const String& key, const String& value, Options::Action action );
-  virtual void         resolveTemplateKey( const String& key, String& out );
+  virtual void         resolveTemplateKey( const StringView& key, String& out );
 
 private:
+  // Commands
+  void                 cmdDebug( const Commands::Args& args );
+
   bool                 checkPassword( const char* user, const char* pass );
   void                 checkSessions();
   Session*             createSession( const char* user, const http_message* hm );
@@ -76,7 +81,7 @@ private:
 
   static void          debugLog( const char* msg, const mg_str* s );
   static void          destroySession( Session* s );
-  static void          dispatchCommand( const String& data );
+  static void          dispatchCommand( const StringView& data );
   static String        dispatchSaveSettings( const mg_str* s );
   static Module*       findRequestedModule( mg_connection *nc, void* ev_data );
   static String        getRequestParameter( mg_connection *nc, http_message* hm, const char* key );
@@ -35,6 +35,8 @@ private:
   uint8_t     connectionStatus;                  // WiFi connection status: 0=initial status; WL_CONNECTED
   uint8_t     connectionRetries;                 // Number of reconnection retries
 
+  static const Commands::Entry<WifiModule> COMMANDS[];
+
 public:
   WifiModule();
   virtual ~WifiModule();
@@ -46,8 +48,8 @@ public:
   virtual const String     getModuleWebpage();
   virtual const String     getStatusWebpage();
   // A generic getData/setData interface
-  virtual const String     getString( const String& key );
-  virtual ResultData       setString( const String& key, const String& value );
+  virtual const String     getString( const StringView& key );
+  virtual ResultData       setString( const StringView& key, const String& value );
 
   virtual void             reinitModule();
 
@@ -60,9 +62,14 @@ public:
 protected:
   virtual bool             handleCommand( const String& cmd, const String& args );
   virtual ResultData       handleOption( const String& key, const String& value, Options::Action action );
-  virtual void             resolveTemplateKey( const String& key, String& out );
+  virtual void             resolveTemplateKey( const StringView& key, String& out );
 
 private:
+  // Commands
+  void                     cmdDebug( const Commands::Args& args );
+  void                     cmdManager( const Commands::Args& args );
+  void                     cmdReconnect( const Commands::Args& args );
+
   void                     checkConnection();
   Config::WifiConfigMethod getConfigMethodOption();
   String                   getIPAddressOption( const char* key, const char* def );
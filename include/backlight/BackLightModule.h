@@ -1,8 +1,11 @@
 #pragma once
+#include <mongoose.h>
 #include <Ticker.h>
 #include "Module.h"
 #include "Messages.h"
 #include "backlight/Effect.h"
+#include "backlight/ParamsCache.h"
+#include "backlight/RealtimeInput.h"
 
 class BackLightModule : public Module {
 
@@ -10,45 +13,87 @@ class BackLightModule : public Module {
 
 private:
   static constexpr const char* const MODULE_CONFIG_KEY    = "Config";
+  static constexpr const char* const DITHER_OPTION_KEY    = "Dither";
   static constexpr const char* const FIX_WHITE_OPTION_KEY = "FixWhite";
+  static constexpr const char* const GAMMA_OPTION_KEY     = "Gamma";
+  static constexpr const char* const HEIGHT_OPTION_KEY    = "Height";
   static constexpr const char* const MAX_POWER_OPTION_KEY = "MaxPower";
   static constexpr const char* const PIN_OPTION_KEY       = "Pin";
   static constexpr const char* const PIXELS_OPTION_KEY    = "Pixels";
+  static constexpr const char* const REALTIME_OPTION_KEY  = "Realtime";
+  static constexpr const char* const ROTATION_OPTION_KEY  = "Rotation";
+  static constexpr const char* const RT_TIMEOUT_OPTION_KEY = "RtTimeout";
+  static constexpr const char* const SERPENTINE_OPTION_KEY = "Serpentine";
+  static constexpr const char* const UNIVERSE_OPTION_KEY  = "Universe";
+  static constexpr const char* const WIDTH_OPTION_KEY     = "Width";
 
   NeoPixelWrapper* strip;
   NeoPixelAnimator animations = NeoPixelAnimator( 2, NEO_MILLISECONDS );
   Backlight::Effect* effect = nullptr;
   RgbColor fixWhiteColor;
   String   lastEffectId;
+  Backlight::ParamsCache params;
+
+  // Realtime UDP input.
+  int      eventBusToken;
+  mg_mgr   manager;
+  mg_connection* realtimeConnection = nullptr;
+  Backlight::RealtimeInput* realtime = nullptr;
+  String   suspendedEffectId;
+
+  static BackLightModule* instance;
+
+  static const Commands::Entry<BackLightModule> COMMANDS[];
 
 public:
   BackLightModule();
   virtual ~BackLightModule();
+  // Module management
+  virtual void loop();
+  virtual void tick_100mS( uint8_t phase );
   // Module identification
   virtual const char* getId()    { return BACKLIGHT_MODULE; }
   virtual const char* getName()  { return Messages::TITLE_BACKLIGHT_MODULE; }
   // Module Web interface
   virtual const String getModuleWebpage();
   // A generic getData/setData interface
-  virtual const String getString( const String& key );
-  virtual ResultData   setString( const String& key, const String& value );
+  virtual const String getString( const StringView& key );
+  virtual ResultData   setString( const StringView& key, const String& value );
 
 protected:
   virtual bool       handleCommand( const String& cmd, const String& args );
   virtual ResultData handleOption( const String& key, const String& value, Options::Action action );
-  virtual void       resolveTemplateKey( const String& key, String& out );
+  virtual void       resolveTemplateKey( const StringView& key, String& out );
 
 private:
-  void   performEffect( const String& jsonOptions );
+  // Commands
+  void               cmdAdjust( const Commands::Args& args );
+  void               cmdFps( const Commands::Args& args );
+  void               cmdOff( const Commands::Args& args );
+  void               cmdOn( const Commands::Args& args );
+  void               cmdPower( const Commands::Args& args );
+  void               cmdRealtime( const Commands::Args& args );
+  void               cmdSet( const Commands::Args& args );
+
+  void   applyParams( uint8_t index );
+  Backlight::EffectParams getEffectParams( uint8_t index );
+  void   performEffect( uint8_t index );
   void   reset( bool resetStrip );
 
+  void   bindRealtime();
+  void   realtimeEventHandler( mg_connection* nc, int ev, void* ev_data );
+  void   resumeEffect();
+  void   setupRealtime( const JsonObject& json );
+  void   suspendEffect();
+
   String buildEffectsHtmlOptions();
   String buildPalettesHtmlOptions();
   String getJsonConfig();
   void   setJsonConfig( const String& cfg );
 
   static void appendOption( String& out, const String& id, const String& title );
+  static void     applyOutputOptions( NeoPixelWrapper* strip, const JsonObject& json );
+  static Backlight::MatrixLayout::Geometry getLayoutOption( const JsonObject& json, uint16_t pixelsCount );
   static RgbColor getFixWhiteOption( const JsonObject& json );
   static uint16_t getMaxPowerBudget( const JsonObject& json );
-  static String makeDefaultEffectOptions( const String& effectId );
 };
\ No newline at end of file
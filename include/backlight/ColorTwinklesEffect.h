@@ -13,6 +13,9 @@ namespace Backlight {
       ColorTwinklesEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator );
       virtual void perform();
 
+    protected:
+      virtual void renderFrame( const FrameTime& time );
+
     private:
       void draw();
   };
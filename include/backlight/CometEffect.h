@@ -8,5 +8,8 @@ namespace Backlight {
     public:
       CometEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator );
       virtual void perform();
+
+    protected:
+      virtual void renderFrame( const FrameTime& time );
   };
 }
\ No newline at end of file
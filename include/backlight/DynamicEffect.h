@@ -1,16 +1,41 @@
 #pragma once
 #include <ArduinoLog.h>
 #include <Ticker.h>
+#include <esp_timer.h>
 #include "Effect.h"
 #include "RgbPalette.h"
 
 namespace Backlight {
 
+  // Frame timing passed to the time-driven effects.
+  struct FrameTime {
+    uint32_t elapsed;         // Milliseconds since the effect has been started.
+    uint32_t delta;           // Microseconds since the previous rendered frame.
+    uint8_t  steps;           // Number of nominal FRAMETIME steps covered by this frame.
+  };
+
   class DynamicEffect : public Effect {
+  protected:
+    static const uint32_t FRAME_INTERVAL_US = FRAMETIME * 1000UL;   // Nominal frame length, microseconds.
+
   private:
+    static const uint8_t  MAX_CATCHUP_STEPS = 4;                    // Late steps above this are dropped.
+    static const uint32_t FPS_WINDOW_US     = 1000000UL;            // Frame rate measurement window.
+
     Ticker        ticker;
     String        paletteId;
+    uint8_t       paletteIndex = 0;           // Palette index of the params, applied or pending.
     uint32_t      lastPaletteChange;
+    volatile int8_t pendingPalette = -1;      // Palette index to be applied in the ticker context.
+
+    bool          framesEnabled = false;
+    int64_t       startTime;
+    int64_t       lastFrameTime;
+    uint32_t      stepAccumulator;
+    int64_t       fpsWindowStart;
+    uint16_t      fpsFrames;
+    uint16_t      fps = 0;
+    uint32_t      droppedFrames = 0;
 
   protected:
     RgbPalette16* palette = nullptr;
@@ -28,6 +53,9 @@ namespace Backlight {
 
     virtual void perform() = 0;
 
+    virtual const uint16_t getFps()           { return framesEnabled ? fps : 0; }
+    virtual const uint32_t getDroppedFrames() { return droppedFrames; }
+
   protected:
     void startTicker() {
       ticker.attach_ms( 1, tickerCallback, this );
@@ -37,39 +65,52 @@ namespace Backlight {
       ticker.detach();
     }
 
+    // Start rendering frames with renderFrame(), driven by the monotonic microseconds clock.
+    void startFrames();
+
+    // Stop rendering frames, e.g. when a one-shot effect is complete.
+    void stopFrames();
+
+    // Render a single frame. The effect state must be derived from the frame time,
+    // not from the number of calls, so effects keep their pace when frames are late.
+    virtual void renderFrame( const FrameTime& time ) {}
+
     virtual const String getDefaultPaletteId() {
       return "party";
     }
 
-    virtual void readOptions( const JsonDocument& doc ) {
-      Effect::readOptions( doc );
-      // palette option
-      if( capabilities.hasPalette && doc.containsKey( PALETTE_KEY )) {
-        const String id = doc[PALETTE_KEY];
-        paletteId = id;
-        palette = createPalette( paletteId );
+    virtual void readParams( const EffectParams& params ) {
+      Effect::readParams( params );
+      const uint8_t index = capabilities.hasPalette ? params.palette : 1;
+      // The first palette is created right away, later changes are applied between frames.
+      // Other params (brightness, speed...) keep the palette, including the "random" one.
+      if( palette ) {
+        if( index != paletteIndex ) {
+          paletteIndex = index;
+          pendingPalette = index;
+        }
       } else {
-        paletteId = getDefaultPaletteId();
+        paletteIndex = index;
+        paletteId = RgbPalette16::getPaletteId( index );
         palette = createPalette( paletteId );
       }
     }
 
   private:
     RgbPalette16* createPalette( const String& id );
+    void          nextFrame( int64_t now );
+    void          updatePalette();
 
     void tickEveryMillisecond( void ) {
-      if( animator.IsAnimating() ) {
+      if( framesEnabled ) {
+        nextFrame( esp_timer_get_time() );
+      }
+      else if( animator.IsAnimating() ) {
         animator.UpdateAnimations();
         if( strip.canShow() ) {
           strip.show();
         }
-        if( paletteId == "random" ) {
-          if( millis() - lastPaletteChange > 1000 + ((uint32_t)(255-intensity)) * 100 ) {
-            if( palette ) delete palette;
-            palette = createPalette( paletteId );
-            lastPaletteChange = millis();
-          }
-        }
+        updatePalette();
       }
     }
 
@@ -77,4 +118,4 @@ namespace Backlight {
       pThis->tickEveryMillisecond();
     }
   };
-}
\ No newline at end of file
+}
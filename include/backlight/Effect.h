@@ -1,6 +1,7 @@
 #pragma once
 #include <ArduinoJson.h>
 #include "types.h"
+#include "EffectParams.h"
 #include "NeoPixelWrapper.h"
 
 namespace Backlight {
@@ -41,16 +42,19 @@ namespace Backlight {
     const Capabilities getCapabilities()                 { return capabilities; }
     const RgbColor     getColor()                        { return color; }
     const uint8_t      getIntensity()                    { return intensity; }
-    const String       getOptions();
     const uint8_t      getSpeed()                        { return speed; }
+    virtual const uint16_t getFps()                      { return 0; }
+    virtual const uint32_t getDroppedFrames()            { return 0; }
     void               setColor( const RgbColor& clr )   { color = clr; }
-    void               setOptions( const String& json );
+    void               setParams( const EffectParams& params ) { readParams( params ); }
+    void               adjust( const EffectParams& params )    { readParams( params ); refresh(); }
     void               setSpeed( uint8_t sp )            { speed = sp; }
 
   protected:
     void               blur( uint8_t blur_amount );
     void               fadeOut( uint8_t rate );
-    virtual void       readOptions( const JsonDocument& doc );
+    virtual void       readParams( const EffectParams& params );
+    virtual void       refresh() {}
     uint16_t           speedFormulaValue();
   };
 }
\ No newline at end of file
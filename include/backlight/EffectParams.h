@@ -0,0 +1,17 @@
+#pragma once
+#include <stdint.h>
+
+namespace Backlight {
+
+  // Compact parameters of a single effect.
+  struct EffectParams {
+    uint8_t bright;
+    uint8_t speed;
+    uint8_t intensity;
+    uint8_t palette;          // Index in the PALETTE_ID array.
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t spare;
+  };
+}
@@ -21,6 +21,9 @@ namespace Backlight {
       "glitter",           // 8
       "comet",             // 9
       "noise1",            // 10
+      "noise2d",           // 11
+      "rain2d",            // 12
+      "ripple2d",          // 13
     };
 
     static const char* const LIGHT_EFFECT_TITLE[] = {
@@ -35,6 +38,9 @@ namespace Backlight {
       "Glitter",
       "Comet",
       "Noise 1",
+      "Noise 2D",
+      "Rain 2D",
+      "Ripple 2D",
     };
 
     /**
@@ -13,6 +13,7 @@ namespace Backlight {
       virtual void perform();
 
     protected:
+      virtual void renderFrame( const FrameTime& time );
       void drawFireworks();
   };
 }
\ No newline at end of file
@@ -8,7 +8,10 @@ namespace Backlight {
       GlitterEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator );
       virtual void perform();
 
+    protected:
+      virtual void renderFrame( const FrameTime& time );
+
     private:
-      void drawPalette();
+      void drawPalette( uint32_t elapsed );
   };
 }
\ No newline at end of file
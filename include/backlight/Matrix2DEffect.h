@@ -0,0 +1,31 @@
+#pragma once
+#include "DynamicEffect.h"
+#include "MatrixLayout.h"
+
+namespace Backlight {
+
+  /**
+   * The base class of 2D effects. Pixels are addressed by (x, y) through the strip
+   * matrix layout, so the effects never compute the wiring order themselves.
+   * The layout must not be changed while an effect is running.
+   */
+  class Matrix2DEffect : public DynamicEffect {
+    protected:
+      const MatrixLayout& layout;
+      const uint16_t      width;
+      const uint16_t      height;
+
+    public:
+      Matrix2DEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator ) :
+        DynamicEffect(strip, animator), layout(strip.getLayout()),
+        width(layout.getWidth()), height(layout.getHeight()) {}
+
+    protected:
+      // 2D span primitives.
+      void           blur2d( uint8_t amount );
+      void           shiftDown();
+
+    private:
+      void           blurLine( const uint16_t* index, uint16_t count, uint16_t stride, uint8_t amount );
+  };
+}
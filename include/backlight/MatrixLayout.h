@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+namespace Backlight {
+
+  /**
+   * Layout of the LEDs wired as a 2D matrix. The strip index of every (x, y) position
+   * is computed once, when the layout is configured, and stored in a flat table.
+   * Coordinates are logical, i.e. already rotated; (0, 0) is the top left corner.
+   */
+  class MatrixLayout {
+    public:
+      enum Rotation : uint8_t { ROTATE_0, ROTATE_90, ROTATE_180, ROTATE_270 };
+
+      struct Geometry {
+        uint16_t width;             // Physical width, i.e. the number of LEDs in a wired row.
+        uint16_t height;            // Physical number of rows.
+        bool     serpentine;        // True if every odd row is wired in the reverse direction.
+        Rotation rotation;          // Clockwise rotation of the logical coordinates.
+      };
+
+    private:
+      Geometry geometry = { 0, 1, false, ROTATE_0 };
+      uint16_t width = 0;           // Logical width.
+      uint16_t height = 1;          // Logical height.
+      std::vector<uint16_t> table;
+
+    public:
+      bool     configure( const Geometry& g );
+      const Geometry& getGeometry() const                   { return geometry; }
+      bool     matches( const Geometry& g ) const;
+      uint16_t getHeight() const                            { return height; }
+      uint16_t getWidth() const                             { return width; }
+      const uint16_t* row( uint16_t y ) const               { return &table[y * width]; }
+      uint16_t xy( uint16_t x, uint16_t y ) const           { return table[y * width + x]; }
+
+      static Geometry makeGeometry( uint16_t width, uint16_t height, bool serpentine, uint16_t degrees, uint16_t pixelsCount );
+  };
+}
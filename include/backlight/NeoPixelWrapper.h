@@ -1,6 +1,9 @@
 #pragma once
-#include <NeoPixelBrightnessBus.h>
+#include <algorithm>
+#include <vector>
+#include <NeoPixelBus.h>
 #include <NeoPixelAnimator.h>
+#include "MatrixLayout.h"
 
 class NeoPixelWrapper {
 private:
@@ -16,29 +19,49 @@ private:
   const uint16_t MCU_POWER_CONSUMPTION = 100;
 
   typedef Neo800KbpsMethod RgbStripMethod;
-  typedef NeoPixelBrightnessBus<NeoGrbFeature, RgbStripMethod> RgbStrip;
+  typedef NeoPixelBus<NeoGrbFeature, RgbStripMethod> RgbStrip;
 
   RgbStrip  strip;
   uint8_t   stripPin;
   uint8_t   brightness;
+  uint8_t   powerLimit = 255;                 // Brightness scale applied by the power limiter.
   uint16_t  currentMilliampers = 0;
   uint16_t  maxPowerBudget;
 
+  // The output stage. Effects work with linear colors in the frame buffer, show() converts
+  // them to the strip data with gamma correction, brightness and temporal dithering.
+  std::vector<RgbColor> frame;                // Linear colors, as set by effects.
+  std::vector<uint8_t>  dither;               // Per channel 8-bit residuals carried to the next frame.
+  uint16_t  gammaTable[256];                  // 8-bit linear to 16-bit gamma corrected values.
+  bool      ditherEnabled = true;
+
+  Backlight::MatrixLayout layout;             // 2D coordinates mapping, a single row by default.
+
 public:
   NeoPixelWrapper( uint16_t pixelsCount, uint8_t pin ) :
-    strip( pixelsCount, pin ) {
+    strip( pixelsCount, pin ), frame( pixelsCount ), dither( pixelsCount * 3, 0x80 ) {
     stripPin = pin;
+    setGamma( 1.0 );
+    layout.configure( Backlight::MatrixLayout::makeGeometry( 0, 0, false, 0, pixelsCount ));
   }
   void     begin()                                        { strip.Begin(); }
   bool     canShow()                                      { return strip.CanShow(); }
-  void     clearTo( RgbColor color )                      { strip.ClearTo( color ); }
+  void     clearTo( RgbColor color )                      { std::fill( frame.begin(), frame.end(), color ); }
   uint8_t  getBrightness()                                { return brightness; }
+  const    Backlight::MatrixLayout& getLayout()           { return layout; }
   uint8_t  getPin()                                       { return stripPin; }
-  const    RgbColor getPixelColor( uint16_t index )       { return strip.GetPixelColor( index ); }
-  uint16_t getPixelsCount()                               { return strip.PixelCount(); }
+  const    RgbColor getPixelColor( uint16_t index )       { return index < frame.size() ? frame[index] : RgbColor( 0 ); }
+  uint16_t getPixelsCount()                               { return frame.size(); }
   uint16_t getStripCurrent()                              { return currentMilliampers; }
   void     setBrightness( uint8_t value );
+  void     setChannels( uint32_t channel, const uint8_t* data, size_t count );
+  void     setDither( bool enabled )                      { ditherEnabled = enabled; std::fill( dither.begin(), dither.end(), 0x80 ); }
+  void     setGamma( float gamma );
+  bool     setLayout( const Backlight::MatrixLayout::Geometry& g ) { return layout.configure( g ); }
   void     setMaxPowerBudget( uint16_t current )          { maxPowerBudget = current; }
-  void     setPixelColor( uint16_t index, RgbColor color) { strip.SetPixelColor( index, color ); }
+  void     setPixelColor( uint16_t index, RgbColor color) { if( index < frame.size() ) frame[index] = color; }
   void     show();
-};
\ No newline at end of file
+
+private:
+  uint32_t render();
+};
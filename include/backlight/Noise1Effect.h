@@ -13,6 +13,8 @@ namespace Backlight {
       virtual void perform();
 
     protected:
+      virtual void renderFrame( const FrameTime& time );
+
       virtual const String getDefaultPaletteId() {
         return "drywet";
       }
@@ -0,0 +1,23 @@
+#pragma once
+#include "Matrix2DEffect.h"
+
+namespace Backlight {
+
+  // 2D noise field drifting over the matrix. Drift velocity from speed.
+  class Noise2DEffect : public Matrix2DEffect {
+    private:
+      const uint16_t scale = 1200;    // The "zoom factor" for the noise
+      uint32_t step = 0;
+
+    public:
+      Noise2DEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator );
+      virtual void perform();
+
+    protected:
+      virtual void renderFrame( const FrameTime& time );
+
+      virtual const String getDefaultPaletteId() {
+        return "drywet";
+      }
+  };
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "EffectParams.h"
+#include "Factory.h"
+
+namespace Backlight {
+
+  /**
+   * Parameters of all effects, loaded once and kept in RAM. Commands update entries in place,
+   * the whole table is persisted lazily as a single NVS blob when it's been idle for a while.
+   */
+  class ParamsCache {
+    private:
+      static constexpr const char* const BLOB_OPTION_KEY = "FxParams";
+      static const uint32_t PERSIST_DELAY = 5000;     // Milliseconds since the last change.
+
+      EffectParams  entries[Factory::getEffectsCount()];
+      bool          dirty = false;
+      unsigned long lastChange;
+
+    public:
+      void          load();
+      bool          persist( bool force );
+
+      EffectParams& get( uint8_t index )                  { return entries[index]; }
+      void          markDirty()                           { dirty = true; lastChange = millis(); }
+
+      static EffectParams defaults();
+      static bool   readJson( EffectParams& params, const JsonDocument& doc );
+      static bool   setValue( EffectParams& params, const String& key, const String& value );
+      static String toJson( const String& effectId, const EffectParams& params );
+  };
+}
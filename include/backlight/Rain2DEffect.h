@@ -0,0 +1,19 @@
+#pragma once
+#include "Matrix2DEffect.h"
+
+namespace Backlight {
+
+  // Drops falling down the matrix columns. Falling velocity from speed. Drop rate from intensity.
+  class Rain2DEffect : public Matrix2DEffect {
+    private:
+      static const uint8_t TRAIL_FADE = 160;
+      uint32_t counterModeStep = 0;
+
+    public:
+      Rain2DEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator );
+      virtual void perform();
+
+    protected:
+      virtual void renderFrame( const FrameTime& time );
+  };
+}
@@ -5,10 +5,12 @@ namespace Backlight {
 
   class RainEffect : public FireworksEffect {
     private:
-      uint16_t counterModeStep;
+      uint32_t counterModeStep = 0;
 
     public:
       RainEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator );
-      virtual void perform();
+
+    protected:
+      virtual void renderFrame( const FrameTime& time );
   };
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "NeoPixelWrapper.h"
+
+namespace Backlight {
+
+  /**
+   * Realtime pixel streaming input. Decodes DDP or E1.31 (sACN) datagrams and writes the
+   * pixel data straight into the strip frame buffer. Out of order and late datagrams are
+   * dropped by their sequence numbers.
+   */
+  class RealtimeInput {
+    public:
+      enum Protocol : uint8_t { NONE, DDP, E131 };
+
+      static const uint16_t DDP_PORT  = 4048;
+      static const uint16_t E131_PORT = 5568;
+
+      struct Counters {
+        uint32_t received;
+        uint32_t dropped;
+        uint32_t applied;
+      };
+
+    private:
+      static const uint8_t  DDP_HEADER_SIZE       = 10;
+      static const uint8_t  DDP_TIMECODE_SIZE     = 4;
+      static const uint8_t  DDP_FLAG_VERSION_MASK = 0xC0;
+      static const uint8_t  DDP_FLAG_VERSION_1    = 0x40;
+      static const uint8_t  DDP_FLAG_TIMECODE     = 0x10;
+      static const uint8_t  DDP_FLAG_PUSH         = 0x01;
+      static const uint8_t  DDP_TYPE_RGB24        = 0x0B;
+      static const uint8_t  DDP_ID_DISPLAY        = 1;
+
+      static const uint8_t  E131_HEADER_SIZE      = 126;
+      static const uint8_t  E131_OPTION_PREVIEW   = 0x80;
+      static const uint8_t  E131_OPTION_TERMINATE = 0x40;
+      static const uint8_t  E131_MAX_UNIVERSES    = 8;    // 170 pixels per universe.
+      static const uint16_t E131_UNIVERSE_SIZE    = 510;  // Channels used in a universe, i.e. 170 RGB pixels.
+
+      NeoPixelWrapper* strip;
+      Protocol         protocol;
+      uint16_t         timeout;                            // Milliseconds without frames to fall back to the effect.
+      uint16_t         firstUniverse;
+      int16_t          ddpSequence = -1;
+      int16_t          e131Sequence[E131_MAX_UNIVERSES];
+      unsigned long    lastFrame = 0;
+      bool             active = false;
+      bool             showPending = false;
+      Counters         counters = {0, 0, 0};
+
+    public:
+      RealtimeInput( NeoPixelWrapper* strip, Protocol protocol, uint16_t timeout, uint16_t firstUniverse );
+
+      bool             receive( const uint8_t* data, size_t len );
+      bool             checkTimeout();
+      const Counters&  getCounters()                         { return counters; }
+      uint16_t         getPort()                             { return protocol == E131 ? E131_PORT : DDP_PORT; }
+      Protocol         getProtocol()                         { return protocol; }
+      bool             isActive()                            { return active; }
+      void             setStrip( NeoPixelWrapper* s )        { strip = s; }
+      bool             takeShowRequest();
+
+      static Protocol  toProtocol( const char* name );
+
+    private:
+      bool             receiveDdp( const uint8_t* data, size_t len );
+      bool             receiveE131( const uint8_t* data, size_t len );
+      static bool      isLate( int16_t last, uint8_t seq, uint16_t modulo, uint8_t window );
+  };
+}
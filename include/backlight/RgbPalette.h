@@ -77,9 +77,10 @@ namespace Backlight {
         return PALETTE_TITLE[index];
       }
 
-    private:
       static int8_t findPaletteById( const String& effectId );
 
+    private:
+
       static void fill_gradient( RgbColor* target, uint16_t startpos, CHSV startcolor, uint16_t endpos, CHSV endcolor,
                                  TGradientDirectionCode directionCode  = SHORTEST_HUES );
       static void fill_gradient( RgbColor* target, uint16_t numLeds, const CHSV& c1, const CHSV& c2, const CHSV& c3, const CHSV& c4 );
@@ -0,0 +1,34 @@
+#pragma once
+#include "Matrix2DEffect.h"
+
+namespace Backlight {
+
+  // Circular water ripples on the matrix. Propagation velocity from speed. Drop rate from intensity.
+  class Ripple2DEffect : public Matrix2DEffect {
+    private:
+      static const uint8_t  MAX_RIPPLES = 4;
+      static const uint16_t RING_WIDTH  = 32;   // Ring half width, 1/16 of pixel.
+
+      struct RippleData {
+        uint8_t  state = 0;
+        uint16_t x;
+        uint16_t y;
+        uint8_t  colorIndex;
+      };
+
+      uint8_t    maxRipples;
+      RippleData store[MAX_RIPPLES];
+      // Distance from (0, 0) to (dx, dy) in 1/16 of pixel, indexed by dy * width + dx.
+      std::vector<uint16_t> distance;
+
+    public:
+      Ripple2DEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator );
+      virtual void perform();
+
+    protected:
+      virtual void renderFrame( const FrameTime& time );
+
+    private:
+      void drawRipple( const RippleData& ripple, uint16_t radius, uint8_t amp );
+  };
+}
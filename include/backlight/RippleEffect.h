@@ -21,7 +21,10 @@ namespace Backlight {
       virtual ~RippleEffect();
       virtual void perform();
 
+    protected:
+      virtual void renderFrame( const FrameTime& time );
+
     private:
-      void drawWave();
+      void drawWave( uint8_t steps );
   };
 }
\ No newline at end of file
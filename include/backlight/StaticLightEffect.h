@@ -14,5 +14,10 @@ namespace Backlight {
       strip.clearTo( color );
       strip.show();
     }
+
+  protected:
+    virtual void refresh() {
+      perform();
+    }
   };
 }
\ No newline at end of file
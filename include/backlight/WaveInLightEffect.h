@@ -9,5 +9,8 @@ namespace Backlight {
     public:
       WaveInLightEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator );
       virtual void perform();
+
+    protected:
+      virtual void renderFrame( const FrameTime& time );
   };
 }
\ No newline at end of file
@@ -0,0 +1,238 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <WString.h>
+
+/**
+ * Declarative command tables.
+ *
+ * A module declares its commands as a constexpr array of entries (name, argument schema,
+ * handler, help) and dispatches them with Commands::Table. The table is turned into a
+ * perfect hash at compile time: a command is found by one hash, one slot lookup and one
+ * strcmp, the argument is parsed and validated against the schema before the handler call.
+ *
+ *   // Header
+ *   static const Commands::Entry<MyModule> COMMANDS[];
+ *   void cmdTemp( const Commands::Args& args );
+ *
+ *   // Source
+ *   constexpr Commands::Entry<MyModule> MyModule::COMMANDS[] = {
+ *     { "temp", Commands::number( 14, 31 ), &MyModule::cmdTemp, "Set the temperature" },
+ *   };
+ *   bool MyModule::handleCommand( const String& cmd, const String& args ) {
+ *     return dispatchCommandTable<COMMAND_TABLE(MyModule, COMMANDS)>( *this, cmd, args );
+ *   }
+ */
+
+#define COMMAND_TABLE(cls, table)  Commands::Table<cls, cls::table, sizeof(cls::table) / sizeof(cls::table[0])>
+
+namespace Commands {
+
+  /* Argument schema */
+
+  enum ArgType : uint8_t {
+    ARG_NONE,                   // No argument, anything given is ignored.
+    ARG_TEXT,                   // Any text, passed as is.
+    ARG_NUMBER,                 // An integer number in the [min..max] range.
+    ARG_CHOICE                  // One of the choices, passed as the choice index.
+  };
+
+  struct ArgSchema {
+    ArgType            type;
+    bool               optional;
+    int32_t            min;
+    int32_t            max;
+    const char* const* choices;
+    uint8_t            choicesCount;
+  };
+
+  constexpr ArgSchema none()                                         { return { ARG_NONE, true, 0, 0, nullptr, 0 }; }
+  constexpr ArgSchema text( bool optional = false )                  { return { ARG_TEXT, optional, 0, 0, nullptr, 0 }; }
+  constexpr ArgSchema number( int32_t min, int32_t max, bool optional = false ) {
+    return { ARG_NUMBER, optional, min, max, nullptr, 0 };
+  }
+  template <size_t N>
+  constexpr ArgSchema choice( const char* const (&choices)[N], bool optional = false ) {
+    return { ARG_CHOICE, optional, 0, 0, choices, N };
+  }
+
+  /* Parsed arguments */
+
+  struct Args {
+    const String& cmd;
+    const String& raw;          // The argument as given.
+    bool          present;      // False if an optional argument is omitted.
+    int32_t       number;       // ARG_NUMBER value.
+    int8_t        choice;       // ARG_CHOICE index.
+  };
+
+  /* Table entry */
+
+  template <typename M>
+  struct Entry {
+    const char* name;
+    ArgSchema   arg;
+    void        (M::*handler)( const Args& args );
+    const char* help;
+  };
+
+  enum Status { NOT_FOUND, INVALID_ARGS, HANDLED };
+
+  /* Compile time helpers */
+
+  // FNV-1a with a seed, the seed is selected to make the table hash perfect.
+  constexpr uint32_t hash( const char* s, uint32_t h ) {
+    return *s ? hash( s + 1, (h ^ static_cast<uint8_t>(*s)) * 16777619u ) : h;
+  }
+
+  constexpr size_t tableSize( size_t count, size_t size = 1 ) {
+    return size >= count * 2 ? size : tableSize( count, size * 2 );
+  }
+
+  template <size_t... I> struct Indexes {};
+  template <size_t N, size_t... I> struct MakeIndexes : MakeIndexes<N - 1, N - 1, I...> {};
+  template <size_t... I> struct MakeIndexes<0, I...> { typedef Indexes<I...> type; };
+
+  const uint32_t FIRST_SEED = 2166136261u;
+  const uint32_t MAX_SEEDS  = 256;
+
+  template <typename M>
+  constexpr uint32_t slotOf( const Entry<M>* table, size_t i, uint32_t seed, size_t size ) {
+    return hash( table[i].name, seed ) & (size - 1);
+  }
+
+  template <typename M>
+  constexpr bool collides( const Entry<M>* table, size_t count, size_t size, uint32_t seed, size_t i, size_t j ) {
+    return j < count && (slotOf( table, i, seed, size ) == slotOf( table, j, seed, size ) || collides( table, count, size, seed, i, j + 1 ));
+  }
+
+  template <typename M>
+  constexpr bool isPerfect( const Entry<M>* table, size_t count, size_t size, uint32_t seed, size_t i = 0 ) {
+    return i >= count || (!collides( table, count, size, seed, i, i + 1 ) && isPerfect( table, count, size, seed, i + 1 ));
+  }
+
+  template <typename M>
+  constexpr uint32_t findSeed( const Entry<M>* table, size_t count, size_t size, uint32_t seed = FIRST_SEED ) {
+    return seed >= FIRST_SEED + MAX_SEEDS || isPerfect( table, count, size, seed ) ? seed : findSeed( table, count, size, seed + 1 );
+  }
+
+  template <typename M>
+  constexpr int8_t entryAt( const Entry<M>* table, size_t count, size_t size, uint32_t seed, uint32_t slot, size_t i = 0 ) {
+    return i >= count ? -1 : slotOf( table, i, seed, size ) == slot ? i : entryAt( table, count, size, seed, slot, i + 1 );
+  }
+
+  /* Table */
+
+  template <typename M, const Entry<M>* TABLE, size_t COUNT>
+  class Table {
+  public:
+    static constexpr size_t   SIZE = tableSize( COUNT );
+    static constexpr uint32_t SEED = findSeed( TABLE, COUNT, SIZE );
+    static_assert( COUNT < 128, "Too many commands in the table" );
+    static_assert( SEED < FIRST_SEED + MAX_SEEDS, "Cannot build a perfect hash, check the table for duplicated names" );
+
+  private:
+    // Entry index per hash slot, -1 for empty slots.
+    template <typename Indexes> struct Slots;
+    template <size_t... I>
+    struct Slots<Indexes<I...>> {
+      static constexpr int8_t values[SIZE] = { entryAt( TABLE, COUNT, SIZE, SEED, I )... };
+    };
+    typedef Slots<typename MakeIndexes<SIZE>::type> SlotTable;
+
+  public:
+    // Returns the entry index or -1.
+    static int find( const char* name ) {
+      const int8_t index = SlotTable::values[hash( name, SEED ) & (SIZE - 1)];
+      return index >= 0 && strcmp( TABLE[index].name, name ) == 0 ? index : -1;
+    }
+
+    static Status dispatch( M& module, const String& cmd, const String& args ) {
+      const int index = find( cmd.c_str() );
+      if( index < 0 ) return NOT_FOUND;
+      const Entry<M>& entry = TABLE[index];
+      Args parsed = { cmd, args, args.length() > 0, 0, -1 };
+      if( !parse( entry.arg, parsed )) return INVALID_ARGS;
+      (module.*entry.handler)( parsed );
+      return HANDLED;
+    }
+
+    // "name <arg>" of the command, an empty string if there is no such command.
+    static String usage( const String& cmd ) {
+      const int index = find( cmd.c_str() );
+      String s;
+      if( index >= 0 ) appendUsage( TABLE[index], s );
+      return s;
+    }
+
+    // Usage and help lines of all commands.
+    static String help() {
+      String s;
+      for( size_t i = 0; i < COUNT; i++ ) {
+        appendUsage( TABLE[i], s );
+        if( TABLE[i].help ) {
+          s += " - ";
+          s += TABLE[i].help;
+        }
+        s += '\n';
+      }
+      return s;
+    }
+
+  private:
+    static bool parse( const ArgSchema& schema, Args& parsed ) {
+      if( !parsed.present ) {
+        return schema.optional || schema.type == ARG_NONE;
+      }
+      switch( schema.type ) {
+        case ARG_NUMBER: {
+          char* end;
+          const long v = strtol( parsed.raw.c_str(), &end, 10 );
+          if( *end != 0 || v < schema.min || v > schema.max ) return false;
+          parsed.number = v;
+          return true;
+        }
+        case ARG_CHOICE:
+          for( uint8_t i = 0; i < schema.choicesCount; i++ ) {
+            if( parsed.raw == schema.choices[i] ) {
+              parsed.choice = i;
+              return true;
+            }
+          }
+          return false;
+        default:
+          return true;
+      }
+    }
+
+    static void appendUsage( const Entry<M>& entry, String& s ) {
+      s += entry.name;
+      const ArgSchema& arg = entry.arg;
+      if( arg.type == ARG_NONE ) return;
+      s += arg.optional ? " [" : " <";
+      switch( arg.type ) {
+        case ARG_NUMBER:
+          s += arg.min;
+          s += "..";
+          s += arg.max;
+          break;
+        case ARG_CHOICE:
+          for( uint8_t i = 0; i < arg.choicesCount; i++ ) {
+            if( i > 0 ) s += '|';
+            s += arg.choices[i];
+          }
+          break;
+        default:
+          s += "text";
+          break;
+      }
+      s += arg.optional ? ']' : '>';
+    }
+  };
+
+  template <typename M, const Entry<M>* TABLE, size_t COUNT>
+  template <size_t... I>
+  constexpr int8_t Table<M, TABLE, COUNT>::Slots<Indexes<I...>>::values[SIZE];
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <stdarg.h>
+#include <stddef.h>
+#include <Print.h>
+#include <WString.h>
+#include "core/InlineString.h"
+
+/**
+ * printf-like formatting straight into the destination: a caller buffer, an inline string,
+ * a Print sink (Serial, the log ring of LogManagerModule) or an existing String.
+ *
+ * Nothing is truncated silently, every call reports the full formatted length along with
+ * the number of chars actually written:
+ *
+ *   char msg[64];
+ *   if( Format::to( msg, Messages::MODULE_NOT_FOUND, id ).truncated() ) { ... }
+ *
+ * Views are formatted with "%.*s", e.g. Format::to( Serial, "%.*s", (int) v.length(), v.data() ).
+ */
+namespace Format {
+
+  struct Result {
+    size_t length;              // The full formatted length.
+    size_t written;             // Chars written to the destination, without the terminator.
+    bool   truncated() const    { return written < length; }
+  };
+
+  Result     to( char* buffer, size_t size, const char* fmt, ... ) __attribute__ ((format (printf, 3, 4)));
+  Result     to( Print& out, const char* fmt, ... ) __attribute__ ((format (printf, 2, 3)));
+  Result     append( String& out, const char* fmt, ... ) __attribute__ ((format (printf, 2, 3)));
+
+  Result     vto( char* buffer, size_t size, const char* fmt, va_list args );
+  Result     vto( Print& out, const char* fmt, va_list args );
+  Result     vappend( String& out, const char* fmt, va_list args );
+
+  // A buffer of known size.
+  template <size_t N>
+  __attribute__ ((format (printf, 2, 3)))
+  Result to( char (&buffer)[N], const char* fmt, ... ) {
+    va_list args;
+    va_start( args, fmt );
+    const Result r = vto( buffer, N, fmt, args );
+    va_end( args );
+    return r;
+  }
+
+  template <size_t N>
+  __attribute__ ((format (printf, 2, 3)))
+  Result append( InlineString<N>& out, const char* fmt, ... ) {
+    va_list args;
+    va_start( args, fmt );
+    const Result r = vto( out.tail(), out.available() + 1, fmt, args );
+    va_end( args );
+    out.commit( r.written );
+    return r;
+  }
+}
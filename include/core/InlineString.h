@@ -0,0 +1,115 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <WString.h>
+
+/**
+ * Allocation-free strings for the command path.
+ *
+ * StringView borrows characters owned by someone else (a literal, a String, a receive
+ * buffer) and is never NUL-terminated by contract. InlineString keeps up to N characters
+ * inside the object, longer values are truncated. Both convert to String, so the legacy
+ * code taking "const String&" keeps working, at the cost of a heap copy.
+ */
+
+/* StringView */
+
+class StringView {
+private:
+  const char* ptr;
+  size_t      len;
+
+public:
+  StringView() : ptr( "" ), len( 0 ) {}
+  StringView( const char* s ) : ptr( s ? s : "" ), len( s ? strlen( s ) : 0 ) {}
+  StringView( const char* s, size_t length ) : ptr( s ), len( length ) {}
+  StringView( const String& s ) : ptr( s.c_str() ), len( s.length() ) {}
+
+  const char* data() const                          { return ptr; }
+  size_t      length() const                        { return len; }
+  bool        isEmpty() const                       { return len == 0; }
+  char        operator[]( size_t i ) const          { return ptr[i]; }
+
+  bool        equals( const char* s, size_t length ) const { return len == length && memcmp( ptr, s, len ) == 0; }
+  bool        operator==( const StringView& s ) const      { return equals( s.ptr, s.len ); }
+  bool        operator==( const char* s ) const            { return equals( s, strlen( s )); }
+  bool        operator!=( const char* s ) const            { return !(*this == s); }
+  bool        startsWith( const char* s ) const            { const size_t n = strlen( s ); return n <= len && memcmp( ptr, s, n ) == 0; }
+
+  StringView  substring( size_t from, size_t to = SIZE_MAX ) const {
+    if( to > len ) to = len;
+    return from < to ? StringView( ptr + from, to - from ) : StringView();
+  }
+
+  // Legacy bridge, allocates.
+  String      toString() const {
+    String s;
+    s.reserve( len );
+    for( size_t i = 0; i < len; i++ ) s += ptr[i];
+    return s;
+  }
+  operator    String() const                        { return toString(); }
+};
+
+/* InlineString */
+
+template <size_t N>
+class InlineString {
+private:
+  uint16_t len = 0;
+  char     buf[N + 1];
+
+public:
+  static const size_t CAPACITY = N;
+
+  InlineString()                                    { buf[0] = 0; }
+  InlineString( const char* s )                     { assign( s, s ? strlen( s ) : 0 ); }
+  InlineString( const StringView& s )               { assign( s.data(), s.length() ); }
+  InlineString( const String& s )                   { assign( s.c_str(), s.length() ); }
+
+  InlineString& operator=( const char* s )          { assign( s, s ? strlen( s ) : 0 ); return *this; }
+  InlineString& operator=( const StringView& s )    { assign( s.data(), s.length() ); return *this; }
+  InlineString& operator=( const String& s )        { assign( s.c_str(), s.length() ); return *this; }
+
+  // Appending truncates the value at the capacity.
+  InlineString& append( const char* s, size_t length ) {
+    if( length > N - len ) length = N - len;
+    if( length == 0 ) return *this;
+    memcpy( buf + len, s, length );
+    len += length;
+    buf[len] = 0;
+    return *this;
+  }
+  InlineString& operator+=( const char* s )         { return append( s, strlen( s )); }
+  InlineString& operator+=( const StringView& s )   { return append( s.data(), s.length() ); }
+  InlineString& operator+=( char c )                { return append( &c, 1 ); }
+
+  // In-place writers (e.g. Format::append) write up to available() chars and a terminator
+  // at tail(), then commit() the number of chars written.
+  char*         tail()                              { return buf + len; }
+  size_t        available() const                   { return N - len; }
+  void          commit( size_t length )             { len += length < N - len ? length : N - len; buf[len] = 0; }
+
+  void          clear()                             { len = 0; buf[0] = 0; }
+  const char*   c_str() const                       { return buf; }
+  size_t        length() const                      { return len; }
+  bool          isEmpty() const                     { return len == 0; }
+  bool          isFull() const                      { return len == N; }
+  StringView    view() const                        { return StringView( buf, len ); }
+  operator      StringView() const                  { return view(); }
+
+  bool          operator==( const char* s ) const   { return view() == s; }
+  bool          operator!=( const char* s ) const   { return !(view() == s); }
+
+  // Legacy bridge, allocates.
+  String        toString() const                    { return String( buf ); }
+  operator      String() const                      { return toString(); }
+
+private:
+  void assign( const char* s, size_t length ) {
+    len = 0;
+    buf[0] = 0;
+    append( s, length );
+  }
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+/**
+ * A scratch arena: a bump allocator for short-lived buffers, mostly JSON documents.
+ *
+ * The arena belongs to the main loop task and is used inside scopes only. A scope is opened
+ * for every command, HTTP/websocket event and main loop pass, all the arena allocations made
+ * inside it are released at once when it ends. Allocations made by other tasks, outside of
+ * scopes or not fitting the arena go to the heap, so the arena never fails.
+ */
+namespace Scratch {
+
+  struct Stats {
+    size_t   size;              // Arena size.
+    size_t   used;              // Currently allocated.
+    size_t   highWater;         // Max allocated since boot.
+    uint32_t fallbacks;         // Allocations served by the heap because the arena was full.
+  };
+
+  void       begin( size_t size );
+  void*      allocate( size_t size );
+  void       deallocate( void* p );
+  void*      reallocate( void* p, size_t size );
+  Stats      getStats();
+
+  size_t     enter();
+  void       leave( size_t mark );
+
+  /* Scope */
+
+  class Scope {
+  private:
+    const size_t mark;
+  public:
+    Scope() : mark( enter() ) {}
+    ~Scope() { leave( mark ); }
+    Scope( const Scope& ) = delete;
+    Scope& operator=( const Scope& ) = delete;
+  };
+
+  /* ArduinoJson allocator */
+
+  struct Allocator {
+    void* allocate( size_t size )              { return Scratch::allocate( size ); }
+    void  deallocate( void* p )                { Scratch::deallocate( p ); }
+    void* reallocate( void* p, size_t size )   { return Scratch::reallocate( p, size ); }
+  };
+}
+
+// A JSON document allocated in the scratch arena, use it instead of DynamicJsonDocument
+// and StaticJsonDocument for short-lived documents.
+typedef BasicJsonDocument<Scratch::Allocator> ScratchJsonDocument;
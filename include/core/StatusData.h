@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+#include <time.h>
+
+/* Typed status data */
+
+// A fixed-size status published by modules with StatusChangedEvent. Listeners read the
+// fields directly, the JSON text form is only built when a consumer asks for it.
+
+struct StatusData {
+  enum Type : uint8_t {
+    TYPE_TEXT,                  // The status is a string payload only.
+    TYPE_TIME,                  // Local time, published every minute by RtcTimeModule.
+    TYPE_RELAYS,                // A relay state change.
+    TYPE_SENSOR                 // Sensor readings.
+  };
+
+  static const uint8_t SENSOR_MAX_VALUES = 4;
+
+  struct Time {
+    time_t   local;
+    uint16_t year;
+    uint8_t  month;             // 1..12
+    uint8_t  day;               // 1..31
+    uint8_t  hour;
+    uint8_t  minute;
+    uint8_t  second;
+  };
+
+  struct Relays {
+    uint64_t mask;              // States of all relays, bit N is relay N.
+    uint64_t changed;           // Relays switched since the previous event, bit N is relay N.
+    uint8_t  index;             // The relay whose state was changed, RELAY_MANY if several relays were switched.
+    uint8_t  state;             // The relay state, RELAY_OFF/RELAY_ON/RELAY_NO_PIN.
+  };
+
+  struct Sensor {
+    const char* const* names;   // Value names, a static array of count entries.
+    float    values[SENSOR_MAX_VALUES];
+    uint8_t  count;
+  };
+
+  static const uint8_t RELAY_OFF    = 0;
+  static const uint8_t RELAY_ON     = 1;
+  static const uint8_t RELAY_NO_PIN = 2;
+  static const uint8_t RELAY_MANY   = 0xFF;
+
+  Type type;
+  union {
+    Time   time;
+    Relays relays;
+    Sensor sensor;
+  };
+
+  StatusData() : type( TYPE_TEXT ) {}
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <stddef.h>
+#include <utility>
+#include "core/InlineString.h"
+
+/**
+ * A zero-copy tokenizer. Tokens are views into the source, nothing is copied or allocated,
+ * so the source must outlive the tokens.
+ *
+ * Tokens are separated by one or more separator chars. A token started with a double or
+ * a single quote lasts until the same quote and may contain separators, the quotes are not
+ * a part of the token. A missed closing quote ends the token at the end of the source.
+ *
+ *   relays rel1 on          -> "relays", "rel1", "on"
+ *   mqtt topic "a b" x      -> "mqtt", "topic", "a b", "x"
+ *   core sleeptime ''       -> "core", "sleeptime", ""
+ */
+class Tokenizer {
+private:
+  const char* p;
+  const char* end;
+  const char  separator;
+
+public:
+  Tokenizer( const StringView& source, const char separator = ' ' ) :
+    p( source.data() ), end( source.data() + source.length() ), separator( separator ) {}
+
+  bool        next( StringView& token );
+  bool        atEnd();
+  // The remaining source as is, leading separators are skipped. Used to take arguments.
+  StringView  rest();
+
+  // The first token and the rest of the source.
+  static std::pair<StringView,StringView> split( const StringView& source, const char separator = ' ' );
+  // Whitespaces removed from both ends.
+  static StringView trim( const StringView& s );
+  // The quotes removed if the whole string is a single quoted token.
+  static StringView unquote( const StringView& s );
+
+private:
+  void        skipSeparators();
+};
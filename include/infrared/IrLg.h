@@ -13,7 +13,12 @@ class IrLg : public Module {
         virtual const char*   getId()    { return LG_MODULE; }
         virtual const char*   getName()  { return Messages::TITLE_LG_MODULE; }
         virtual const String  getModuleWebpage();
-        virtual void          resolveTemplateKey( const String& key, String& out );
+        virtual void          resolveTemplateKey( const StringView& key, String& out );
     protected:
         virtual bool          handleCommand( const String& cmd, const String& args );
+    private:
+        static const Commands::Entry<IrLg> COMMANDS[];
+        void                  cmdFan( const Commands::Args& args );
+        void                  cmdMode( const Commands::Args& args );
+        void                  cmdTemp( const Commands::Args& args );
   };
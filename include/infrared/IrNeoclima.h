@@ -16,8 +16,13 @@ class IrNeoclima : public Module {
         virtual const char*   getName()  { return Messages::TITLE_NEOCLIMA_MODULE; }
         virtual const String  getModuleWebpage();
         virtual const String  getStatusWebpage();
-        void                  resolveTemplateKey( const String& key, String& out );
+        void                  resolveTemplateKey( const StringView& key, String& out );
     protected:
         virtual bool          handleCommand( const String& cmd, const String& args );
+    private:
+        static const Commands::Entry<IrNeoclima> COMMANDS[];
+        void                  cmdFan( const Commands::Args& args );
+        void                  cmdMode( const Commands::Args& args );
+        void                  cmdTemp( const Commands::Args& args );
         ResultData            handleOption( const String& key, const String& value, Options::Action action );
   };
@@ -0,0 +1,50 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+
+/**
+ * LRU cache of the assets read from the SD card: file pages and whole decoded images.
+ * The total size of the cached data is kept within the byte budget; entries in use
+ * (pinned) are never evicted.
+ */
+class AssetCache {
+public:
+  enum Kind : uint8_t { PAGE, IMAGE };
+
+  struct Entry {
+    Kind     kind;
+    uint8_t  pins;
+    uint32_t key;             // Hash of the file path.
+    uint32_t index;           // Page number, zero for images.
+    uint32_t size;
+    uint8_t* data;
+  };
+
+  struct Stats {
+    uint32_t hits[2];         // Per kind.
+    uint32_t misses[2];
+    uint32_t evictions;
+  };
+
+private:
+  std::list<Entry> entries;   // The most recently used first.
+  size_t   budget;
+  size_t   used = 0;
+  Stats    stats = {};
+
+public:
+  AssetCache( size_t budget ) : budget(budget) {}
+  ~AssetCache();
+  Entry*        find( Kind kind, uint32_t key, uint32_t index );
+  Entry*        insert( Kind kind, uint32_t key, uint32_t index, size_t size );
+  void          remove( Entry* entry );
+  size_t        getBudget()                   { return budget; }
+  const Stats&  getStats()                    { return stats; }
+  size_t        getUsed()                     { return used; }
+  void          pin( Entry* entry )           { entry->pins++; }
+  void          unpin( Entry* entry )         { if( entry->pins ) entry->pins--; }
+
+private:
+  bool          evict( size_t size );
+};
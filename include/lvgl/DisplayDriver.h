@@ -7,14 +7,46 @@ struct LcdInitCommand {
   const uint8_t  length;      //Nr of bytes in data; bit 7 = delay after set; 0xFF = end of cmds.
 };
 
+struct FlushStats {
+  uint32_t flushes;           // Number of flushed areas.
+  uint32_t pixels;            // Number of flushed pixels.
+  uint32_t busyTime;          // Microseconds the bus was busy with pixel data.
+  uint32_t windows;           // Number of address window commands sent.
+  uint32_t continued;         // Areas written without a new address window.
+  uint32_t solidAreas;        // Areas of a single color.
+  uint32_t runPixels;         // Pixels clocked by the WR strobe only, without data bus writes.
+};
+
+// Touch panel calibration, raw ADC values at the screen edges.
+struct TouchCalibration {
+  uint16_t xMin;
+  uint16_t yMin;
+  uint16_t xMax;
+  uint16_t yMax;
+  bool     swapXY;
+  bool     invertX;
+  bool     invertY;
+  uint8_t  spare;
+};
+
 class DisplayDriver {
 public:
   virtual ~DisplayDriver() {};
   virtual void flushArea( lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p ) = 0;
   virtual bool readTouch( lv_indev_drv_t* drv, lv_indev_data_t* data ) {return false;}
   virtual void setBacklight( bool enable ) {};
+  virtual bool getTouchRaw( int16_t* x, int16_t* y ) {return false;}
+  virtual void setTouchCalibration( const TouchCalibration& cal ) {};
+  // Returns the flush statistics collected since the previous call.
+  virtual FlushStats takeFlushStats() {
+    const FlushStats s = flushStats;
+    flushStats = {};
+    return s;
+  }
 
 protected:
+  FlushStats flushStats = {};
+
   void writeCommandSequence( const LcdInitCommand sequence[] );
 
   virtual void writeCommand( uint8_t c ) = 0;
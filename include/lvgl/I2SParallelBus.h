@@ -0,0 +1,44 @@
+#pragma once
+#include <lvgl.h>
+#include <rom/lldesc.h>
+#include <esp_intr_alloc.h>
+#include <freertos/FreeRTOS.h>
+
+/**
+ * The 8-bit parallel display bus driven by the ESP32 I2S0 peripheral in LCD mode.
+ * Pixel data is clocked out by DMA on the D0..D7 pins with WS as the WR strobe, so
+ * the CPU is free while an area is flushed. The pins are switched between the I2S and
+ * the plain GPIO matrix signals, so commands can still be bit-banged in between.
+ */
+class I2SParallelBus {
+private:
+  static const uint16_t DMA_MAX_LENGTH = 4092;  // Max bytes per DMA descriptor, 4 bytes aligned.
+
+  const uint8_t*    dataPins;
+  uint8_t           wrPin;
+  lldesc_t*         descriptors = nullptr;
+  uint16_t          descriptorsCount = 0;
+  intr_handle_t     interrupt = nullptr;
+  bool              routed = false;           // True if the pins are connected to the I2S signals.
+  volatile bool     busy = false;
+  int64_t           startTime;
+  volatile uint32_t busyTime = 0;             // Microseconds of the completed transfers.
+  portMUX_TYPE      busyTimeLock = portMUX_INITIALIZER_UNLOCKED;
+  lv_disp_drv_t* volatile displayDriver = nullptr;
+
+public:
+  I2SParallelBus( const uint8_t* dataPins, uint8_t wrPin );
+  ~I2SParallelBus();
+  bool      begin( uint8_t clockDivider );
+  bool      canSend( const void* data, size_t length );
+  bool      isBusy()                                  { return busy; }
+  void      release();
+  uint32_t  takeBusyTime();
+  bool      send( const void* data, size_t length, lv_disp_drv_t* drv );
+
+private:
+  void      route( bool toI2S );
+  void      waitIdle();
+
+  static void interruptHandler( void* arg );
+};
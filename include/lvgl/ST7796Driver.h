@@ -2,6 +2,8 @@
 #include <lvgl.h>
 #include "Config.h"
 #include "lvgl/DisplayDriver.h"
+#include "lvgl/I2SParallelBus.h"
+#include "lvgl/XPT2046Touch.h"
 
 using namespace Config;
 
@@ -31,11 +33,6 @@ static constexpr const LcdInitCommand INIT_COMMANDS[] = {
   {0x00, (uint8_t[]) {}, 0xFF}                                                // End of sequence.
 };
 
-static const int    TOUCH_SPI_CLOCK  = 2500000;        // 2.5 MHz
-static const int8_t TOUCH_CMD_X_READ = 0b10010000;
-static const int8_t TOUCH_CMD_Y_READ = 0b11010000;
-
-
 // Mask for the 8 data bits to set pin directions
 static constexpr uint32_t DIR_MASK = (
   (1 << ST7796_D0_PIN) |
@@ -48,6 +45,12 @@ static constexpr uint32_t DIR_MASK = (
   (1 << ST7796_D7_PIN)
 );
 
+// Data bus pins, D0 first, for the I2S signals routing
+static constexpr uint8_t DATA_PINS[] = {
+  ST7796_D0_PIN, ST7796_D1_PIN, ST7796_D2_PIN, ST7796_D3_PIN,
+  ST7796_D4_PIN, ST7796_D5_PIN, ST7796_D6_PIN, ST7796_D7_PIN
+};
+
 // Data bits and the write line are cleared to 0 in one step
 static constexpr uint32_t CLR_MASK = (DIR_MASK | (1 << ST7796_WR_PIN));
 
@@ -55,11 +58,15 @@ static constexpr uint32_t CLR_MASK = (DIR_MASK | (1 << ST7796_WR_PIN));
 class ST7796Driver : public DisplayDriver {
 private:
   uint32_t xset_mask[256];                  // Lookup table for ESP32 parallel bus interface uses 1kbyte RAM
-  int16_t  last_x;
-  int16_t  last_y;
-  int16_t  avg_buf_x[ST7796_TOUCH_AVG];
-  int16_t  avg_buf_y[ST7796_TOUCH_AVG];
-  uint8_t  avg_last;
+  XPT2046Touch* touch;
+  I2SParallelBus* bus = nullptr;            // DMA backend, nullptr if the bus is bit-banged
+
+  // The open address window. Its bottom is the screen bottom, so an area right below
+  // the previous one with the same columns continues the memory write without a new window.
+  bool     windowOpen = false;
+  int16_t  windowX1;
+  int16_t  windowX2;
+  int16_t  windowNextY;
 
 public:
   ST7796Driver();
@@ -67,6 +74,9 @@ public:
   virtual void flushArea( lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p );
   virtual bool readTouch( lv_indev_drv_t* drv, lv_indev_data_t* data );
   virtual void setBacklight( bool enable );
+  virtual bool getTouchRaw( int16_t* x, int16_t* y )               { return touch->getRaw( x, y ); }
+  virtual void setTouchCalibration( const TouchCalibration& cal )  { touch->setCalibration( cal ); }
+  virtual FlushStats takeFlushStats();
 
 protected:
   virtual void writeCommand( uint8_t c );    // Send a command, function resets DC/RS high ready for data
@@ -74,7 +84,10 @@ protected:
 
 private:
   // Display low level
+  void   openWindow( const lv_area_t* area, bool exact );
   void   setWindow( int16_t x0, int16_t y0, int16_t x1, int16_t y1 );
+  void   writePixels( const lv_color_t* color_p, uint32_t count );
+  void   writeRun( uint16_t color, uint32_t count );
   void   write8( uint8_t d );
   void   write16( uint16_t d );
   void   write32c( uint16_t c, uint16_t d );
@@ -85,9 +98,4 @@ private:
   inline static void  dc_d();
   inline static void  wr_l();
   inline static void  wr_h();
-
-  // Touch low level
-  static int16_t read_spi( uint8_t reg );
-  void           xpt2046_avg( int16_t* x, int16_t* y );
-  static void    xpt2046_corr( int16_t* x, int16_t* y );
 };
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include <lvgl.h>
+#include <FS.h>
+#include "lvgl/AssetCache.h"
+
+/**
+ * LVGL file system driver for the SD card, the "S:" drive. Files are read by aligned
+ * pages kept in the LRU asset cache; reads of whole pages go straight to the caller.
+ * True color ".bin" images are decoded into the cache as a whole, so LVGL draws them
+ * from RAM. Font files loaded from the drive are read through the same page cache.
+ */
+class SdFileSystem {
+private:
+  static const char     LETTER    = 'S';
+  static const uint16_t PAGE_SIZE = 4096;
+
+  // LVGL allocates file handles from its own heap, so they're kept small.
+  struct FileHandle {
+    fs::File file;
+    uint32_t id;              // Hash of the path, the cache key.
+    uint32_t pos;
+    uint32_t size;
+  };
+
+  fs::FS&     fs;
+  AssetCache  cache;
+  uint32_t    bytesRead = 0;
+  uint32_t    readTime = 0;   // Microseconds spent in the SD card reads.
+
+  static SdFileSystem* instance;
+
+public:
+  SdFileSystem( fs::FS& fs, size_t cacheBudget );
+  ~SdFileSystem();
+  void         begin();
+  const String getStats();
+
+private:
+  lv_fs_res_t  read( FileHandle* fh, uint8_t* buf, uint32_t btr, uint32_t* br );
+  bool         readFromCard( fs::File& file, uint32_t offset, uint8_t* dst, uint32_t len );
+
+  static uint32_t    hash( const char* path );
+  static String      toCardPath( const char* path );
+
+  // lv_fs driver callbacks
+  static bool        readyCallback( lv_fs_drv_t* drv );
+  static lv_fs_res_t openCallback( lv_fs_drv_t* drv, void* file_p, const char* path, lv_fs_mode_t mode );
+  static lv_fs_res_t closeCallback( lv_fs_drv_t* drv, void* file_p );
+  static lv_fs_res_t readCallback( lv_fs_drv_t* drv, void* file_p, void* buf, uint32_t btr, uint32_t* br );
+  static lv_fs_res_t seekCallback( lv_fs_drv_t* drv, void* file_p, uint32_t pos );
+  static lv_fs_res_t tellCallback( lv_fs_drv_t* drv, void* file_p, uint32_t* pos_p );
+  static lv_fs_res_t sizeCallback( lv_fs_drv_t* drv, void* file_p, uint32_t* size_p );
+
+  // Image decoder callbacks
+  static lv_res_t    imageInfoCallback( lv_img_decoder_t* decoder, const void* src, lv_img_header_t* header );
+  static lv_res_t    imageOpenCallback( lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc );
+  static void        imageCloseCallback( lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc );
+};
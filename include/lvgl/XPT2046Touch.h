@@ -0,0 +1,57 @@
+#pragma once
+#include <lvgl.h>
+#include <esp_attr.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "Config.h"
+#include "lvgl/DisplayDriver.h"
+
+/**
+ * XPT2046 resistive touch controller. Nothing is read while the panel is released:
+ * the PENIRQ falling edge wakes up the sampling task, which samples the panel until
+ * it's released and passes the points to LVGL through a small queue.
+ */
+class XPT2046Touch {
+private:
+  struct Point {
+    int16_t x;
+    int16_t y;
+    bool    pressed;
+  };
+
+  static const int     SPI_CLOCK    = 2500000;          // 2.5 MHz
+  static const uint8_t CMD_X_READ   = 0b10010000;       // Power down between conversions, PENIRQ enabled.
+  static const uint8_t CMD_Y_READ   = 0b11010000;
+  static const uint8_t SAMPLES      = Config::ST7796_TOUCH_SAMPLES;
+  static const uint8_t FRAME_SIZE   = SAMPLES * 4 + 1;  // 16 clocks per conversion, commands overlap the results.
+  static const uint8_t QUEUE_LENGTH = 8;
+
+  uint8_t           command[FRAME_SIZE];
+  TouchCalibration  calibration;
+  QueueHandle_t     queue;
+  TaskHandle_t      task = nullptr;
+  volatile bool     sampling = false;
+  Point             last = {0, 0, false};
+  int16_t           rawX = 0;
+  int16_t           rawY = 0;
+
+public:
+  XPT2046Touch();
+  ~XPT2046Touch();
+  bool     read( lv_indev_data_t* data );
+  bool     getRaw( int16_t* x, int16_t* y );
+  void     setCalibration( const TouchCalibration& cal )  { calibration = cal; }
+
+  static TouchCalibration getDefaultCalibration();
+
+private:
+  void     push( const Point& p );
+  void     run();
+  bool     sample( Point& p );
+  void     toScreen( int16_t x, int16_t y, Point& p );
+
+  static int16_t median( int16_t* values, uint8_t count );
+  static void    taskFunction( void* arg );
+  static void    IRAM_ATTR penIrqHandler( void* arg );
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <functional>
 #include <vector>
 #include <WString.h>
 #include "DisplaySSD1306.h"
@@ -25,6 +26,8 @@ namespace DisplayMenu {
   const int TEXT_HEIGHT                = 10;
   const int TEXT_OFFSET_Y              = 7;
 
+  const int16_t NO_ENTRY               = -1;                   // Menu or entry index when nothing is selected.
+
   /* KeyEvent enum */
 
   enum KeyEvent { SELECT, UP, DOWN };
@@ -45,152 +48,158 @@ namespace DisplayMenu {
     virtual void dismissEntryEditor( const String& value ) = 0;
   };
 
-  /* Menu entries */
-
-  class Entry {
-  protected:
-    String  id;
-    String  title;
-    String  text;
-    bool    visible;
-
-  public:
-    Entry( const String& _id, const String& _title );
-    Entry( const String& _id, const String& _title, const String& _text );
-    virtual ~Entry() {}
-
-    /**
-     * Draws an entry on a display.
-     * @param display The reference to display object where the entry should draw itself.
-     */
-    virtual void draw( Display_SSD1306& display );
-    virtual void drawEditor( Display_SSD1306& display ) {;}
-    void drawTitleOnTop( Display_SSD1306& display );
-    void drawTitleOnBottom( Display_SSD1306& display );
-
-    virtual uint8_t getHeight( Display_SSD1306& display );
-    virtual void onKeyPress( const KeyEvent ev, Executor& executor );
-
-    const String getId()                         {return id;}
-    const String getTitle()                      {return title;}
-    const bool isVisible()                       {return visible;}
-    void setTitle( const String& value )         {title = value;}
-    void setText( const String& txt )            {text = txt;}
-    void setVisible( bool value )                {visible = value;}
+  /* Compiled menu image */
+
+  // The menu JSON (see todo/todo.txt) is compiled into a single binary block when saved:
+  //
+  //   ImageHeader | MenuRecord[menusCount] | EntryRecord[entriesCount] | uint16_t keys[keysCount] | strings
+  //
+  // Strings are NUL-terminated and referenced by offsets in the strings area, the offset 0
+  // is an empty string. Titles and texts are stored with template parameters replaced by
+  // PARAM_MARK followed by the key index + 1, the '~' characters are removed.
+
+  const char    IMAGE_MAGIC[2]         = {'M', 'N'};
+  const uint8_t IMAGE_VERSION          = 1;
+  const char    PARAM_MARK             = '\x01';
+
+  enum EntryKind : uint8_t {
+    ENTRY_TEXT,                 // Shows a text, "entry" in JSON.
+    ENTRY_LINK,                 // Shows other menu, "link" in JSON.
+    ENTRY_COMMAND,              // Executes a command, "cmd" in JSON.
+    ENTRY_NUMBER                // Number editor, "number" in JSON.
   };
 
-  /* Link: a menu entry that represents a link to other menu */
-
-  class Link : public Entry {
-  private:
-    String targetMenuId;
-  public:
-    Link( const String& id, const String& title, const String& target )
-      : Entry( id, title ), targetMenuId( target ) {}
-    Link( const String& _id, const String& _title, const String& _text, const String& _target)
-      : Entry( _id, _title ) {
-        text = _text;
-        targetMenuId = _target;
-      }
-    virtual ~Link() {}
-    virtual void onKeyPress( const KeyEvent ev, Executor& executor );
+  enum EntryFlags : uint8_t {
+    FLAG_HIDDEN_TITLE = 0x01,   // The title started with '~', it's drawn on top or bottom only.
+    FLAG_INVISIBLE    = 0x02
   };
 
-  /* Command: a menu entry to trigger some command  */
-
-  class Command : public Entry {
-  private:
-    String command;
-  public:
-    Command( const String& id, const String& title, const String& cmd )
-      : Entry( id, title ), command( cmd ) {}
-    virtual ~Command() {}
-    virtual void onKeyPress( const KeyEvent ev, Executor& executor );
+  struct ImageHeader {
+    char     magic[2];
+    uint8_t  version;
+    uint8_t  menusCount;
+    uint16_t entriesCount;
+    uint16_t keysCount;
+    uint16_t defaultMenu;       // "menu/entry" to show by default.
+    uint16_t topic;             // MQTT topic to resolve the editor values.
+    uint16_t stringsSize;
   };
 
-  /* Editors */
-
-  union EditorFlags {
-    uint8_t data;
-    struct {
-      uint8_t editMode         : 1;     // In edit mode the value is changed with up/down keys.
-      uint8_t needMeasureWidth : 1;     // Indicates that it's need to measure the value with max possible text width.
-    };
-
-    EditorFlags() : data(0) {}
+  struct MenuRecord {
+    uint16_t id;
+    uint16_t title;
+    uint16_t firstEntry;
+    uint16_t entriesCount;
   };
 
-  class BaseEditor : public Entry {
-  protected:
-    EditorFlags flags;
-  public:
-    BaseEditor( const String& id, const String& title ) : Entry( id, title ) {}
-    virtual ~BaseEditor()  {}
-    virtual void onKeyPress( const KeyEvent ev, Executor& executor );
-  protected:
-    virtual const String getValueAsString() = 0;
-    virtual bool selectValue( int8_t index ) = 0;
+  struct EntryRecord {
+    uint8_t  kind;
+    uint8_t  flags;
+    uint16_t id;
+    uint16_t title;
+    uint16_t text;
+    uint16_t payload;           // Command or link target.
   };
 
-  class Number : public BaseEditor {
+  /* Number editor */
+
+  // There is only one active editor at a time, so it's not a part of the menu image.
+  class NumberEditor {
   private:
-    int value = 0;
-    int min = 0;
-    int max = 0;
-    int step = 0;
+    int      value = 0;
+    int      min = 0;
+    int      max = 0;
+    int      step = 0;
     uint16_t valueMaxWidth = 20;
-  public:
-    Number( const String& id, const String& title ) : BaseEditor( id, title ) {}
-    virtual ~Number() {}
-    virtual void drawEditor( Display_SSD1306& display );
-    void setValue( int value, int min, int max, int step );
-  protected:
-    virtual const String getValueAsString();
-    virtual bool selectValue( int8_t index );
-  };
+    bool     editMode = false;
+    bool     needMeasureWidth = false;     // Indicates that it's need to measure the value with max possible text width.
 
-  class Choice : public BaseEditor {
-  private:
-    std::vector<String> options;
-    uint8_t selectedPosition;
   public:
-    Choice( const String& id, const String& title ) : BaseEditor( id, title ) {}
-    virtual ~Choice();
-    virtual void drawEditor( Display_SSD1306& display );
-    void setValue( std::vector<String>& options, String& selectedKey );
-  protected:
-    virtual const String getValueAsString();
-    virtual bool selectValue( int8_t index );
+    void     draw( Display_SSD1306& display );
+    String   getValueAsString()            { return String( value ); }
+    bool     isEditMode()                  { return editMode; }
+    bool     selectValue( int8_t index );
+    void     setEditMode( bool mode )      { editMode = mode; }
+    void     setValue( int value, int min, int max, int step );
   };
 
-  /* Menu */
+  /* MenuImage */
 
-  class Menu {
+  /**
+   * The compiled menu. Menus and entries are addressed by their indexes in the image,
+   * the only heap objects are the image itself and the runtime changes (entries
+   * visibility and texts or titles changed by commands).
+   */
+  class MenuImage {
   private:
-    String menuId;
-    String title;
-    std::vector<Entry*> entries;
+    enum Field : uint8_t { FIELD_TITLE, FIELD_TEXT };
+
+    struct Override {
+      uint16_t entry;
+      Field    field;
+      String   line;            // Compiled like the image lines.
+    };
+
+    std::vector<uint8_t>  image;
+    const ImageHeader*    header = nullptr;
+    const MenuRecord*     menus = nullptr;
+    const EntryRecord*    entries = nullptr;
+    const char*           strings = nullptr;
+    std::vector<int8_t>   keySlots;         // Template parameter slots of the image keys, then of the runtime ones.
+    std::vector<uint8_t>  entryFlags;
+    std::vector<Override> overrides;
+    TemplateParams*       params = nullptr;
 
   public:
-    Menu( const String& id, const String& title );
-    Menu( const String& id, const String& title, const std::initializer_list<Entry*> &list );
-
-    const String getId()  {return menuId;}
-    const String getTitle()  {return title;}
-    void drawTitleOnTop( Display_SSD1306& display );
-
-    void add( Entry* const entry );
-    void addAt( Entry* const entry, uint8_t position );
-    int count()  {return entries.size();}
-    Entry* getEntry( const uint8_t position );
-    Entry* getEntry( const String& id );
-    Entry* getFirstVisibleEntry();
-    Entry* getNextVisibleEntry( const String& id );
-    Entry* getPreviousVisibleEntry( const String& id );
-    int8_t getPosition( const String& id );
-    void remove( const String& id );
-    void reserve( int num_entries )  { entries.reserve( num_entries ); }
-    void setVisible( const String& entry_id, bool value );
-    void setTitle( const String& entry_id, const String& txt );
+    MenuImage() {}
+    MenuImage( const MenuImage& ) = delete;
+    MenuImage& operator=( const MenuImage& ) = delete;
+
+    static bool   compile( const String& json, std::vector<uint8_t>& out );
+    bool          load( std::vector<uint8_t>&& data, TemplateParams& templateParams );
+    size_t        getImageSize()                            { return image.size(); }
+
+    // Menus
+    int16_t       findMenu( const String& id );
+    uint8_t       getMenusCount()                           { return header ? header->menusCount : 0; }
+    const char*   getMenuId( int16_t menu )                 { return str( menus[menu].id ); }
+    const char*   getDefaultMenu()                          { return header ? str( header->defaultMenu ) : ""; }
+    const char*   getTopic()                                { return header ? str( header->topic ) : ""; }
+
+    // Entries, the indexes are global in the image.
+    int16_t       findEntry( int16_t menu, const String& id );
+    int16_t       findEntry( const String& id );
+    uint16_t      getEntriesCount()                         { return header ? header->entriesCount : 0; }
+    const char*   getEntryId( int16_t entry )               { return str( entries[entry].id ); }
+    EntryKind     getKind( int16_t entry )                  { return (EntryKind) entries[entry].kind; }
+    int16_t       getMenuOf( int16_t entry );
+    int16_t       getFirstVisibleEntry( int16_t menu );
+    int16_t       getNextVisibleEntry( int16_t entry );
+    int16_t       getPreviousVisibleEntry( int16_t entry );
+    void          setText( int16_t entry, const String& text )    { setLine( entry, FIELD_TEXT, text ); }
+    void          setTitle( int16_t entry, const String& title )  { setLine( entry, FIELD_TITLE, title ); }
+    void          setVisible( int16_t entry, bool visible );
+
+    // Drawing
+    void          draw( Display_SSD1306& display, int16_t entry );
+    void          drawMenuTitleOnTop( Display_SSD1306& display, int16_t menu );
+    void          drawTitleOnTop( Display_SSD1306& display, int16_t entry );
+    void          drawTitleOnBottom( Display_SSD1306& display, int16_t entry );
+    uint32_t      getEntryStamp( int16_t entry );
+    uint32_t      getMenuTitleStamp( int16_t menu )         { return getStamp( str( menus[menu].title )); }
+    uint32_t      getTitleStamp( int16_t entry )            { return getStamp( getLine( entry, FIELD_TITLE )); }
+
+    // Keyboard
+    void          onKeyPress( int16_t entry, const KeyEvent ev, Executor& executor, NumberEditor& editor );
+
+  private:
+    const char*   getLine( int16_t entry, Field field );
+    uint32_t      getStamp( const char* line );
+    size_t        printLine( Display_SSD1306& display, const char* line );
+    void          setLine( int16_t entry, Field field, const String& source );
+    const char*   str( uint16_t offset )                    { return strings + offset; }
+
+    static void   compileLine( const char* source, String& out, const std::function<uint8_t(const char* key, size_t length)>& keyIndex );
+    static bool   validate( const uint8_t* data, size_t size );
   };
-}
\ No newline at end of file
+}
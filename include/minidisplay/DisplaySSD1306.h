@@ -1,30 +1,53 @@
 #pragma once
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
-#include "SimpleMap.h"
+#include "TemplateParams.h"
 
 /* Display_SSD1306 */
 
 class Display_SSD1306 : public Adafruit_SSD1306 {
+public:
+  // Transfer counters of the partial display updates.
+  struct UpdateStats {
+    uint32_t updates;         // Number of update() calls.
+    uint32_t fullUpdates;     // Updates that have sent the whole buffer.
+    uint32_t windows;         // Page/column windows sent.
+    uint32_t bytes;           // Total bytes sent over I2C, including addressing and commands.
+    uint16_t lastBytes;       // Bytes sent by the most recent update.
+  };
+
 private:
+  static const uint32_t I2C_CLOCK_DURING = 400000UL;    // Same clocks as used by Adafruit_SSD1306.
+  static const uint32_t I2C_CLOCK_AFTER  = 100000UL;
+  static const uint8_t  WINDOW_OVERHEAD  = 10;          // Bytes to open a window: two transmissions and 6 commands.
+
   int16_t textLeftPadding = 0;
-  SimpleMap<String, String> templateParams;
+  TemplateParams templateParams;
+
+  uint8_t* shadow = nullptr;            // Copy of the controller RAM, i.e. what is currently on the screen.
+  bool     shadowValid = false;
+  uint8_t  i2cAddress = 0;
+  UpdateStats stats = {};
 
 public:
   Display_SSD1306( uint8_t w, uint8_t h ) :
-    Adafruit_SSD1306( w, h ),
-    templateParams( [](String& a, String& b) -> int {
-      return b.compareTo( a );
-    }) {}
+    Adafruit_SSD1306( w, h ) {}
+  ~Display_SSD1306()                                                   { free( shadow ); }
 
+  bool begin( uint8_t switchvcc, uint8_t i2caddr );
   void clearTemplateParameters()                                       { templateParams.clear(); }
-  void removeTemplateParameter( const String& key )                    { templateParams.remove( key ); }
-  void setTemplateParameter( const String& key, const String& value )  { templateParams.put( key, value); }
-  size_t printLine( const String& s );
+  TemplateParams& getTemplateParams()                                  { return templateParams; }
+  const UpdateStats& getUpdateStats()                                  { return stats; }
+  void invalidate()                                                    { shadowValid = false; }
+  bool removeTemplateParameter( const String& key )                    { return templateParams.remove( key ); }
+  bool setTemplateParameter( const String& key, const String& value )  { return templateParams.set( key, value ); }
+  size_t printLine( const String& s )                                  { return print( s ) + println(); }
   void setLeftPadding( int16_t padding )  { textLeftPadding = padding; }
+  uint16_t update();
   virtual size_t write( uint8_t c );
+  using Print::write;
 
 
 private:
-  String resolveTemplateKey( const String& key );
+  uint16_t sendWindow( uint8_t firstPage, uint8_t lastPage, uint8_t firstColumn, uint8_t lastColumn );
 };
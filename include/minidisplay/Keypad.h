@@ -0,0 +1,57 @@
+#pragma once
+#include <esp_attr.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/timers.h>
+#include "DisplayMenu.h"
+
+/* Keypad */
+
+/**
+ * The 3 buttons keyboard of the mini display. Button edges are captured by GPIO
+ * interrupts, which restart a one-shot debounce timer. The timer callback reads the
+ * settled state, classifies presses and passes them to the menu through a small queue.
+ * While a button is held, the timer keeps sampling it to detect long presses and repeats.
+ */
+class Keypad {
+public:
+  enum Kind : uint8_t {
+    PRESS,          // The button is pressed (debounced).
+    SHORT,          // The button is released before the long press time.
+    LONG,           // The button is held for the long press time.
+    REPEAT          // The button is still held after the long press.
+  };
+
+  struct KeyPress {
+    DisplayMenu::KeyEvent key;
+    Kind                  kind;
+  };
+
+private:
+  static const uint8_t QUEUE_LENGTH = 8;
+  static const uint8_t KEYS_COUNT   = 3;
+  static const uint8_t NO_KEY       = 0xFF;
+
+  static const uint8_t PINS[KEYS_COUNT];
+
+  QueueHandle_t queue;
+  TimerHandle_t timer;
+  uint8_t       stable = 0;           // Debounced state, a bit per key.
+  uint8_t       held = NO_KEY;        // The key being classified.
+  bool          longSent = false;
+  uint32_t      pressTime = 0;
+  uint32_t      repeatTime = 0;
+
+public:
+  Keypad();
+  ~Keypad();
+  bool     read( KeyPress& press );
+
+private:
+  void     push( uint8_t key, Kind kind );
+  uint8_t  readState();
+  void     sample();
+
+  static void           timerCallback( TimerHandle_t timer );
+  static void IRAM_ATTR edgeIrqHandler( void* arg );
+};
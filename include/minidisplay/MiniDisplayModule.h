@@ -1,6 +1,7 @@
 #pragma once
 #include "DisplayMenu.h"
 #include "DisplaySSD1306.h"
+#include "Keypad.h"
 #include "Messages.h"
 #include "Module.h"
 #include "SimpleMap.h"
@@ -20,7 +21,7 @@ typedef union {
   struct {
     uint8_t initialized     : 1;
     uint8_t display_on      : 1;
-    uint8_t any_key_pressed : 1;
+    uint8_t skip_key        : 1;        // Ignore the rest of the key press that has woken up the display.
     uint8_t spare03         : 1;
     uint8_t spare04         : 1;
     uint8_t spare05         : 1;
@@ -32,23 +33,37 @@ typedef union {
 /* MiniDisplayModule */
 
 private:
+  static constexpr const char* const MENU_IMAGE_KEY = "MenuImage";
+
+  // Used when there is no valid menu config.
+  static constexpr const char* const DEFAULT_MENU = R"({"menu":[)"
+    R"({"type":"menu","id":"root"},)"
+    R"({"type":"entry","id":"status","text":"%STATUS%"},)"
+    R"({"type":"link","id":"about","title":"About","target":"about"},)"
+    R"({"type":"menu","id":"about","title":"About"},)"
+    R"({"type":"link","id":"info","text":"%PROJECT%\nVersion %VERSION%","target":"root/about"}]})";
+
   Display_SSD1306 display;
-  std::vector<Menu*> menuList;
-  String defaultMenu;
-  String valuesResolveTopic;
+  Keypad keypad;
+  MenuImage menu;
+  NumberEditor editor;
 
   StateFlags flags;
-  Menu* activeMenu = nullptr;
-  Entry* selectedEntry = nullptr;
+  int16_t activeMenu = NO_ENTRY;
+  int16_t selectedEntry = NO_ENTRY;
+  uint32_t drawnStamps[3] = {0, 0, 0};        // Template parameters revisions of the top, middle and bottom parts.
   int16_t sleepTimeout;
   bool needRedrawMenu;
 
   OnRequestValueListener onRequestValueListener = 0;
   OnChangeValueListener onChangeValueListener = 0;
 
+  static const Commands::Entry<MiniDisplayModule> COMMANDS[];
+
 public:
   MiniDisplayModule();
   virtual ~MiniDisplayModule();
+  virtual void         loop();
   virtual void         tick_100mS( uint8_t phase );
   // Module identification.
   virtual const char*  getId()    { return MINI_DISPLAY_MODULE; }
@@ -56,8 +71,8 @@ public:
   // Module Web interface
   virtual const String getModuleWebpage();
   // A generic getData/setData interface
-  virtual const String getString( const String& key );
-  virtual ResultData   setString( const String& key, const String& value );
+  virtual const String getString( const StringView& key );
+  virtual ResultData   setString( const StringView& key, const String& value );
   // DisplayMenu::Executor interface.
   virtual void         selectEntry( int8_t index );
   virtual void         executeEntryCommand( const String& cmd ) ;
@@ -68,28 +83,39 @@ public:
   void                 setOnRequestValueListener( OnRequestValueListener listener )  {onRequestValueListener = listener;}
   void                 setOnChangeValueListener( OnChangeValueListener listener )  {onChangeValueListener = listener;}
   // Public API
-  void                 addMenu( Menu* menu ) { menuList.push_back( menu ); }
   void                 setDisplayEnabled( bool value );
-  bool                 setEntry( const String& menuId, const String& entryId, const std::function<void(Entry* entry)> f );
+  bool                 setEntry( const String& menuId, const String& entryId, const std::function<void(int16_t entry)> f );
   void                 setTemplateParameter( const String& key, const String& value );
   void                 showDefaultMenuEntry();
   void                 redrawMenu();
+  void                 refreshMenu();
   bool                 selectMenu( const String& menuId, const String& entryId );
   bool                 selectMenu( const String& entryId );
 
 protected:
   virtual bool         handleCommand( const String& cmd, const String& args );
-  virtual void         resolveTemplateKey( const String& key, String& out );
+  virtual void         resolveTemplateKey( const StringView& key, String& out );
 
 private:
-  void                 buildJsonMenu();
-  void                 buildDefaultMenu();
+  // Commands
+  void                 cmdDisable( const Commands::Args& args );
+  void                 cmdEditValue( const Commands::Args& args );
+  void                 cmdEnable( const Commands::Args& args );
+  void                 cmdOff( const Commands::Args& args );
+  void                 cmdOn( const Commands::Args& args );
+  void                 cmdSelect( const Commands::Args& args );
+  void                 cmdStats( const Commands::Args& args );
+  void                 cmdText( const Commands::Args& args );
+  void                 cmdTimeout( const Commands::Args& args );
+  void                 cmdTitle( const Commands::Args& args );
+
   bool                 dispatchRequestedValue( const String& jsonString );
   String               getMenuData();
   uint16_t             getSleepTimeout();
-  Entry*               findEntry( const String& menuId, const String& entryId );
-  Menu*                findMenu( const String& menuId );
   void                 handleKeyPress( KeyEvent ev );
+  void                 handleKeypad( const Keypad::KeyPress& press );
+  void                 loadMenu();
   void                 redrawEditor();
+  bool                 saveMenuImage( const String& json, std::vector<uint8_t>* out = nullptr );
 
 };
\ No newline at end of file
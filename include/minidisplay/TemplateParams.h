@@ -0,0 +1,39 @@
+#pragma once
+#include <WString.h>
+
+/* TemplateParams */
+
+/**
+ * A small open-addressing table of the menu template parameters. Slots are never freed,
+ * so compiled menu lines can keep slot indexes. Every value change increments the slot
+ * revision, the lines compare revisions to find out whether they need to be re-rendered.
+ */
+class TemplateParams {
+public:
+  static const uint8_t CAPACITY       = 32;         // Must be a power of 2.
+  static const uint8_t MAX_KEY_LENGTH = 9;          // SWITCH macro requires 9 chars max.
+
+private:
+  struct Slot {
+    char     key[MAX_KEY_LENGTH + 1];
+    uint16_t revision;
+    String   value;
+  };
+
+  Slot    slots[CAPACITY];
+  uint8_t used = 0;
+
+public:
+  TemplateParams();
+
+  void          clear();
+  int8_t        find( const char* key, size_t length );
+  const String& get( int8_t slot )                      { return slots[slot].value; }
+  uint16_t      getRevision( int8_t slot )              { return slots[slot].revision; }
+  int8_t        obtain( const char* key, size_t length );
+  bool          remove( const String& key );
+  bool          set( const String& key, const String& value );
+
+private:
+  static uint8_t hash( const char* key, size_t length );
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <stdint.h>
+#include <WString.h>
+
+namespace Relays {
+
+  // Channels are the bits of 64-bit masks, so a backend drives up to 64 outputs.
+  static const uint8_t MAX_CHANNELS = 64;
+  static const int8_t  NO_CHANNEL   = -1;
+
+  struct BackendConfig {
+    uint8_t address;            // I2C address of the first chip (MCP23017).
+    uint8_t chips;              // Chips on the bus or in the chain (MCP23017, 74HC595).
+    uint8_t latchPin;           // Storage register clock pin (74HC595).
+  };
+
+  /**
+   * The relay outputs hardware. Outputs are addressed by channel masks, bit N is the channel N,
+   * and all the selected channels are written at once, in one bus transaction (or one register
+   * write) per port where the hardware allows it. Output levels are cached by backends, so
+   * reading them back never touches the bus.
+   */
+  class Backend {
+  public:
+    virtual ~Backend() {}
+    // Sets the initial levels and configures the channels as outputs.
+    // @return false if the hardware doesn't respond.
+    virtual bool     begin( uint64_t channels, uint64_t levels ) = 0;
+    // Sets the selected channels to the levels, others are untouched.
+    virtual void     write( uint64_t levels, uint64_t select ) = 0;
+    // Output levels of all the channels.
+    virtual uint64_t read() = 0;
+    // The channel of the relay "pin" config value, NO_CHANNEL if the pin is 0 or invalid.
+    virtual int8_t   toChannel( uint8_t pin ) = 0;
+  };
+
+  /**
+   * The factory method to instantiate backends, the type is "gpio", "mcp23017" or "74hc595".
+   * @return nullptr if the backend type is unknown.
+   */
+  Backend* createBackend( const String& type, const BackendConfig& config );
+
+  bool     isValidBackend( const String& type );
+  // An output pin not used by the display, touch or SD card (they share the SPI bus with the chain)
+  // and not used by the I2C bus.
+  bool     isValidLatchPin( uint8_t pin );
+}
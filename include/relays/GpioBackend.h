@@ -0,0 +1,17 @@
+#pragma once
+#include "Backend.h"
+
+namespace Relays {
+
+  /**
+   * Relays driven by the ESP32 GPIOs, the channel is the GPIO number. Pins of both GPIO banks
+   * are switched with the write-one-to-set/clear registers, one write per bank and direction.
+   */
+  class GpioBackend : public Backend {
+  public:
+    virtual bool     begin( uint64_t channels, uint64_t levels );
+    virtual void     write( uint64_t levels, uint64_t select );
+    virtual uint64_t read();
+    virtual int8_t   toChannel( uint8_t pin );
+  };
+}
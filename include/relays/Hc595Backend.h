@@ -0,0 +1,32 @@
+#pragma once
+#include "Backend.h"
+
+namespace Relays {
+
+  /**
+   * Relays driven by a 74HC595 shift registers chain on the SPI bus (VSPI, shared with the
+   * touchscreen and the SD card), up to 8 chips. The relay pin N (1-based) is the channel N-1,
+   * Q0..Q7 of the first chip in the chain (the nearest to MOSI), then the next chip.
+   * The whole chain is shifted in one SPI transfer and latched at once.
+   */
+  class Hc595Backend : public Backend {
+  public:
+    static const uint8_t OUTPUTS_PER_CHIP = 8;
+    static const uint8_t MAX_CHIPS        = MAX_CHANNELS / OUTPUTS_PER_CHIP;
+
+  private:
+    const uint8_t chips;
+    const uint8_t latchPin;
+    uint64_t      levels = 0;     // Storage registers of all chips.
+
+  public:
+    Hc595Backend( const BackendConfig& config );
+    virtual bool     begin( uint64_t channels, uint64_t levels );
+    virtual void     write( uint64_t levels, uint64_t select );
+    virtual uint64_t read()  { return levels; }
+    virtual int8_t   toChannel( uint8_t pin );
+
+  private:
+    void             transfer();
+  };
+}
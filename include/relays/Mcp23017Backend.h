@@ -0,0 +1,32 @@
+#pragma once
+#include "Backend.h"
+
+namespace Relays {
+
+  /**
+   * Relays driven by MCP23017 I/O expanders on the shared I2C bus (Wire), up to 4 chips at
+   * consecutive addresses. The relay pin N (1-based) is the channel N-1: GPA0..GPA7, GPB0..GPB7
+   * of the first chip, then the next chip. Both ports of a chip are written in one transaction,
+   * chips whose outputs are unchanged aren't written at all.
+   */
+  class Mcp23017Backend : public Backend {
+  public:
+    static const uint8_t OUTPUTS_PER_CHIP = 16;
+    static const uint8_t MAX_CHIPS        = MAX_CHANNELS / OUTPUTS_PER_CHIP;
+
+  private:
+    const uint8_t address;
+    const uint8_t chips;
+    uint64_t      levels = 0;     // OLAT registers of all chips.
+
+  public:
+    Mcp23017Backend( const BackendConfig& config );
+    virtual bool     begin( uint64_t channels, uint64_t levels );
+    virtual void     write( uint64_t levels, uint64_t select );
+    virtual uint64_t read()  { return levels; }
+    virtual int8_t   toChannel( uint8_t pin );
+
+  private:
+    bool             writeRegisters( uint8_t chip, uint8_t reg, uint16_t value );
+  };
+}
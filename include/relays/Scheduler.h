@@ -0,0 +1,102 @@
+#pragma once
+#include <functional>
+#include <stdint.h>
+#include <time.h>
+#include <WString.h>
+#include "Config.h"
+#include "TimerWheel.h"
+#include "core/Tokenizer.h"
+
+namespace Relays {
+
+  /**
+   * A relay schedule, 24 bytes, stored as is in the options blob. Cron fields are bit sets,
+   * e.g. bit 7 of hours is 7 o'clock. Times are local, intervals are aligned to the epoch.
+   */
+  struct Schedule {
+    enum Type : uint8_t {
+      EMPTY,
+      CRON,                     // "<minute> <hour> <day> <month> <weekday>", as in crontab.
+      INTERVAL                  // Every <period> seconds.
+    };
+    static const uint8_t CATCH_UP = 0x01;     // A missed run is performed once, see Scheduler.
+
+    Type     type;
+    uint8_t  relay;             // The relay index.
+    uint8_t  action;            // 0 - off, 1 - on, 2 - toggle.
+    uint8_t  flags;
+    union {
+      struct {
+        uint32_t minutes[2];    // 0..59
+        uint32_t hours;         // 0..23
+        uint32_t days;          // 1..31
+        uint16_t months;        // 1..12
+        uint8_t  weekdays;      // 0..6, Sunday is 0.
+      } cron;
+      struct {
+        uint32_t period;
+        uint32_t offset;
+      } interval;
+    };
+  };
+
+  /**
+   * Runs relay schedules from the real-time clock. Due times of all schedules are kept in a
+   * timer wheel, and each tick compares the clock with the next due time only.
+   *
+   * Missed runs are handled explicitly. When the clock becomes valid after a reboot, or is
+   * stepped forward by more than RELAY_SCHEDULE_MAX_DRIFT (e.g. by NTP), the runs in between
+   * (but not older than RELAY_SCHEDULE_LOOKBACK) are missed: for each relay, the latest missed
+   * on/off run of CATCH_UP schedules is performed once, others are skipped. After a reboot the
+   * missed runs are those after the resume() time, the last clock processed before the reboot;
+   * nothing is caught up if it's unknown. Smaller steps
+   * forward are caught up by the wheel, each late schedule runs once. When the clock goes back,
+   * schedules are rebuilt from the new time without runs.
+   */
+  class Scheduler {
+  public:
+    typedef std::function<void(const Schedule& schedule)> RunCallback;
+
+  private:
+    Schedule   schedules[Config::RELAY_MAX_SCHEDULES];
+    uint8_t    count = 0;
+    TimerWheel wheel;
+    time_t     nextDue = 0;
+    time_t     lastTime = 0;          // The clock of the previous tick, 0 before the first valid one.
+    time_t     resumeTime = 0;        // The last clock processed before the reboot, 0 if unknown.
+
+  public:
+    // Called every second with the clock, 0 if the clock isn't valid yet.
+    void            tick( time_t now, const RunCallback& run );
+    // Sets the last clock processed before the reboot, must be called before the first tick.
+    void            resume( time_t time )            { resumeTime = time; }
+    // The last processed clock, to be saved for resume().
+    time_t          getLastTime()                    { return lastTime; }
+    // True if any schedule is caught up, so the last processed clock is worth saving.
+    bool            hasCatchUp();
+
+    bool            add( const Schedule& schedule );
+    bool            remove( uint8_t index );
+    void            clear();
+    uint8_t         getCount()                       { return count; }
+    const Schedule& get( uint8_t index )             { return schedules[index]; }
+
+    // The blob form for options.
+    const void*     data()                           { return schedules; }
+    size_t          size()                           { return count * sizeof(Schedule); }
+    void            load( const void* data, size_t size );
+
+    // "<cron fields>" or "every <seconds>" tokens, followed by an optional "catchup".
+    static bool     parse( Tokenizer& tokens, Schedule& schedule );
+    // The same form as parse() takes.
+    static void     format( const Schedule& schedule, String& out );
+    // The first run after the time, 0 if none.
+    static time_t   next( const Schedule& schedule, time_t after );
+    // The last run at or before the time, but after the limit, 0 if none.
+    static time_t   previous( const Schedule& schedule, time_t before, time_t limit );
+
+  private:
+    void            catchUp( time_t from, time_t to, const RunCallback& run );
+    void            rebuild( time_t now );
+  };
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <functional>
+#include <stdint.h>
+#include <time.h>
+#include "Config.h"
+
+namespace Relays {
+
+  /**
+   * A hierarchical timer wheel with one-second ticks. Timers are identified by their index.
+   *
+   * Level 0 has a slot per second of the current 64 s round, level 1 a slot per round of the
+   * current 64 rounds, and so on, 4 levels cover 2^24 s (194 days). Later timers wait in the
+   * overflow list. When the wheel time enters a new round, the timers of the level 1 slot of
+   * this round are moved down to level 0 (cascaded), and the same for upper levels.
+   *
+   * Inserting and cancelling are O(1), advancing jumps straight to the next occupied slot or
+   * the next round, and nextDue() only looks at the first occupied slot.
+   */
+  class TimerWheel {
+  public:
+    static const uint8_t  CAPACITY = Config::RELAY_MAX_SCHEDULES;
+    typedef std::function<void(uint8_t id)> ExpiredCallback;
+
+  private:
+    static const uint8_t  LEVELS    = 4;
+    static const uint8_t  SLOT_BITS = 6;
+    static const uint8_t  SLOTS     = 1 << SLOT_BITS;
+    static const uint16_t OVERFLOW  = LEVELS * SLOTS;     // The overflow list "slot".
+    static const uint16_t IDLE      = 0xFFFF;             // The timer isn't scheduled.
+    static const uint8_t  NONE      = 0xFF;               // The end of a slot list.
+
+    struct Timer {
+      uint32_t due;
+      uint16_t slot;
+      uint8_t  next;
+    };
+
+    Timer    timers[CAPACITY];
+    uint8_t  heads[OVERFLOW + 1];
+    uint64_t occupied[LEVELS];          // A bit per non-empty slot.
+    uint32_t now = 0;
+
+  public:
+    TimerWheel()  { reset( 0 ); }
+
+    // Cancels all timers and sets the wheel time.
+    void     reset( time_t time );
+    // Schedules the timer to expire at the due time, at least one second after the wheel time.
+    void     schedule( uint8_t id, time_t due );
+    void     cancel( uint8_t id );
+    // Moves the wheel time to the time, expiring timers on the way. The callback may schedule
+    // the expired timer again.
+    void     advance( time_t time, const ExpiredCallback& expired );
+    // The earliest due time, 0 if there are no timers.
+    time_t   nextDue();
+
+  private:
+    void     cascade();
+    void     insert( uint8_t id );
+    void     link( uint8_t id, uint16_t slot );
+    uint8_t  unlinkAll( uint16_t slot );
+  };
+}
@@ -53,6 +53,24 @@ namespace s_s
     {
         return (str_is_correct(str.c_str()) && (str.length() <= MAX_LEN)) ? str_hash(str.c_str(), str.length()) : N_HASH;
     }
+
+    // Not NUL-terminated strings, e.g. StringView.
+    inline ullong str_hash_for_switch(const char* const str, const size_t len)
+    {
+        if (len > MAX_LEN) return N_HASH;
+        ullong hash = 0;
+        for (size_t i = 0; i < len; i++) {
+            if (static_cast<signed char>(str[i]) <= 0) return N_HASH;
+            hash += raise_128_to(len - 1 - i) * static_cast<uchar>(str[i]);
+        }
+        return hash;
+    }
+
+    template <typename T>
+    inline ullong str_hash_for_switch(const T& str)
+    {
+        return str_hash_for_switch(str.data(), str.length());
+    }
 }
 
 #endif  // STR_SWITCH_H
\ No newline at end of file
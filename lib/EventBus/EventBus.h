@@ -6,6 +6,8 @@
 #include <map>
 #include <memory>
 
+#include <EventFilter.h>
+#include <FilteredCallbackVector.h>
 #include <TransactionCallbackVector.h>
 #include <common.h>
 
@@ -20,6 +22,7 @@ public:
 	~EventBus()
 	{
 		_callbacks.clear();
+		_filtered.clear();
 	}
 
 	EventBus(const EventBus&) = delete;
@@ -69,6 +72,54 @@ public:
 		vectorImpl->add(token, callback);
 	}
 
+	/**
+	 * Register a filtered listener for event. Returns token used for unlisten.
+	 *
+	 * @tparam Event - type you want to listen for, must have EventFilterTraits
+	 * @param filter - source and subtype of events to listen
+	 * @param callback - your callback to handle event
+	 * @return token used for unlisten
+	 */
+	template <typename Event>
+	int listen(const EventFilter& filter, const std::function<void(const Event&)>& callback)
+	{
+		const int token = ++_tokener;
+		listen<Event>(token, filter, callback);
+		return token;
+	}
+
+	/**
+	 * @tparam Event - type you want to listen for, must have EventFilterTraits
+	 * @param token - unique token for identification receiver. Simply pass token from @see EventBus::listen
+	 * @param filter - source and subtype of events to listen
+	 * @param callback - your callback to handle event
+	 */
+	template <typename Event>
+	void listen(const int token, const EventFilter& filter, const std::function<void(const Event&)>& callback)
+	{
+		static_assert(Internal::validateEvent<Event>(), "Invalid event");
+		static_assert(EventFilterTraits<Event>::enabled, "Event doesn't support filters");
+
+		if(filter.isAny())
+		{
+			listen<Event>(token, callback);
+			return;
+		}
+
+		using Vector = Internal::FilteredCallbackVector<Event>;
+
+		assert(callback && "callback should be valid"); //Check for valid object
+
+		std::unique_ptr<Internal::CallbackVector>& vector = _filtered[Internal::type_id<Event>()];
+		if(vector == nullptr)
+		{
+			vector.reset(new Vector {});
+		}
+		assert(dynamic_cast<Vector*>(vector.get()));
+		Vector* vectorImpl = static_cast<Vector*>(vector.get());
+		vectorImpl->add(token, filter, callback);
+	}
+
 	/**
 	 * @param token - token from EventBus::listen
 	 */
@@ -78,6 +129,10 @@ public:
 		{
 			element.second->remove(token);
 		}
+		for(auto& element : _filtered)
+		{
+			element.second->remove(token);
+		}
 	}
 
 	/**
@@ -94,6 +149,11 @@ public:
 		{
 			found->second->remove(token);
 		}
+		found = _filtered.find(Internal::type_id<Event>());
+		if(found != _filtered.end())
+		{
+			found->second->remove(token);
+		}
 	}
 
 	/**
@@ -109,26 +169,46 @@ public:
 
 		using Vector = Internal::TransactionCallbackVector<CleanEventType>;
 		auto found = _callbacks.find(Internal::type_id<CleanEventType>());
-		if(found == _callbacks.end())
+		if(found != _callbacks.end())
 		{
-			return; // no such notifications
+			std::unique_ptr<Internal::CallbackVector>& vector = found->second;
+			assert(dynamic_cast<Vector*>(vector.get()));
+			Vector* vectorImpl = static_cast<Vector*>(vector.get());
+
+			vectorImpl->beginTransaction();
+			for(const auto& element : vectorImpl->container)
+			{
+				element.second(event);
+			}
+			vectorImpl->commitTransaction();
 		}
 
-		std::unique_ptr<Internal::CallbackVector>& vector = found->second;
-		assert(dynamic_cast<Vector*>(vector.get()));
-		Vector* vectorImpl = static_cast<Vector*>(vector.get());
-
-		vectorImpl->beginTransaction();
-		for(const auto& element : vectorImpl->container)
-		{
-			element.second(event);
-		}
-		vectorImpl->commitTransaction();
+		notifyFiltered<CleanEventType>(
+			event, std::integral_constant<bool, EventFilterTraits<CleanEventType>::enabled> {});
 	}
 
 private:
 	int _tokener = 0;
 	std::map<Internal::type_id_t, std::unique_ptr<Internal::CallbackVector>> _callbacks;
+	std::map<Internal::type_id_t, std::unique_ptr<Internal::CallbackVector>> _filtered;
+
+	template <typename Event>
+	void notifyFiltered(const Event& event, std::true_type)
+	{
+		using Vector = Internal::FilteredCallbackVector<Event>;
+		auto found = _filtered.find(Internal::type_id<Event>());
+		if(found == _filtered.end())
+		{
+			return; // no filtered listeners
+		}
+		assert(dynamic_cast<Vector*>(found->second.get()));
+		static_cast<Vector*>(found->second.get())->notify(event);
+	}
+
+	template <typename Event>
+	void notifyFiltered(const Event&, std::false_type)
+	{
+	}
 };
 
 } /* namespace Dexode */
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Dexode
+{
+
+/**
+ * Listener filter: the event source ID and the event subtype. Filters are resolved into
+ * listener buckets at registration time, so notify() only calls the matching listeners.
+ */
+struct EventFilter
+{
+	static constexpr std::uint32_t ANY = 0xFFFFFFFFu;
+
+	std::uint32_t source = ANY;
+	std::uint32_t subtype = ANY;
+
+	/**
+	 * @param sourceId - the event source ID, nullptr for any source
+	 * @param subtype - the event subtype, ANY for any subtype
+	 */
+	static EventFilter of(const char* sourceId, const std::uint32_t subtype = ANY)
+	{
+		EventFilter filter;
+		filter.source = sourceId != nullptr ? hash(sourceId) : ANY;
+		filter.subtype = subtype;
+		return filter;
+	}
+
+	static EventFilter of(const std::uint32_t subtype)
+	{
+		return of(nullptr, subtype);
+	}
+
+	bool isAny() const
+	{
+		return source == ANY && subtype == ANY;
+	}
+
+	// FNV-1a, used to turn the source IDs into bucket keys.
+	static std::uint32_t hash(const char* s)
+	{
+		std::uint32_t h = 2166136261u;
+		while(*s)
+		{
+			h = (h ^ static_cast<std::uint8_t>(*s++)) * 16777619u;
+		}
+		return h == ANY ? 0 : h;
+	}
+};
+
+/**
+ * Specialize it for the events supporting filters:
+ *
+ *   template <> struct EventFilterTraits<MyEvent>
+ *   {
+ *       static const bool enabled = true;
+ *       static std::uint32_t source(const MyEvent& event);     // EventFilter::hash() of the source ID or ANY
+ *       static std::uint32_t subtype(const MyEvent& event);
+ *   };
+ */
+template <typename Event>
+struct EventFilterTraits
+{
+	static const bool enabled = false;
+};
+
+} /* namespace Dexode */
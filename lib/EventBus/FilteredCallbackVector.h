@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+#include "CallbackVector.h"
+#include "EventFilter.h"
+#include "TransactionCallbackVector.h"
+
+namespace Dexode
+{
+namespace Internal
+{
+
+/**
+ * Filtered listeners of an event type, grouped into buckets by the filter.
+ * Buckets are never erased, so notify() is safe against listen/unlisten from callbacks.
+ */
+template <typename Event>
+struct FilteredCallbackVector : public CallbackVector
+{
+	using Bucket = TransactionCallbackVector<Event>;
+	using CallbackType = typename Bucket::CallbackType;
+
+	std::map<std::uint64_t, Bucket> buckets;
+
+	static std::uint64_t makeKey(const std::uint32_t source, const std::uint32_t subtype)
+	{
+		return (static_cast<std::uint64_t>(source) << 32) | subtype;
+	}
+
+	virtual void remove(const int token) override
+	{
+		for(auto& element : buckets)
+		{
+			element.second.remove(token);
+		}
+	}
+
+	void add(const int token, const EventFilter& filter, const CallbackType& callback)
+	{
+		buckets[makeKey(filter.source, filter.subtype)].add(token, callback);
+	}
+
+	void notify(const Event& event)
+	{
+		const std::uint32_t source = EventFilterTraits<Event>::source(event);
+		const std::uint32_t subtype = EventFilterTraits<Event>::subtype(event);
+
+		// The exact match, then the source only and the subtype only listeners.
+		// A source or subtype reported as ANY is not a match for filters.
+		if(source != EventFilter::ANY && subtype != EventFilter::ANY)
+		{
+			notifyBucket(makeKey(source, subtype), event);
+		}
+		if(source != EventFilter::ANY)
+		{
+			notifyBucket(makeKey(source, EventFilter::ANY), event);
+		}
+		if(subtype != EventFilter::ANY)
+		{
+			notifyBucket(makeKey(EventFilter::ANY, subtype), event);
+		}
+	}
+
+private:
+	void notifyBucket(const std::uint64_t key, const Event& event)
+	{
+		auto found = buckets.find(key);
+		if(found == buckets.end())
+		{
+			return;
+		}
+		Bucket& bucket = found->second;
+		bucket.beginTransaction();
+		for(const auto& element : bucket.container)
+		{
+			element.second(event);
+		}
+		bucket.commitTransaction();
+	}
+};
+
+} // namespace Internal
+} // namespace Dexode
@@ -2,6 +2,7 @@
 #include "Events.h"
 #include "str_switch.h"
 #include "Utils.h"
+#include "core/Format.h"
 
 AM312Module::AM312Module() {
   properties.has_module_webpage = true;
@@ -32,7 +33,7 @@ void AM312Module::tick_100mS( uint8_t phase ) {
         sensorValue = v;
         // Send the status changed event to the EventBus.
         // The new state (in JSON format) is provided as the event payload.
-        Bus.notify<StatusChangedEvent>( {this, payload} );
+        Bus.notify( StatusChangedEvent( this, payload ));
 
         if( v ) {
           lastMotionTimestamp = millis();
@@ -68,8 +69,8 @@ const String AM312Module::getStatusWebpage() {
 
 /* A generic getData/setData interface */
 
-const String AM312Module::getString( const String& key ) {
-  SWITCH( key.c_str() ) {
+const String AM312Module::getString( const StringView& key ) {
+  SWITCH( key ) {
     // Get the module export config (JSON string)
     CASE( Config::KEY_EXPORT_CONFIGURATION ): {
       StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
@@ -82,8 +83,8 @@ const String AM312Module::getString( const String& key ) {
   }
 }
 
-ResultData AM312Module::setString( const String& key, const String& value ) {
-  SWITCH( key.c_str() ) {
+ResultData AM312Module::setString( const StringView& key, const String& value ) {
+  SWITCH( key ) {
     // Permanently store the new module config.
     CASE( Config::KEY_IMPORT_CONFIGURATION ):
       return handleConfigImport( value );
@@ -119,8 +120,8 @@ ResultData AM312Module::handleOption( const String& key, const String& value, Op
   }
 }
 
-void AM312Module::resolveTemplateKey( const String& key, String& out ) {
-  SWITCH( key.c_str() ) {
+void AM312Module::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     // ==========================================
     // Module template parameters
     CASE( "TITLE" ):     out += Utils::formatModuleSettingsTitle( getId(), getName() );  break;
@@ -128,6 +129,6 @@ void AM312Module::resolveTemplateKey( const String& key, String& out ) {
     CASE( "HOLD" ):      out += getShortOption( HOLD_OPTION_KEY );                       break;
     // ==========================================
     // Status template parameters
-    CASE( "MOTION" ):    out += Utils::format( Messages::AM_312_MOTION, Utils::toString( sensorValue ));  break;
+    CASE( "MOTION" ):    Format::append( out, Messages::AM_312_MOTION, sensorValue ? "true" : "false" );  break;
   }
 }
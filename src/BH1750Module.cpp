@@ -2,6 +2,10 @@
 #include "Events.h"
 #include "str_switch.h"
 #include "Utils.h"
+#include "core/Format.h"
+
+// Sensor value names of the status data.
+static const char* const STATUS_NAMES[] = { "lux" };
 
 BH1750Module::BH1750Module() {
   properties.has_module_webpage = true;
@@ -36,15 +40,18 @@ void BH1750Module::tick_100mS( uint8_t phase ) {
       if( previousValue != newValue ) {
         lux = String( newValue );
         // Send the status changed event to the EventBus.
-        // The new state (in a JSON format) is provided as the event payload.
-        StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-        json["lux"] = lux;
-        const String payload = json.as<String>();
-        Bus.notify( (StatusChangedEvent) {this, payload} );
+        // The new value is provided as typed sensor data, serialized only on demand.
+        StatusData data;
+        data.type = StatusData::TYPE_SENSOR;
+        data.sensor.names = STATUS_NAMES;
+        data.sensor.values[0] = newValue;
+        data.sensor.count = 1;
+        const StatusChangedEvent event( this, data );
+        Bus.notify( event );
         // Send an event if value is changed more than dalta threshold option.
         if( std::abs(previousValue - newValue) > valueDelta ) {
           previousValue = newValue;
-          Bus.notify<CommandResponseEvent>( (CommandResponseEvent) {this, getId(), payload} );
+          Bus.notify<CommandResponseEvent>( (CommandResponseEvent) {this, getId(), event.getPayload()} );
         }
       }
     }
@@ -63,8 +70,8 @@ const String BH1750Module::getStatusWebpage() {
 
 /* A generic getData/setData interface */
 
-const String BH1750Module::getString( const String& key ) {
-  SWITCH( key.c_str() ) {
+const String BH1750Module::getString( const StringView& key ) {
+  SWITCH( key ) {
     // Get the module export config (JSON string)
     CASE( Config::KEY_EXPORT_CONFIGURATION ): {
     StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
@@ -77,8 +84,8 @@ const String BH1750Module::getString( const String& key ) {
   }
 }
 
-ResultData BH1750Module::setString( const String& key, const String& value ) {
-  SWITCH( key.c_str() ) {
+ResultData BH1750Module::setString( const StringView& key, const String& value ) {
+  SWITCH( key ) {
     // Permanently store the new module config.
     CASE( Config::KEY_IMPORT_CONFIGURATION ):
       return handleConfigImport( value );
@@ -116,8 +123,8 @@ ResultData BH1750Module::handleOption( const String& key, const String& value, O
   }
 }
 
-void BH1750Module::resolveTemplateKey( const String& key, String& out ) {
-  SWITCH( key.c_str() ) {
+void BH1750Module::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     // ==========================================
     // Module template parameters
     CASE( "POLLTIME" ):  out += getPollOption();                              break;
@@ -125,7 +132,7 @@ void BH1750Module::resolveTemplateKey( const String& key, String& out ) {
     // ==========================================
     // Status template parameters
     CASE( "TITLE" ):    out += Messages::TITLE_BH1750_MODULE;                break;
-    CASE( "LUX" ):      out += Utils::format( Messages::BME1750_LUX, lux );  break;
+    CASE( "LUX" ):      Format::append( out, Messages::BME1750_LUX, lux.c_str() );  break;
   }
 }
 
@@ -3,6 +3,11 @@
 #include "Events.h"
 #include "str_switch.h"
 #include "Utils.h"
+#include "core/Format.h"
+#include "core/ScratchArena.h"
+
+// Sensor value names of the status data, the same as in toJsonString().
+static const char* const STATUS_NAMES[] = { "temperature", "humidity" };
 
 BME280Module::BME280Module() {
   properties.has_module_webpage = true;
@@ -41,13 +46,19 @@ void BME280Module::tick_100mS( uint8_t phase ) {
         temperature = String( temp );
         humidity = String( hum );
         // Send the status changed event to the EventBus.
-        // The new state (in a JSON format) is provided as the event payload.
-        const String json = toJsonString();
-        Bus.notify( (StatusChangedEvent) {this, json} );
+        // The new values are provided as typed sensor data, serialized only on demand.
+        StatusData data;
+        data.type = StatusData::TYPE_SENSOR;
+        data.sensor.names = STATUS_NAMES;
+        data.sensor.values[0] = temp;
+        data.sensor.values[1] = hum;
+        data.sensor.count = 2;
+        Bus.notify( StatusChangedEvent( this, data ));
         // Send a packet of new values to the EventBus.
         if( std::abs(previousTemperature - temp) > temperatureDelta || std::abs(previousHumidity - hum) > humidityDelta ) {
           previousTemperature = temp;
           previousHumidity = hum;
+          const String json = toJsonString();
           Bus.notify<CommandResponseEvent>( (CommandResponseEvent) {this, getId(), json} );
         }
         state = SLEEP;
@@ -82,11 +93,11 @@ const String BME280Module::getStatusWebpage() {
 
 /* A generic getData/setData interface */
 
-const String BME280Module::getString( const String& key ) {
-  SWITCH( key.c_str() ) {
+const String BME280Module::getString( const StringView& key ) {
+  SWITCH( key ) {
     // Get the module export config (JSON string)
     CASE( Config::KEY_EXPORT_CONFIGURATION ): {
-      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+      ScratchJsonDocument json( Config::JSON_MESSAGE_SIZE );
       json["scale"]  = toString( getScaleOption() );
       json["poll"]   = getPollOption();
       json["deltaT"] = getDeltaTOption();
@@ -98,8 +109,8 @@ const String BME280Module::getString( const String& key ) {
   }
 }
 
-ResultData BME280Module::setString( const String& key, const String& value ) {
-  SWITCH( key.c_str() ) {
+ResultData BME280Module::setString( const StringView& key, const String& value ) {
+  SWITCH( key ) {
     // Permanently store the new relay config (JSON array string).
     CASE( Config::KEY_IMPORT_CONFIGURATION ):
       return handleConfigImport( value );
@@ -110,10 +121,6 @@ ResultData BME280Module::setString( const String& key, const String& value ) {
 
 /* Protected */
 
-bool BME280Module::handleCommand( const String& cmd, const String& args ) {
-  return false;
-}
-
 ResultData BME280Module::handleOption( const String& key, const String& value, Options::Action action ) {
   SWITCH( key.c_str() ) {
     // ==========================================
@@ -161,8 +168,8 @@ ResultData BME280Module::handleOption( const String& key, const String& value, O
   }
 }
 
-void BME280Module::resolveTemplateKey( const String& key, String& out ) {
-  SWITCH( key.c_str() ) {
+void BME280Module::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     // ==========================================
     // Module template parameters
     CASE( "MTITLE" ):    out += Utils::formatModuleSettingsTitle( getId(), getName() );  break;
@@ -174,9 +181,9 @@ void BME280Module::resolveTemplateKey( const String& key, String& out ) {
     // ==========================================
     // Status template parameters
     CASE( "STITLE" ):    out += Messages::TITLE_BME280_MODULE;                           break;
-    CASE( "SHUM" ):      out += Utils::format( Messages::BME280_HUMIDITY, humidity );    break;
+    CASE( "SHUM" ):      Format::append( out, Messages::BME280_HUMIDITY, humidity.c_str() );  break;
     CASE( "STEMP" ): {
-      out += Utils::format( Messages::BME280_TEMPERATURE, temperature, getScaleOption() == Config::CELSIUS ? "C" : "F" );
+      Format::append( out, Messages::BME280_TEMPERATURE, temperature.c_str(), getScaleOption() == Config::CELSIUS ? "C" : "F" );
       break;
     }
   }
@@ -201,7 +208,7 @@ Config::TemperatureScale BME280Module::getScaleOption() {
 }
 
 String BME280Module::toJsonString() {
-  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  ScratchJsonDocument json( Config::JSON_MESSAGE_SIZE );
   json["temperature"] = temperature;
   json["humidity"] = humidity;
   return json.as<String>();
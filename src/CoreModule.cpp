@@ -16,6 +16,8 @@
 #include "Utils.h"
 #include "core/ConfigImporter.h"
 #include "core/FirmwareUploader.h"
+#include "core/Format.h"
+#include "core/ScratchArena.h"
 
 CoreModule::CoreModule() {
   properties.has_module_webpage = true;
@@ -23,8 +25,8 @@ CoreModule::CoreModule() {
   flags.data = 0;
 
   // Subscribe to event bus connectivity events.
-  eventBusToken = Bus.listen<ConnectivityEvent>( [this](const ConnectivityEvent& event ) {
-    if( event.type == ConnectivityEvent::TYPE_MQTT && event.connected ) {
+  eventBusToken = Bus.listen<ConnectivityEvent>( EventFilter::of( ConnectivityEvent::TYPE_MQTT ), [this](const ConnectivityEvent& event ) {
+    if( event.connected ) {
       publishMqttConnectionInfo1();
       publishMqttConnectionInfo2();
     }
@@ -44,7 +46,7 @@ CoreModule::CoreModule() {
   // If have any extra options (in JSON format), apply them now.
   auto rc = applyExtraOptions( getStringOption( MODULE_OPTIONS_KEY ));
   if( rc.code != RC_OK ) {
-    Log.error( "CORE %s" CR, rc.details );
+    Log.error( "CORE %s" CR, rc.details.c_str() );
   }
 }
 
@@ -86,8 +88,8 @@ const String CoreModule::getModuleWebpage() {
 
 /* A generic getData/setData interface */
 
-const String CoreModule::getString( const String& key ) {
-  SWITCH( key.c_str() ) {
+const String CoreModule::getString( const StringView& key ) {
+  SWITCH( key ) {
     CASE( Config::KEY_EXPORT_CONFIGURATION ): {
       StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
       json["sleepmode"] = fromSleepMode( Options::getSleepMode() );
@@ -101,8 +103,8 @@ const String CoreModule::getString( const String& key ) {
   }
 }
 
-ResultData CoreModule::setString( const String& key, const String& value ) {
-  SWITCH( key.c_str() ) {
+ResultData CoreModule::setString( const StringView& key, const String& value ) {
+  SWITCH( key ) {
     CASE( Config::KEY_IMPORT_CONFIGURATION ):
       return handleConfigImport( value );
     DEFAULT_CASE:
@@ -169,133 +171,25 @@ void CoreModule::performPendingRestart() {
 
 /* Protected */
 
+static constexpr const char* const NVS_ACTIONS[] = { "clear" };
+
+constexpr Commands::Entry<CoreModule> CoreModule::COMMANDS[] = {
+  { "heapstat",  Commands::none(),              &CoreModule::cmdHeapStat,  "Heap memory statistics" },
+  { "modules",   Commands::none(),              &CoreModule::cmdModules,   "The list of active modules" },
+  { "netinfo",   Commands::none(),              &CoreModule::cmdNetInfo,   "Network info" },
+  { "nvs",       Commands::choice(NVS_ACTIONS), &CoreModule::cmdNvs,       "Erase ALL persistent options and restart" },
+  { "nvsstat",   Commands::none(),              &CoreModule::cmdNvsStat,   "NVS entries statistics" },
+  { "powerinfo", Commands::none(),              &CoreModule::cmdPowerInfo, "Sleep and cpu load info" },
+  { "resetinfo", Commands::none(),              &CoreModule::cmdResetInfo, "The last restart reason" },
+  { "restart",   Commands::none(),              &CoreModule::cmdRestart,   "Restart the device" },
+  { "telemetry", Commands::none(),              &CoreModule::cmdTelemetry, "Telemetry info" },
+  { "timeinfo",  Commands::none(),              &CoreModule::cmdTimeInfo,  "System time and uptime" },
+  { "version",   Commands::none(),              &CoreModule::cmdVersion,   "Firmware version" },
+  { "wifiinfo",  Commands::none(),              &CoreModule::cmdWifiInfo,  "WiFi info" },
+};
+
 bool CoreModule::handleCommand( const String& cmd, const String& args ) {
-  SWITCH( cmd.c_str() ) {
-    // ==========================================
-    // Heap memory statistics
-    CASE( "heapstat" ): {
-      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-      json["HeapSize"] = ESP.getHeapSize();
-      json["Free"]     = ESP.getFreeHeap();
-      json["Lowest"]   = ESP.getMinFreeHeap();
-      json["MaxBlock"] = ESP.getMaxAllocHeap();
-      handleCommandResults( cmd, args, json.as<String>() );
-      return true;
-    }
-    // ==========================================
-    // Heap memory statistics
-    CASE( "nvsstat" ): {
-      nvs_stats_t nvs_stats;
-      nvs_get_stats( NULL, &nvs_stats );
-      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-      json["Used"] = nvs_stats.used_entries;
-      json["Free"] = nvs_stats.free_entries;
-      handleCommandResults( cmd, args, json.as<String>() );
-      return true;
-    }
-    // ==========================================
-    // Return the list (JSON array) of active modules.
-    CASE( "modules" ): {
-      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-      JsonArray array = json.createNestedArray( "modules" );
-      Modules.iterator( [&array](Module* module) {
-        array.add( module->getId() );
-      });
-      handleCommandResults( cmd, args, json.as<String>() );
-      return true;
-    }
-    // ==========================================
-    // Get network info
-    CASE( "netinfo" ): {
-      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-      json["LocalIP"] = WiFi.localIP().toString();
-      json["SubnetMask"] = WiFi.subnetMask().toString();
-      json["GatewayIP"] = WiFi.gatewayIP().toString();
-      json["DnsIP"] = WiFi.dnsIP().toString();
-      json["Mac"] = WiFi.macAddress();
-      handleCommandResults( cmd, args, json.as<String>() );
-      return true;
-    }
-    // ==========================================
-    // Commands to manage persistent options (NVS) stored in non-volatile RAM.
-    // options erase - Used to erase ALL persistent options. You must reconfigure the device afterwards.
-    //                 Warning!! There is no extra confirmations for console commands, so the options will be erased immediately.
-    CASE( "nvs" ): {
-      if( args == "clear" ) {
-        Options::clear();
-        performPendingRestart();
-      }
-      return true;
-    }
-    // ==========================================
-    // Get sleep and cpu load info
-    CASE( "powerinfo" ): {
-      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-      json["SleepMode"] = fromSleepMode( Options::getSleepMode() );
-      json["SleepTime"] = Options::getSleepTime();
-      json["LoadAvg"] = State.cpuLoadValue();
-      json["WiFiSleep"] = WiFi.getSleep();
-      handleCommandResults( cmd, args, json.as<String>() );
-      return true;
-    }
-    // ==========================================
-    // Get some debug/diagnostic info
-    CASE( "resetinfo" ): {
-      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-      json["RestartReason"] = Utils::getResetReason();
-      handleCommandResults( cmd, args, json.as<String>() );
-      return true;
-    }
-    // ==========================================
-    // Restart
-    // value 0 - System restart
-    CASE( "restart" ): {
-      handleCommandResults( cmd, args, Messages::OK );
-      performPendingRestart();
-      return true;
-    }
-    // ==========================================
-    // Get the telemetry info
-    CASE( "telemetry" ): {
-      handleCommandResults( cmd, args, prepareTelemetry() );
-      return true;
-    }
-    // ==========================================
-    // Get system time and uptime info
-    CASE( "timeinfo" ): {
-      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-      Modules.execute( RTC_MODULE, [&json](Module* module) {
-        json["Local"] = ((RtcTimeModule*) module)->getLocalTimeString();
-        json["Uptime"] = ((RtcTimeModule*) module)->getUptimeString();
-      });
-      handleCommandResults( cmd, args, json.as<String>() );
-      return true;
-    }
-    // ==========================================
-    // Get firmware version
-    CASE( "version" ): {
-      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-      json["Codename"] = Config::PROJECT_NAME;
-      json["Version"] = Utils::getSystemVersionName();
-      handleCommandResults( cmd, args, json.as<String>() );
-      return true;
-    }
-    // ==========================================
-    // Get wifi info
-    CASE( "wifiinfo" ): {
-      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-      json["SSID"] = WiFi.SSID();
-      json["BSSID"] = WiFi.BSSIDstr();
-      json["Channel"] = WiFi.channel();
-      json["RSSI"] = Utils::getWifiRssiAsQuality( WiFi.RSSI() );
-      handleCommandResults( cmd, args, json.as<String>() );
-      return true;
-    }
-    // ==========================================
-    // Unknown command
-    DEFAULT_CASE:
-      return false;
-  }
+  return dispatchCommandTable<COMMAND_TABLE(CoreModule, COMMANDS)>( *this, cmd, args );
 }
 
 ResultData CoreModule::handleOption( const String& key, const String& value, Options::Action action ) {
@@ -368,8 +262,8 @@ ResultData CoreModule::handleOption( const String& key, const String& value, Opt
   }
 }
 
-void CoreModule::resolveTemplateKey( const String& key, String& out ) {
-  SWITCH( key.c_str() ) {
+void CoreModule::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     // ==========================================
     // loglevel
     CASE( "LOG_0" ):
@@ -418,6 +312,117 @@ void CoreModule::resolveTemplateKey( const String& key, String& out ) {
   }
 }
 
+/* Commands */
+
+// Heap memory statistics
+void CoreModule::cmdHeapStat( const Commands::Args& args ) {
+  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  json["HeapSize"] = ESP.getHeapSize();
+  json["Free"]     = ESP.getFreeHeap();
+  json["Lowest"]   = ESP.getMinFreeHeap();
+  json["MaxBlock"] = ESP.getMaxAllocHeap();
+  const Scratch::Stats scratch = Scratch::getStats();
+  json["Scratch"]     = scratch.size;
+  json["ScratchPeak"] = scratch.highWater;
+  json["ScratchMiss"] = scratch.fallbacks;
+  handleCommandResults( args.cmd, args.raw, json.as<String>() );
+}
+
+// Return the list (JSON array) of active modules.
+void CoreModule::cmdModules( const Commands::Args& args ) {
+  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  JsonArray array = json.createNestedArray( "modules" );
+  Modules.iterator( [&array](Module* module) {
+    array.add( module->getId() );
+  });
+  handleCommandResults( args.cmd, args.raw, json.as<String>() );
+}
+
+// Get network info
+void CoreModule::cmdNetInfo( const Commands::Args& args ) {
+  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  json["LocalIP"] = WiFi.localIP().toString();
+  json["SubnetMask"] = WiFi.subnetMask().toString();
+  json["GatewayIP"] = WiFi.gatewayIP().toString();
+  json["DnsIP"] = WiFi.dnsIP().toString();
+  json["Mac"] = WiFi.macAddress();
+  handleCommandResults( args.cmd, args.raw, json.as<String>() );
+}
+
+// Commands to manage persistent options (NVS) stored in non-volatile RAM.
+// nvs clear - Used to erase ALL persistent options. You must reconfigure the device afterwards.
+//             Warning!! There is no extra confirmations for console commands, so the options will be erased immediately.
+void CoreModule::cmdNvs( const Commands::Args& args ) {
+  Options::clear();
+  performPendingRestart();
+}
+
+// NVS statistics
+void CoreModule::cmdNvsStat( const Commands::Args& args ) {
+  nvs_stats_t nvs_stats;
+  nvs_get_stats( NULL, &nvs_stats );
+  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  json["Used"] = nvs_stats.used_entries;
+  json["Free"] = nvs_stats.free_entries;
+  handleCommandResults( args.cmd, args.raw, json.as<String>() );
+}
+
+// Get sleep and cpu load info
+void CoreModule::cmdPowerInfo( const Commands::Args& args ) {
+  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  json["SleepMode"] = fromSleepMode( Options::getSleepMode() );
+  json["SleepTime"] = Options::getSleepTime();
+  json["LoadAvg"] = State.cpuLoadValue();
+  json["WiFiSleep"] = WiFi.getSleep();
+  handleCommandResults( args.cmd, args.raw, json.as<String>() );
+}
+
+// Get some debug/diagnostic info
+void CoreModule::cmdResetInfo( const Commands::Args& args ) {
+  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  json["RestartReason"] = Utils::getResetReason();
+  handleCommandResults( args.cmd, args.raw, json.as<String>() );
+}
+
+// System restart
+void CoreModule::cmdRestart( const Commands::Args& args ) {
+  handleCommandResults( args.cmd, args.raw, Messages::OK );
+  performPendingRestart();
+}
+
+// Get the telemetry info
+void CoreModule::cmdTelemetry( const Commands::Args& args ) {
+  handleCommandResults( args.cmd, args.raw, prepareTelemetry() );
+}
+
+// Get system time and uptime info
+void CoreModule::cmdTimeInfo( const Commands::Args& args ) {
+  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  Modules.execute( RTC_MODULE, [&json](Module* module) {
+    json["Local"] = ((RtcTimeModule*) module)->getLocalTimeString();
+    json["Uptime"] = ((RtcTimeModule*) module)->getUptimeString();
+  });
+  handleCommandResults( args.cmd, args.raw, json.as<String>() );
+}
+
+// Get firmware version
+void CoreModule::cmdVersion( const Commands::Args& args ) {
+  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  json["Codename"] = Config::PROJECT_NAME;
+  json["Version"] = Utils::getSystemVersionName();
+  handleCommandResults( args.cmd, args.raw, json.as<String>() );
+}
+
+// Get wifi info
+void CoreModule::cmdWifiInfo( const Commands::Args& args ) {
+  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  json["SSID"] = WiFi.SSID();
+  json["BSSID"] = WiFi.BSSIDstr();
+  json["Channel"] = WiFi.channel();
+  json["RSSI"] = Utils::getWifiRssiAsQuality( WiFi.RSSI() );
+  handleCommandResults( args.cmd, args.raw, json.as<String>() );
+}
+
 /* Private */
 
 ResultData CoreModule::applyExtraOptions( const String& options ) {
@@ -425,7 +430,9 @@ ResultData CoreModule::applyExtraOptions( const String& options ) {
     DynamicJsonDocument doc( Config::JSON_CONFIG_SIZE );
     DeserializationError rc = deserializeJson( doc, options );
     if( rc != DeserializationError::Ok ) {
-      return {RC_ERROR, Utils::format( Messages::JSON_DECODE_ERROR, rc.c_str() )};
+      ResultData result = {RC_ERROR};
+      Format::append( result.details, Messages::JSON_DECODE_ERROR, rc.c_str() );
+      return result;
     }
 
     JsonObject json = doc.as<JsonObject>();
@@ -481,10 +488,8 @@ String CoreModule::prepareManageModulesHTML() {
   for( uint8_t i = 0; i < count; i++ ) {
     const char* id = CUSTOM_MODULE_IDS[i];
     const char* name = CUSTOM_MODULE_NAMES[i];
-    char buffer[500];
     const char* checked = getByteOption( id ) ? "checked" : "";
-    snprintf( buffer, sizeof(buffer), MODULE_SWITCH_HTML, id, id, checked, id, name );
-    result += buffer;
+    Format::append( result, MODULE_SWITCH_HTML, id, id, checked, id, name );
   }
   return result;
 }
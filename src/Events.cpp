@@ -5,6 +5,17 @@
 Dexode::EventBus Bus;
 GlobalState State;
 
+/*******************************************************************************/
+/* StatusChangedEvent */
+
+const String& StatusChangedEvent::getPayload() const {
+  if( text ) return *text;
+  if( serialized.length() == 0 ) {
+    serialized = module->serializeStatus( data );
+  }
+  return serialized;
+}
+
 /*******************************************************************************/
 /* GlobalState */
 
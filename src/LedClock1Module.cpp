@@ -1,5 +1,9 @@
+#include <soc/gpio_struct.h>
 #include "LedClock1Module.h"
 #include "Events.h"
+#include "str_switch.h"
+
+LedClock1Module* LedClock1Module::instance = nullptr;
 
 /* Public */
 
@@ -30,44 +34,82 @@ LedClock1Module::LedClock1Module() {
   displayBuffer[3] = DIGIT_DASH;
   //showDots = true;
 
-  ticker.attach_ms( REFRESH_RATE, ticker_callback, this );
-
-  eventBusToken = Bus.listen<StatusChangedEvent>( [this](const StatusChangedEvent& event) {
-    if( strcmp( event.module->getId(), RTC_MODULE ) == 0 ) {      
-      String datetime = event.payload;
-      int i = datetime.indexOf( 'T' );
-      displayBuffer[0] = digitToSymbol(datetime.charAt(i + 1));
-      displayBuffer[1] = digitToSymbol(datetime.charAt(i + 2));
-      displayBuffer[2] = digitToSymbol(datetime.charAt(i + 4));
-      displayBuffer[3] = digitToSymbol(datetime.charAt(i + 5));
-    }
+  digitsOffMask[0] = digitsOffMask[1] = 0;
+  for( uint8_t i = 0; i < 4; i++ ) {
+    addPin( digitsOffMask, DIGIT_TO_PIN[i] );
+  }
+  setBrightness( getLongOption( BRIGHTNESS_OPTION_KEY, 0xFFFFFFFF ));
+
+  // The multiplexing timer.
+  instance = this;
+  timer = timerBegin( TIMER_NUMBER, TIMER_DIVIDER, true );
+  timerAttachInterrupt( timer, onTimer, true );
+  timerAlarmWrite( timer, TICK_US, true );
+  timerAlarmEnable( timer );
+
+  eventBusToken = Bus.listen<StatusChangedEvent>( EventFilter::of( RTC_MODULE, StatusData::TYPE_TIME ), [this](const StatusChangedEvent& event) {
+    displayBuffer[0] = event.data.time.hour / 10;
+    displayBuffer[1] = event.data.time.hour % 10;
+    displayBuffer[2] = event.data.time.minute / 10;
+    displayBuffer[3] = event.data.time.minute % 10;
+    rebuildFrame();
   });
 }
 
 void LedClock1Module::tick_100mS( uint8_t phase ) {
   if( phase == 0 ) {
     showDots = !showDots;
+    rebuildFrame();
   }
 }
-char LedClock1Module::digitToSymbol( unsigned char digit ){
-  
-  if( digit >= 48 && digit <= 57 ) {
-    return digit - 48;
-  } else if(digit == '-'){
-    return 10;
-  } else {
-    return 11;
-  }
-};
-
 
 LedClock1Module::~LedClock1Module() {
   Bus.unlisten<StatusChangedEvent>( eventBusToken );
-  ticker.detach();
+  timerAlarmDisable( timer );
+  timerDetachInterrupt( timer );
+  timerEnd( timer );
+  instance = nullptr;
+  clearDisplay();
+}
+
+/* Protected */
+
+ResultData LedClock1Module::handleOption( const String& key, const String& value, Options::Action action ) {
+  SWITCH( key.c_str() ) {
+    // ==========================================
+    // Digits brightness, 0..255. A single value for all digits or 4 comma separated values.
+    CASE( "bright" ): {
+      if( action != Options::READ ) {
+        unsigned int v[4];
+        const int n = sscanf( value.c_str(), "%u,%u,%u,%u", &v[0], &v[1], &v[2], &v[3] );
+        if( n != 1 && n != 4 ) return INVALID_VALUE;
+        uint32_t packed = 0;
+        for( uint8_t i = 0; i < 4; i++ ) {
+          const unsigned int b = v[n == 1 ? 0 : i];
+          if( b > 255 ) return INVALID_VALUE;
+          packed |= b << (i * 8);
+        }
+        if( action == Options::SAVE ) {
+          setLongOption( BRIGHTNESS_OPTION_KEY, packed );
+          setBrightness( packed );
+        }
+      }
+      char buf[20];
+      snprintf( buf, sizeof(buf), "%u,%u,%u,%u", brightness[0], brightness[1], brightness[2], brightness[3] );
+      return {RC_OK, buf};
+    }
+    // ==========================================
+    DEFAULT_CASE:
+      return UNKNOWN_OPTION;
+  }
 }
 
 /* Private */
 
+void LedClock1Module::addPin( uint32_t* masks, uint8_t pin ) {
+  masks[pin >> 5] |= 1UL << (pin & 31);
+}
+
 void LedClock1Module::clearDisplay() {
   digitalWrite( DIGIT_1_PIN, HIGH );
   digitalWrite( DIGIT_2_PIN, HIGH );
@@ -75,15 +117,7 @@ void LedClock1Module::clearDisplay() {
   digitalWrite( DIGIT_4_PIN, HIGH );
 }
 
-void LedClock1Module::showNextSymbol() {
-  showSymbol( displayBuffer[currentPosition], currentPosition );
-
-  if( ++currentPosition > 3 ) {
-    currentPosition = 0;
-  }
-}
-
-void LedClock1Module::showSymbol( uint8_t symbol, uint8_t position ) {
+uint8_t LedClock1Module::getSymbolBitset( uint8_t symbol, uint8_t position ) {
   // The used pcb doesn't have a led on the F segment.
   // Practically it means it could display only digits 1, 2, 3 and 7
   if( position == 0 ) {
@@ -102,16 +136,65 @@ void LedClock1Module::showSymbol( uint8_t symbol, uint8_t position ) {
       (position == 2 && showDots) ) {
     bitset &= 0b11111110;
   }
+  return bitset;
+}
+
+/**
+ * Convert the display buffer into GPIO masks. The set masks turn off all digits and unused
+ * segments, the clear masks turn on used segments and the digit itself. The new frame is
+ * built in the inactive buffer, the ISR switches to it at the next digit slot.
+ */
+void LedClock1Module::rebuildFrame() {
+  DigitMasks* frame = frames[activeFrame ^ 1];
+  for( uint8_t position = 0; position < 4; position++ ) {
+    DigitMasks& d = frame[position];
+    d.set[0] = digitsOffMask[0];
+    d.set[1] = digitsOffMask[1];
+    d.clear[0] = d.clear[1] = 0;
+    d.litTicks = (brightness[position] * SLOT_TICKS + 127) / 255;
+
+    const uint8_t bitset = getSymbolBitset( displayBuffer[position], position );
+    uint8_t mask = 0b10000000;
+    for( uint8_t i = 0; i < 8; i++, mask >>= 1 ) {
+      addPin( (bitset & mask) ? d.set : d.clear, BIT_TO_PIN[i] );
+    }
+    if( d.litTicks > 0 ) {
+      d.set[DIGIT_TO_PIN[position] >> 5] &= ~(1UL << (DIGIT_TO_PIN[position] & 31));
+      addPin( d.clear, DIGIT_TO_PIN[position] );
+    }
+  }
+  activeFrame ^= 1;
+}
 
-  uint8_t i = 0;
-  uint8_t mask = 0b10000000;
-  do {
-    bool bit = bitset & mask;
-    digitalWrite( BIT_TO_PIN[i], bit );
-    mask = mask >> 1;
-  } while( ++i < 8 );
+void LedClock1Module::setBrightness( uint32_t packed ) {
+  for( uint8_t i = 0; i < 4; i++ ) {
+    brightness[i] = packed >> (i * 8);
+  }
+  rebuildFrame();
+}
 
-  for( i = 0; i < 4; i++ ) {
-    digitalWrite( DIGIT_TO_PIN[i], position == i ? LOW : HIGH );
+/**
+ * The timer ISR, called every TICK_US. At the start of a digit slot it switches all digits off,
+ * outputs the digit segments and turns the digit on, with two register writes per GPIO bank.
+ * The digit is turned off again after its brightness number of ticks.
+ */
+void IRAM_ATTR LedClock1Module::onTimer() {
+  LedClock1Module* const m = instance;
+  if( !m ) return;
+  if( m->tick == 0 ) {
+    const DigitMasks& d = m->frames[m->activeFrame][m->position];
+    GPIO.out_w1ts = d.set[0];
+    GPIO.out1_w1ts.val = d.set[1];
+    GPIO.out_w1tc = d.clear[0];
+    GPIO.out1_w1tc.val = d.clear[1];
+    m->litTicks = d.litTicks;
   }
-}
\ No newline at end of file
+  if( m->tick == m->litTicks ) {
+    GPIO.out_w1ts = m->digitsOffMask[0];
+    GPIO.out1_w1ts.val = m->digitsOffMask[1];
+  }
+  if( ++m->tick == SLOT_TICKS ) {
+    m->tick = 0;
+    m->position = (m->position + 1) & 3;
+  }
+}
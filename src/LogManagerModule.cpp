@@ -3,6 +3,8 @@
 #include "LogManagerModule.h"
 #include "Options.h"
 
+int LogManagerModule::level = LOG_LEVEL_SILENT;
+
 /* Public */
 
 LogManagerModule::LogManagerModule() {
@@ -13,7 +15,8 @@ LogManagerModule::LogManagerModule() {
     buffer.push_front( new BufferLine() );
   }
   // Init Arduino-Log library with log level and log output.
-  Log.begin( getByteOption( "LeveL", Config::LOG_LEVEL ), this );
+  level = getByteOption( "LeveL", Config::LOG_LEVEL );
+  Log.begin( level, this );
 }
 
 
@@ -34,29 +37,28 @@ void LogManagerModule::tick_100mS( uint8_t phase ) {
 }
 
 size_t LogManagerModule::write( uint8_t symbol ) {
-  if( symbol != '\r' && symbol != '\0' ) {      // ignore these symbols
-    if( symbol == '\n' ) {
-      newline = true;
-      modified = true;
-    } else {
-      if( newline ) {
-        // A new line should be started at front.
-        newline = false;
-        BufferLine* line = buffer.back();
-        buffer.pop_back();
-        line->set( symbol );
-        buffer.push_front( line );
-      } else {
-        // Continue to fill the front line.
-        BufferLine* line = buffer.front();
-        line->append( symbol );
-      }
-    }
+  if( store( symbol )) {
     Serial.print( (char)symbol );
   }
   return 1;
 }
 
+/**
+ * Bulk write, e.g. from Format::to(). The lines are filled char by char, the serial port
+ * gets the runs of stored chars, so it prints the same as the single char write.
+ */
+size_t LogManagerModule::write( const uint8_t* data, size_t size ) {
+  size_t start = 0;
+  for( size_t i = 0; i < size; i++ ) {
+    if( !store( data[i] )) {
+      if( i > start ) Serial.write( data + start, i - start );
+      start = i + 1;
+    }
+  }
+  if( size > start ) Serial.write( data + start, size - start );
+  return size;
+}
+
 String LogManagerModule::getLogString() {
   // Calc the total length of log lines.
   int total = 0, size = buffer.size();
@@ -83,5 +85,36 @@ String LogManagerModule::getLogString() {
 }
 
 void LogManagerModule::setLogLevel( int level ) {
+  LogManagerModule::level = level;
   Log.begin( level, this );
-}
\ No newline at end of file
+}
+
+/* Private */
+
+/**
+ * Puts a char into the log lines.
+ * @return false if the char is ignored.
+ */
+bool LogManagerModule::store( uint8_t symbol ) {
+  if( symbol != '\r' && symbol != '\0' ) {      // ignore these symbols
+    if( symbol == '\n' ) {
+      newline = true;
+      modified = true;
+    } else {
+      if( newline ) {
+        // A new line should be started at front.
+        newline = false;
+        BufferLine* line = buffer.back();
+        buffer.pop_back();
+        line->set( symbol );
+        buffer.push_front( line );
+      } else {
+        // Continue to fill the front line.
+        BufferLine* line = buffer.front();
+        line->append( symbol );
+      }
+    }
+    return true;
+  }
+  return false;
+}
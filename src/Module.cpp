@@ -5,6 +5,9 @@
 #include "Module.h"
 #include "str_switch.h"
 #include "Utils.h"
+#include "core/Format.h"
+#include "core/ScratchArena.h"
+#include "core/Tokenizer.h"
 
 const String Module::getModuleWebpage() {
   return makeWebpage( "/module_project.html" );
@@ -35,8 +38,8 @@ void Module::setByte( const String& key, const uint8_t value ) {
   }
 }
 
-ResultData Module::setString( const String& key, const String& value ) {
-  SWITCH( key.c_str() ) {
+ResultData Module::setString( const StringView& key, const String& value ) {
+  SWITCH( key ) {
     CASE( Config::KEY_IMPORT_CONFIGURATION ):
       return RESULT_OK;
     DEFAULT_CASE:
@@ -44,21 +47,58 @@ ResultData Module::setString( const String& key, const String& value ) {
   }
 }
 
+/**
+ * Default conversion of the typed status data to JSON. Modules override it when the
+ * status text needs module data which isn't a part of StatusData.
+ */
+const String Module::serializeStatus( const StatusData& data ) {
+  switch( data.type ) {
+    case StatusData::TYPE_TIME: {
+      // "2017-03-07T11:08:02" - ISO8601:2004
+      char dt[20];
+      snprintf( dt, sizeof(dt), "%04u-%02u-%02uT%02u:%02u:%02u",
+        data.time.year, data.time.month, data.time.day, data.time.hour, data.time.minute, data.time.second );
+      return dt;
+    }
+    case StatusData::TYPE_RELAYS: {
+      // 64-bit integers aren't enabled in ArduinoJson, so the mask is a hex string.
+      char mask[19];
+      Format::to( mask, "0x%08lX%08lX", (unsigned long) (data.relays.mask >> 32), (unsigned long) data.relays.mask );
+      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+      json["mask"] = mask;
+      return json.as<String>();
+    }
+    case StatusData::TYPE_SENSOR: {
+      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+      for( uint8_t i = 0; i < data.sensor.count; i++ ) {
+        json[data.sensor.names[i]] = String( data.sensor.values[i] );
+      }
+      return json.as<String>();
+    }
+    default:
+      return "";
+  }
+}
+
 /**
  * Try to execute the command on module using the virtual handleCommand() method.
  * @return true if command was handled, no matters successfully or not, and no other actions are needed.
  *         false if the handleCommand() method wasn't processed it.
  */
-bool Module::dispatchCommand( const String& command ) {
-  auto pair = Utils::split( command );
-  bool handled = handleCommand( pair.first, pair.second );
+bool Module::dispatchCommand( const StringView& command ) {
+  Scratch::Scope scratch;
+  const auto tokens = Tokenizer::split( command );
+  // Command handlers take Strings, these are the only copies made on the command path.
+  const String cmd = tokens.first;
+  const String args = tokens.second;
+  bool handled = handleCommand( cmd, args );
   if( !handled ) {
     // Try to handle the command as module settings update using the virtual handleOption() method.
-    // The '' is a special case meaning an empty string.
-    auto action = pair.second.length() > 0 ? Options::SAVE : Options::READ;
-    if( pair.second == "''" )  pair.second = "";
-    ResultData result = handleOption( pair.first, pair.second, action );
-    handleCommandResults( pair.first, pair.second, result.details );
+    // A quoted value is unquoted, so '' is an empty string.
+    auto action = args.length() > 0 ? Options::SAVE : Options::READ;
+    const String value = Tokenizer::unquote( tokens.second );
+    ResultData result = handleOption( cmd, value, action );
+    handleCommandResults( cmd, value, result.details );
     handled = result.code == RC_OK;
   }
   return handled;
@@ -146,7 +186,9 @@ ResultData Module::handleConfigImport( const String& data ) {
   StaticJsonDocument<Config::JSON_CONFIG_SIZE> doc;
   DeserializationError rc = deserializeJson( doc, data );
   if( rc != DeserializationError::Ok ) {
-    return {RC_ERROR, Utils::format( Messages::JSON_DECODE_ERROR, rc.c_str() )};
+    ResultData result = {RC_ERROR};
+    Format::append( result.details, Messages::JSON_DECODE_ERROR, rc.c_str() );
+    return result;
   } else {
     JsonObject json = doc.as<JsonObject>();
     for( JsonPair p : json ) {
@@ -175,7 +217,8 @@ String Module::makeWebpage( const char* fpath ) {
     file.close();
 
     // Resolve template parameters.
-    String key;
+    char key[Config::MAX_STRING_KEY_SIZE];
+    size_t key_len = 0;
     String out;
     out.reserve( fsize + fsize * 10 / 100 );    // file size + 10%
 
@@ -185,11 +228,11 @@ String Module::makeWebpage( const char* fpath ) {
       char c = *content++;
       if( have_key ) {
         if( c == '%' ) {
-          resolveTemplateKey( key, out );
+          resolveTemplateKey( StringView( key, key_len ), out );
           have_key = false;
-          key = "";
-        } else if( key.length() < 9 ) {     // SWITCH macro requires 9 chars max
-          key += c;
+          key_len = 0;
+        } else if( key_len < sizeof(key) ) {     // SWITCH macro requires 9 chars max
+          key[key_len++] = c;
         }
       } else {
         if( c == '%' ) {
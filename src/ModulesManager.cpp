@@ -11,6 +11,7 @@
 #include "Utils.h"
 #include "WebServerModule.h"
 #include "WifiModule.h"
+#include "core/Tokenizer.h"
 
 #ifdef USE_AM312_MODULE
   #include "AM312Module.h"
@@ -73,15 +74,15 @@ void ModulesManager::add( std::initializer_list<String> moduleIds ) {
   }
 }
 
-void ModulesManager::dispatchCommand( const String& command ) {
+void ModulesManager::dispatchCommand( const StringView& command ) {
   // Try to find the module which ID equals to key.
-  auto pair = Utils::split( command );
+  const auto tokens = Tokenizer::split( command );
   const int count = Modules.count();
   for( int i = 0; i < count; i++ ) {
     Module* module = Modules.get( i );
-    if( strcmp( pair.first.c_str(), module->getId() ) == 0 ) {
+    if( tokens.first == module->getId() ) {
       // Module found, forward command to the module.
-      module->dispatchCommand( pair.second );
+      module->dispatchCommand( tokens.second );
       return;
     }
   }
@@ -1,6 +1,7 @@
 #include <ArduinoLog.h>
 #include "Config.h"
 #include "Events.h"
+#include "LogManagerModule.h"
 #include "ModulesManager.h"
 #include "MqttClientModule.h"
 #include "Messages.h"
@@ -22,19 +23,10 @@ MqttClientModule::MqttClientModule() {
   // Initialize MQTT client
   mg_mgr_init( &manager, NULL );
   // Subscribe to event bus connectivity events.
-  eventBusToken = Bus.listen<ConnectivityEvent>( [this](const ConnectivityEvent& event) {
-    switch( event.type ) {
-      case ConnectivityEvent::TYPE_WIFI:
-        if( event.connected ) {
-          if( !flags.initial_start ) {
-            flags.initial_start = true;
-            reconnect();
-          }
-        }
-        break;
-
-      default:
-        break;
+  eventBusToken = Bus.listen<ConnectivityEvent>( EventFilter::of( ConnectivityEvent::TYPE_WIFI ), [this](const ConnectivityEvent& event) {
+    if( event.connected && !flags.initial_start ) {
+      flags.initial_start = true;
+      reconnect();
     }
   });
 
@@ -82,8 +74,8 @@ const String MqttClientModule::getStatusWebpage() {
 
 /* A generic getData/setData interface */
 
-const String MqttClientModule::getString( const String& key ) {
-  SWITCH( key.c_str() ) {
+const String MqttClientModule::getString( const StringView& key ) {
+  SWITCH( key ) {
     CASE( Config::KEY_EXPORT_CONFIGURATION ): {
       DynamicJsonDocument json( Config::JSON_MESSAGE_SIZE );
       json["clientid"]  = getStringOption( "ClientId", Config::MQTT_CLIENT_ID );
@@ -106,8 +98,8 @@ const String MqttClientModule::getString( const String& key ) {
   }
 }
 
-ResultData MqttClientModule::setString( const String& key, const String& value ) {
-  SWITCH( key.c_str() ) {
+ResultData MqttClientModule::setString( const StringView& key, const String& value ) {
+  SWITCH( key ) {
     CASE( Config::KEY_IMPORT_CONFIGURATION ):
       return handleConfigImport( value );
     DEFAULT_CASE:
@@ -117,14 +109,14 @@ ResultData MqttClientModule::setString( const String& key, const String& value )
 
 /* Public non-virtual methods */
 
-void MqttClientModule::publish( TopicPrefix prefix, const String& subtopic, const JsonDocument& json ) {
+void MqttClientModule::publish( TopicPrefix prefix, const StringView& subtopic, const JsonDocument& json ) {
   String topic = buildTopicName( prefix, getStringOption("Topic", Config::MQTT_DEVICE_TOPIC), subtopic );
   String data;
   serializeJson( json, data );
   publish( topic, data, false );
 }
 
-void MqttClientModule::publish( TopicPrefix prefix, const String& subtopic, const String& data ) {
+void MqttClientModule::publish( TopicPrefix prefix, const StringView& subtopic, const StringView& data ) {
   // char data[JSON_MESSAGE_SIZE];
   // va_list arglist;
   // va_start( arglist, format );
@@ -135,16 +127,16 @@ void MqttClientModule::publish( TopicPrefix prefix, const String& subtopic, cons
   publish( topic, data, false );
 }
 
-void MqttClientModule::publish( const String& topic, const String& data, boolean retained ) {
+void MqttClientModule::publish( const String& topic, const StringView& data, boolean retained ) {
   // Explanation of MQTT QoS
   // https://stackoverflow.com/questions/14037302/mqtt-how-to-know-which-msg-a-puback-is-for
   if( connectionState == CONNECTED ) {
     int msg_flags = MG_MQTT_QOS(0);
     if( retained ) msg_flags |= MG_MQTT_RETAIN;
-    mg_mqtt_publish( connection, topic.c_str(), ++messageId, msg_flags, data.c_str(), data.length() );
-    Log.verbose( "MQTT %s %s%s" CR, topic.c_str(), data.c_str(), (retained) ? " (retained)" : "" );
+    mg_mqtt_publish( connection, topic.c_str(), ++messageId, msg_flags, data.data(), data.length() );
+    logPublish( topic, data, retained ? " (retained)" : "" );
   } else {
-    Log.verbose( "MQTT %s %s (not connected)" CR, topic.c_str(), data.c_str() );
+    logPublish( topic, data, " (not connected)" );
   }
 }
 
@@ -168,30 +160,15 @@ void MqttClientModule::reconnect() {
 
 /* Protected */
 
+constexpr Commands::Entry<MqttClientModule> MqttClientModule::COMMANDS[] = {
+  { "debug",     Commands::number( 0, 1, true ), &MqttClientModule::cmdDebug,     "Enable or disable the debug log" },
+  { "reconnect", Commands::none(),               &MqttClientModule::cmdReconnect, "Reconnect to the broker" },
+};
+
+// TODO "send" command to publish the payload via MQTT
+// the payload should be in format <prefix> <data> or <prefix>/<data>
 bool MqttClientModule::handleCommand( const String& cmd, const String& args ) {
-  SWITCH( cmd.c_str() ) {
-    // ==========================================
-    // Enable or disable the module debug logging.
-    // Value: integer - enable or disable the debug log [0..1]
-    CASE( "debug" ):
-      if( args.length() > 0 ) {
-        setDebugLog( Utils::toBool( args.c_str() ));
-      }
-      handleCommandResults( cmd, args, String( getDebugLog() ));
-      return true;
-    // ==========================================
-    CASE( "reconnect" ):
-      reconnect();
-      handleCommandResults( cmd, args, Messages::OK );
-      return true;
-    // ==========================================
-    // TODO "send" command to publish the payload via MQTT
-    // the payload should be in format <prefix> <data> or <prefix>/<data>
-    // ==========================================
-    // Unknown command
-    DEFAULT_CASE:
-      return false;
-  }
+  return dispatchCommandTable<COMMAND_TABLE(MqttClientModule, COMMANDS)>( *this, cmd, args );
 }
 
 ResultData MqttClientModule::handleOption( const String& key, const String& value, Options::Action action ) {
@@ -248,8 +225,8 @@ ResultData MqttClientModule::handleOption( const String& key, const String& valu
   }
 }
 
-void MqttClientModule::resolveTemplateKey( const String& key, String& out ) {
-  SWITCH( key.c_str() ) {
+void MqttClientModule::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     // ==========================================
     // Module template parameters
     CASE( "MQ_TCLID" ):    out += getStringOption( "ClientId", Config::MQTT_CLIENT_ID );       break;
@@ -278,6 +255,21 @@ void MqttClientModule::resolveTemplateKey( const String& key, String& out ) {
   }
 }
 
+/* Commands */
+
+// Enable or disable the module debug logging, returns the actual value.
+void MqttClientModule::cmdDebug( const Commands::Args& args ) {
+  if( args.present ) {
+    setDebugLog( args.number );
+  }
+  handleCommandResults( args.cmd, args.raw, String( getDebugLog() ));
+}
+
+void MqttClientModule::cmdReconnect( const Commands::Args& args ) {
+  reconnect();
+  handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
 /* Private methods */
 
 /**
@@ -289,7 +281,7 @@ void MqttClientModule::resolveTemplateKey( const String& key, String& out ) {
  * @param topic The topic name.
  * @param subtopic The sub-topic name.
  */
-String MqttClientModule::buildTopicName( TopicPrefix prefix, const String& topic, const String& subtopic ) {
+String MqttClientModule::buildTopicName( TopicPrefix prefix, const String& topic, const StringView& subtopic ) {
   String fulltopic = getStringOption( "FullTopic", Config::MQTT_FULL_TOPIC );
   fulltopic.replace( "#PREFIX", toString( prefix ));
   fulltopic.replace( "#TOPIC", topic );
@@ -299,10 +291,21 @@ String MqttClientModule::buildTopicName( TopicPrefix prefix, const String& topic
   if( !fulltopic.endsWith( "/" )) {
     fulltopic += "/";
   }
-  fulltopic += subtopic;
+  fulltopic += subtopic.toString();
   return fulltopic;
 }
 
+/**
+ * The data isn't NUL-terminated, so the log gets a truncated copy. It's made only when
+ * the verbose messages are printed, publishing doesn't pay for it otherwise.
+ */
+void MqttClientModule::logPublish( const String& topic, const StringView& data, const char* suffix ) {
+  if( LogManagerModule::isLogged( LOG_LEVEL_VERBOSE )) {
+    const InlineString<Config::JSON_MESSAGE_SIZE> text( data );
+    Log.verbose( "MQTT %s %s%s" CR, topic.c_str(), text.c_str(), suffix );
+  }
+}
+
 void MqttClientModule::mqttEventsHandler( struct mg_connection* nc, int ev, void* p ) {
   if( ev == MG_EV_CONNECT ) {
     int code = *(int*) p;
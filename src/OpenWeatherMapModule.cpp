@@ -2,6 +2,8 @@
 #include "OpenWeatherMapModule.h"
 #include "str_switch.h"
 #include "Utils.h"
+#include "core/Format.h"
+#include "core/ScratchArena.h"
 
 OpenWeatherMapModule* OpenWeatherMapModule::INSTANCE = nullptr;
 
@@ -47,17 +49,12 @@ const String OpenWeatherMapModule::getStatusWebpage() {
 
 /* Protected */
 
+constexpr Commands::Entry<OpenWeatherMapModule> OpenWeatherMapModule::COMMANDS[] = {
+  { "update", Commands::none(), &OpenWeatherMapModule::cmdUpdate, "Update the weather now" },
+};
+
 bool OpenWeatherMapModule::handleCommand( const String& cmd, const String& args ) {
-  SWITCH( cmd.c_str() ) {
-    // ==========================================
-    CASE( "update" ):
-      updateWeather();
-      handleCommandResults( cmd, args, Messages::OK );
-      return true;
-    // Unknown command
-    DEFAULT_CASE:
-      return false;
-  }
+  return dispatchCommandTable<COMMAND_TABLE(OpenWeatherMapModule, COMMANDS)>( *this, cmd, args );
 }
 
 ResultData OpenWeatherMapModule::handleOption( const String& key, const String& value, Options::Action action ) {
@@ -105,8 +102,8 @@ ResultData OpenWeatherMapModule::handleOption( const String& key, const String&
   }
 }
 
-void OpenWeatherMapModule::resolveTemplateKey( const String& key, String& out ) {
-  SWITCH( key.c_str() ) {
+void OpenWeatherMapModule::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     // ==========================================
     // Module template parameters
     CASE( "MTITLE" ):    out += Utils::formatModuleSettingsTitle( getId(), getName() );   break;
@@ -169,6 +166,13 @@ void OpenWeatherMapModule::resolveTemplateKey( const String& key, String& out )
   }
 }
 
+/* Commands */
+
+void OpenWeatherMapModule::cmdUpdate( const Commands::Args& args ) {
+  updateWeather();
+  handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
 /* Private */
 
 String OpenWeatherMapModule::formatTemperature( float value ) {
@@ -227,11 +231,12 @@ void OpenWeatherMapModule::httpEventHandler( mg_connection* nc, int ev, void* ev
     case MG_EV_HTTP_REPLY: {
       http_message* hm = static_cast<http_message*>(ev_data);
 
-      DynamicJsonDocument doc( hm->body.len * 2 );
+      ScratchJsonDocument doc( hm->body.len * 2 );
       DeserializationError rc = deserializeJson( doc, hm->body.p, hm->body.len );
       if( rc != DeserializationError::Ok ) {
-        auto msg = Utils::format( Messages::JSON_DECODE_ERROR, rc.c_str() );
-        Log.error( "WEA %s" CR, msg.c_str() );
+        char msg[64];
+        Format::to( msg, Messages::JSON_DECODE_ERROR, rc.c_str() );
+        Log.error( "WEA %s" CR, msg );
       } else {
         JsonObject json = doc.as<JsonObject>();
         // Root fields
@@ -294,7 +299,7 @@ void OpenWeatherMapModule::httpEventHandler( mg_connection* nc, int ev, void* ev
       updateWeatherCleanup();
       if( nc->flags & MG_F_USER_1 ) {
         Bus.notify( weatherData );
-        Bus.notify( (StatusChangedEvent) { this,"" });
+        Bus.notify( StatusChangedEvent( this, "" ));
         Log.verbose( "WEA Weather is updated" CR );
       }
       break;
@@ -30,6 +30,22 @@ const String Options::makeKey( const String& moduleId, const String& key ) {
   }
 }
 
+/**
+ * Read a binary blob into the buffer of len bytes.
+ * Returns the number of bytes read, 0 when the stored blob is missed or doesn't fit the buffer.
+ */
+size_t Options::getBlob( const String& moduleId, const String& key, void* buf, size_t len ) {
+  const String k = makeKey( moduleId, key );
+  if( preferences.getBytesLength( k.c_str() ) > len ) {
+    return 0;
+  }
+  return preferences.getBytes( k.c_str(), buf, len );
+}
+
+size_t Options::getBlobLength( const String& moduleId, const String& key ) {
+  return preferences.getBytesLength( makeKey( moduleId, key ).c_str() );
+}
+
 const uint8_t Options::getByte( const String& moduleId, const String& key, uint8_t defValue ) {
   return preferences.getUChar( makeKey(moduleId, key).c_str(), defValue );
 }
@@ -46,6 +62,14 @@ const String Options::getString( const String& moduleId, const String& key, cons
   return preferences.getString( makeKey(moduleId, key).c_str(), value );
 }
 
+void Options::remove( const String& moduleId, const String& key ) {
+  preferences.remove( makeKey( moduleId, key ).c_str() );
+}
+
+void Options::setBlob( const String& moduleId, const String& key, const void* buf, size_t len ) {
+  preferences.putBytes( makeKey(moduleId, key).c_str(), buf, len );
+}
+
 void Options::setByte( const String& moduleId, const String& key, uint8_t value ) {
   preferences.putUChar( makeKey(moduleId, key).c_str(), value );
 }
@@ -1,10 +1,16 @@
 #include <ArduinoJson.h>
+#include <ArduinoLog.h>
 #include "config.h"
 #include "Events.h"
+#include "ModulesManager.h"
 #include "Options.h"
 #include "RelaysModule.h"
+#include "RtcTimeModule.h"
 #include "str_switch.h"
 #include "Utils.h"
+#include "core/Format.h"
+#include "core/ScratchArena.h"
+#include "core/Tokenizer.h"
 
 const RelaysModule::RelayConfig RelaysModule::DEFAULT_CONFIG[] = {
   {Config::RELAY1_PIN, Config::RELAY1_INVERSE_PIN},
@@ -17,6 +23,21 @@ const RelaysModule::RelayConfig RelaysModule::DEFAULT_CONFIG[] = {
   {Config::RELAY8_PIN, Config::RELAY8_INVERSE_PIN},
 };
 
+const uint64_t RelaysModule::ALL_RELAYS;
+
+/**
+ * The document capacity to deserialize the JSON, so small configs fit the scratch arena:
+ * a slot per value (every value but the first one follows a separator or an opening bracket)
+ * and a copy of all the strings.
+ */
+static size_t toJsonCapacity( const String& json, const size_t extra = 0 ) {
+  size_t values = 1;
+  for( const char* p = json.c_str(); *p; p++ ) {
+    if( *p == ',' || *p == '[' || *p == '{' ) values++;
+  }
+  return JSON_ARRAY_SIZE( values ) + json.length() + 1 + extra;
+}
+
 /* Public */
 
 RelaysModule::RelaysModule() {
@@ -26,21 +47,41 @@ RelaysModule::RelaysModule() {
 
   const ResultData rc = buildRelayData( getRelayData() );
   if( rc.code != RC_OK ) {
-    Log.error( "REL %s" CR, rc.details );
+    Log.error( "REL %s" CR, rc.details.c_str() );
     buildRelayData( getDefaultRelayData() );    // Failsafe
   }
+  createBackend();
   initializeHardware();
+  loadSchedules();
 }
 
 RelaysModule::~RelaysModule() {
-  // Do nothing here.
+  delete backend;
+}
+
+/**
+ * Backend options were changed.
+ */
+void RelaysModule::reinitModule() {
+  createBackend();
+  initializeHardware();
 }
 
 void RelaysModule::tick_100mS( uint8_t phase ) {
+  // Schedules are run from the RTC module clock, once a second.
+  if( phase == 0 ) {
+    RtcTimeModule* const rtc = (RtcTimeModule*) Modules.get( RTC_MODULE );
+    bool ran = false;
+    scheduler.tick( rtc ? rtc->getLocalTime() : 0, [this, &ran](const Relays::Schedule& schedule) {
+      runSchedule( schedule );
+      ran = true;
+    });
+    saveScheduleTime( ran );
+  }
   if( pendingStateDelay > 0 ) {
     if( --pendingStateDelay == 0 ) {
-      Bus.notify( (StatusChangedEvent) {this,pendingState} );
-      pendingState = "";
+      Bus.notify( StatusChangedEvent( this, getStatusData( pendingRelay, pendingChanged )));
+      pendingChanged = 0;
     }
   }
 }
@@ -57,21 +98,25 @@ const String RelaysModule::getStatusWebpage() {
 
 // A generic getData/setData interface
 
-const String RelaysModule::getString( const String& key ) {
-  SWITCH( key.c_str() ) {
+const String RelaysModule::getString( const StringView& key ) {
+  SWITCH( key ) {
     // Get the module export config (JSON string)
     // Get the relays data (JSON array string)
     CASE( Config::KEY_EXPORT_CONFIGURATION ):
     CASE( "RelayData" ): {
       return getRelayData();
     }
+    // Get the named relay scenes (JSON object string)
+    CASE( "Scenes" ): {
+      return getScenes();
+    }
     DEFAULT_CASE:
       return Module::getString( key );
   }
 }
 
-ResultData RelaysModule::setString( const String& key, const String& value ) {
-  SWITCH( key.c_str() ) {
+ResultData RelaysModule::setString( const StringView& key, const String& value ) {
+  SWITCH( key ) {
     // Permanently store the new relay config (JSON array string).
     CASE( Config::KEY_IMPORT_CONFIGURATION ):
     CASE( "RelayData" ): {
@@ -84,44 +129,96 @@ ResultData RelaysModule::setString( const String& key, const String& value ) {
       initializeHardware();
       return rc;
     }
+    // Permanently store the named relay scenes (JSON object string).
+    CASE( "Scenes" ): {
+      return saveScenes( value );
+    }
     DEFAULT_CASE:
       return Module::setString( key, value );
   }
 }
 
+/**
+ * The relay state JSON, the same as the relay command results.
+ * Bulk changes are reported with the relays mask, the same as the mask command results.
+ */
+const String RelaysModule::serializeStatus( const StatusData& data ) {
+  if( data.type == StatusData::TYPE_RELAYS && data.relays.index < relaysCount ) {
+    return toJsonString( data.relays.index );
+  }
+  if( data.type == StatusData::TYPE_RELAYS && data.relays.index == StatusData::RELAY_MANY ) {
+    return toMaskJson( data.relays.mask, data.relays.changed );
+  }
+  return Module::serializeStatus( data );
+}
+
 /* Virtual protected */
 
+constexpr Commands::Entry<RelaysModule> RelaysModule::COMMANDS[] = {
+  { "mask",     Commands::text( true ), &RelaysModule::cmdMask,     "Switch relays at once, <value> [<select>]" },
+  { "scene",    Commands::text( true ), &RelaysModule::cmdScene,    "Apply, define or delete a scene, <name> [<value> [<select>]|delete]" },
+  { "schedule", Commands::text( true ), &RelaysModule::cmdSchedule, "List, add or delete schedules, add <relay> <action> <rule>|delete <n>|all" },
+};
+
 bool RelaysModule::handleCommand( const String& cmd, const String& args ) {
-  SWITCH( cmd.c_str() ) {
-    // ==========================================
-    // Handle commands like "relays rel1 toggle"
-    DEFAULT_CASE: {
-      const uint8_t index = toRelayIndex( cmd );
-      if( index >= 0 && index < Config::RELAY_MAX_RELAYS ) {
-        const RelayInfo info = relays[index];
-        if( args.length() > 0 ) {
-          // A command to change the relay state.
-          const uint8_t v = parseRelayPayload( args );
-          switchRelay( index, info, v );
-          // Send the status changed event to the EventBus.
-          // The new relay state (in a JSON format) is provided as the event payload.
-          const String state = toJsonString( index, info );
-          pendingState = state;
-          pendingStateDelay = 7;
-          //Bus.notify( (StatusChangedEvent) {this,state} );
-          const String topic = info.alias.length() > 0 ? info.alias : cmd;
-          handleCommandResults( topic, args, state );
-          return true;
-        } else {
-          // A command to ask, not modify the relay state.
-          const String topic = info.alias.length() > 0 ? info.alias : cmd;
-          handleCommandResults( topic, args, toJsonString( index, info ));
-          return false;
-        }
-      }
-    }
+  if( dispatchCommandTable<COMMAND_TABLE(RelaysModule, COMMANDS)>( *this, cmd, args )) {
+    return true;
+  }
+  // Relay IDs and aliases are configured at runtime, so relay commands like "relays rel1 toggle"
+  // are handled out of the table.
+  const uint8_t index = toRelayIndex( cmd );
+  if( index >= relaysCount ) {
     return false;
   }
+  const RelayInfo& info = relays[index];
+  const String topic = info.alias.length() > 0 ? info.alias : cmd;
+  if( args.length() > 0 ) {
+    // A command to change the relay state.
+    const uint8_t v = parseRelayPayload( args );
+    const uint64_t changed = switchRelay( index, v );
+    postStatusChange( index, changed );
+    handleCommandResults( topic, args, toJsonString( index ));
+    return true;
+  }
+  // A command to ask, not modify the relay state.
+  handleCommandResults( topic, args, toJsonString( index ));
+  return false;
+}
+
+/* Commands */
+
+/**
+ * Switch all relays at once: "relays mask <value> [<select>]", where the value and the
+ * optional select masks are binary (0b1010), hex (0xA) or decimal, bit 0 is rel1.
+ * Only the selected relays are switched, all relays if the select mask is omitted.
+ * "relays mask" without arguments returns the current relays mask.
+ */
+void RelaysModule::cmdMask( const Commands::Args& args ) {
+  Tokenizer tokens( args.raw );
+  StringView value, select;
+  if( !tokens.next( value )) {
+    handleCommandResults( args.cmd, args.raw, toMaskJson( getRelaysMask(), 0 ));
+    return;
+  }
+  uint64_t v = 0, s = ALL_RELAYS;
+  tokens.next( select );
+  if( !parseMask( value, v ) || (!select.isEmpty() && !parseMask( select, s )) || !tokens.atEnd() ) {
+    handleCommandResults( args.cmd, args.raw, Messages::COMMAND_INVALID_VALUE );
+    return;
+  }
+  const uint64_t changed = applyRelays( v, s, true );
+  if( changed != 0 ) postStatusChange( StatusData::RELAY_MANY, changed );
+  handleCommandResults( args.cmd, args.raw, toMaskJson( getRelaysMask(), changed ));
+}
+
+// Named relay scenes, see handleSceneCommand().
+void RelaysModule::cmdScene( const Commands::Args& args ) {
+  handleCommandResults( args.cmd, args.raw, handleSceneCommand( args.raw ));
+}
+
+// Relay schedules, see handleScheduleCommand().
+void RelaysModule::cmdSchedule( const Commands::Args& args ) {
+  handleCommandResults( args.cmd, args.raw, handleScheduleCommand( args.raw ));
 }
 
 /**
@@ -133,9 +230,44 @@ void RelaysModule::handleCommandResults( const String& cmd, const String& args,
 }
 
 /**
+ * The relay outputs hardware options. Unset options are read as their defaults.
  */
-void RelaysModule::resolveTemplateKey( const String& key, String& out ) {
+ResultData RelaysModule::handleOption( const String& key, const String& value, Options::Action action ) {
   SWITCH( key.c_str() ) {
+    // ==========================================
+    // Relay outputs: "gpio", "mcp23017" or "74hc595".
+    CASE( "backend" ):
+      if( action == Options::READ )  return {RC_OK, getBackendOption()};
+      if( !Relays::isValidBackend( value ))  return INVALID_VALUE;
+      return handleStringOption( "Backend", value, action, {NOT_EMPTY, IMPORTANT} );
+    // ==========================================
+    // I2C address of the first MCP23017 chip, 32..39 (0x20..0x27).
+    CASE( "i2caddr" ):
+      if( action == Options::READ )  return {RC_OK, String( getByteOption( "I2cAddr", Config::RELAY_MCP23017_ADDRESS ))};
+      if( value.toInt() < 0x20 || value.toInt() > 0x27 )  return INVALID_VALUE;
+      return handleByteOption( "I2cAddr", value, action, IMPORTANT );
+    // ==========================================
+    // MCP23017 chips on the bus or 74HC595 chips in the chain.
+    CASE( "chips" ):
+      if( action == Options::READ )  return {RC_OK, String( getByteOption( "Chips", 1 ))};
+      if( value.toInt() < 1 || value.toInt() > Relays::MAX_CHANNELS / 8 )  return INVALID_VALUE;
+      return handleByteOption( "Chips", value, action, IMPORTANT );
+    // ==========================================
+    // 74HC595 chain latch pin, the display, touch, SD card and I2C pins are rejected.
+    CASE( "latch" ):
+      if( action == Options::READ )  return {RC_OK, String( getByteOption( "LatchPin", Config::RELAY_HC595_LATCH_PIN ))};
+      if( value.toInt() < 1 || value.toInt() > 33 || !Relays::isValidLatchPin( value.toInt() ))  return INVALID_VALUE;
+      return handleByteOption( "LatchPin", value, action, IMPORTANT );
+    // ==========================================
+    DEFAULT_CASE:
+      return UNKNOWN_OPTION;
+  }
+}
+
+/**
+ */
+void RelaysModule::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     // ==========================================
     // Module template parameters
     CASE( "ID" ):
@@ -145,60 +277,135 @@ void RelaysModule::resolveTemplateKey( const String& key, String& out ) {
       out += Utils::formatModuleSettingsTitle( getId(), getName() );
       break;
     // ==========================================
-    // Relay ID options
-    CASE( "ID1" ):  out += getRelayName( 0 );  break;
-    CASE( "ID2" ):  out += getRelayName( 1 );  break;
-    CASE( "ID3" ):  out += getRelayName( 2 );  break;
-    CASE( "ID4" ):  out += getRelayName( 3 );  break;
-    CASE( "ID5" ):  out += getRelayName( 4 );  break;
-    CASE( "ID6" ):  out += getRelayName( 5 );  break;
-    CASE( "ID7" ):  out += getRelayName( 6 );  break;
-    CASE( "ID8" ):  out += getRelayName( 7 );  break;
+    // Relay buttons, one per configured relay
+    CASE( "RELAYS" ): {
+      const uint64_t mask = getRelaysMask();
+      for( uint8_t i = 0; i < relaysCount; i++ ) {
+        Format::append( out,
+          "<div class=\"col-6 mt-1\"><a href=\"#\" class=\"btn btn-block %s\" role=\"button\" onclick=\"onRelayClick()\">%s</a></div>",
+          getRelayHtmlStatus( relays[i], (mask >> i) & 1 ), getRelayName( i ).c_str() );
+      }
+      break;
+    }
+    // ==========================================
+    // Backend options
+    CASE( "BE_GPIO" ):   out += getBackendOption() == "gpio" ? "selected" : "";      break;
+    CASE( "BE_MCP" ):    out += getBackendOption() == "mcp23017" ? "selected" : "";  break;
+    CASE( "BE_595" ):    out += getBackendOption() == "74hc595" ? "selected" : "";   break;
+    CASE( "I2CADDR" ):   out += getByteOption( "I2cAddr", Config::RELAY_MCP23017_ADDRESS );  break;
+    CASE( "CHIPS" ):     out += getByteOption( "Chips", 1 );                         break;
+    CASE( "LATCH" ):     out += getByteOption( "LatchPin", Config::RELAY_HC595_LATCH_PIN );  break;
+    // ==========================================
+    // Scene buttons, one per named relay scene
+    CASE( "SCENES" ): {
+      const String scenes = getScenes();
+      ScratchJsonDocument doc( toJsonCapacity( scenes ));
+      if( deserializeJson( doc, scenes ) != DeserializationError::Ok ) break;
+      for( JsonPair scene : doc.as<JsonObject>() ) {
+        Format::append( out,
+          "<a href=\"#\" class=\"btn btn-outline-primary mr-1 mb-1\" role=\"button\" onclick=\"onSceneClick()\">%s</a>",
+          scene.key().c_str() );
+      }
+      break;
+    }
     // ==========================================
-    // Relay status, a per-relay buttons style to indicate relays states (ON/OFF/Disabled)
-    CASE( "ST1" ):   out += getRelayHtmlStatus( relays[0] );  break;
-    CASE( "ST2" ):   out += getRelayHtmlStatus( relays[1] );  break;
-    CASE( "ST3" ):   out += getRelayHtmlStatus( relays[2] );  break;
-    CASE( "ST4" ):   out += getRelayHtmlStatus( relays[3] );  break;
-    CASE( "ST5" ):   out += getRelayHtmlStatus( relays[4] );  break;
-    CASE( "ST6" ):   out += getRelayHtmlStatus( relays[5] );  break;
-    CASE( "ST7" ):   out += getRelayHtmlStatus( relays[6] );  break;
-    CASE( "ST8" ):   out += getRelayHtmlStatus( relays[7] );  break;
+    // Generated relay keys: IDn - the relay name, STn - the relay button style (ON/OFF/Disabled).
+    DEFAULT_CASE: {
+      const uint8_t index = toTemplateIndex( key );
+      if( index >= relaysCount )  break;
+      if( key[0] == 'I' ) {
+        out += getRelayName( index );
+      } else {
+        out += getRelayHtmlStatus( relays[index], (getRelaysMask() >> index) & 1 );
+      }
+      break;
+    }
   }
 }
 
 /* Private */
 
+/**
+ * Switches the selected relays to the value bits (bit N is relay N, 1 means ON). All the pins
+ * are written by the backend at once, see Relays::Backend::write().
+ * @param persist true to store states of persistent relays, a single NVS write for all of them.
+ * @return relays whose states have been changed.
+ */
+uint64_t RelaysModule::applyRelays( uint64_t value, uint64_t select, bool persist ) {
+  const uint64_t before = getRelaysMask();
+  uint64_t levels = 0;
+  uint64_t channels = 0;
+  for( uint8_t i = 0; i < relaysCount; i++ ) {
+    const RelayInfo& info = relays[i];
+    if( info.channel == Relays::NO_CHANNEL || (select & (1ULL << i)) == 0 ) continue;
+    channels |= 1ULL << info.channel;
+    if( ((value & (1ULL << i)) != 0) != info.inverse ) levels |= 1ULL << info.channel;
+  }
+  backend->write( levels, channels );
+
+  const uint64_t after = getRelaysMask();
+  if( persist ) saveRelayValues( after );
+  return before ^ after;
+}
+
 ResultData RelaysModule::buildRelayData( const String& data ) {
-  DynamicJsonDocument doc( Config::JSON_CONFIG_SIZE );
+  ScratchJsonDocument doc( toJsonCapacity( data ));
   DeserializationError rc = deserializeJson( doc, data );
   // If the JSON config cannot be decoded.
   if( rc != DeserializationError::Ok ) {
-    return {RC_ERROR, Utils::format( Messages::JSON_DECODE_ERROR, rc.c_str() )};
+    ResultData result = {RC_ERROR};
+    Format::append( result.details, Messages::JSON_DECODE_ERROR, rc.c_str() );
+    return result;
   }
-  // Build the data from JSON.
+  // Build the data from JSON, the number of entries is the number of relays.
   JsonArray array = doc.as<JsonArray>();
   uint8_t i = 0;
   for( JsonObject item : array ) {
+    if( i >= Config::RELAY_MAX_RELAYS ) break;
     relays[i].alias      = item["alias"].as<char*>();
     relays[i].pin        = item["pin"].as<int>();
     relays[i].inverse    = item["invert"].as<bool>();
     relays[i].persistent = item["persist"].as<bool>();
-    if( ++i >= Config::RELAY_MAX_RELAYS ) break;
+    relays[i].channel    = Relays::NO_CHANNEL;
+    i += 1;
   }
-  // Fill the rest of RelayInfo data if JSON config is too short.
+  relaysCount = i;
+  // Clear the rest of RelayInfo data.
   while( i < Config::RELAY_MAX_RELAYS ) {
     relays[i].alias = "";
     relays[i].pin = 0;
     relays[i].inverse = false;
     relays[i].persistent = false;
+    relays[i].channel = Relays::NO_CHANNEL;
     i += 1;
   }
   return RESULT_OK;
 }
 
+/**
+ * Creates the backend selected by options, the GPIO one if the option is invalid.
+ */
+void RelaysModule::createBackend() {
+  const Relays::BackendConfig config = {
+    getByteOption( "I2cAddr", Config::RELAY_MCP23017_ADDRESS ),
+    getByteOption( "Chips", 1 ),
+    getByteOption( "LatchPin", Config::RELAY_HC595_LATCH_PIN )
+  };
+  delete backend;
+  const String type = getBackendOption();
+  backend = Relays::createBackend( type, config );
+  if( !backend ) {
+    Log.error( "REL The %s backend is not configured, gpio is used" CR, type.c_str() );
+    backend = Relays::createBackend( "gpio", config );
+  }
+}
+
+String RelaysModule::getBackendOption() {
+  return getStringOption( "Backend", Config::RELAY_BACKEND );
+}
+
 String RelaysModule::getDefaultRelayData() {
-  StaticJsonDocument<Config::JSON_MESSAGE_SIZE * 2> doc;
+  ScratchJsonDocument doc( Config::JSON_MESSAGE_SIZE * 2 );
   JsonArray array = doc.to<JsonArray>();
   for( RelayConfig item : DEFAULT_CONFIG ) {
     JsonObject nested = array.createNestedObject();
@@ -217,99 +424,453 @@ String RelaysModule::getRelayName( const uint8_t index ) {
   if( relays[index].alias.length() > 0 ) {
     return relays[index].alias;
   } else {
-    String s = "rel";
-    s += index + 1;
-    return s;
+    return getRelayId( index );
   }
 }
 
-void RelaysModule::initializeHardware() {
-  for( uint8_t i = 0; i < Config::RELAY_MAX_RELAYS; i++ ) {
-    const RelayInfo info = relays[i];
-    if( info.pin == 0 ) continue;
-
-    pinMode( info.pin, OUTPUT );
-    if( info.persistent ) {
-      const uint16_t values = getShortOption( "Values" );
-      uint8_t v = (values & (1 << i)) != 0;
-      switchRelay( i, info, v );
+/**
+ * States of all relays, bit N is relay N, 1 means ON. Relays without a pin are always OFF.
+ * Output levels are cached by the backend, the bus isn't touched.
+ */
+uint64_t RelaysModule::getRelaysMask() {
+  const uint64_t levels = backend->read();
+  uint64_t mask = 0;
+  for( uint8_t i = 0; i < relaysCount; i++ ) {
+    const RelayInfo& info = relays[i];
+    if( info.channel == Relays::NO_CHANNEL ) continue;
+    if( (((levels >> info.channel) & 1) != 0) != info.inverse ) mask |= 1ULL << i;
+  }
+  return mask;
+}
+
+String RelaysModule::getScenes() {
+  const String scenes = getStringOption( "Scenes" );
+  return scenes.length() > 0 ? scenes : "{}";
+}
+
+/**
+ * Schedules as a JSON array of strings, e.g. ["pump on every 3600","light off 30 23 * * * catchup"].
+ */
+String RelaysModule::getSchedules() {
+  static const char* const ACTIONS[] = { "off", "on", "toggle" };
+  // The strings are added by pointers, so the document holds the array slots only.
+  String items[Config::RELAY_MAX_SCHEDULES];
+  ScratchJsonDocument doc( JSON_ARRAY_SIZE( Config::RELAY_MAX_SCHEDULES ));
+  JsonArray array = doc.to<JsonArray>();
+  for( uint8_t i = 0; i < scheduler.getCount(); i++ ) {
+    const Relays::Schedule& schedule = scheduler.get( i );
+    String& s = items[i];
+    s = schedule.relay < relaysCount ? getRelayName( schedule.relay ) : getRelayId( schedule.relay );
+    s += ' ';
+    s += ACTIONS[schedule.action];
+    s += ' ';
+    Relays::Scheduler::format( schedule, s );
+    array.add( s.c_str() );
+  }
+  return doc.as<String>();
+}
+
+StatusData RelaysModule::getStatusData( const uint8_t index, const uint64_t changed ) {
+  StatusData data;
+  data.type = StatusData::TYPE_RELAYS;
+  data.relays.mask = getRelaysMask();
+  data.relays.changed = changed;
+  data.relays.index = index;
+  data.relays.state = StatusData::RELAY_NO_PIN;
+  if( index < relaysCount && relays[index].channel != Relays::NO_CHANNEL ) {
+    data.relays.state = ((data.relays.mask >> index) & 1) ? StatusData::RELAY_ON : StatusData::RELAY_OFF;
+  }
+  return data;
+}
+
+/**
+ * Named relay scenes:
+ *   "relays scene"                           - list scenes (JSON object string);
+ *   "relays scene <name>"                    - apply the scene;
+ *   "relays scene <name> <value> [<select>]" - define or redefine the scene, masks are the same as the mask command ones;
+ *   "relays scene <name> delete"             - delete the scene.
+ * @return the command results.
+ */
+String RelaysModule::handleSceneCommand( const String& args ) {
+  Tokenizer tokens( args );
+  StringView token;
+  if( !tokens.next( token )) {
+    return getScenes();
+  }
+  const InlineString<Config::RELAY_MAX_SCENE_NAME + 1> name( token );
+
+  // Room for one more scene: the name and two masks.
+  const String stored = getScenes();
+  ScratchJsonDocument doc( toJsonCapacity( stored, JSON_OBJECT_SIZE( 1 ) + JSON_ARRAY_SIZE( 2 ) + sizeof(name) + 2 * (Config::RELAY_MAX_RELAYS + 3) ));
+  if( deserializeJson( doc, stored ) != DeserializationError::Ok ) {
+    doc.to<JsonObject>();
+  }
+  JsonObject scenes = doc.as<JsonObject>();
+
+  // Apply the scene.
+  if( !tokens.next( token )) {
+    JsonArray scene = scenes[name.c_str()];
+    if( scene.isNull() ) {
+      return Messages::SCENE_UNKNOWN;
+    }
+    uint64_t value = 0, select = ALL_RELAYS;
+    if( !toMask( scene.getElement( 0 ), value ) || (scene.size() > 1 && !toMask( scene.getElement( 1 ), select )) ) {
+      return Messages::COMMAND_INVALID_VALUE;
+    }
+    const uint64_t changed = applyRelays( value, select, true );
+    if( changed != 0 ) postStatusChange( StatusData::RELAY_MANY, changed );
+    return toMaskJson( getRelaysMask(), changed );
+  }
+  // Delete the scene.
+  if( token == "delete" && tokens.atEnd() ) {
+    if( !scenes.containsKey( name.c_str() )) {
+      return Messages::SCENE_UNKNOWN;
+    }
+    scenes.remove( name.c_str() );
+  } else {
+    // Define the scene, masks are stored as strings, 64-bit numbers aren't enabled in ArduinoJson.
+    uint64_t value = 0, select = ALL_RELAYS;
+    StringView s;
+    tokens.next( s );
+    if( !parseMask( token, value ) || (!s.isEmpty() && !parseMask( s, select )) || !tokens.atEnd() ) {
+      return Messages::COMMAND_INVALID_VALUE;
+    }
+    char buffer[Config::RELAY_MAX_RELAYS + 3];
+    JsonArray scene = scenes.createNestedArray( name.c_str() );
+    toMaskString( value, buffer );
+    scene.add( buffer );
+    if( !s.isEmpty() ) {
+      toMaskString( select, buffer );
+      scene.add( buffer );
+    }
+  }
+  String json;
+  serializeJson( doc, json );
+  const ResultData rc = saveScenes( json );
+  return rc.code == RC_OK ? json : rc.details;
+}
+
+/**
+ * Relay schedules:
+ *   "relays schedule"                                          - list schedules (JSON array string);
+ *   "relays schedule add <relay> <on|off|toggle> <m> <h> <day> <month> <weekday> [catchup]"
+ *                                                              - add a cron-like schedule, the 5 fields may be quoted;
+ *   "relays schedule add <relay> <on|off|toggle> every <seconds> [<offset>] [catchup]"
+ *                                                              - add an interval schedule;
+ *   "relays schedule delete <n>|all"                           - delete the n-th (1-based) or all schedules.
+ * See Relays::Scheduler for the "catchup" flag.
+ * @return the command results.
+ */
+String RelaysModule::handleScheduleCommand( const String& args ) {
+  Tokenizer tokens( args );
+  StringView token;
+  if( !tokens.next( token )) {
+    return getSchedules();
+  }
+  if( token == "add" ) {
+    StringView relay, action;
+    Relays::Schedule schedule;
+    memset( &schedule, 0, sizeof(schedule) );
+    if( !tokens.next( relay ) || !tokens.next( action )) {
+      return Messages::COMMAND_INVALID_VALUE;
+    }
+    schedule.relay = toRelayIndex( relay );
+    schedule.action = parseRelayPayload( action );
+    if( schedule.relay >= relaysCount || schedule.action > 2 || !Relays::Scheduler::parse( tokens, schedule )) {
+      return Messages::COMMAND_INVALID_VALUE;
+    }
+    if( !scheduler.add( schedule )) {
+      return Messages::SCHEDULES_LIMIT;
+    }
+  } else if( token == "delete" && tokens.next( token ) && tokens.atEnd() ) {
+    if( token == "all" ) {
+      scheduler.clear();
     } else {
-      switchRelay( i, info, 0 );
+      const long n = atol( token.toString().c_str() );
+      if( n < 1 || !scheduler.remove( n - 1 )) {
+        return Messages::COMMAND_INVALID_VALUE;
+      }
     }
+  } else {
+    return Messages::COMMAND_INVALID_VALUE;
+  }
+  saveSchedules();
+  return getSchedules();
+}
+
+/**
+ * Resolves the relay channels, then restores persistent relays and switches off others.
+ */
+void RelaysModule::initializeHardware() {
+  const uint64_t values = loadRelayValues();
+  uint64_t channels = 0;
+  uint64_t levels = 0;
+  for( uint8_t i = 0; i < relaysCount; i++ ) {
+    RelayInfo& info = relays[i];
+    info.channel = backend->toChannel( info.pin );
+    if( info.channel == Relays::NO_CHANNEL ) continue;
+
+    channels |= 1ULL << info.channel;
+    const bool on = info.persistent && (values & (1ULL << i)) != 0;
+    if( on != info.inverse ) levels |= 1ULL << info.channel;
+  }
+  if( !backend->begin( channels, levels )) {
+    Log.error( "REL %s backend did not respond" CR, getBackendOption().c_str() );
+  }
+}
+
+/**
+ * States of persistent relays, bit N is relay N.
+ */
+uint64_t RelaysModule::loadRelayValues() {
+  uint64_t values = 0;
+  if( Options::getBlob( getId(), "States", &values, sizeof(values) ) != sizeof(values) ) {
+    values = getShortOption( "Values" );    // Stored by former versions, up to 16 relays.
   }
+  return values;
+}
+
+void RelaysModule::loadSchedules() {
+  Relays::Schedule buffer[Config::RELAY_MAX_SCHEDULES];
+  const size_t size = Options::getBlob( getId(), "Schedules", buffer, sizeof(buffer) );
+  scheduler.load( buffer, size );
+  // Runs after the last saved clock are caught up, none if it's not saved.
+  savedScheduleTime = Options::getLong( getId(), "SchedTime", 0 );
+  scheduler.resume( savedScheduleTime );
 }
 
-void RelaysModule::saveRelayValue( const uint8_t index, const RelayInfo info, const uint8_t value ) {
-  const String moduleId = getId();
-  uint16_t values = getShortOption( "Values" );
-  if( value == HIGH ) {
-    values |= 1 << index;
+/**
+ * Parses a relays mask, binary (0b1010), hex (0xA) or decimal. Bits above the relays count
+ * are invalid if inRange is set.
+ */
+bool RelaysModule::parseMask( const StringView& s, uint64_t& mask, const bool inRange ) {
+  unsigned base = 10;
+  size_t i = 0;
+  if( s.length() > 2 && s[0] == '0' && (s[1] == 'b' || s[1] == 'B') ) {
+    base = 2;  i = 2;
+  } else if( s.length() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X') ) {
+    base = 16;  i = 2;
+  }
+  if( i >= s.length() ) return false;
+  uint64_t v = 0;
+  for( ; i < s.length(); i++ ) {
+    const char c = s[i];
+    unsigned d;
+    if( c >= '0' && c <= '9' )       d = c - '0';
+    else if( c >= 'a' && c <= 'f' )  d = c - 'a' + 10;
+    else if( c >= 'A' && c <= 'F' )  d = c - 'A' + 10;
+    else return false;
+    if( d >= base || v > (UINT64_MAX - d) / base ) return false;
+    v = v * base + d;
+  }
+  if( inRange && relaysCount < 64 && (v >> relaysCount) != 0 ) return false;
+  mask = v;
+  return true;
+}
+
+/**
+ * Schedules the status changed event, a bit later to let the relays settle. Changes made
+ * while the event is pending are coalesced into one event, reported with the RELAY_MANY index
+ * if more than one relay is involved.
+ */
+void RelaysModule::postStatusChange( const uint8_t index, const uint64_t changed ) {
+  if( pendingStateDelay == 0 ) {
+    pendingRelay = index;
+  } else if( pendingRelay != index ) {
+    pendingRelay = StatusData::RELAY_MANY;
+  }
+  pendingChanged |= changed;
+  pendingStateDelay = 7;
+}
+
+/**
+ * Schedules never touch relays which are not configured anymore.
+ */
+void RelaysModule::runSchedule( const Relays::Schedule& schedule ) {
+  if( schedule.relay >= relaysCount ) return;
+  const uint64_t changed = switchRelay( schedule.relay, schedule.action );
+  postStatusChange( schedule.relay, changed );
+}
+
+/**
+ * Stores states of persistent relays. The option is only written if any of them has changed.
+ */
+void RelaysModule::saveRelayValues( const uint64_t states ) {
+  uint64_t persistent = 0;
+  for( uint8_t i = 0; i < relaysCount; i++ ) {
+    if( relays[i].persistent ) persistent |= 1ULL << i;
+  }
+  const uint64_t values = loadRelayValues();
+  const uint64_t v = (values & ~persistent) | (states & persistent);
+  if( v != values ) {
+    Options::setBlob( getId(), "States", &v, sizeof(v) );
+  }
+}
+
+/**
+ * Validates and permanently stores the scenes JSON, e.g. {"night":["0b0101","0b1111"],"off":["0"]}.
+ */
+ResultData RelaysModule::saveScenes( const String& scenes ) {
+  ScratchJsonDocument doc( toJsonCapacity( scenes ));
+  DeserializationError rc = deserializeJson( doc, scenes );
+  if( rc != DeserializationError::Ok ) {
+    ResultData result = {RC_ERROR};
+    Format::append( result.details, Messages::JSON_DECODE_ERROR, rc.c_str() );
+    return result;
+  }
+  if( !doc.is<JsonObject>() || doc.as<JsonObject>().size() > Config::RELAY_MAX_SCENES ) {
+    return {RC_ERROR, Messages::SCENES_LIMIT};
+  }
+  for( JsonPair scene : doc.as<JsonObject>() ) {
+    if( !isValidSceneName( scene.key().c_str() )) {
+      return {RC_ERROR, Messages::SCENES_LIMIT};
+    }
+    JsonArray masks = scene.value().as<JsonArray>();
+    uint64_t mask;
+    if( masks.isNull() || masks.size() < 1 || masks.size() > 2 ) {
+      return INVALID_VALUE;
+    }
+    for( JsonVariant m : masks ) {
+      if( !toMask( m, mask )) return INVALID_VALUE;
+    }
+  }
+  setStringOption( "Scenes", scenes );
+  return RESULT_OK;
+}
+
+void RelaysModule::saveSchedules() {
+  if( scheduler.getCount() > 0 ) {
+    Options::setBlob( getId(), "Schedules", scheduler.data(), scheduler.size() );
   } else {
-    values &= ~(1 << index);
+    Options::remove( getId(), "Schedules" );
   }
-  Options::setShort( moduleId, "Values", values );
 }
 
-void RelaysModule::switchRelay( const uint8_t index, const RelayInfo info, const uint8_t value ) {
-  if( info.pin == 0 ) return;
+/**
+ * Saves the scheduler clock every RELAY_SCHEDULE_SAVE_PERIOD, or right after schedules
+ * have run, so the runs made before a reboot aren't caught up again. It's saved only if
+ * there are catch-up schedules, to spare the flash.
+ */
+void RelaysModule::saveScheduleTime( const bool force ) {
+  const time_t now = scheduler.getLastTime();
+  if( now == 0 || now == savedScheduleTime || !scheduler.hasCatchUp() ) return;
+  if( force || now < savedScheduleTime || now - savedScheduleTime >= Config::RELAY_SCHEDULE_SAVE_PERIOD ) {
+    Options::setLong( getId(), "SchedTime", now );
+    savedScheduleTime = now;
+  }
+}
+
+/**
+ * Switches one relay, value is 0 - off, 1 - on, 2 - toggle.
+ * @return relays whose states have been changed.
+ */
+uint64_t RelaysModule::switchRelay( const uint8_t index, const uint8_t value ) {
+  const uint64_t bit = 1ULL << index;
   switch( value ) {
-    // Toggle relay
-    case 2: {
-      uint8_t v = digitalRead( info.pin ) == LOW ? HIGH : LOW;
-      digitalWrite( info.pin, digitalRead( info.pin ) == LOW ? HIGH : LOW );
-      if( info.persistent ) saveRelayValue( index, info, v );
-      break;
-    }
-    // Switch on
-    case 1:
-      digitalWrite( info.pin, info.inverse ? LOW : HIGH );
-      if( info.persistent ) saveRelayValue( index, info, HIGH );
-      break;
-    // Switch off
-    case 0:
-      digitalWrite( info.pin, info.inverse ? HIGH : LOW );
-      if( info.persistent ) saveRelayValue( index, info, LOW );
-      break;
-    // Invalid value
-    default:
-      break;
+    case 2:   return applyRelays( ~getRelaysMask(), bit, true );
+    case 1:   return applyRelays( ALL_RELAYS, bit, true );
+    case 0:   return applyRelays( 0, bit, true );
+    default:  return 0;
+  }
+}
+
+String RelaysModule::toJsonString( const uint8_t index ) {
+  ScratchJsonDocument json( Config::JSON_MESSAGE_SIZE );
+  json["id"] = getRelayId( index );
+  const RelayInfo& info = relays[index];
+  if( info.alias.length() > 0 ) {
+    json["alias"] = info.alias;
+  }
+  if( info.channel != Relays::NO_CHANNEL ) {
+    json["state"] = ((getRelaysMask() >> index) & 1) ? "ON" : "OFF";
+  } else {
+    json["state"] = "No pin";
   }
+  return json.as<String>();
+}
+
+/**
+ * A stored scene mask, a mask string or a number (32 relays max). Bits of relays removed
+ * since the scene was defined are dropped, so such scenes stay valid.
+ */
+bool RelaysModule::toMask( const JsonVariant value, uint64_t& mask ) {
+  if( value.is<const char*>() ) {
+    if( !parseMask( value.as<const char*>(), mask, false )) return false;
+  } else if( value.is<uint32_t>() ) {
+    mask = value.as<uint32_t>();
+  } else {
+    return false;
+  }
+  if( relaysCount < 64 ) mask &= (1ULL << relaysCount) - 1;
+  return true;
+}
+
+/**
+ * The mask command results, e.g. {"mask":"0b00001010","changed":"0b00001000"}.
+ */
+String RelaysModule::toMaskJson( const uint64_t mask, const uint64_t changed ) {
+  char buffer[Config::RELAY_MAX_RELAYS + 3];
+  ScratchJsonDocument json( Config::JSON_MESSAGE_SIZE );
+  toMaskString( mask, buffer );
+  json["mask"] = buffer;              // Copied, it's a char*.
+  toMaskString( changed, buffer );
+  json["changed"] = buffer;
+  return json.as<String>();
+}
+
+/**
+ * "0b" followed by one digit per relay, the last relay first.
+ */
+void RelaysModule::toMaskString( const uint64_t mask, char* buffer ) {
+  *buffer++ = '0';
+  *buffer++ = 'b';
+  for( int8_t i = (relaysCount > 0 ? relaysCount : 1) - 1; i >= 0; i-- ) {
+    *buffer++ = ((mask >> i) & 1) ? '1' : '0';
+  }
+  *buffer = 0;
 }
 
 uint8_t RelaysModule::toRelayIndex( const String& value ) {
-  SWITCH( value.c_str() ) {
-    CASE( "rel1" ):   return 0;
-    CASE( "rel2" ):   return 1;
-    CASE( "rel3" ):   return 2;
-    CASE( "rel4" ):   return 3;
-    CASE( "rel5" ):   return 4;
-    CASE( "rel6" ):   return 5;
-    CASE( "rel7" ):   return 6;
-    CASE( "rel8" ):   return 7;
+  // Relay IDs "rel1".."relN".
+  const char* p = value.c_str();
+  if( strncmp( p, "rel", 3 ) == 0 && p[3] >= '1' && p[3] <= '9' ) {
+    char* end;
+    const unsigned long n = strtoul( p + 3, &end, 10 );
+    if( *end == 0 && n <= relaysCount ) return n - 1;
+  }
+  // Check relays aliases.
+  for( uint8_t i = 0; i < relaysCount; i++ ) {
+    if( relays[i].alias == value ) return i;
+  }
+  // Invalid value.
+  return 255;
+}
 
-    DEFAULT_CASE: {
-      // Check relays aliases.
-      for( uint8_t i = 0; i < Config::RELAY_MAX_RELAYS; i++ ) {
-        if( relays[i].alias == value ) return i;
-      }
-      // Invalid value.
-      return 255;
-    }
+/**
+ * The relay index of generated template keys "ID1".."IDn" and "ST1".."STn", 255 if the key
+ * isn't one of them.
+ */
+uint8_t RelaysModule::toTemplateIndex( const StringView& key ) {
+  if( key.length() < 3 || key.length() > 4 || !(key.startsWith( "ID" ) || key.startsWith( "ST" )) ) {
+    return 255;
   }
+  unsigned n = 0;
+  for( size_t i = 2; i < key.length(); i++ ) {
+    if( key[i] < '0' || key[i] > '9' ) return 255;
+    n = n * 10 + (key[i] - '0');
+  }
+  return n >= 1 && n <= relaysCount ? n - 1 : 255;
 }
 
 /* Private static */
 
-String RelaysModule::getRelayHtmlStatus( const RelayInfo info ) {
-  if( info.pin == 0 )  return "btn-outline-dark disabled";
-
-  uint8_t v = digitalRead( info.pin );
-  if( info.inverse ) v ^= 1;
-  return v == HIGH ? "btn-primary" : "btn-secondary";
+const char* RelaysModule::getRelayHtmlStatus( const RelayInfo& info, const bool on ) {
+  if( info.channel == Relays::NO_CHANNEL )  return "btn-outline-dark disabled";
+  return on ? "btn-primary" : "btn-secondary";
 }
 
 String RelaysModule::getRelayId( const uint8_t index ) {
-  if( index >= 0 && index < Config::RELAY_MAX_RELAYS ) {
+  if( index < Config::RELAY_MAX_RELAYS ) {
     String s = "rel";
     s += index + 1;
     return s;
@@ -318,6 +879,19 @@ String RelaysModule::getRelayId( const uint8_t index ) {
   }
 }
 
+/**
+ * Scene names are used in commands and web pages as is, so they're limited to letters, digits,
+ * '_' and '-'.
+ */
+bool RelaysModule::isValidSceneName( const char* name ) {
+  const size_t len = strlen( name );
+  if( len == 0 || len > Config::RELAY_MAX_SCENE_NAME ) return false;
+  for( const char* p = name; *p; p++ ) {
+    if( !isalnum( (unsigned char) *p ) && *p != '_' && *p != '-' ) return false;
+  }
+  return true;
+}
+
 uint8_t RelaysModule::parseRelayPayload( const String& payload ) {
   SWITCH( payload.c_str() ) {
     CASE( "0" ):
@@ -335,20 +909,4 @@ uint8_t RelaysModule::parseRelayPayload( const String& payload ) {
     DEFAULT_CASE:
       return 255;
   }
-}
-
-String RelaysModule::toJsonString( const uint8_t index, const RelayInfo info ) {
-  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-  json["id"] = getRelayId( index );
-  if( info.alias.length() > 0 ) {
-    json["alias"] = info.alias;
-  }
-  if( info.pin > 0 ) {
-    uint8_t value = digitalRead( info.pin );
-    if( info.inverse ) value = !value;
-    json["state"] = value > 0 ? "ON" : "OFF";
-  } else {
-    json["state"] = "No pin";
-  }
-  return json.as<String>();
 }
\ No newline at end of file
@@ -23,11 +23,9 @@ RtcTimeModule::RtcTimeModule() {
   localtime_r( &now, &timeInfo );
 
   // Lambda expression, an EventBus callback handler.
-  eventBusToken = Bus.listen<ConnectivityEvent>( [this](const ConnectivityEvent& event ) {
-    if( event.type == ConnectivityEvent::TYPE_WIFI ) {
-      if( event.connected ) {
-        reconfigureNtp();
-      }
+  eventBusToken = Bus.listen<ConnectivityEvent>( EventFilter::of( ConnectivityEvent::TYPE_WIFI ), [this](const ConnectivityEvent& event ) {
+    if( event.connected ) {
+      reconfigureNtp();
     }
   });
   rtcTicker.attach( 1, tickerCallback, this );
@@ -46,8 +44,8 @@ const String RtcTimeModule::getStatusWebpage() {
   return makeWebpage( "/status_rtc.html" );
 }
 
-const String RtcTimeModule::getString( const String& key ) {
-  SWITCH( key.c_str() ) {
+const String RtcTimeModule::getString( const StringView& key ) {
+  SWITCH( key ) {
     CASE( Config::KEY_EXPORT_CONFIGURATION ): {
       StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
       json["timezone"]  = getStringOption( "TZone", Config::RTC_TIMEZONE );
@@ -63,8 +61,8 @@ const String RtcTimeModule::getString( const String& key ) {
   }
 }
 
-ResultData RtcTimeModule::setString( const String& key, const String& value ) {
-  SWITCH( key.c_str() ) {
+ResultData RtcTimeModule::setString( const StringView& key, const String& value ) {
+  SWITCH( key ) {
     CASE( Config::KEY_IMPORT_CONFIGURATION ):
       return handleConfigImport( value );
     DEFAULT_CASE:
@@ -143,18 +141,12 @@ bool RtcTimeModule::reconfigureNtp() {
 
 /* Protected */
 
+constexpr Commands::Entry<RtcTimeModule> RtcTimeModule::COMMANDS[] = {
+  { "reconfig", Commands::none(), &RtcTimeModule::cmdReconfig, "Restart the NTP synchronization" },
+};
+
 bool RtcTimeModule::handleCommand( const String& cmd, const String& args ) {
-  SWITCH( cmd.c_str() ) {
-    // ==========================================
-    CASE( "reconfig" ): {
-      reconfigureNtp();
-      handleCommandResults( cmd, args, Messages::OK );
-      return true;
-    }
-    // ==========================================
-    DEFAULT_CASE:
-      return false;
-  }
+  return dispatchCommandTable<COMMAND_TABLE(RtcTimeModule, COMMANDS)>( *this, cmd, args );
 }
 
 ResultData RtcTimeModule::handleOption( const String& key, const String& value, Options::Action action ) {
@@ -183,8 +175,8 @@ ResultData RtcTimeModule::handleOption( const String& key, const String& value,
   }
 }
 
-void RtcTimeModule::resolveTemplateKey( const String& key, String& out ) {
-  SWITCH( key.c_str() ) {
+void RtcTimeModule::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     // ==========================================
     // Module template parameters
     CASE( "NTP1" ):       out += getStringOption( "Ntp1", Config::RTC_NTP_SERVER1 );      break;
@@ -201,6 +193,13 @@ void RtcTimeModule::resolveTemplateKey( const String& key, String& out ) {
   }
 }
 
+/* Commands */
+
+void RtcTimeModule::cmdReconfig( const Commands::Args& args ) {
+  reconfigureNtp();
+  handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
 /* Private */
 
 void RtcTimeModule::handleTickEverySecond( void ) {
@@ -225,7 +224,16 @@ void RtcTimeModule::handleTickEverySecond( void ) {
     }
     // Send a status update event to EventBus every minute.
     if( timeInfo.tm_sec == 0 ) {
-      Bus.notify( (StatusChangedEvent) { this, getLocalTimeIsoString() });
+      StatusData data;
+      data.type = StatusData::TYPE_TIME;
+      data.time.local  = now;
+      data.time.year   = timeInfo.tm_year + 1900;
+      data.time.month  = timeInfo.tm_mon + 1;
+      data.time.day    = timeInfo.tm_mday;
+      data.time.hour   = timeInfo.tm_hour;
+      data.time.minute = timeInfo.tm_min;
+      data.time.second = timeInfo.tm_sec;
+      Bus.notify( StatusChangedEvent( this, data ));
     }
   } else {
     // Not synchronized...
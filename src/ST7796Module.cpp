@@ -1,4 +1,6 @@
 #include <SPI.h>
+#include <esp_heap_caps.h>
+#include <soc/soc_memory_layout.h>
 #include "lvgl/ST7796Driver.h"
 #include <SD.h>
 #include "ST7796Module.h"
@@ -165,6 +167,9 @@ void testFileIO(fs::FS &fs, const char * path){
 
 
 DisplayDriver* ST7796Module::driver = nullptr;
+QueueHandle_t ST7796Module::guiQueue = nullptr;
+SemaphoreHandle_t ST7796Module::guiMutex = nullptr;
+ST7796Module::RenderStats ST7796Module::stats;
 
 ST7796Module::ST7796Module() {
 //  properties.tick_100mS_required = true;
@@ -178,7 +183,8 @@ ST7796Module::ST7796Module() {
   SPI.begin();
 
   // Mounting SD card, it's used to hold graphical assets.
-  if( !SD.begin( Config::ST7796_SDCARD_CS_PIN, SPI )) {
+  const bool sdMounted = SD.begin( Config::ST7796_SDCARD_CS_PIN, SPI );
+  if( !sdMounted ) {
     Log.error( "ST7796 SD card mount failed" CR );
   } else {
     const String cardType = SDUtils::toString( SD.cardType() );
@@ -190,28 +196,39 @@ ST7796Module::ST7796Module() {
   lv_init();
   //  2. Initialize your drivers.
   driver = new ST7796Driver();
-  //  3. Register the display driver in LVGL.
-  lv_disp_buf_init( &bufferInfo, &displayBuffer1, NULL, LV_HOR_RES_MAX * LV_VER_RES_MAX / 10 );
+  //  3. Register the display driver in LVGL. With two buffers LVGL renders the next band
+  //     while the previous one is flushed.
+  const uint8_t lines = getByteOption( LINES_OPTION_KEY, Config::ST7796_BUFFER_LINES );
+  const bool psram = getByteOption( PSRAM_OPTION_KEY, Config::ST7796_BUFFER_PSRAM );
+  if( !allocateBuffers( lines, psram )) {
+    Log.error( "ST7796 render buffers allocation failed" CR );
+    return;
+  }
+  lv_disp_buf_init( &bufferInfo, displayBuffer1, displayBuffer2, LV_HOR_RES_MAX * bufferLines );
   lv_disp_drv_t disp_drv;
   lv_disp_drv_init( &disp_drv );
   disp_drv.flush_cb = flushDisplay;
+  disp_drv.monitor_cb = monitorDisplay;
+  disp_drv.wait_cb = waitDisplay;
   disp_drv.buffer = &bufferInfo;
   lv_disp_drv_register( &disp_drv );
+  stats = {esp_timer_get_time(), 0, 0, 0, 0, 0};
+
+  // 3a. Register the SD card as the "S:" drive for the images and fonts.
+  if( sdMounted ) {
+    sdFileSystem = new SdFileSystem( SD, getByteOption( CACHE_OPTION_KEY, Config::ST7796_CACHE_SIZE ) * 1024 );
+    sdFileSystem->begin();
+  }
 
   // 4. Register the touchscreen driver in LVGL.
-  /*
+  driver->setTouchCalibration( getTouchCalibration() );
   lv_indev_drv_t indev_drv;
   lv_indev_drv_init( &indev_drv );
   indev_drv.type = LV_INDEV_TYPE_POINTER;
   indev_drv.read_cb = readDisplayTouch;
-  lv_indev_t* my_indev = lv_indev_drv_register( &indev_drv );
-  */
-
-  //  5. Call lv_tick_inc(x) in every x milliseconds in an interrupt to tell the elapsed time.
-  //  6. Call lv_task_handler() periodically in every few milliseconds to handle LVGL related tasks.
-  ticker_1ms.attach_ms( 1, ticker_1ms_callback, this );
-  ticker_20ms.attach_ms( 20, ticker_20ms_callback, this );
+  lv_indev_drv_register( &indev_drv );
 
+  //  5. The LVGL tick comes from the esp_timer clock, see LV_TICK_CUSTOM in lv_conf.h.
   // /* use a pretty small demo for monochrome displays */
   // /* Get the current screen  */
   // lv_obj_t * scr = lv_disp_get_scr_act(NULL);
@@ -226,6 +243,11 @@ ST7796Module::ST7796Module() {
 
   demo_create();
 
+  //  6. Run lv_task_handler() in its own task, so redraws don't block the Ticker callbacks.
+  guiMutex = xSemaphoreCreateRecursiveMutex();
+  guiQueue = xQueueCreate( GUI_QUEUE_LENGTH, sizeof(GuiMessage) );
+  xTaskCreatePinnedToCore( guiTaskFunction, "gui", Config::ST7796_GUI_STACK_SIZE, this,
+    Config::ST7796_GUI_PRIORITY, &guiTask, Config::ST7796_GUI_CORE );
 
   listDir(SD, "/", 0);
   createDir(SD, "/mydir");
@@ -242,10 +264,34 @@ ST7796Module::ST7796Module() {
 }
 
 ST7796Module::~ST7796Module() {
-  ticker_20ms.detach();
-  ticker_1ms.detach();
+  // The task is deleted while it doesn't hold the LVGL lock.
+  if( guiTask ) {
+    lock();
+    vTaskDelete( guiTask );
+    unlock();
+  }
+  if( guiQueue ) {
+    vQueueDelete( guiQueue );
+    guiQueue = nullptr;
+  }
+  if( guiMutex ) {
+    vSemaphoreDelete( guiMutex );
+    guiMutex = nullptr;
+  }
   SPI.end();
   delete driver;
+  if( sdFileSystem ) {
+    delete sdFileSystem;
+  }
+  heap_caps_free( displayBuffer1 );
+  heap_caps_free( displayBuffer2 );
+}
+
+/**
+ * Post an UI update to the LVGL task. Returns false if the queue is full.
+ */
+bool ST7796Module::post( const GuiMessage& message ) {
+  return guiQueue && xQueueSend( guiQueue, &message, 0 ) == pdTRUE;
 }
 
 // void ST7796Module::tick_100mS( uint8_t phase ) {
@@ -254,47 +300,185 @@ ST7796Module::~ST7796Module() {
 
 /* Protected */
 
+constexpr Commands::Entry<ST7796Module> ST7796Module::COMMANDS[] = {
+  { "bright", Commands::number( 0, 255 ), &ST7796Module::cmdBright, "LED backlight brightness" },
+  { "cache",  Commands::none(),           &ST7796Module::cmdCache,  "SD card assets cache statistics" },
+  { "stats",  Commands::none(),           &ST7796Module::cmdStats,  "Rendering and flushing statistics since the previous call" },
+  { "touch",  Commands::none(),           &ST7796Module::cmdTouch,  "Raw touch coordinates, used to find the calibration values" },
+};
+
 bool ST7796Module::handleCommand( const String& cmd, const String& args ) {
-  SWITCH( cmd.c_str() ) {
+  return dispatchCommandTable<COMMAND_TABLE(ST7796Module, COMMANDS)>( *this, cmd, args );
+}
+
+
+ResultData ST7796Module::handleOption( const String& key, const String& value, Options::Action action ) {
+  SWITCH( key.c_str() ) {
     // ==========================================
-    // LED backlight
-    CASE( "bright" ): {
-      uint8_t v = Utils::toByte( args.c_str() );
-      driver->setBacklight( v );
-      handleCommandResults( cmd, args, Messages::OK );
-      return true;
+    // Commands save without verifying, and 0 lines would leave the display without buffers.
+    CASE( "lines" ): {
+      if( action != Options::READ ) {
+        const uint16_t lines = atoi( value.c_str() );
+        if( lines < 1 || lines > LV_VER_RES_MAX / 2 ) return INVALID_VALUE;
+      }
+      return handleByteOption( LINES_OPTION_KEY, value, action, true );
     }
-
     // ==========================================
-    // CASE( "write" ): {
-    //   auto p = Utils::split( args );
-    //   uint8_t cmd = strtol( p.first.c_str(), NULL, 16 );
-    //   uint8_t data = strtol( p.second.c_str(), NULL, 16 );
-    //   ST7796::writeCommand( cmd );
-    //   ST7796::writeData( data );
-    //   return true;
-    // }
-
+    CASE( "psram" ):
+      return handleByteOption( PSRAM_OPTION_KEY, value, action, true );
     // ==========================================
-    // CASE( "read" ): {
-    //   auto p = Utils::split( args );
-    //   uint8_t cmd = strtol( p.first.c_str(), NULL, 16 );
-    //   uint8_t data = strtol( p.second.c_str(), NULL, 16 );
-    //   ST7796::writeCommand( cmd );
-    //   ST7796::writeData( data );
-    //   return true;
-    // }
-
+    CASE( "cachekb" ):
+      return handleByteOption( CACHE_OPTION_KEY, value, action, true );
+    // ==========================================
+    // Touch calibration: "xmin,ymin,xmax,ymax[,swap,invx,invy]" raw values.
+    CASE( "touchcal" ): {
+      TouchCalibration cal = getTouchCalibration();
+      if( action != Options::READ ) {
+        unsigned int v[7] = {0, 0, 0, 0, cal.swapXY, cal.invertX, cal.invertY};
+        const int n = sscanf( value.c_str(), "%u,%u,%u,%u,%u,%u,%u", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6] );
+        if( n < 4 || v[0] >= v[2] || v[1] >= v[3] || v[2] > 4095 || v[3] > 4095 ) {
+          return INVALID_VALUE;
+        }
+        cal = {(uint16_t) v[0], (uint16_t) v[1], (uint16_t) v[2], (uint16_t) v[3], v[4] != 0, v[5] != 0, v[6] != 0, 0};
+        if( action == Options::SAVE ) {
+          Options::setBlob( getId(), TOUCH_CAL_OPTION_KEY, &cal, sizeof(cal) );
+          driver->setTouchCalibration( cal );
+        }
+      }
+      char buf[48];
+      snprintf( buf, sizeof(buf), "%u,%u,%u,%u,%u,%u,%u", cal.xMin, cal.yMin, cal.xMax, cal.yMax, cal.swapXY, cal.invertX, cal.invertY );
+      return {RC_OK, buf};
+    }
     // ==========================================
-    // Unknown command
     DEFAULT_CASE:
-      return false;
+      return UNKNOWN_OPTION;
+  }
+}
+
+/* Commands */
+
+void ST7796Module::cmdBright( const Commands::Args& args ) {
+  driver->setBacklight( args.number );
+  handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
+void ST7796Module::cmdCache( const Commands::Args& args ) {
+  if( sdFileSystem ) {
+    handleCommandResults( args.cmd, args.raw, sdFileSystem->getStats() );
+  } else {
+    handleCommandResults( args.cmd, args.raw, Messages::SD_CARD_MISSED );
   }
 }
 
+void ST7796Module::cmdStats( const Commands::Args& args ) {
+  handleCommandResults( args.cmd, args.raw, takeStats() );
+}
+
+void ST7796Module::cmdTouch( const Commands::Args& args ) {
+  int16_t x, y;
+  const bool pressed = driver->getTouchRaw( &x, &y );
+  char buf[64];
+  snprintf( buf, sizeof(buf), "{\"x\":%d,\"y\":%d,\"pressed\":%s}", x, y, pressed ? "true" : "false" );
+  handleCommandResults( args.cmd, args.raw, buf );
+}
 
 /* Private */
 
+/**
+ * The LVGL task. It sleeps until the next LVGL task is due, as lv_task_handler() reports,
+ * or until a message is posted.
+ */
+void ST7796Module::guiTaskFunction( void* arg ) {
+  GuiMessage message;
+  uint32_t sleep = 0;
+  for( ;; ) {
+    if( xQueueReceive( guiQueue, &message, pdMS_TO_TICKS( sleep )) == pdTRUE ) {
+      lock();
+      do {
+        message.callback( message );
+      } while( xQueueReceive( guiQueue, &message, 0 ) == pdTRUE );
+      unlock();
+    }
+    lock();
+    const uint32_t next = lv_task_handler();
+    unlock();
+    sleep = constrain( next, 1, Config::ST7796_GUI_MAX_SLEEP );
+  }
+}
+
+/**
+ * Allocate two render buffers of the given band height. DMA-capable internal RAM is used
+ * unless PSRAM is requested. The band is halved until it fits; if there is no room for
+ * the second buffer, LVGL works with a single one.
+ */
+bool ST7796Module::allocateBuffers( uint16_t lines, bool psram ) {
+  const uint32_t caps = psram ? MALLOC_CAP_SPIRAM : MALLOC_CAP_DMA;
+  for( bufferLines = lines; bufferLines > 0; bufferLines /= 2 ) {
+    const size_t size = LV_HOR_RES_MAX * bufferLines * sizeof(lv_color_t);
+    displayBuffer1 = (lv_color_t*) heap_caps_malloc( size, caps );
+    if( displayBuffer1 == nullptr && psram ) {
+      displayBuffer1 = (lv_color_t*) heap_caps_malloc( size, MALLOC_CAP_DMA );
+    }
+    if( displayBuffer1 ) {
+      displayBuffer2 = (lv_color_t*) heap_caps_malloc( size, esp_ptr_dma_capable( displayBuffer1 ) ? MALLOC_CAP_DMA : caps );
+      break;
+    }
+  }
+  bufferInPsram = displayBuffer1 && !esp_ptr_dma_capable( displayBuffer1 );
+  if( displayBuffer1 && displayBuffer2 == nullptr ) {
+    Log.warning( "ST7796 single render buffer of %d lines" CR, bufferLines );
+  }
+  return displayBuffer1 != nullptr;
+}
+
+/**
+ * The stored touch calibration or the default one from Config.
+ */
+TouchCalibration ST7796Module::getTouchCalibration() {
+  TouchCalibration cal;
+  if( Options::getBlob( getId(), TOUCH_CAL_OPTION_KEY, &cal, sizeof(cal) ) != sizeof(cal) ) {
+    cal = XPT2046Touch::getDefaultCalibration();
+  }
+  return cal;
+}
+
+/**
+ * Format the statistics collected since the previous call and start a new window.
+ */
+const String ST7796Module::takeStats() {
+  const int64_t now = esp_timer_get_time();
+  const uint32_t window = (now - stats.windowStart) / 1000;
+  const RenderStats s = stats;
+  stats = {now, 0, 0, 0, 0, 0};
+  const FlushStats f = driver->takeFlushStats();
+
+  lv_mem_monitor_t mem;
+  lock();
+  lv_mem_monitor( &mem );
+  unlock();
+
+  // Time per refresh: the rendering is the refresh time without waiting for the flushing buffer.
+  // The overlap is the part of the flushing done while LVGL was rendering.
+  const uint32_t refreshes = s.refreshes > 0 ? s.refreshes : 1;
+  const uint32_t waitMs = s.waitTime / 1000;
+  const uint32_t renderMs = s.refreshTime > waitMs ? s.refreshTime - waitMs : 0;
+  const uint32_t flushMs = f.busyTime / 1000;
+  const uint8_t overlap = f.busyTime > 0 ? 100 - min( 100UL, (unsigned long) s.waitTime * 100 / f.busyTime ) : 0;
+  const uint32_t fps10 = window > 0 ? s.refreshes * 10000UL / window : 0;
+
+  char buf[320];
+  snprintf( buf, sizeof(buf),
+    "{\"lines\":%u,\"buffers\":%u,\"psram\":%s,\"fps\":%lu.%lu,\"render\":%lu,\"flush\":%lu,\"wait\":%lu,"
+    "\"overlap\":%u,\"areas\":%lu,\"pixels\":%lu,\"windows\":%lu,\"continued\":%lu,\"solid\":%lu,\"run_px\":%lu,"
+    "\"mem_used\":%u,\"mem_frag\":%u}",
+    bufferLines, displayBuffer2 ? 2 : 1, bufferInPsram ? "true" : "false",
+    (unsigned long) fps10 / 10, (unsigned long) fps10 % 10,
+    (unsigned long) renderMs / refreshes, (unsigned long) flushMs / refreshes, (unsigned long) waitMs / refreshes,
+    overlap, (unsigned long) f.flushes, (unsigned long) f.pixels, (unsigned long) f.windows, (unsigned long) f.continued,
+    (unsigned long) f.solidAreas, (unsigned long) f.runPixels, mem.used_pct, mem.frag_pct );
+  return buf;
+}
+
 static void write_create(lv_obj_t * parent);
 static void list_create(lv_obj_t * parent);
 static void chart_create(lv_obj_t * parent);
@@ -2,7 +2,6 @@
 #include "Config.h"
 #include "StatusLedModule.h"
 #include "str_switch.h"
-#include "Utils.h"
 
 StatusLedModule::StatusLedModule() {
   properties.tick_100mS_required = true;
@@ -55,13 +54,29 @@ void StatusLedModule::oneshot( const LEDMode mode, const uint8_t count ) {
 
 /* Protected */
 
+// Every LED mode is a command, the optional argument is the number of the pattern repeats,
+// 0 or omitted - continuously.
+constexpr Commands::Entry<StatusLedModule> StatusLedModule::COMMANDS[] = {
+  { "blink1",  Commands::number( 0, 255, true ), &StatusLedModule::cmdMode, "One blink in 2 seconds" },
+  { "blink2",  Commands::number( 0, 255, true ), &StatusLedModule::cmdMode, "One blink per second" },
+  { "blink3",  Commands::number( 0, 255, true ), &StatusLedModule::cmdMode, "One blink in 0.5 second" },
+  { "flash1",  Commands::number( 0, 255, true ), &StatusLedModule::cmdMode, "One double flash in 2 seconds" },
+  { "flash2",  Commands::number( 0, 255, true ), &StatusLedModule::cmdMode, "One double flash per second" },
+  { "off",     Commands::none(),                 &StatusLedModule::cmdMode, "Turn the LED off" },
+  { "on",      Commands::number( 0, 255, true ), &StatusLedModule::cmdMode, "Turn the LED on" },
+  { "toggle1", Commands::number( 0, 255, true ), &StatusLedModule::cmdMode, "1 second on, 1 second off" },
+  { "toggle2", Commands::number( 0, 255, true ), &StatusLedModule::cmdMode, "0.5 second on, 0.5 second off" },
+};
+
 bool StatusLedModule::handleCommand( const String& cmd, const String& args ) {
-  const LEDMode mode = toLEDMode( cmd );
-  uint8_t count = Utils::toByte( args.c_str() );
-  if( count == 0 ) count = 255;
-  oneshot( mode, count );
-  handleCommandResults( cmd, args, toJsonString() );
-  return true;
+  return dispatchCommandTable<COMMAND_TABLE(StatusLedModule, COMMANDS)>( *this, cmd, args );
+}
+
+/* Commands */
+
+void StatusLedModule::cmdMode( const Commands::Args& args ) {
+  oneshot( toLEDMode( args.cmd ), args.number == 0 ? 255 : args.number );
+  handleCommandResults( args.cmd, args.raw, toJsonString() );
 }
 
 /* Private */
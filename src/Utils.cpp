@@ -6,6 +6,8 @@
 #include "Config.h"
 #include "Messages.h"
 #include "Utils.h"
+#include "core/Format.h"
+#include "core/ScratchArena.h"
 
 /* Common static utilities */
 
@@ -218,38 +220,10 @@ String Utils::toString( const uint64_t value ) {
 
 // Strings conversion
 
-std::pair<String,String> Utils::split( const String& str, const char separator ) {
-  int max = str.length() - 1;
-  for( int i = 0; i <= max; i++) {
-    if( str.charAt(i) == separator ) {
-      return std::pair<String,String>( str.substring( 0, i ), str.substring( i+1 ) );
-    }
-  }
-  return std::pair<String,String>( str, "" );
-}
-
-String Utils::format( const char* fmt, const char* arg1 ) {
-  char buffer[64];
-  snprintf( buffer, sizeof(buffer), fmt, arg1 );
-  return buffer;
-}
-
-String Utils::format( const char* fmt, const String& arg1 ) {
-  char buffer[64];
-  snprintf( buffer, sizeof(buffer), fmt, arg1.c_str() );
-  return buffer;
-}
-
-String Utils::format( const char* fmt, const String& arg1, const String& arg2 ) {
-  char buffer[64];
-  snprintf( buffer, sizeof(buffer), fmt, arg1.c_str(), arg2.c_str() );
-  return buffer;
-}
-
 String Utils::formatModuleSettingsTitle( const char* id, const char* name ) {
-  char buffer[64];
-  snprintf( buffer, sizeof(buffer), Messages::TITLE_MODULE_SETTINGS, name );
-  return String( buffer );
+  String s;
+  Format::append( s, Messages::TITLE_MODULE_SETTINGS, name );
+  return s;
 }
 
 /**
@@ -287,13 +261,9 @@ String Utils::toJsonString( const char* key, const bool value ) {
 }
 
 String Utils::toJsonString( const char* key, const char* value ) {
-  char buffer[Config::JSON_MESSAGE_SIZE];
-  if( *value == '{' ) {
-    snprintf( buffer, sizeof(buffer), R"({"%s":%s})", key, value );
-  } else {
-    snprintf( buffer, sizeof(buffer), R"({"%s":"%s"})", key, value );
-  }
-  return String( buffer );
+  String s;
+  Format::append( s, *value == '{' ? R"({"%s":%s})" : R"({"%s":"%s"})", key, value );
+  return s;
 }
 
 String Utils::toJsonString( const char* key, const int value ) {
@@ -303,7 +273,7 @@ String Utils::toJsonString( const char* key, const int value ) {
 }
 
 String Utils::toResultsJson( const String& cmd, const String& args, const String& results ) {
-  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  ScratchJsonDocument json( Config::JSON_MESSAGE_SIZE );
   json["cmd"] = cmd;
   // Payload, i.e. the command arguments, could be optional.
   if( args.length() > 0 ) {
@@ -10,6 +10,9 @@
 #include "str_switch.h"
 #include "Utils.h"
 #include "WebServerModule.h"
+#include "core/Format.h"
+#include "core/ScratchArena.h"
+#include "core/Tokenizer.h"
 
 // HINT: Array to string
 // String strData;
@@ -75,10 +78,10 @@ const String WebServerModule::getModuleWebpage() {
   return makeWebpage( "/module_web_server.html" );
 }
 
-const String WebServerModule::getString( const String& key ) {
-  SWITCH( key.c_str() ) {
+const String WebServerModule::getString( const StringView& key ) {
+  SWITCH( key ) {
     CASE( Config::KEY_EXPORT_CONFIGURATION ): {
-      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+      ScratchJsonDocument json( Config::JSON_MESSAGE_SIZE );
       json["name"] = getStringOption( "Name", Config::WEB_SERVER_NAME );
       json["port"] = getShortOption( "Port", Config::WEB_SERVER_PORT );
       json["auth"] = (bool) getByteOption( "Auth", Config::WEB_AUTH_ENABLED );
@@ -91,8 +94,8 @@ const String WebServerModule::getString( const String& key ) {
   }
 }
 
-ResultData  WebServerModule::setString( const String& key, const String& value ) {
-  SWITCH( key.c_str() ) {
+ResultData  WebServerModule::setString( const StringView& key, const String& value ) {
+  SWITCH( key ) {
     CASE( Config::KEY_IMPORT_CONFIGURATION ):
       return handleConfigImport( value );
     DEFAULT_CASE:
@@ -102,22 +105,12 @@ ResultData  WebServerModule::setString( const String& key, const String& value )
 
 /* Protected methods */
 
+constexpr Commands::Entry<WebServerModule> WebServerModule::COMMANDS[] = {
+  { "debug", Commands::number( 0, 1, true ), &WebServerModule::cmdDebug, "Enable or disable the debug log" },
+};
+
 bool WebServerModule::handleCommand( const String& cmd, const String& args ) {
-  SWITCH( cmd.c_str() ) {
-    // ==========================================
-    // Enables or disables the module debug log.
-    // debug 0/1 - Disable/enable the debug log.
-    // Returns the actual value of debug log parameter.
-    CASE( "debug" ):
-      if( args.length() > 0 ) {
-        flags.debug_log = Utils::toBool( args.c_str() );
-      }
-      handleCommandResults( cmd, args, String( flags.debug_log ));
-      return true;
-    // ==========================================
-    DEFAULT_CASE:
-      return false;
-  }
+  return dispatchCommandTable<COMMAND_TABLE(WebServerModule, COMMANDS)>( *this, cmd, args );
 }
 
 ResultData WebServerModule::handleOption( const String& key, const String& value, Options::Action action ) {
@@ -147,8 +140,8 @@ ResultData WebServerModule::handleOption( const String& key, const String& value
   }
 }
 
-void WebServerModule::resolveTemplateKey( const String& key, String& out ) {
-  SWITCH( key.c_str() ) {
+void WebServerModule::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     CASE( "SYS_NAME" ):
     CASE( "WS_NAME" ):
       out += getStringOption( "Name", Config::WEB_SERVER_NAME );
@@ -176,6 +169,16 @@ void WebServerModule::resolveTemplateKey( const String& key, String& out ) {
   }
 }
 
+/* Commands */
+
+// Enables or disables the module debug log, returns the actual value.
+void WebServerModule::cmdDebug( const Commands::Args& args ) {
+  if( args.present ) {
+    flags.debug_log = args.number;
+  }
+  handleCommandResults( args.cmd, args.raw, String( flags.debug_log ));
+}
+
 /* Private methods */
 
 /**
@@ -258,6 +261,7 @@ WebServerModule::Session* WebServerModule::getSession( struct http_message* hm )
 }
 
 void WebServerModule::eventHandler( struct mg_connection* nc, int ev, void* ev_data ) {
+  Scratch::Scope scratch;
   // ===========================================================================
   // Serve HTTP requests
   if( ev == MG_EV_HTTP_REQUEST ) {
@@ -301,7 +305,7 @@ void WebServerModule::eventHandler( struct mg_connection* nc, int ev, void* ev_d
       // ==================
       // Export the all modules configuration to a JSON file.
       if( mg_vcmp( &hm->uri, "/export_cfg" ) == 0 ) {
-        DynamicJsonDocument doc( Config::JSON_EXPORT_CONFIG_SIZE );
+        ScratchJsonDocument doc( Config::JSON_EXPORT_CONFIG_SIZE );
         JsonObject json = doc.to<JsonObject>();
         // Assemble the complete configuration.
         Modules.iterator( [&json](Module* module) {
@@ -370,7 +374,7 @@ void WebServerModule::eventHandler( struct mg_connection* nc, int ev, void* ev_d
       // Response: [{"id":"module_id","name":"module_name"},{..}]
       if( mg_vcmp( &hm->uri, "/modules" ) == 0 ) {
         // Prepare a json array
-        StaticJsonDocument<Config::JSON_CONFIG_SIZE> json;
+        ScratchJsonDocument json( Config::JSON_CONFIG_SIZE );
         JsonArray array = json.to<JsonArray>();
         // First add core modules.
         uint8_t count = sizeof(CORE_MODULE_IDS) / sizeof(CORE_MODULE_IDS[0]);
@@ -518,7 +522,7 @@ void WebServerModule::eventHandler( struct mg_connection* nc, int ev, void* ev_d
 
       // Try to decode text message as JSON object
       if( buf[0] == '{' ) {
-        StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+        ScratchJsonDocument json( Config::JSON_MESSAGE_SIZE );
         DeserializationError rc = deserializeJson( json, buf );
         if( rc == DeserializationError::Ok ) {
           const String type = json["type"];
@@ -545,9 +549,8 @@ void WebServerModule::eventHandler( struct mg_connection* nc, int ev, void* ev_d
           }
           // Handle commands (JSON format)
           else if( type == "cmd" ) {
-            String payload = json["payload"];
-            payload.trim();
-            dispatchCommand( payload );
+            // The payload points into the message buffer, no copies.
+            dispatchCommand( Tokenizer::trim( json["payload"] | "" ));
           }
         }
       }
@@ -747,9 +750,7 @@ bool WebServerModule::checkPassword( const char* user, const char* pass ) {
 void WebServerModule::debugLog( const char* msg, const mg_str* s ) {
   // Convert mg_str into null-terminated char sequence
   char buf[512];
-  int len = s->len < 511 ? s->len : 511;
-  memcpy( buf, s->p, len );
-  buf[len] = '\0';
+  Format::to( buf, "%.*s", (int) s->len, s->p );
   // Output a string to the log
   Log.verbose( "WS %s %s" CR, msg, buf );
 }
@@ -762,7 +763,7 @@ void WebServerModule::destroySession( Session* s ) {
   memset( s, 0, sizeof(*s) );
 }
 
-void WebServerModule::dispatchCommand( const String& data ) {
+void WebServerModule::dispatchCommand( const StringView& data ) {
   if( data.length() > 0 ) {
     Modules.dispatchCommand( data );
   }
@@ -812,8 +813,8 @@ String WebServerModule::dispatchSaveSettings( const mg_str* body ) {
       return result.details;
     } else {
       // Error: module is not found.
-      char msg[64];
-      snprintf( msg, sizeof(msg), Messages::MODULE_NOT_FOUND, id.c_str() );
+      String msg;
+      Format::append( msg, Messages::MODULE_NOT_FOUND, id.c_str() );
       return msg;
     }
   }
@@ -836,7 +837,7 @@ Module* WebServerModule::findRequestedModule( mg_connection *nc, void* ev_data )
   Module* module = Modules.get( id );
   if( !module ) {
     char msg[64];
-    snprintf( msg, sizeof(msg), "Unknown module %s", id );
+    Format::to( msg, "Unknown module %s", id );
     mg_http_send_error( nc, 404, msg );
     return NULL;
   }
@@ -848,9 +849,9 @@ String WebServerModule::getRequestParameter( mg_connection *nc, http_message* hm
   // Obtain the data key.
   int rc = mg_get_http_var( &hm->body, key, buffer, sizeof(buffer) );
   if( rc <= 0 ) {
-    String msg = Messages::REQUEST_PARAMETER_MISSED;
-    msg += key;
-    mg_http_send_error( nc, 400, msg.c_str() );
+    char msg[64];
+    Format::to( msg, "%s%s", Messages::REQUEST_PARAMETER_MISSED, key );
+    mg_http_send_error( nc, 400, msg );
     return "";
   }
   return buffer;
@@ -859,7 +860,7 @@ String WebServerModule::getRequestParameter( mg_connection *nc, http_message* hm
 String WebServerModule::prepareModuleStatus( Module* const module ) {
   String output;
   const String html = module->getStatusWebpage();
-  DynamicJsonDocument json = DynamicJsonDocument( html.length() + 64 );
+  ScratchJsonDocument json( html.length() + 64 );
   json["type"] = "status";
   json["card"] = String( module->getId() );
   json["html"] = html.c_str();
@@ -881,7 +882,7 @@ void WebServerModule::sendConsoleLog( struct mg_connection* nc, bool broadcast )
   if( nc == NULL ) return;
   Modules.execute( LOG_MODULE, [nc,broadcast](Module* module) {
     // Prepare a JSON message
-    DynamicJsonDocument json( Config::JSON_CONFIG_SIZE * 2 );
+    ScratchJsonDocument json( Config::JSON_CONFIG_SIZE * 2 );
     json["type"] = "console";
     json["payload"] = ((LogManagerModule*) module)->getLogString();
     const String msg = json.as<String>();
@@ -73,8 +73,8 @@ const String WifiModule::getStatusWebpage() {
 
 /* A generic getData/setData interface */
 
-const String WifiModule::getString( const String& key ) {
-  SWITCH( key.c_str() ) {
+const String WifiModule::getString( const StringView& key ) {
+  SWITCH( key ) {
     CASE( Config::KEY_EXPORT_CONFIGURATION ): {
       StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
       json["hostname"]     = getStringOption( "Hostname", Config::WIFI_HOSTNAME );
@@ -94,8 +94,8 @@ const String WifiModule::getString( const String& key ) {
   }
 }
 
-ResultData WifiModule::setString( const String& key, const String& value ) {
-  SWITCH( key.c_str() ) {
+ResultData WifiModule::setString( const StringView& key, const String& value ) {
+  SWITCH( key ) {
     CASE( Config::KEY_IMPORT_CONFIGURATION ):
       return handleConfigImport( value );
     DEFAULT_CASE:
@@ -126,32 +126,14 @@ void WifiModule::setSleepMode( bool enabled ) {
 
 /* Protected */
 
+constexpr Commands::Entry<WifiModule> WifiModule::COMMANDS[] = {
+  { "debug",     Commands::number( 0, 1, true ), &WifiModule::cmdDebug,     "Enable or disable the debug log" },
+  { "manager",   Commands::none(),               &WifiModule::cmdManager,   "Start the WiFi manager" },
+  { "reconnect", Commands::none(),               &WifiModule::cmdReconnect, "Reconnect to the access point" },
+};
+
 bool WifiModule::handleCommand( const String& cmd, const String& args ) {
-  SWITCH( cmd.c_str() ) {
-    // ==========================================
-    // Enables or disables the module debug log.
-    // debug 0/1 - Disable/enable WiFi debug log.
-    // Returns the actual value of debug log parameter.
-    CASE( "debug" ):
-      if( args.length() > 0 ) {
-        setDebugLog( Utils::toBool( args.c_str() ));
-      }
-      handleCommandResults( cmd, args, String( getDebugLog() ));
-      return true;
-    // ==========================================
-    CASE( "reconnect" ):
-      reinitModule();
-      handleCommandResults( cmd, args, Messages::OK );
-      return true;
-    // ==========================================
-    CASE( "manager" ):
-      reconfigure( Config::WifiConfigMethod::WIFI_MANAGER );
-      handleCommandResults( cmd, args, Messages::OK );
-      return true;
-    // ==========================================
-    DEFAULT_CASE:
-      return false;
-  }
+  return dispatchCommandTable<COMMAND_TABLE(WifiModule, COMMANDS)>( *this, cmd, args );
 }
 
 ResultData WifiModule::handleOption( const String& key, const String& value, Options::Action action ) {
@@ -208,8 +190,8 @@ void WifiModule::reinitModule() {
   }
 }
 
-void WifiModule::resolveTemplateKey( const String& key, String& out ) {
-  SWITCH( key.c_str() ) {
+void WifiModule::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     // ==========================================
     // Module template parameters
     CASE( "SSID1" ):      out += getStringOption( "SSID1", Config::WIFI_SSID1 );                    break;
@@ -237,6 +219,26 @@ void WifiModule::resolveTemplateKey( const String& key, String& out ) {
   }
 }
 
+/* Commands */
+
+// Enables or disables the module debug log, returns the actual value.
+void WifiModule::cmdDebug( const Commands::Args& args ) {
+  if( args.present ) {
+    setDebugLog( args.number );
+  }
+  handleCommandResults( args.cmd, args.raw, String( getDebugLog() ));
+}
+
+void WifiModule::cmdManager( const Commands::Args& args ) {
+  reconfigure( Config::WifiConfigMethod::WIFI_MANAGER );
+  handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
+void WifiModule::cmdReconnect( const Commands::Args& args ) {
+  reinitModule();
+  handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
 /* Private */
 
 Config::WifiConfigMethod WifiModule::getConfigMethodOption() {
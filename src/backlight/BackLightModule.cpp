@@ -1,13 +1,22 @@
 #include <ArduinoLog.h>
 #include <ArduinoJson.h>
+#include "Events.h"
 #include "str_switch.h"
 #include "Utils.h"
 #include "backlight/BackLightModule.h"
 #include "backlight/Factory.h"
 #include "backlight/RgbPalette.h"
+#include "core/Tokenizer.h"
+
+BackLightModule* BackLightModule::instance = nullptr;
 
 BackLightModule::BackLightModule() {
   properties.has_module_webpage = true;
+  properties.loop_required = true;
+  properties.tick_100mS_required = true;
+  instance = this;
+  params.load();
+  mg_mgr_init( &manager, NULL );
 
   StaticJsonDocument<Config::JSON_MESSAGE_SIZE> doc;
   DeserializationError rc = deserializeJson( doc, getJsonConfig() );
@@ -18,7 +27,10 @@ BackLightModule::BackLightModule() {
     const uint16_t pixelsCount = json[PIXELS_OPTION_KEY];
     strip = new NeoPixelWrapper( pixelsCount, pin );
     strip->setMaxPowerBudget( getMaxPowerBudget( json ));
+    applyOutputOptions( strip, json );
+    strip->setLayout( getLayoutOption( json, pixelsCount ));
     fixWhiteColor = getFixWhiteOption( json );
+    setupRealtime( json );
   }
   // Instantiate the strip object with default parameters.
   else {
@@ -26,6 +38,10 @@ BackLightModule::BackLightModule() {
     const uint16_t pixelsCount = Config::BACKLIGHT_PIXELS_COUNT;
     strip = new NeoPixelWrapper( pixelsCount, pin );
     strip->setMaxPowerBudget( Config::BACKLIGHT_MAX_POWER_BUDGET );
+    strip->setGamma( Config::BACKLIGHT_GAMMA );
+    strip->setDither( Config::BACKLIGHT_DITHER );
+    strip->setLayout( Backlight::MatrixLayout::makeGeometry( Config::BACKLIGHT_MATRIX_WIDTH, Config::BACKLIGHT_MATRIX_HEIGHT,
+      Config::BACKLIGHT_MATRIX_SERPENTINE, Config::BACKLIGHT_MATRIX_ROTATION, pixelsCount ));
     fixWhiteColor = RgbColor( HtmlColor( 0xFFFFFF ));
     // Store the default module configuration.
     doc.clear();
@@ -33,17 +49,56 @@ BackLightModule::BackLightModule() {
     doc[PIXELS_OPTION_KEY] = pixelsCount;
     doc[MAX_POWER_OPTION_KEY] = Config::BACKLIGHT_MAX_POWER_BUDGET;
     doc[FIX_WHITE_OPTION_KEY] = "0xFFFFFF";
+    doc[GAMMA_OPTION_KEY] = Config::BACKLIGHT_GAMMA;
+    doc[DITHER_OPTION_KEY] = Config::BACKLIGHT_DITHER;
+    doc[REALTIME_OPTION_KEY] = Config::BACKLIGHT_REALTIME;
+    doc[RT_TIMEOUT_OPTION_KEY] = Config::BACKLIGHT_REALTIME_TIMEOUT;
+    doc[WIDTH_OPTION_KEY] = Config::BACKLIGHT_MATRIX_WIDTH;
+    doc[HEIGHT_OPTION_KEY] = Config::BACKLIGHT_MATRIX_HEIGHT;
+    doc[SERPENTINE_OPTION_KEY] = Config::BACKLIGHT_MATRIX_SERPENTINE;
+    doc[ROTATION_OPTION_KEY] = Config::BACKLIGHT_MATRIX_ROTATION;
     setJsonConfig( doc.as<String>() );
   }
 
   // Final setup steps.
   strip->begin();
   reset( true );
+
+  // The realtime input is bound when the network is up.
+  eventBusToken = Bus.listen<ConnectivityEvent>( EventFilter::of( ConnectivityEvent::TYPE_WIFI ), [this](const ConnectivityEvent& event) {
+    if( event.connected ) {
+      bindRealtime();
+    }
+  });
 }
 
 BackLightModule::~BackLightModule() {
+  Bus.unlistenAll( eventBusToken );
+  mg_mgr_free( &manager );
   reset( true );
+  params.persist( true );
+  if( realtime ) delete realtime;
   delete strip;
+  instance = nullptr;
+}
+
+void BackLightModule::loop() {
+  mg_mgr_poll( &manager, 0 );
+  if( realtime ) {
+    if( strip->canShow() && realtime->takeShowRequest() ) {
+      strip->show();
+    }
+    if( realtime->checkTimeout() ) {
+      resumeEffect();
+    }
+  }
+}
+
+void BackLightModule::tick_100mS( uint8_t phase ) {
+  // Effect parameters are written to NVS once they've been idle for a while.
+  if( phase == 0 ) {
+    params.persist( false );
+  }
 }
 
 /* Public virtual */
@@ -52,8 +107,8 @@ const String BackLightModule::getModuleWebpage() {
   return makeWebpage( "/module_backlight.html" );
 }
 
-const String BackLightModule::getString( const String& key ) {
-  SWITCH( key.c_str() ) {
+const String BackLightModule::getString( const StringView& key ) {
+  SWITCH( key ) {
     CASE( Config::KEY_EXPORT_CONFIGURATION ): {
       DynamicJsonDocument doc( Config::JSON_CONFIG_SIZE );
       // Export the module config.
@@ -63,20 +118,16 @@ const String BackLightModule::getString( const String& key ) {
       const uint8_t count = Backlight::Factory::getEffectsCount();
       for( uint8_t i = 1; i < count; i++ ) {
         const String id = Backlight::Factory::getEffectId( i );
-        const String options = Options::getString( "fx", id );
-        if( !options.isEmpty() ) {
-          doc[id] = serialized( options );
-        }
+        doc[id] = serialized( Backlight::ParamsCache::toJson( id, params.get( i )));
       }
       return doc.as<String>();
     }
     DEFAULT_CASE: {
       // Serve the module webpage request to obtain effect options.
-      if( Backlight::Factory::findEffectById( key ) > 0 ) {
-        const String options = Options::getString( "fx", key );
-        return options.isEmpty()
-          ? makeDefaultEffectOptions( key )
-          : options;
+      const String effectId = key;
+      const int8_t index = Backlight::Factory::findEffectById( effectId );
+      if( index > 0 ) {
+        return Backlight::ParamsCache::toJson( effectId, params.get( index ));
       }
       // Unknown key, so return an empty string.
       else {
@@ -86,8 +137,8 @@ const String BackLightModule::getString( const String& key ) {
   }
 }
 
-ResultData BackLightModule::setString( const String& key, const String& value ) {
-  SWITCH( key.c_str() ) {
+ResultData BackLightModule::setString( const StringView& key, const String& value ) {
+  SWITCH( key ) {
     CASE( Config::KEY_IMPORT_CONFIGURATION ):
       //TODO
       //return handleConfigImport( value );
@@ -98,69 +149,18 @@ ResultData BackLightModule::setString( const String& key, const String& value )
 
 /* Protected */
 
-bool BackLightModule::handleCommand( const String& cmd, const String& args ) {
-  SWITCH( cmd.c_str() ) {
-    // ==========================================
-    // Adjust the effect parameters.
-    // payload: JSON object with effect parameters.
-    CASE( "adjust" ): {
-      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> doc;
-      DeserializationError rc = deserializeJson( doc, args );
-
-      if( rc != DeserializationError::Ok ) {
-        handleCommandResults( cmd, args, rc.c_str() );
-        return true;
-      }
+constexpr Commands::Entry<BackLightModule> BackLightModule::COMMANDS[] = {
+  { "adjust",   Commands::text(), &BackLightModule::cmdAdjust,   "Adjust the effect parameters, JSON with the effect ID" },
+  { "fps",      Commands::none(), &BackLightModule::cmdFps,      "Achieved frame rate of the running effect" },
+  { "off",      Commands::none(), &BackLightModule::cmdOff,      "Turn off the strip" },
+  { "on",       Commands::text(), &BackLightModule::cmdOn,       "Turn on the strip with the effect ID" },
+  { "power",    Commands::none(), &BackLightModule::cmdPower,    "The strip current" },
+  { "realtime", Commands::none(), &BackLightModule::cmdRealtime, "Realtime UDP input counters" },
+  { "set",      Commands::text(), &BackLightModule::cmdSet,      "Set a parameter of the running effect, <name> <value>" },
+};
 
-      const JsonObject json = doc.as<JsonObject>();
-      if( !json.containsKey( Backlight::EFFECT_ID_KEY )) {
-        handleCommandResults( cmd, args, Messages::EFFECT_ID_MISSED );
-        return true;
-      }
-
-      const String id = json[Backlight::EFFECT_ID_KEY];
-      reset( lastEffectId != id );
-      lastEffectId = id;
-      effect = Backlight::Factory::createEffect( id, strip, animations );
-
-      if( effect ) {
-        performEffect( args );
-        handleCommandResults( cmd, args, Messages::OK );
-      } else {
-        reset( true );
-        handleCommandResults( cmd, args, Messages::EFFECT_CREATE_FAILED );
-      }
-      return true;
-    }
-    // ==========================================
-    // Turn on the strip.
-    // payload: the effect ID.
-    CASE( "on" ): {
-      // Create an effect.
-      reset( false );
-      effect = Backlight::Factory::createEffect( args, strip, animations );
-      if( !effect ) {
-        handleCommandResults( cmd, args, Messages::EFFECT_CREATE_FAILED );
-      } else {
-        performEffect( Options::getString( "fx", args ));
-        handleCommandResults( cmd, args, Messages::OK );
-      }
-      return true;
-    }
-    // ==========================================
-    // Turn off the strip.
-    CASE( "off" ):
-      reset( true );
-      handleCommandResults( cmd, args, Messages::OK );
-      return true;
-    // ==========================================
-    CASE( "power" ):
-      handleCommandResults( cmd, args, String( strip->getStripCurrent() ));
-      return true;
-    // ==========================================
-    DEFAULT_CASE:
-      return false;
-  }
+bool BackLightModule::handleCommand( const String& cmd, const String& args ) {
+  return dispatchCommandTable<COMMAND_TABLE(BackLightModule, COMMANDS)>( *this, cmd, args );
 }
 
 ResultData BackLightModule::handleOption( const String& key, const String& value, Options::Action action ) {
@@ -190,8 +190,17 @@ ResultData BackLightModule::handleOption( const String& key, const String& value
             reset( true );
             delete strip;
             strip = new NeoPixelWrapper( pixelsCount, pin );
+            strip->setMaxPowerBudget( getMaxPowerBudget( json ));
             strip->begin();
           }
+          applyOutputOptions( strip, json );
+          // 2D effects address pixels through the layout, so the running one is stopped first.
+          const Backlight::MatrixLayout::Geometry geometry = getLayoutOption( json, pixelsCount );
+          if( !strip->getLayout().matches( geometry )) {
+            reset( false );
+            strip->setLayout( geometry );
+          }
+          setupRealtime( json );
           // Save the new config.
           setJsonConfig( value );
         }
@@ -219,14 +228,17 @@ ResultData BackLightModule::handleOption( const String& key, const String& value
         }
         // save
         else if( action == Options::SAVE ) {
-          String id = doc[Backlight::EFFECT_ID_KEY];
-          StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-          json[Backlight::BRIGHTNESS_KEY] = doc[Backlight::BRIGHTNESS_KEY];
-          json[Backlight::COLOR_KEY]      = doc[Backlight::COLOR_KEY];
-          json[Backlight::PALETTE_KEY]    = doc[Backlight::PALETTE_KEY];
-          json[Backlight::INTENSITY_KEY]  = doc[Backlight::INTENSITY_KEY];
-          json[Backlight::SPEED_KEY]      = doc[Backlight::SPEED_KEY];
-          Options::setString( "fx", id, json.as<String>() );
+          // Commands save without verifying, so the value is checked here too.
+          if( rc != DeserializationError::Ok ) {
+            return INVALID_VALUE;
+          }
+          const String id = doc[Backlight::EFFECT_ID_KEY];
+          const int8_t index = Backlight::Factory::findEffectById( id );
+          if( index == -1 ) {
+            return INVALID_VALUE;
+          }
+          Backlight::ParamsCache::readJson( params.get( index ), doc );
+          params.markDirty();
         }
       }
       return {RC_OK, value};
@@ -234,9 +246,15 @@ ResultData BackLightModule::handleOption( const String& key, const String& value
     // ==========================================
     // If the option's key matches the effect ID, consider it as a 'save' command.
     DEFAULT_CASE: {
-      if( Backlight::Factory::findEffectById( key ) > 0 ) {
+      const int8_t index = Backlight::Factory::findEffectById( key );
+      if( index > 0 ) {
         if( action == Options::SAVE ) {
-          Options::setString( "fx", key, value );
+          StaticJsonDocument<Config::JSON_MESSAGE_SIZE> doc;
+          if( deserializeJson( doc, value ) != DeserializationError::Ok ) {
+            return INVALID_VALUE;
+          }
+          Backlight::ParamsCache::readJson( params.get( index ), doc );
+          params.markDirty();
         }
         return {RC_OK, value};
       }
@@ -245,8 +263,8 @@ ResultData BackLightModule::handleOption( const String& key, const String& value
   }
 }
 
-void BackLightModule::resolveTemplateKey( const String& key, String& out ) {
-  SWITCH( key.c_str() ) {
+void BackLightModule::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     CASE( "FxId" ): {
       out += buildEffectsHtmlOptions();
       break;
@@ -266,19 +284,136 @@ void BackLightModule::resolveTemplateKey( const String& key, String& out ) {
   }
 }
 
+/* Commands */
+
+// Adjust the effect parameters.
+// payload: JSON object with effect parameters.
+void BackLightModule::cmdAdjust( const Commands::Args& args ) {
+  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> doc;
+  DeserializationError rc = deserializeJson( doc, args.raw );
+
+  if( rc != DeserializationError::Ok ) {
+    handleCommandResults( args.cmd, args.raw, rc.c_str() );
+    return;
+  }
+
+  const JsonObject json = doc.as<JsonObject>();
+  if( !json.containsKey( Backlight::EFFECT_ID_KEY )) {
+    handleCommandResults( args.cmd, args.raw, Messages::EFFECT_ID_MISSED );
+    return;
+  }
+
+  const String id = json[Backlight::EFFECT_ID_KEY];
+  const int8_t index = Backlight::Factory::findEffectById( id );
+  if( index <= 0 ) {
+    reset( true );
+    handleCommandResults( args.cmd, args.raw, Messages::EFFECT_CREATE_FAILED );
+    return;
+  }
+  Backlight::ParamsCache::readJson( params.get( index ), doc );
+  params.markDirty();
+
+  // The running effect is adjusted in place, otherwise a new effect is started.
+  if( effect && lastEffectId == id ) {
+    applyParams( index );
+  } else {
+    reset( lastEffectId != id );
+    lastEffectId = id;
+    performEffect( index );
+  }
+  handleCommandResults( args.cmd, args.raw, effect ? Messages::OK : Messages::EFFECT_CREATE_FAILED );
+}
+
+// Achieved frame rate of the running effect.
+void BackLightModule::cmdFps( const Commands::Args& args ) {
+  char buf[48];
+  const uint16_t fps = effect ? effect->getFps() : 0;
+  const uint32_t dropped = effect ? effect->getDroppedFrames() : 0;
+  snprintf( buf, sizeof(buf), R"({"fps":%u,"dropped":%lu})", fps, (unsigned long) dropped );
+  handleCommandResults( args.cmd, args.raw, buf );
+}
+
+void BackLightModule::cmdOff( const Commands::Args& args ) {
+  reset( true );
+  handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
+// Turn on the strip.
+// payload: the effect ID.
+void BackLightModule::cmdOn( const Commands::Args& args ) {
+  // Create an effect.
+  reset( false );
+  const int8_t index = Backlight::Factory::findEffectById( args.raw );
+  if( index > 0 ) {
+    lastEffectId = args.raw;
+    performEffect( index );
+  }
+  handleCommandResults( args.cmd, args.raw, effect ? Messages::OK : Messages::EFFECT_CREATE_FAILED );
+}
+
+void BackLightModule::cmdPower( const Commands::Args& args ) {
+  handleCommandResults( args.cmd, args.raw, String( strip->getStripCurrent() ));
+}
+
+// Realtime UDP input counters.
+void BackLightModule::cmdRealtime( const Commands::Args& args ) {
+  if( !realtime ) {
+    handleCommandResults( args.cmd, args.raw, Messages::REALTIME_DISABLED );
+    return;
+  }
+  char buf[96];
+  const Backlight::RealtimeInput::Counters& c = realtime->getCounters();
+  snprintf( buf, sizeof(buf), R"({"active":%s,"received":%lu,"dropped":%lu,"applied":%lu})",
+            realtime->isActive() ? "true" : "false", (unsigned long) c.received, (unsigned long) c.dropped, (unsigned long) c.applied );
+  handleCommandResults( args.cmd, args.raw, buf );
+}
+
+// Set a single parameter of the running effect, e.g. "set speed 120".
+// Used by the web page sliders, so neither JSON nor flash writes are involved.
+void BackLightModule::cmdSet( const Commands::Args& args ) {
+  const int8_t index = Backlight::Factory::findEffectById( lastEffectId );
+  if( !effect || index <= 0 ) {
+    handleCommandResults( args.cmd, args.raw, Messages::EFFECT_ID_MISSED );
+    return;
+  }
+  const auto pair = Tokenizer::split( args.raw );
+  if( !Backlight::ParamsCache::setValue( params.get( index ), pair.first, pair.second )) {
+    handleCommandResults( args.cmd, args.raw, Messages::COMMAND_INVALID_VALUE );
+    return;
+  }
+  params.markDirty();
+  applyParams( index );
+  handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
 /* Private */
 
-void BackLightModule::performEffect( const String& jsonOptions ) {
+void BackLightModule::applyParams( uint8_t index ) {
+  effect->adjust( getEffectParams( index ));
+}
+
+void BackLightModule::performEffect( uint8_t index ) {
+  effect = Backlight::Factory::createEffect( Backlight::Factory::getEffectId( index ), strip, animations );
+  if( !effect ) return;
   // Apply options.
-  effect->setOptions( jsonOptions );
-  if( effect->getColor() == RgbColor( 255,255,255 )) {
-    effect->setColor( fixWhiteColor );
-  }
-  if( effect)
+  effect->setParams( getEffectParams( index ));
   // Perform an effect.
   effect->perform();
 }
 
+/**
+ * Cached parameters of the effect with the "white" color replaced by the fixed white one.
+ */
+Backlight::EffectParams BackLightModule::getEffectParams( uint8_t index ) {
+  Backlight::EffectParams p = params.get( index );
+  if( p.r == 255 && p.g == 255 && p.b == 255 ) {
+    p.r = fixWhiteColor.R;
+    p.g = fixWhiteColor.G;
+    p.b = fixWhiteColor.B;
+  }
+  return p;
+}
+
 void BackLightModule::reset( bool resetStrip ) {
   animations.StopAll();
 
@@ -293,6 +428,82 @@ void BackLightModule::reset( bool resetStrip ) {
   }
 }
 
+/**
+ * (Re)create the realtime input with the module JSON config.
+ */
+void BackLightModule::setupRealtime( const JsonObject& json ) {
+  const char* name = json.containsKey( REALTIME_OPTION_KEY ) ? json[REALTIME_OPTION_KEY].as<const char*>() : Config::BACKLIGHT_REALTIME;
+  const uint16_t timeout = json.containsKey( RT_TIMEOUT_OPTION_KEY ) ? json[RT_TIMEOUT_OPTION_KEY].as<uint16_t>() : Config::BACKLIGHT_REALTIME_TIMEOUT;
+  const uint16_t universe = json.containsKey( UNIVERSE_OPTION_KEY ) ? json[UNIVERSE_OPTION_KEY].as<uint16_t>() : Config::BACKLIGHT_E131_UNIVERSE;
+
+  if( realtimeConnection ) {
+    realtimeConnection->flags |= MG_F_CLOSE_IMMEDIATELY;
+    realtimeConnection = nullptr;
+  }
+  if( realtime ) {
+    delete realtime;
+    realtime = nullptr;
+  }
+
+  const Backlight::RealtimeInput::Protocol protocol = Backlight::RealtimeInput::toProtocol( name );
+  if( protocol != Backlight::RealtimeInput::NONE ) {
+    realtime = new Backlight::RealtimeInput( strip, protocol, timeout, universe );
+    if( State.wifiConnected() ) {
+      bindRealtime();
+    }
+  }
+}
+
+void BackLightModule::bindRealtime() {
+  if( !realtime || realtimeConnection ) return;
+  const String address = "udp://" + String( realtime->getPort() );
+  realtimeConnection = mg_bind( &manager, address.c_str(), [](mg_connection* nc, int ev, void* data) {
+    instance->realtimeEventHandler( nc, ev, data );
+  });
+  if( realtimeConnection ) {
+    Log.notice( "Backlight realtime input at %s" CR, address.c_str() );
+  } else {
+    Log.error( "Backlight realtime bind failed %s" CR, address.c_str() );
+  }
+}
+
+void BackLightModule::realtimeEventHandler( mg_connection* nc, int ev, void* ev_data ) {
+  if( ev == MG_EV_RECV ) {
+    mbuf* io = &nc->recv_mbuf;
+    if( realtime ) {
+      const bool wasActive = realtime->isActive();
+      if( realtime->receive( (const uint8_t*) io->buf, io->len ) && !wasActive ) {
+        suspendEffect();
+      }
+    }
+    mbuf_remove( io, io->len );
+  }
+}
+
+/**
+ * Stop the running effect while the strip is driven by the realtime input.
+ */
+void BackLightModule::suspendEffect() {
+  if( effect ) {
+    suspendedEffectId = lastEffectId;
+    reset( false );
+  }
+}
+
+/**
+ * Realtime frames are timed out, fall back to the effect which was running before.
+ */
+void BackLightModule::resumeEffect() {
+  const int8_t index = Backlight::Factory::findEffectById( suspendedEffectId );
+  suspendedEffectId = "";
+  if( index > 0 ) {
+    performEffect( index );
+  } else {
+    strip->clearTo( RgbColor( 0 ));
+    strip->show();
+  }
+}
+
 String BackLightModule::buildEffectsHtmlOptions() {
   String out;
   uint8_t count = Backlight::Factory::getEffectsCount();
@@ -331,6 +542,21 @@ void BackLightModule::appendOption( String& out, const String& id, const String&
   out += buf;
 }
 
+void BackLightModule::applyOutputOptions( NeoPixelWrapper* strip, const JsonObject& json ) {
+  const float gamma = json.containsKey( GAMMA_OPTION_KEY ) ? json[GAMMA_OPTION_KEY].as<float>() : Config::BACKLIGHT_GAMMA;
+  const bool dither = json.containsKey( DITHER_OPTION_KEY ) ? json[DITHER_OPTION_KEY].as<bool>() : Config::BACKLIGHT_DITHER;
+  strip->setGamma( gamma );
+  strip->setDither( dither );
+}
+
+Backlight::MatrixLayout::Geometry BackLightModule::getLayoutOption( const JsonObject& json, uint16_t pixelsCount ) {
+  const uint16_t width = json.containsKey( WIDTH_OPTION_KEY ) ? json[WIDTH_OPTION_KEY].as<uint16_t>() : Config::BACKLIGHT_MATRIX_WIDTH;
+  const uint16_t height = json.containsKey( HEIGHT_OPTION_KEY ) ? json[HEIGHT_OPTION_KEY].as<uint16_t>() : Config::BACKLIGHT_MATRIX_HEIGHT;
+  const bool serpentine = json.containsKey( SERPENTINE_OPTION_KEY ) ? json[SERPENTINE_OPTION_KEY].as<bool>() : Config::BACKLIGHT_MATRIX_SERPENTINE;
+  const uint16_t rotation = json.containsKey( ROTATION_OPTION_KEY ) ? json[ROTATION_OPTION_KEY].as<uint16_t>() : Config::BACKLIGHT_MATRIX_ROTATION;
+  return Backlight::MatrixLayout::makeGeometry( width, height, serpentine, rotation, pixelsCount );
+}
+
 RgbColor BackLightModule::getFixWhiteOption( const JsonObject& json ) {
   if( json.containsKey( FIX_WHITE_OPTION_KEY )) {
     const char* value = json[FIX_WHITE_OPTION_KEY];
@@ -350,14 +576,3 @@ uint16_t BackLightModule::getMaxPowerBudget( const JsonObject& json ) {
     return Config::BACKLIGHT_MAX_POWER_BUDGET;
   }
 }
-
-String BackLightModule::makeDefaultEffectOptions( const String& _id ) {
-  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-  json[Backlight::EFFECT_ID_KEY]  = _id;
-  json[Backlight::BRIGHTNESS_KEY] = Backlight::DEFAULT_BRIGHTNESS;
-  json[Backlight::COLOR_KEY]      = "#FFFFFF";
-  json[Backlight::PALETTE_KEY]    = "Default";
-  json[Backlight::SPEED_KEY]      = Backlight::DEFAULT_SPEED;
-  json[Backlight::INTENSITY_KEY]  = Backlight::DEFAULT_INTENSITY;
-  return json.as<String>();
-}
@@ -10,16 +10,16 @@ ColorTwinklesEffect::ColorTwinklesEffect( NeoPixelWrapper& strip, NeoPixelAnimat
 }
 
 void ColorTwinklesEffect::perform() {
+  startFrames();
+}
+
+void ColorTwinklesEffect::renderFrame( const FrameTime& time ) {
+  // Speed may be adjusted while the effect is running.
   fadeUpAmount = 10 + (speed / 4);
   fadeDownAmount = 5 + (speed / 7);
-
-  animator.StartAnimation( 0, FRAMETIME, [this](const AnimationParam& param) {
-    if( param.state == AnimationState_Completed ) {
-      draw();
-      animator.RestartAnimation( 0 );
-    }
-  });
-  startTicker();
+  for( uint8_t i = 0; i < time.steps; i++ ) {
+    draw();
+  }
 }
 
 void ColorTwinklesEffect::draw() {
@@ -10,18 +10,17 @@ CometEffect::CometEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator )
 }
 
 void CometEffect::perform() {
-  animator.StartAnimation( 0, FRAMETIME, [this](const AnimationParam& param) {
-    if( param.state == AnimationState_Completed ) {
-      uint16_t counter = millis() * (speed >>3) + 1;
-      uint16_t index = counter * strip.getPixelsCount() >> 16;
-      fadeOut( intensity );
+  startFrames();
+}
 
-      uint8_t i = map( index, 0, strip.getPixelsCount() - 1, 0, 255 );
-      RgbColor c = Utils::colorFromPalette( *palette, i, 255, NOBLEND );
-      strip.setPixelColor( index, c );
+void CometEffect::renderFrame( const FrameTime& time ) {
+  uint16_t counter = time.elapsed * (speed >>3) + 1;
+  uint16_t index = counter * strip.getPixelsCount() >> 16;
+  for( uint8_t i = 0; i < time.steps; i++ ) {
+    fadeOut( intensity );
+  }
 
-      animator.RestartAnimation( 0 );
-    }
-  });
-  startTicker();
+  uint8_t i = map( index, 0, strip.getPixelsCount() - 1, 0, 255 );
+  RgbColor c = Utils::colorFromPalette( *palette, i, 255, NOBLEND );
+  strip.setPixelColor( index, c );
 }
\ No newline at end of file
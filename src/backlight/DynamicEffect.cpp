@@ -22,6 +22,77 @@ RgbPalette16* DynamicEffect::createPalette( const String& id ) {
   }
 }
 
+void DynamicEffect::startFrames() {
+  const int64_t now = esp_timer_get_time();
+  startTime = now;
+  lastFrameTime = now - FRAME_INTERVAL_US;      // The first frame is due immediately.
+  stepAccumulator = 0;
+  fpsWindowStart = now;
+  fpsFrames = 0;
+  fps = 0;
+  droppedFrames = 0;
+  framesEnabled = true;
+  startTicker();
+}
+
+void DynamicEffect::stopFrames() {
+  framesEnabled = false;
+  stopTicker();
+}
+
+/**
+ * Render the next frame if it's due. Frames are rendered no faster than FRAMETIME and
+ * only when the strip is ready to accept data, so the achieved rate is whatever the
+ * output pipeline sustains. When frames are late, the effect receives the real elapsed
+ * time instead of being replayed frame by frame; steps above MAX_CATCHUP_STEPS are dropped.
+ */
+void DynamicEffect::nextFrame( int64_t now ) {
+  const uint32_t delta = now - lastFrameTime;
+  if( delta < FRAME_INTERVAL_US || !strip.canShow() ) {
+    return;
+  }
+  lastFrameTime = now;
+
+  stepAccumulator += delta;
+  uint32_t steps = stepAccumulator / FRAME_INTERVAL_US;
+  stepAccumulator -= steps * FRAME_INTERVAL_US;
+  if( steps > MAX_CATCHUP_STEPS ) {
+    droppedFrames += steps - MAX_CATCHUP_STEPS;
+    steps = MAX_CATCHUP_STEPS;
+  }
+
+  const FrameTime time = { (uint32_t)((now - startTime) / 1000), delta, (uint8_t) steps };
+  renderFrame( time );
+  strip.show();
+  updatePalette();
+
+  // Measure the achieved frame rate.
+  fpsFrames++;
+  const int64_t window = now - fpsWindowStart;
+  if( window >= FPS_WINDOW_US ) {
+    fps = (uint32_t)(fpsFrames * 1000000ULL / window);
+    fpsFrames = 0;
+    fpsWindowStart = now;
+  }
+}
+
+void DynamicEffect::updatePalette() {
+  if( pendingPalette >= 0 ) {
+    paletteId = RgbPalette16::getPaletteId( pendingPalette );
+    pendingPalette = -1;
+    if( palette ) delete palette;
+    palette = createPalette( paletteId );
+    lastPaletteChange = millis();
+  }
+  else if( paletteId == "random" ) {
+    if( millis() - lastPaletteChange > 1000 + ((uint32_t)(255-intensity)) * 100 ) {
+      if( palette ) delete palette;
+      palette = createPalette( paletteId );
+      lastPaletteChange = millis();
+    }
+  }
+}
+
 /*
 void WS2812FX::handle_palette(void)
 {
@@ -4,39 +4,6 @@
 
 using namespace Backlight;
 
-/* Effect public */
-
-const String Effect::getOptions() {
-  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> doc;
-  // brightness option
-  doc[BRIGHTNESS_KEY] = strip.getBrightness();
-  // color option
-  if( capabilities.hasColor ) {
-    char buf[8];
-    HtmlColor html = HtmlColor( color );
-    html.ToNumericalString( buf, sizeof(buf) );
-    doc[COLOR_KEY] = buf;
-  }
-  // intensity option
-  if( capabilities.hasIntensity ) {
-    doc[INTENSITY_KEY] = intensity;
-  }
-  // speed option
-  if( capabilities.hasSpeed ) {
-    doc[SPEED_KEY] = speed;
-  }
-  return doc.as<String>();
-}
-
-void Effect::setOptions( const String& json ) {
-  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> doc;
-  DeserializationError rc = deserializeJson( doc, json );
-  if( rc == DeserializationError::Ok && doc.size() > 0 ) {
-    readOptions( doc );
-  }
-}
-
-
 /* Effect protected */
 
 /*
@@ -94,25 +61,16 @@ void Effect::fadeOut( uint8_t rate ) {
   }
 }
 
-void Effect::readOptions( const JsonDocument& doc ) {
-  // brightness option
-  if( doc.containsKey( BRIGHTNESS_KEY )) {
-    const uint8_t v = doc[BRIGHTNESS_KEY];
-    strip.setBrightness( v );
-  }
-  // color option: convert hex string to RgbColor
-  if( capabilities.hasColor && doc.containsKey( COLOR_KEY )) {
-    HtmlColor html;
-    html.Parse<HtmlShortColorNames>( doc[COLOR_KEY].as<String>() );
-    color = RgbColor( html );
+void Effect::readParams( const EffectParams& params ) {
+  strip.setBrightness( params.bright );
+  if( capabilities.hasColor ) {
+    color = RgbColor( params.r, params.g, params.b );
   }
-  // intensity option
-  if( capabilities.hasIntensity && doc.containsKey( INTENSITY_KEY )) {
-    intensity = doc[INTENSITY_KEY];
+  if( capabilities.hasIntensity ) {
+    intensity = params.intensity;
   }
-  // speed option
-  if( capabilities.hasSpeed && doc.containsKey( SPEED_KEY )) {
-    speed = doc[SPEED_KEY];
+  if( capabilities.hasSpeed ) {
+    speed = params.speed;
   }
 }
 
@@ -10,6 +10,9 @@
 #include "backlight/GlitterEffect.h"
 #include "backlight/CometEffect.h"
 #include "backlight/Noise1Effect.h"
+#include "backlight/Noise2DEffect.h"
+#include "backlight/Rain2DEffect.h"
+#include "backlight/Ripple2DEffect.h"
 
 using namespace Backlight;
 
@@ -27,6 +30,9 @@ Effect* Factory::createEffect( const String& id, NeoPixelWrapper* strip, NeoPixe
     case 8:      return new GlitterEffect( *strip, animations );
     case 9:      return new CometEffect( *strip, animations );
     case 10:     return new Noise1Effect( *strip, animations );
+    case 11:     return new Noise2DEffect( *strip, animations );
+    case 12:     return new Rain2DEffect( *strip, animations );
+    case 13:     return new Ripple2DEffect( *strip, animations );
     default:     return nullptr;
   }
 }
@@ -13,13 +13,13 @@ FireworksEffect::FireworksEffect( NeoPixelWrapper& strip, NeoPixelAnimator& anim
 void FireworksEffect::perform() {
   aux1 = UINT16_MAX;
   aux2 = UINT16_MAX;
-  animator.StartAnimation( 0, FRAMETIME, [this](const AnimationParam& param) {
-    if( param.state == AnimationState_Completed ) {
-      drawFireworks();
-      animator.RestartAnimation( 0 );
-    }
-  });
-  startTicker();
+  startFrames();
+}
+
+void FireworksEffect::renderFrame( const FrameTime& time ) {
+  for( uint8_t i = 0; i < time.steps; i++ ) {
+    drawFireworks();
+  }
 }
 
 void FireworksEffect::drawFireworks() {
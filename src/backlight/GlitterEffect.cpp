@@ -10,22 +10,22 @@ GlitterEffect::GlitterEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator
 }
 
 void GlitterEffect::perform() {
-  animator.StartAnimation( 0, FRAMETIME, [this](const AnimationParam& param) {
-    if( param.state == AnimationState_Completed ) {
-      drawPalette();
-      if( intensity > random( 0, 255 )) {
-        strip.setPixelColor( random( 0, strip.getPixelsCount() - 1 ), RgbColor( 255, 255, 255 ));
-      }
-      animator.RestartAnimation( 0 );
+  startFrames();
+}
+
+void GlitterEffect::renderFrame( const FrameTime& time ) {
+  drawPalette( time.elapsed );
+  for( uint8_t i = 0; i < time.steps; i++ ) {
+    if( intensity > random( 0, 255 )) {
+      strip.setPixelColor( random( 0, strip.getPixelsCount() - 1 ), RgbColor( 255, 255, 255 ));
     }
-  });
-  startTicker();
+  }
 }
 
-void GlitterEffect::drawPalette() {
+void GlitterEffect::drawPalette( uint32_t elapsed ) {
   uint16_t counter = 0;
   if( speed != 0 ) {
-    counter = (millis() * ((speed >> 3) + 1)) & 0xFFFF;
+    counter = (elapsed * ((speed >> 3) + 1)) & 0xFFFF;
     counter = counter >> 8;
   }
 
@@ -0,0 +1,50 @@
+#include "backlight/Matrix2DEffect.h"
+#include "backlight/utils.h"
+
+using namespace Backlight;
+
+/**
+ * Blurs the matrix content in both directions, rows first.
+ */
+void Matrix2DEffect::blur2d( uint8_t amount ) {
+  for( uint16_t y = 0; y < height; y++ ) {
+    blurLine( layout.row( y ), width, 1, amount );
+  }
+  for( uint16_t x = 0; x < width; x++ ) {
+    blurLine( layout.row( 0 ) + x, height, width, amount );
+  }
+}
+
+/**
+ * Moves every row one line down. The top row keeps its content.
+ */
+void Matrix2DEffect::shiftDown() {
+  for( uint16_t y = height - 1; y > 0; y-- ) {
+    const uint16_t* dst = layout.row( y );
+    const uint16_t* src = layout.row( y - 1 );
+    for( uint16_t x = 0; x < width; x++ ) {
+      strip.setPixelColor( dst[x], strip.getPixelColor( src[x] ));
+    }
+  }
+}
+
+/*
+ * Blurs a single row or column, the same way as Effect::blur() does.
+ */
+void Matrix2DEffect::blurLine( const uint16_t* index, uint16_t count, uint16_t stride, uint8_t amount ) {
+  const uint8_t keep = 255 - amount;
+  const uint8_t seep = amount >> 1;
+  RgbColor carryover = RgbColor( 0, 0, 0 );
+
+  for( uint16_t i = 0; i < count; i++, index += stride ) {
+    const RgbColor c = strip.getPixelColor( *index );
+    const RgbColor part = Utils::nscale8x3( c, seep );
+    const RgbColor cur = Utils::sumColors( Utils::nscale8x3( c, keep ), carryover );
+    if( i > 0 ) {
+      const uint16_t prev = *(index - stride);
+      strip.setPixelColor( prev, Utils::sumColors( strip.getPixelColor( prev ), part ));
+    }
+    strip.setPixelColor( *index, cur );
+    carryover = part;
+  }
+}
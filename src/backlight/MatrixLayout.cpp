@@ -0,0 +1,60 @@
+#include "backlight/MatrixLayout.h"
+
+using namespace Backlight;
+
+/**
+ * Build the XY to strip index table. Returns false if the geometry is the same as
+ * the current one, so the table is left as is.
+ */
+bool MatrixLayout::configure( const Geometry& g ) {
+  if( !table.empty() && matches( g )) {
+    return false;
+  }
+  geometry = g;
+  const bool swap = g.rotation == ROTATE_90 || g.rotation == ROTATE_270;
+  width = swap ? g.height : g.width;
+  height = swap ? g.width : g.height;
+  table.assign( (uint32_t) width * height, 0 );
+
+  for( uint16_t y = 0; y < height; y++ ) {
+    for( uint16_t x = 0; x < width; x++ ) {
+      // Logical to physical coordinates.
+      uint16_t px, py;
+      switch( g.rotation ) {
+        case ROTATE_90:   px = y;                  py = g.height - 1 - x;  break;
+        case ROTATE_180:  px = g.width - 1 - x;    py = g.height - 1 - y;  break;
+        case ROTATE_270:  px = g.width - 1 - y;    py = x;                 break;
+        default:          px = x;                  py = y;                 break;
+      }
+      if( g.serpentine && (py & 1) ) {
+        px = g.width - 1 - px;
+      }
+      table[y * width + x] = py * g.width + px;
+    }
+  }
+  return true;
+}
+
+bool MatrixLayout::matches( const Geometry& g ) const {
+  return g.width == geometry.width && g.height == geometry.height
+      && g.serpentine == geometry.serpentine && g.rotation == geometry.rotation;
+}
+
+/**
+ * Make the geometry from the configuration values. A missed or invalid size falls back
+ * to a single row of all strip pixels, so the 2D effects still run on a plain strip.
+ */
+MatrixLayout::Geometry MatrixLayout::makeGeometry( uint16_t width, uint16_t height, bool serpentine, uint16_t degrees, uint16_t pixelsCount ) {
+  if( width == 0 || height == 0 || (uint32_t) width * height > pixelsCount ) {
+    width = pixelsCount;
+    height = 1;
+  }
+  Rotation rotation;
+  switch( degrees ) {
+    case 90:   rotation = ROTATE_90;  break;
+    case 180:  rotation = ROTATE_180; break;
+    case 270:  rotation = ROTATE_270; break;
+    default:   rotation = ROTATE_0;   break;
+  }
+  return { width, height, serpentine, rotation };
+}
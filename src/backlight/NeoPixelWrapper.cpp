@@ -1,3 +1,5 @@
+#include <math.h>
+#include <string.h>
 #include "Config.h"
 #include "backlight/NeoPixelWrapper.h"
 
@@ -5,10 +7,15 @@
 // Each LED can draw up 195075 "power units" (approx. 53mA).
 // One PU is the power it takes to have 1 channel 1 step brighter per brightness step
 // so A=2,R=255,G=0,B=0 would use 510 PU per LED (1mA is about 3700 PU)
+// The power is summed over the output values while the frame is rendered. The limiter
+// scale found for this frame is used by the next one; the frame is rendered once more
+// only when it exceeds the budget.
 void NeoPixelWrapper::show() {
+  const uint16_t pixelsCount = frame.size();
+  uint32_t powerSum = render();
+
   if( maxPowerBudget > 0 ) {        // zero turns off calculation
     uint32_t powerBudget = (maxPowerBudget - MCU_POWER_CONSUMPTION) * POWER_UNITS_PER_MA;
-    uint16_t pixelsCount = strip.PixelCount();
 
     // each LED uses about 1mA in standby, exclude that from power budget
     if( powerBudget > POWER_UNITS_PER_MA * pixelsCount ) {
@@ -17,49 +24,90 @@ void NeoPixelWrapper::show() {
       powerBudget = 0;
     }
 
-    // sum up the usage of each LED
-    uint32_t powerSum = 0;
-    for( uint16_t i = 0; i < pixelsCount; i++ ) {
-      RgbColor c = strip.GetPixelColor( i );
-      if( Config::BACKLIGHT_WS8212B_ECO ) {
-        powerSum += (c.R + c.G + c.B) / 2;
-      } else {
-        powerSum += (c.R + c.G + c.B);
+    // scale brightness to stay in current limit
+    if( powerSum > 0 ) {
+      const uint32_t limit = (uint64_t)(powerLimit + 1) * powerBudget / powerSum;
+      powerLimit = limit > 255 ? 255 : (limit > 0 ? limit - 1 : 0);
+      if( powerSum > powerBudget ) {
+        powerSum = render();
       }
-    }
-
-    uint32_t powerSum0 = powerSum;
-    powerSum *= brightness;
-
-    // scale brightness down to stay in current limit
-    if( powerSum > powerBudget ) {
-      float scale = (float)powerBudget / (float)powerSum;
-      uint16_t scaleI = scale * 255;
-      uint8_t scaleB = (scaleI > 255) ? 255 : scaleI;
-
-      // scale one byte by a second one, which is treated as
-      // the numerator of a fraction whose denominator is 256
-      // In other words, it computes i * (scale / 256)
-      uint8_t newBrightness = ((uint16_t)brightness * (uint16_t)scaleB ) >> 8;
-
-      strip.SetBrightness( newBrightness );
-      currentMilliampers = (powerSum0 * newBrightness) / POWER_UNITS_PER_MA;
     } else {
-      currentMilliampers = powerSum / POWER_UNITS_PER_MA;
-      strip.SetBrightness( brightness );
+      powerLimit = 255;
     }
+
+    currentMilliampers = powerSum / POWER_UNITS_PER_MA;
     // add power of ESP and LED standby power back to estimate
     currentMilliampers += MCU_POWER_CONSUMPTION;
     currentMilliampers += pixelsCount;
   } else {
+    powerLimit = 255;
     currentMilliampers = 0;
   }
   strip.Show();
 }
 
+/**
+ * Write raw R,G,B channel values into the frame buffer starting from the given channel.
+ * Values beyond the end of the strip are ignored.
+ */
+void NeoPixelWrapper::setChannels( uint32_t channel, const uint8_t* data, size_t count ) {
+  static_assert( sizeof(RgbColor) == 3, "RgbColor must be packed R,G,B" );
+  const size_t size = frame.size() * 3;
+  if( channel >= size ) return;
+  if( count > size - channel ) count = size - channel;
+  memcpy( reinterpret_cast<uint8_t*>( frame.data() ) + channel, data, count );
+}
+
 void NeoPixelWrapper::setBrightness( uint8_t value ) {
   if( brightness == value ) return;
   brightness = value;
-  strip.SetBrightness( value );
   show();
-}
\ No newline at end of file
+}
+
+/**
+ * Build the gamma lookup table, 1.0 means linear output.
+ */
+void NeoPixelWrapper::setGamma( float gamma ) {
+  if( gamma <= 0 ) gamma = 1.0;
+  for( uint16_t i = 0; i < 256; i++ ) {
+    gammaTable[i] = (uint16_t)( powf( i / 255.0f, gamma ) * 65535.0f + 0.5f );
+  }
+}
+
+/**
+ * The output stage: gamma correction, brightness and temporal dithering in a single
+ * fixed-point pass from the frame buffer into the strip data. Values are kept in 16 bits
+ * until the output; the dropped low byte is carried to the next frame per channel.
+ * @return the estimated power of the rendered frame, in power units.
+ */
+uint32_t NeoPixelWrapper::render() {
+  // 16-bit brightness multiplier, 256 means full scale.
+  const uint32_t scale = brightness ? ((uint32_t)brightness * (powerLimit + 1) >> 8) + 1 : 0;
+  const uint8_t keep = ditherEnabled ? 0xFF : 0x00;
+  const uint16_t pixelsCount = frame.size();
+  const RgbColor* src = frame.data();
+  uint8_t* residual = dither.data();
+  uint8_t* out = strip.Pixels();
+  uint32_t outputSum = 0;
+
+  for( uint16_t i = 0; i < pixelsCount; i++, src++ ) {
+    // NeoGrbFeature byte order.
+    const uint8_t channels[3] = { src->G, src->R, src->B };
+    for( uint8_t c = 0; c < 3; c++ ) {
+      uint32_t v = ((gammaTable[channels[c]] * scale) >> 8) + *residual;
+      // With dithering disabled the residual stays at 0x80, i.e. plain rounding.
+      *residual = (v & keep) | (0x80 & ~keep);
+      v >>= 8;
+      if( v > 255 ) v = 255;
+      *out++ = v;
+      residual++;
+      outputSum += v;
+    }
+  }
+  strip.Dirty();
+
+  if( Config::BACKLIGHT_WS8212B_ECO ) {
+    outputSum /= 2;
+  }
+  return outputSum * 255;
+}
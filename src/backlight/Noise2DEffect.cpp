@@ -0,0 +1,31 @@
+#include "backlight/Noise2DEffect.h"
+#include "backlight/utils.h"
+
+using namespace Backlight;
+
+Noise2DEffect::Noise2DEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator )
+  : Matrix2DEffect(strip, animator) {
+  capabilities.hasSpeed = true;
+}
+
+void Noise2DEffect::perform() {
+  startFrames();
+}
+
+void Noise2DEffect::renderFrame( const FrameTime& time ) {
+  step += (1 + speed / 16) * time.steps;
+
+  const uint32_t shift_x = Utils::beatsin8( 11 ) * scale / 16;    // the x position of the noise field swings @ 11 bpm
+  const uint32_t shift_y = step * 8;                               // the y position becomes slowly incremented
+  const uint32_t real_z = step * 4;                                // the z position becomes quickly incremented
+
+  uint32_t real_y = shift_y;
+  for( uint16_t y = 0; y < height; y++, real_y += scale ) {
+    const uint16_t* index = layout.row( y );
+    uint32_t real_x = shift_x;
+    for( uint16_t x = 0; x < width; x++, real_x += scale ) {
+      const uint8_t noise = Utils::inoise16( real_x, real_y, real_z ) >> 8;
+      strip.setPixelColor( index[x], Utils::colorFromPalette( *palette, Utils::sin8( noise * 3 ), 255, LINEARBLEND ));
+    }
+  }
+}
@@ -0,0 +1,126 @@
+#include <ArduinoLog.h>
+#include "Config.h"
+#include "ModuleId.h"
+#include "Options.h"
+#include "str_switch.h"
+#include "backlight/Effect.h"
+#include "backlight/ParamsCache.h"
+#include "backlight/RgbPalette.h"
+
+using namespace Backlight;
+
+/**
+ * Load parameters of all effects. If the blob isn't stored yet, it's built once from
+ * the legacy per-effect JSON options ("fx" + effect ID). Effects added after the blob
+ * has been stored get default parameters.
+ */
+void ParamsCache::load() {
+  const uint8_t count = Factory::getEffectsCount();
+  const size_t size = Options::getBlob( BACKLIGHT_MODULE, BLOB_OPTION_KEY, entries, sizeof(entries) );
+  if( size > 0 && size % sizeof(EffectParams) == 0 ) {
+    for( uint8_t i = size / sizeof(EffectParams); i < count; i++ ) {
+      entries[i] = defaults();
+      dirty = true;
+    }
+    if( dirty ) markDirty();
+    return;
+  }
+
+  for( uint8_t i = 0; i < count; i++ ) {
+    entries[i] = defaults();
+    if( i == 0 ) continue;
+    const String options = Options::getString( "fx", Factory::getEffectId( i ));
+    if( !options.isEmpty() ) {
+      StaticJsonDocument<Config::JSON_MESSAGE_SIZE> doc;
+      if( deserializeJson( doc, options ) == DeserializationError::Ok ) {
+        readJson( entries[i], doc );
+      }
+    }
+  }
+  Log.notice( "FX params are migrated to a blob" CR );
+  markDirty();
+  persist( true );
+}
+
+/**
+ * Write the table to NVS if it's modified and no changes were made for PERSIST_DELAY.
+ * @return true if the table has been written.
+ */
+bool ParamsCache::persist( bool force ) {
+  if( !dirty ) return false;
+  if( !force && millis() - lastChange < PERSIST_DELAY ) return false;
+  Options::setBlob( BACKLIGHT_MODULE, BLOB_OPTION_KEY, entries, sizeof(entries) );
+  dirty = false;
+  return true;
+}
+
+EffectParams ParamsCache::defaults() {
+  EffectParams p;
+  p.bright    = DEFAULT_BRIGHTNESS;
+  p.speed     = DEFAULT_SPEED;
+  p.intensity = DEFAULT_INTENSITY;
+  p.palette   = 1;                    // "default"
+  p.r = p.g = p.b = 255;
+  p.spare     = 0;
+  return p;
+}
+
+/**
+ * Update parameters with values found in JSON document. Missed keys remain unchanged.
+ */
+bool ParamsCache::readJson( EffectParams& params, const JsonDocument& doc ) {
+  bool changed = false;
+  for( const char* key : { BRIGHTNESS_KEY, COLOR_KEY, INTENSITY_KEY, PALETTE_KEY, SPEED_KEY }) {
+    if( doc.containsKey( key )) {
+      changed |= setValue( params, key, doc[key].as<String>() );
+    }
+  }
+  return changed;
+}
+
+/**
+ * Update a single parameter by its JSON key.
+ * @return true if the key is known and the value is valid.
+ */
+bool ParamsCache::setValue( EffectParams& params, const String& key, const String& value ) {
+  SWITCH( key.c_str() ) {
+    CASE( BRIGHTNESS_KEY ):
+      params.bright = value.toInt();
+      return true;
+    CASE( COLOR_KEY ): {
+      HtmlColor html;
+      if( html.Parse<HtmlShortColorNames>( value ) == 0 ) return false;
+      const RgbColor c = RgbColor( html );
+      params.r = c.R;
+      params.g = c.G;
+      params.b = c.B;
+      return true;
+    }
+    CASE( INTENSITY_KEY ):
+      params.intensity = value.toInt();
+      return true;
+    CASE( PALETTE_KEY ): {
+      const int8_t index = RgbPalette16::findPaletteById( value );
+      params.palette = index > 0 ? index : 1;
+      return true;
+    }
+    CASE( SPEED_KEY ):
+      params.speed = value.toInt();
+      return true;
+    DEFAULT_CASE:
+      return false;
+  }
+}
+
+String ParamsCache::toJson( const String& effectId, const EffectParams& params ) {
+  char color[8];
+  snprintf( color, sizeof(color), "#%02X%02X%02X", params.r, params.g, params.b );
+  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  json[EFFECT_ID_KEY]  = effectId;
+  json[BRIGHTNESS_KEY] = params.bright;
+  json[COLOR_KEY]      = color;
+  json[PALETTE_KEY]    = RgbPalette16::getPaletteId( params.palette );
+  json[SPEED_KEY]      = params.speed;
+  json[INTENSITY_KEY]  = params.intensity;
+  return json.as<String>();
+}
@@ -0,0 +1,34 @@
+#include "backlight/Rain2DEffect.h"
+#include "backlight/utils.h"
+
+using namespace Backlight;
+
+Rain2DEffect::Rain2DEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator )
+    : Matrix2DEffect(strip, animator) {
+  capabilities.hasSpeed = true;
+  capabilities.hasIntensity = true;
+}
+
+void Rain2DEffect::perform() {
+  strip.clearTo( RgbColor( 0, 0, 0 ));
+  startFrames();
+}
+
+void Rain2DEffect::renderFrame( const FrameTime& time ) {
+  // The drops move 22 units per nominal frame step (capped after stalls),
+  // so the fastest speed moves them one row per frame.
+  counterModeStep += 22UL * time.steps;
+  const uint32_t period = 22 + (255 - speed);
+  const uint16_t* top = layout.row( 0 );
+  while( counterModeStep >= period ) {
+    counterModeStep -= period;
+    shiftDown();
+    // The top row keeps a faded copy of itself, it makes the trails behind the drops.
+    for( uint16_t x = 0; x < width; x++ ) {
+      strip.setPixelColor( top[x], Utils::nscale8x3( strip.getPixelColor( top[x] ), TRAIL_FADE ));
+      if( random( 0, 2048 ) < intensity ) {
+        strip.setPixelColor( top[x], Utils::colorFromPalette( *palette, random( 0, 255 ), 255, NOBLEND ));
+      }
+    }
+  }
+}
@@ -0,0 +1,151 @@
+#include <Arduino.h>
+#include <string.h>
+#include "backlight/RealtimeInput.h"
+
+using namespace Backlight;
+
+RealtimeInput::RealtimeInput( NeoPixelWrapper* s, Protocol p, uint16_t t, uint16_t universe ) {
+  strip = s;
+  protocol = p;
+  timeout = t;
+  firstUniverse = universe;
+  for( uint8_t i = 0; i < E131_MAX_UNIVERSES; i++ ) {
+    e131Sequence[i] = -1;
+  }
+}
+
+/**
+ * Decode a received datagram and write its pixels into the frame buffer.
+ * @return true if the datagram has been applied.
+ */
+bool RealtimeInput::receive( const uint8_t* data, size_t len ) {
+  counters.received++;
+  const bool applied = (protocol == DDP)
+    ? receiveDdp( data, len )
+    : (protocol == E131) ? receiveE131( data, len ) : false;
+  if( applied ) {
+    counters.applied++;
+    lastFrame = millis();
+    active = true;
+  } else {
+    counters.dropped++;
+  }
+  return applied;
+}
+
+/**
+ * @return true once, when no frames have been received during the timeout.
+ */
+bool RealtimeInput::checkTimeout() {
+  if( active && millis() - lastFrame > timeout ) {
+    active = false;
+    showPending = false;
+    ddpSequence = -1;
+    for( uint8_t i = 0; i < E131_MAX_UNIVERSES; i++ ) {
+      e131Sequence[i] = -1;
+    }
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @return true if a complete frame has been received since the last call, i.e. the strip should be shown.
+ */
+bool RealtimeInput::takeShowRequest() {
+  const bool rc = showPending;
+  showPending = false;
+  return rc;
+}
+
+RealtimeInput::Protocol RealtimeInput::toProtocol( const char* name ) {
+  if( name == nullptr )          return NONE;
+  if( !strcmp( name, "ddp" ))    return DDP;
+  if( !strcmp( name, "e131" ))   return E131;
+  return NONE;
+}
+
+/* Private */
+
+/**
+ * DDP, http://www.3waylabs.com/ddp/
+ * byte 0: flags, 1: sequence (low 4 bits), 2: data type, 3: destination ID,
+ * bytes 4..7: data offset in bytes, 8..9: data length, optional 4 bytes timecode, data.
+ */
+bool RealtimeInput::receiveDdp( const uint8_t* data, size_t len ) {
+  if( len < DDP_HEADER_SIZE ) return false;
+
+  const uint8_t flags = data[0];
+  if( (flags & DDP_FLAG_VERSION_MASK) != DDP_FLAG_VERSION_1 ) return false;
+  if( data[2] != 0 && data[2] != DDP_TYPE_RGB24 ) return false;
+  if( data[3] > DDP_ID_DISPLAY ) return false;
+
+  // Zero sequence number means sequencing isn't used by the sender.
+  const uint8_t seq = data[1] & 0x0F;
+  if( seq ) {
+    if( isLate( ddpSequence, seq, 16, 8 )) return false;
+    ddpSequence = seq;
+  }
+
+  const uint32_t offset = ((uint32_t)data[4] << 24) | ((uint32_t)data[5] << 16) | ((uint32_t)data[6] << 8) | data[7];
+  const uint16_t length = (data[8] << 8) | data[9];
+  const uint8_t header = (flags & DDP_FLAG_TIMECODE) ? DDP_HEADER_SIZE + DDP_TIMECODE_SIZE : DDP_HEADER_SIZE;
+  if( len < (size_t)header + length ) return false;
+
+  strip->setChannels( offset, data + header, length );
+  if( flags & DDP_FLAG_PUSH ) {
+    showPending = true;
+  }
+  return true;
+}
+
+/**
+ * E1.31 (sACN) data packet. Universes starting from the firstUniverse are mapped
+ * to the strip sequentially, 170 pixels each.
+ */
+bool RealtimeInput::receiveE131( const uint8_t* data, size_t len ) {
+  static const uint8_t ACN_ID[12] = { 'A','S','C','-','E','1','.','1','7',0,0,0 };
+
+  if( len < E131_HEADER_SIZE ) return false;
+  if( memcmp( data + 4, ACN_ID, sizeof(ACN_ID) ) != 0 ) return false;
+  if( data[21] != 0x04 || data[43] != 0x02 || data[117] != 0x02 ) return false;   // root, framing and DMP vectors
+  if( data[125] != 0 ) return false;                                                // DMX start code
+
+  const uint8_t options = data[112];
+  if( options & E131_OPTION_PREVIEW ) return false;
+  if( options & E131_OPTION_TERMINATE ) {
+    lastFrame = millis() - timeout - 1;
+    return false;
+  }
+
+  const uint16_t universe = (data[113] << 8) | data[114];
+  if( universe < firstUniverse || universe - firstUniverse >= E131_MAX_UNIVERSES ) return false;
+  const uint8_t slot = universe - firstUniverse;
+
+  const uint8_t seq = data[111];
+  if( isLate( e131Sequence[slot], seq, 256, 20 )) return false;
+  e131Sequence[slot] = seq;
+
+  uint16_t count = ((data[123] << 8) | data[124]) - 1;     // property values count includes the start code
+  if( len < (size_t)E131_HEADER_SIZE + count ) return false;
+  if( count > E131_UNIVERSE_SIZE ) count = E131_UNIVERSE_SIZE;
+
+  strip->setChannels( (uint32_t)slot * E131_UNIVERSE_SIZE, data + E131_HEADER_SIZE, count );
+
+  // The frame is complete when the universe holding the last pixel is received.
+  const uint16_t channels = strip->getPixelsCount() * 3;
+  if( channels == 0 || slot >= (channels - 1) / E131_UNIVERSE_SIZE ) {
+    showPending = true;
+  }
+  return true;
+}
+
+/**
+ * A datagram is late if its sequence number is equal to the last one or behind it
+ * within the window. Larger gaps are treated as a sender restart.
+ */
+bool RealtimeInput::isLate( int16_t last, uint8_t seq, uint16_t modulo, uint8_t window ) {
+  if( last < 0 ) return false;
+  const uint16_t diff = (seq - last + modulo) % modulo;
+  return diff == 0 || diff > modulo - window;
+}
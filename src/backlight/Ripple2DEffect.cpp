@@ -0,0 +1,67 @@
+#include <math.h>
+#include "backlight/Ripple2DEffect.h"
+#include "backlight/utils.h"
+
+using namespace Backlight;
+
+Ripple2DEffect::Ripple2DEffect( NeoPixelWrapper& strip, NeoPixelAnimator& animator )
+    : Matrix2DEffect(strip, animator), distance( (uint32_t) width * height ) {
+  capabilities.hasSpeed = true;
+  capabilities.hasIntensity = true;
+  maxRipples = constrain( (width * height) / 32, 1, MAX_RIPPLES );
+  // The distances are computed once, so frames don't need the square roots.
+  for( uint16_t dy = 0; dy < height; dy++ ) {
+    for( uint16_t dx = 0; dx < width; dx++ ) {
+      distance[dy * width + dx] = sqrtf( dx * dx + dy * dy ) * 16 + 0.5f;
+    }
+  }
+}
+
+void Ripple2DEffect::perform() {
+  startFrames();
+}
+
+void Ripple2DEffect::renderFrame( const FrameTime& time ) {
+  strip.clearTo( RgbColor( 0, 0, 0 ));
+  const uint8_t decay = (speed >> 4) + 1;                                 // faster decay if faster propagation
+  for( uint8_t i = 0; i < maxRipples; i++ ) {
+    RippleData& ripple = store[i];
+    uint16_t state = ripple.state;
+    if( state ) {
+      const uint16_t radius = (state / decay) * speed / 16;               // 1/16 of pixel
+      const uint8_t amp = (state < 17) ? Utils::triwave8( (state - 1) * 8 ) : map( state, 17, 255, 255, 2 );
+      drawRipple( ripple, radius, amp );
+      state += decay * time.steps;
+      ripple.state = (state > 254) ? 0 : state;
+    }
+    // Randomly create a new ripple.
+    else if( random( 0, 5100 + 10000 ) <= intensity * time.steps ) {
+      ripple.state = 1;
+      ripple.x = random( 0, width );
+      ripple.y = random( 0, height );
+      ripple.colorIndex = random( 0, 255 );
+    }
+  }
+  blur2d( 48 );
+}
+
+void Ripple2DEffect::drawRipple( const RippleData& ripple, uint16_t radius, uint8_t amp ) {
+  const RgbColor col = Utils::colorFromPalette( *palette, ripple.colorIndex, 255, LINEARBLEND );
+  // Only the rows crossed by the ring are visited.
+  const int reach = (radius + RING_WIDTH) / 16 + 1;
+  const uint16_t top = max( 0, (int) ripple.y - reach );
+  const uint16_t bottom = min( (int) height, (int) ripple.y + reach + 1 );
+
+  for( uint16_t y = top; y < bottom; y++ ) {
+    const uint16_t* index = layout.row( y );
+    const uint16_t* dist = &distance[abs( (int) y - (int) ripple.y ) * width];
+    for( uint16_t x = 0; x < width; x++ ) {
+      const uint16_t d = dist[abs( (int) x - (int) ripple.x )];
+      const uint16_t delta = d > radius ? d - radius : radius - d;
+      if( delta < RING_WIDTH ) {
+        const uint8_t mag = Utils::scale8( Utils::cubicwave8( 128 - delta * 4 ), amp );
+        strip.setPixelColor( index[x], Utils::colorBlend( strip.getPixelColor( index[x] ), col, mag ));
+      }
+    }
+  }
+}
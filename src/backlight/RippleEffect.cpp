@@ -25,16 +25,14 @@ RippleEffect::~RippleEffect() {
 
 void RippleEffect::perform() {
   //Log.verbose( "FX ripple started, maxRipples=%d intencity=%d" CR, maxRipples, strip.getBrightness() );
-  animator.StartAnimation( 0, FRAMETIME, [this](const AnimationParam& param) {
-    if( param.state == AnimationState_Completed ) {
-      drawWave();
-      animator.RestartAnimation( 0 );
-    }
-  });
-  startTicker();
+  startFrames();
+}
+
+void RippleEffect::renderFrame( const FrameTime& time ) {
+  drawWave( time.steps );
 }
 
-void RippleEffect::drawWave() {
+void RippleEffect::drawWave( uint8_t steps ) {
   if( maxRipples == 0 ) {
     strip.clearTo( color );
   } else {
@@ -64,11 +62,11 @@ void RippleEffect::drawWave() {
             strip.setPixelColor( w, Utils::colorBlend( strip.getPixelColor( w ), col, mag ));
           }
         }
-        state += decay;
+        state += decay * steps;
         ripple->state = (state > 254) ? 0 : state;
       } else {
         // Randomly create a new wave.
-        if( random( 0, 5100 + 10000 ) <= intensity ) {
+        if( random( 0, 5100 + 10000 ) <= intensity * steps ) {
           ripple->state = 1;
           ripple->waveOrigin = random( 0, strip.getPixelsCount() - 1 );
           ripple->colorIndex = random( 0, 255 );
@@ -10,17 +10,18 @@ WaveInLightEffect::WaveInLightEffect( NeoPixelWrapper& strip, NeoPixelAnimator&
 
 void WaveInLightEffect::perform() {
   lastPixel = 0;
-  uint16_t delay = speedFormulaValue();
-  animator.StartAnimation( 0, delay, [this]( const AnimationParam& param ) {
-    if( param.state == AnimationState_Completed ) {
-      if( lastPixel < strip.getPixelsCount() ) {
-        strip.setPixelColor( lastPixel++, color );
-        animator.RestartAnimation( 0 );
-      } else {
-        stopTicker();
-      }
-    }
-  });
-  // Start animation.
-  startTicker();
+  startFrames();
+}
+
+void WaveInLightEffect::renderFrame( const FrameTime& time ) {
+  // Light up all pixels which are due by now, one pixel per speedFormulaValue() milliseconds.
+  const uint16_t count = strip.getPixelsCount();
+  const uint32_t due = time.elapsed / speedFormulaValue() + 1;
+  const uint16_t target = due < count ? due : count;
+  while( lastPixel < target ) {
+    strip.setPixelColor( lastPixel++, color );
+  }
+  if( lastPixel >= count ) {
+    stopFrames();
+  }
 }
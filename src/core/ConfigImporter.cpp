@@ -4,6 +4,7 @@
 #include "ModulesManager.h"
 #include "Utils.h"
 #include "core/ConfigImporter.h"
+#include "core/Format.h"
 
 ResultData ConfigImporter::begin( const String& action, const int total_size ) {
   buffer.reserve( total_size );
@@ -30,9 +31,10 @@ ResultData ConfigImporter::end( const bool hasSuccessful ) {
     DeserializationError rc = deserializeJson( doc, buffer );
     // If the JSON config cannot be decoded.
     if( rc != DeserializationError::Ok ) {
-      String msg = Utils::format( Messages::JSON_DECODE_ERROR, rc.c_str() );
-      Log.error( "IMPORT %s" CR, msg );
-      return {RC_OK, msg};
+      ResultData result = {RC_OK};
+      Format::append( result.details, Messages::JSON_DECODE_ERROR, rc.c_str() );
+      Log.error( "IMPORT %s" CR, result.details.c_str() );
+      return result;
     }
     // Separate the config JSON into sub-objects. Provide an each sub-object to
     // the respective module.
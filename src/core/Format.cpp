@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include "core/Format.h"
+#include "core/ScratchArena.h"
+
+// Most of the messages fit into the stack chunk, longer ones are formatted in the scratch arena.
+static const size_t CHUNK_SIZE = 128;
+
+Format::Result Format::to( char* buffer, size_t size, const char* fmt, ... ) {
+  va_list args;
+  va_start( args, fmt );
+  const Result r = vto( buffer, size, fmt, args );
+  va_end( args );
+  return r;
+}
+
+Format::Result Format::to( Print& out, const char* fmt, ... ) {
+  va_list args;
+  va_start( args, fmt );
+  const Result r = vto( out, fmt, args );
+  va_end( args );
+  return r;
+}
+
+Format::Result Format::append( String& out, const char* fmt, ... ) {
+  va_list args;
+  va_start( args, fmt );
+  const Result r = vappend( out, fmt, args );
+  va_end( args );
+  return r;
+}
+
+Format::Result Format::vto( char* buffer, size_t size, const char* fmt, va_list args ) {
+  const int n = vsnprintf( buffer, size, fmt, args );
+  if( n < 0 ) {
+    if( size > 0 ) buffer[0] = 0;
+    return {0, 0};
+  }
+  const size_t length = n;
+  return {length, size == 0 ? 0 : (length < size ? length : size - 1)};
+}
+
+Format::Result Format::vto( Print& out, const char* fmt, va_list args ) {
+  char chunk[CHUNK_SIZE];
+  va_list copy;
+  va_copy( copy, args );
+  const Result r = vto( chunk, sizeof(chunk), fmt, copy );
+  va_end( copy );
+  if( !r.truncated() ) {
+    return {r.length, out.write( (const uint8_t*) chunk, r.written )};
+  }
+  char* buffer = (char*) Scratch::allocate( r.length + 1 );
+  if( !buffer ) {
+    return {r.length, out.write( (const uint8_t*) chunk, r.written )};
+  }
+  vsnprintf( buffer, r.length + 1, fmt, args );
+  const size_t written = out.write( (const uint8_t*) buffer, r.length );
+  Scratch::deallocate( buffer );
+  return {r.length, written};
+}
+
+Format::Result Format::vappend( String& out, const char* fmt, va_list args ) {
+  char chunk[CHUNK_SIZE];
+  va_list copy;
+  va_copy( copy, args );
+  const Result r = vto( chunk, sizeof(chunk), fmt, copy );
+  va_end( copy );
+  if( !r.truncated() ) {
+    return out.concat( chunk ) ? r : Result{r.length, 0};
+  }
+  char* buffer = (char*) Scratch::allocate( r.length + 1 );
+  if( !buffer || !out.reserve( out.length() + r.length )) {
+    Scratch::deallocate( buffer );
+    return {r.length, 0};
+  }
+  vsnprintf( buffer, r.length + 1, fmt, args );
+  out.concat( buffer );
+  Scratch::deallocate( buffer );
+  return {r.length, r.length};
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <Arduino.h>
+#include <ArduinoLog.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "core/ScratchArena.h"
+
+namespace Scratch {
+
+  // Every block starts with a header holding the block size, so blocks can be released
+  // or resized in place when they are the last ones.
+  struct Header {
+    size_t size;
+    size_t spare;               // Keeps the data 8-byte aligned.
+  };
+
+  static const size_t ALIGNMENT = 8;
+  static const uint8_t MAX_DEPTH = 16;   // Deeper scopes are merged into the outer one.
+
+  static uint8_t*     buffer = nullptr;
+  static size_t       capacity = 0;
+  static size_t       top = 0;
+  static size_t       highWater = 0;
+  static uint32_t     fallbacks = 0;
+  static uint8_t      depth = 0;
+  static size_t       marks[MAX_DEPTH];  // The arena top at the start of every open scope.
+  static TaskHandle_t owner = nullptr;
+
+  static inline size_t align( size_t size ) {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  }
+
+  static inline bool inArena( const void* p ) {
+    return p >= buffer && p < buffer + capacity;
+  }
+
+  static inline bool isActive() {
+    return depth > 0 && xTaskGetCurrentTaskHandle() == owner;
+  }
+
+  static inline Header* headerOf( void* p ) {
+    return static_cast<Header*>(p) - 1;
+  }
+
+  // True if the block is the last allocated one.
+  static inline bool isLast( void* p ) {
+    return static_cast<uint8_t*>(p) + headerOf( p )->size == buffer + top;
+  }
+
+  // True if the block was allocated in the innermost open scope, so it may move or grow
+  // within the scope. Blocks of outer scopes must stay below the scope mark, leave() would
+  // release anything above it.
+  static inline bool inCurrentScope( void* p ) {
+    return isActive() && reinterpret_cast<uint8_t*>(headerOf( p )) - buffer >= (ptrdiff_t) marks[depth - 1];
+  }
+
+  /**
+   * Allocate the arena and bind it to the calling task.
+   */
+  void begin( size_t size ) {
+    if( buffer ) return;
+    buffer = static_cast<uint8_t*>(malloc( size ));
+    capacity = buffer ? size : 0;
+    owner = xTaskGetCurrentTaskHandle();
+    if( !buffer ) {
+      Log.error( "SCR Cannot allocate %d bytes" CR, size );
+    }
+  }
+
+  void* allocate( size_t size ) {
+    if( isActive() ) {
+      const size_t need = sizeof(Header) + align( size );
+      if( top + need <= capacity ) {
+        Header* h = reinterpret_cast<Header*>(buffer + top);
+        h->size = align( size );
+        top += need;
+        if( top > highWater ) highWater = top;
+        return h + 1;
+      }
+      fallbacks++;
+    }
+    return malloc( size );
+  }
+
+  void deallocate( void* p ) {
+    if( !inArena( p )) {
+      free( p );
+    } else if( inCurrentScope( p ) && isLast( p )) {
+      top = reinterpret_cast<uint8_t*>(headerOf( p )) - buffer;
+    }
+    // Other arena blocks are released with their scopes.
+  }
+
+  void* reallocate( void* p, size_t size ) {
+    if( !inArena( p )) {
+      return realloc( p, size );
+    }
+    Header* h = headerOf( p );
+    const bool own = inCurrentScope( p );
+    if( own && isLast( p )) {
+      const size_t end = static_cast<uint8_t*>(p) - buffer + align( size );
+      if( end <= capacity ) {
+        h->size = align( size );
+        top = end;
+        if( top > highWater ) highWater = top;
+        return p;
+      }
+    } else if( size <= h->size ) {
+      return p;
+    } else if( !own ) {
+      // The copy goes to the heap, the block itself is released with its scope.
+      void* n = malloc( size );
+      if( n ) memcpy( n, p, h->size );
+      return n;
+    }
+    void* n = allocate( size );
+    if( n ) memcpy( n, p, std::min( size, h->size ));
+    return n;
+  }
+
+  Stats getStats() {
+    return { capacity, top, highWater, fallbacks };
+  }
+
+  /**
+   * Open a scope, returns the mark to release the scope allocations with.
+   * Scopes opened by other tasks or nested deeper than MAX_DEPTH do nothing.
+   */
+  size_t enter() {
+    if( xTaskGetCurrentTaskHandle() != owner || depth == MAX_DEPTH ) return SIZE_MAX;
+    marks[depth++] = top;
+    return top;
+  }
+
+  void leave( size_t mark ) {
+    if( mark == SIZE_MAX ) return;
+    top = mark;
+    depth--;
+  }
+}
@@ -0,0 +1,73 @@
+#include <ctype.h>
+#include "core/Tokenizer.h"
+
+static inline bool isQuote( char c ) {
+  return c == '"' || c == '\'';
+}
+
+/**
+ * Takes the next token.
+ * @return false if there are no more tokens.
+ */
+bool Tokenizer::next( StringView& token ) {
+  skipSeparators();
+  if( p >= end ) {
+    return false;
+  }
+  const char* start = p;
+  if( isQuote( *p )) {
+    const char quote = *p++;
+    start = p;
+    while( p < end && *p != quote ) p++;
+    token = StringView( start, p - start );
+    if( p < end ) p++;      // The closing quote.
+  } else {
+    while( p < end && *p != separator ) p++;
+    token = StringView( start, p - start );
+  }
+  return true;
+}
+
+bool Tokenizer::atEnd() {
+  skipSeparators();
+  return p >= end;
+}
+
+StringView Tokenizer::rest() {
+  skipSeparators();
+  const StringView s( p, end - p );
+  p = end;
+  return s;
+}
+
+void Tokenizer::skipSeparators() {
+  while( p < end && *p == separator ) p++;
+}
+
+/* Static */
+
+std::pair<StringView,StringView> Tokenizer::split( const StringView& source, const char separator ) {
+  Tokenizer tokens( source, separator );
+  StringView first;
+  tokens.next( first );
+  return std::pair<StringView,StringView>( first, tokens.rest() );
+}
+
+StringView Tokenizer::trim( const StringView& s ) {
+  size_t from = 0, to = s.length();
+  while( from < to && isspace( (unsigned char) s[from] )) from++;
+  while( to > from && isspace( (unsigned char) s[to - 1] )) to--;
+  return s.substring( from, to );
+}
+
+StringView Tokenizer::unquote( const StringView& s ) {
+  const size_t len = s.length();
+  if( len >= 2 && isQuote( s[0] ) && s[len - 1] == s[0] ) {
+    // Only if there are no quotes of the same kind inside.
+    for( size_t i = 1; i < len - 1; i++ ) {
+      if( s[i] == s[0] ) return s;
+    }
+    return s.substring( 1, len - 1 );
+  }
+  return s;
+}
@@ -1,6 +1,7 @@
 #include "Events.h"
 #include "ModulesManager.h"
 #include "Utils.h"
+#include "RelaysModule.h"
 #include "RtcTimeModule.h"
 #include "minidisplay/MiniDisplayModule.h"
 
@@ -64,40 +65,37 @@ namespace MiniDisplayBehavior {
   // Subscribes to relays module status change events. Updates the related mini display menu entries.
 
   void useRelaysModuleStatus() {
-    Bus.listen<StatusChangedEvent>( [](const StatusChangedEvent& event) {
+    Bus.listen<StatusChangedEvent>( EventFilter::of( RELAYS_MODULE, StatusData::TYPE_RELAYS ), [](const StatusChangedEvent& event) {
       // ================================
       // Handling status change events of the relays module.
       // This code updates the mini display template parameter, where:
       // - the key is a relay alias or relay ID (if the relay alias is empty);
       // - the value is a relay state.
-      if( strcmp( event.module->getId(), RELAYS_MODULE ) == 0 ) {
-        // Avoid the display flickering when relay switches a reactive payload.
-        Wire.begin();
-        //delay( 250 );
-        //Wire.begin();
 
-        Modules.execute( MINI_DISPLAY_MODULE, [&event](Module* module) {
-          StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-          DeserializationError rc = deserializeJson( json, event.payload );
-          if( rc == DeserializationError::Ok ) {
-            const String id = json["id"];
-            const String alias = json["alias"];
-            const String state = json["state"];
-            // Use the relay alias as a template parameter when it's possible.
-            // To select the mini display menu entry, it's ID must be the same as relay alias or id.
-            MiniDisplayModule* const display = (MiniDisplayModule*) module;
-            if( alias.length() > 0 && alias != "null" ) {
-              display->setTemplateParameter( alias, state );
-              display->selectMenu( alias );
-            } else {
-              display->setTemplateParameter( id, state );
-              display->selectMenu( id );
-            }
-          } else {
-             Log.error( "BHVR Relays status event decode error: %s" CR, rc.c_str() );
+      // Avoid the display flickering when relay switches a reactive payload.
+      Wire.begin();
+      //delay( 250 );
+      //Wire.begin();
+
+      Modules.execute( MINI_DISPLAY_MODULE, [&event](Module* module) {
+        static const char* const STATES[] = { "OFF", "ON", "No pin" };
+        // Use the relay alias as a template parameter when it's possible.
+        // To select the mini display menu entry, it's ID must be the same as relay alias or id.
+        RelaysModule* const relays = static_cast<RelaysModule*>(event.module);
+        MiniDisplayModule* const display = (MiniDisplayModule*) module;
+        if( event.data.relays.index == StatusData::RELAY_MANY ) {
+          // Several relays were switched at once (mask or scene), update them all, keep the menu.
+          for( uint8_t i = 0; i < relays->getRelaysCount(); i++ ) {
+            if( (event.data.relays.changed & (1ULL << i)) == 0 ) continue;
+            const bool on = (event.data.relays.mask & (1ULL << i)) != 0;
+            display->setTemplateParameter( relays->getRelayName( i ), STATES[on ? StatusData::RELAY_ON : StatusData::RELAY_OFF] );
           }
-        });
-      }
+          return;
+        }
+        const String name = relays->getRelayName( event.data.relays.index );
+        display->setTemplateParameter( name, STATES[event.data.relays.state] );
+        display->selectMenu( name );
+      });
     });
   }
 
@@ -105,17 +103,16 @@ namespace MiniDisplayBehavior {
   // Subscribes to RTC module status change events. Updates the mini display time.
 
   void useTimeStatus() {
-    Bus.listen<StatusChangedEvent>( [](const StatusChangedEvent& event) {
-      if( strcmp( event.module->getId(), RTC_MODULE ) == 0 ) {
-        Modules.execute( MINI_DISPLAY_MODULE, [&event](Module* module) {
-          String datetime = event.payload;
-          int i = datetime.indexOf( 'T' );
-          String date = datetime.substring( 0, i );
-          String time = datetime.substring( i+1, datetime.lastIndexOf( ':' ));
-          (static_cast<MiniDisplayModule*>(module))->setTemplateParameter( "DATE", date );
-          (static_cast<MiniDisplayModule*>(module))->setTemplateParameter( "TIME", time );
-        });
-      }
+    Bus.listen<StatusChangedEvent>( EventFilter::of( RTC_MODULE, StatusData::TYPE_TIME ), [](const StatusChangedEvent& event) {
+      Modules.execute( MINI_DISPLAY_MODULE, [&event](Module* module) {
+        const StatusData::Time& t = event.data.time;
+        char date[11];
+        char time[6];
+        snprintf( date, sizeof(date), "%04u-%02u-%02u", t.year, t.month, t.day );
+        snprintf( time, sizeof(time), "%02u:%02u", t.hour, t.minute );
+        (static_cast<MiniDisplayModule*>(module))->setTemplateParameter( "DATE", date );
+        (static_cast<MiniDisplayModule*>(module))->setTemplateParameter( "TIME", time );
+      });
     });
   }
 }
\ No newline at end of file
@@ -7,7 +7,6 @@
 #include <IRremoteESP8266.h>
 #include <IRsend.h>
 #include "infrared/IrLg.h"
-#include "str_switch.h"
 #include "Utils.h"
 
 IrLg::IrLg() {
@@ -24,72 +23,39 @@ IrLg::~IrLg(){
     delete airConditional;
 };
 
+static constexpr const char* const FAN_VALUES[]  = { "on", "off", "low", "med", "high" };
+static constexpr const char* const MODE_VALUES[] = { "cool", "heat" };
+
+constexpr Commands::Entry<IrLg> IrLg::COMMANDS[] = {
+    { "fan",  Commands::choice( FAN_VALUES ),  &IrLg::cmdFan,  "Power on/off or the fan speed" },
+    { "mode", Commands::choice( MODE_VALUES ), &IrLg::cmdMode, "Operation mode" },
+    { "temp", Commands::number( 16, 29 ),      &IrLg::cmdTemp, "Temperature" },
+};
+
 bool IrLg::handleCommand( const String& cmd, const String& args ){
-     SWITCH( cmd.c_str() ) {
-    // ==========================================
-        CASE( "fan" ): {
-            SWITCH( args.c_str() ){
-                CASE( "on" ): {
-                    airConditional->on();
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true;
-                }
-                CASE( "off" ): {
-                    airConditional->off();
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true;
-                }
-                CASE( "low" ): {
-                    airConditional->setFan(kLgAcFanLow);
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true;
-                }
-                CASE( "med" ): {
-                    airConditional->setFan(kLgAcFanMedium);
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true;
-                }
-                CASE( "high" ): {
-                    airConditional->setFan(kLgAcFanHigh);
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true;
-                }
-            }
-        }
-        CASE( "mode" ): {
-            SWITCH( args.c_str() ){
-                CASE( "cool" ): {
-                    airConditional->setMode( kLgAcCool );
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true; 
-                }
-                CASE( "heat" ):{
-                    airConditional->setMode( kLgAcHeat );
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true;
-                }
-            }
-        }
-        CASE( "temp" ): {
-            uint8_t number = Utils::toByte( args.c_str() );
-            if( number <= 15 || number >= 30 ) {
-                handleCommandResults( cmd, args, Messages::COMMAND_INVALID_VALUE );
-            } else {
-                airConditional->setTemp(number);
-                airConditional->send();
-                handleCommandResults( cmd, args, Messages::OK );
-            }
-            return true;
-        }
-        DEFAULT_CASE:
-            return false;
-     }
-    // ==========================================
-};
\ No newline at end of file
+    return dispatchCommandTable<COMMAND_TABLE(IrLg, COMMANDS)>( *this, cmd, args );
+}
+
+void IrLg::cmdFan( const Commands::Args& args ){
+    switch( args.choice ){
+        case 0:  airConditional->on();  break;
+        case 1:  airConditional->off();  break;
+        case 2:  airConditional->setFan( kLgAcFanLow );  break;
+        case 3:  airConditional->setFan( kLgAcFanMedium );  break;
+        default: airConditional->setFan( kLgAcFanHigh );  break;
+    }
+    airConditional->send();
+    handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
+void IrLg::cmdMode( const Commands::Args& args ){
+    airConditional->setMode( args.choice == 0 ? kLgAcCool : kLgAcHeat );
+    airConditional->send();
+    handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
+void IrLg::cmdTemp( const Commands::Args& args ){
+    airConditional->setTemp( args.number );
+    airConditional->send();
+    handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
\ No newline at end of file
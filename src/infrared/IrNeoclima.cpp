@@ -36,79 +36,46 @@ const String IrNeoclima::getStatusWebpage() {
   return makeWebpage( "/status_ir_ac.html" );
 }
 
+static constexpr const char* const FAN_VALUES[]  = { "on", "off", "low", "med", "high" };
+static constexpr const char* const MODE_VALUES[] = { "cool", "heat" };
+
+constexpr Commands::Entry<IrNeoclima> IrNeoclima::COMMANDS[] = {
+    { "fan",  Commands::choice( FAN_VALUES ),  &IrNeoclima::cmdFan,  "Power on/off or the fan speed" },
+    { "mode", Commands::choice( MODE_VALUES ), &IrNeoclima::cmdMode, "Operation mode" },
+    { "temp", Commands::number( 14, 31 ),      &IrNeoclima::cmdTemp, "Temperature" },
+};
+
 bool IrNeoclima::handleCommand( const String& cmd, const String& args ){
-     SWITCH( cmd.c_str() ) {
-    // ==========================================
-        CASE( "fan" ): {
-            SWITCH( args.c_str() ){
-                CASE( "on" ): {
-                    airConditional->on();
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true;
-                }
-                CASE( "off" ): {
-                    airConditional->off();
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true;
-                }
-                CASE( "low" ): {
-                    airConditional->setFan(kNeoclimaFanLow);
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true;
-                }
-                CASE( "med" ): {
-                    airConditional->setFan(kNeoclimaFanMed);
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true;
-                }
-                CASE( "high" ): {
-                    airConditional->setFan(kNeoclimaFanHigh);
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true;
-                }
-            }
-        }
-        CASE( "mode" ): {
-            SWITCH( args.c_str() ){
-                CASE( "cool" ): {
-                    airConditional->setMode( kNeoclimaCool );
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true; 
-                }
-                CASE( "heat" ):{
-                    airConditional->setMode( kNeoclimaHeat );
-                    airConditional->send();
-                    handleCommandResults( cmd, args, Messages::OK );
-                    return true;
-                }
-            }
-        }
-        CASE( "temp" ): {
-            uint8_t number = Utils::toByte( args.c_str() );
-            if( number < 14 || number > 31 ) {
-                handleCommandResults( cmd, args, Messages::COMMAND_INVALID_VALUE );
-            } else {
-                airConditional->setTemp(number);
-                airConditional->send();
-                handleCommandResults( cmd, args, Messages::OK );
-            }
-            return true;
-        }
-        DEFAULT_CASE:
-            return false;
-     }
-    // ==========================================
+    return dispatchCommandTable<COMMAND_TABLE(IrNeoclima, COMMANDS)>( *this, cmd, args );
+}
+
+void IrNeoclima::cmdFan( const Commands::Args& args ){
+    switch( args.choice ){
+        case 0:  airConditional->on();  break;
+        case 1:  airConditional->off();  break;
+        case 2:  airConditional->setFan( kNeoclimaFanLow );  break;
+        case 3:  airConditional->setFan( kNeoclimaFanMed );  break;
+        default: airConditional->setFan( kNeoclimaFanHigh );  break;
+    }
+    airConditional->send();
+    handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
+void IrNeoclima::cmdMode( const Commands::Args& args ){
+    airConditional->setMode( args.choice == 0 ? kNeoclimaCool : kNeoclimaHeat );
+    airConditional->send();
+    handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
+void IrNeoclima::cmdTemp( const Commands::Args& args ){
+    airConditional->setTemp( args.number );
+    airConditional->send();
+    handleCommandResults( args.cmd, args.raw, Messages::OK );
 }
 
 
-void IrNeoclima::resolveTemplateKey( const String& key, String& out ) {
-  SWITCH( key.c_str() ) {
+void IrNeoclima::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     // Module template parameters
     CASE( "MTITLE" ):  {
         out += Utils::formatModuleSettingsTitle( getId(), getName() );  break;
@@ -0,0 +1,72 @@
+#include <stdlib.h>
+#include "lvgl/AssetCache.h"
+
+AssetCache::~AssetCache() {
+  for( Entry& e : entries ) {
+    free( e.data );
+  }
+}
+
+/**
+ * Find the entry and make it the most recently used one.
+ */
+AssetCache::Entry* AssetCache::find( Kind kind, uint32_t key, uint32_t index ) {
+  for( auto it = entries.begin(); it != entries.end(); it++ ) {
+    if( it->key == key && it->index == index && it->kind == kind ) {
+      if( it != entries.begin() ) {
+        entries.splice( entries.begin(), entries, it );
+      }
+      stats.hits[kind]++;
+      return &entries.front();
+    }
+  }
+  stats.misses[kind]++;
+  return nullptr;
+}
+
+/**
+ * Allocate a new entry of the given size, the data must be filled by the caller.
+ * Returns nullptr if it doesn't fit the budget even after eviction.
+ */
+AssetCache::Entry* AssetCache::insert( Kind kind, uint32_t key, uint32_t index, size_t size ) {
+  if( size > budget || !evict( size )) {
+    return nullptr;
+  }
+  uint8_t* data = (uint8_t*) malloc( size );
+  if( data == nullptr ) {
+    return nullptr;
+  }
+  entries.push_front( {kind, 0, key, index, (uint32_t) size, data} );
+  used += size;
+  return &entries.front();
+}
+
+void AssetCache::remove( Entry* entry ) {
+  for( auto it = entries.begin(); it != entries.end(); it++ ) {
+    if( &(*it) == entry ) {
+      used -= it->size;
+      free( it->data );
+      entries.erase( it );
+      return;
+    }
+  }
+}
+
+/* Private */
+
+/**
+ * Drop the least recently used entries, that are not in use, until the size fits.
+ */
+bool AssetCache::evict( size_t size ) {
+  auto it = entries.end();
+  while( used + size > budget && it != entries.begin() ) {
+    it--;
+    if( it->pins == 0 ) {
+      used -= it->size;
+      free( it->data );
+      it = entries.erase( it );
+      stats.evictions++;
+    }
+  }
+  return used + size <= budget;
+}
@@ -0,0 +1,223 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <ArduinoLog.h>
+#include <esp_heap_caps.h>
+#include <rom/gpio.h>
+#include <soc/gpio_sig_map.h>
+#include <soc/i2s_reg.h>
+#include <soc/i2s_struct.h>
+#include <soc/soc_memory_layout.h>
+#include <driver/periph_ctrl.h>
+#include "lvgl/I2SParallelBus.h"
+
+/* Public */
+
+I2SParallelBus::I2SParallelBus( const uint8_t* dataPins, uint8_t wrPin ) {
+  this->dataPins = dataPins;
+  this->wrPin = wrPin;
+}
+
+I2SParallelBus::~I2SParallelBus() {
+  release();
+  if( interrupt ) {
+    esp_intr_free( interrupt );
+  }
+  if( descriptors ) {
+    heap_caps_free( descriptors );
+  }
+  periph_module_disable( PERIPH_I2S0_MODULE );
+}
+
+/**
+ * Setup I2S0 in the 8-bit LCD mode. Returns false if the interrupt can't be allocated,
+ * the caller should then stay with the bit-banged bus.
+ */
+bool I2SParallelBus::begin( uint8_t clockDivider ) {
+  periph_module_enable( PERIPH_I2S0_MODULE );
+
+  // Reset the peripheral, the FIFO and the DMA.
+  I2S0.conf.tx_reset = 1;
+  I2S0.conf.tx_reset = 0;
+  I2S0.conf.tx_fifo_reset = 1;
+  I2S0.conf.tx_fifo_reset = 0;
+  I2S0.lc_conf.out_rst = 1;
+  I2S0.lc_conf.out_rst = 0;
+  I2S0.lc_conf.ahbm_rst = 1;
+  I2S0.lc_conf.ahbm_rst = 0;
+  I2S0.lc_conf.ahbm_fifo_rst = 1;
+  I2S0.lc_conf.ahbm_fifo_rst = 0;
+
+  // LCD master transmitter, WS is the write strobe.
+  I2S0.conf.val = 0;
+  I2S0.conf.tx_right_first = 1;
+  I2S0.conf2.val = 0;
+  I2S0.conf2.lcd_en = 1;
+  I2S0.conf1.val = 0;
+  I2S0.conf1.tx_pcm_bypass = 1;
+  I2S0.conf1.tx_stop_en = 1;
+  I2S0.timing.val = 0;
+
+  // 16-bit FIFO samples, a single channel. In the 8-bit mode the bytes of every 16-bit word
+  // are sent high byte first, that's the RGB565 order expected by the display.
+  I2S0.fifo_conf.val = 0;
+  I2S0.fifo_conf.tx_fifo_mod_force_en = 1;
+  I2S0.fifo_conf.tx_fifo_mod = 1;
+  I2S0.fifo_conf.tx_data_num = 32;
+  I2S0.fifo_conf.dscr_en = 1;
+  I2S0.conf_chan.val = 0;
+  I2S0.conf_chan.tx_chan_mod = 1;
+  I2S0.sample_rate_conf.val = 0;
+  I2S0.sample_rate_conf.tx_bits_mod = 16;
+  I2S0.sample_rate_conf.tx_bck_div_num = 1;
+
+  // 80MHz PLL clock / divider, the WR strobe runs at the half of it.
+  I2S0.clkm_conf.val = 0;
+  I2S0.clkm_conf.clka_en = 0;
+  I2S0.clkm_conf.clkm_div_a = 1;
+  I2S0.clkm_conf.clkm_div_b = 0;
+  I2S0.clkm_conf.clkm_div_num = clockDivider < 2 ? 2 : clockDivider;
+
+  I2S0.lc_conf.val = 0;
+  I2S0.lc_conf.out_eof_mode = 1;
+  I2S0.lc_conf.out_data_burst_en = 1;
+  I2S0.lc_conf.outdscr_burst_en = 1;
+
+  I2S0.int_ena.val = 0;
+  I2S0.int_clr.val = 0xFFFFFFFF;
+  if( esp_intr_alloc( ETS_I2S0_INTR_SOURCE, 0, interruptHandler, this, &interrupt ) != ESP_OK ) {
+    Log.error( "ST7796 I2S interrupt allocation failed" CR );
+    interrupt = nullptr;
+    return false;
+  }
+  I2S0.int_ena.out_total_eof = 1;
+  return true;
+}
+
+/**
+ * The DMA reads the internal RAM only, by 32-bit words.
+ */
+bool I2SParallelBus::canSend( const void* data, size_t length ) {
+  return interrupt != nullptr && esp_ptr_dma_capable( data )
+      && ((uint32_t) data & 3) == 0 && (length & 3) == 0;
+}
+
+/**
+ * Wait for the running transfer and give the pins back to the GPIO matrix.
+ */
+void I2SParallelBus::release() {
+  if( routed ) {
+    waitIdle();
+    route( false );
+  }
+}
+
+/**
+ * Returns the transfers time accumulated since the previous call.
+ */
+uint32_t I2SParallelBus::takeBusyTime() {
+  // The DMA interrupt adds to the time, so it's taken and cleared under the lock.
+  portENTER_CRITICAL( &busyTimeLock );
+  const uint32_t t = busyTime;
+  busyTime = 0;
+  portEXIT_CRITICAL( &busyTimeLock );
+  return t;
+}
+
+/**
+ * Start sending the data. The function returns immediately, lv_disp_flush_ready()
+ * is called from the DMA interrupt when the last descriptor is sent.
+ */
+bool I2SParallelBus::send( const void* data, size_t length, lv_disp_drv_t* drv ) {
+  waitIdle();
+
+  // The descriptors are (re)allocated for the largest chunk seen so far.
+  const uint16_t count = (length + DMA_MAX_LENGTH - 1) / DMA_MAX_LENGTH;
+  if( count > descriptorsCount ) {
+    lldesc_t* p = (lldesc_t*) heap_caps_realloc( descriptors, count * sizeof(lldesc_t), MALLOC_CAP_DMA );
+    if( p == nullptr ) {
+      return false;
+    }
+    descriptors = p;
+    descriptorsCount = count;
+  }
+
+  // Build the descriptors chain.
+  const uint8_t* ptr = (const uint8_t*) data;
+  for( uint16_t i = 0; i < count; i++ ) {
+    const uint16_t len = length > DMA_MAX_LENGTH ? DMA_MAX_LENGTH : length;
+    lldesc_t& d = descriptors[i];
+    d.size = len;
+    d.length = len;
+    d.offset = 0;
+    d.sosf = 0;
+    d.eof = (i == count - 1);
+    d.owner = 1;
+    d.buf = (uint8_t*) ptr;
+    d.empty = (i == count - 1) ? 0 : (uint32_t) &descriptors[i + 1];
+    ptr += len;
+    length -= len;
+  }
+
+  route( true );
+  displayDriver = drv;
+  busy = true;
+  startTime = esp_timer_get_time();
+
+  I2S0.conf.tx_start = 0;
+  I2S0.conf.tx_reset = 1;
+  I2S0.conf.tx_reset = 0;
+  I2S0.conf.tx_fifo_reset = 1;
+  I2S0.conf.tx_fifo_reset = 0;
+  I2S0.lc_conf.out_rst = 1;
+  I2S0.lc_conf.out_rst = 0;
+  I2S0.int_clr.val = 0xFFFFFFFF;
+  I2S0.out_link.addr = (uint32_t) &descriptors[0];
+  I2S0.out_link.start = 1;
+  I2S0.conf.tx_start = 1;
+  return true;
+}
+
+/* Private */
+
+/**
+ * Connect the pins to the I2S0 LCD signals or back to the GPIO output register.
+ */
+void I2SParallelBus::route( bool toI2S ) {
+  if( routed == toI2S ) return;
+  for( uint8_t i = 0; i < 8; i++ ) {
+    gpio_matrix_out( dataPins[i], toI2S ? I2S0O_DATA_OUT16_IDX + i : SIG_GPIO_OUT_IDX, false, false );
+  }
+  gpio_matrix_out( wrPin, toI2S ? I2S0O_WS_OUT_IDX : SIG_GPIO_OUT_IDX, false, false );
+  routed = toI2S;
+}
+
+/**
+ * The EOF interrupt comes when DMA has passed the last byte to the FIFO,
+ * so the FIFO is drained before the transmitter is stopped.
+ */
+void I2SParallelBus::waitIdle() {
+  while( busy ) {
+    // Busy wait, a chunk takes a few milliseconds at most.
+  }
+  if( routed ) {
+    while( !I2S0.state.tx_idle ) {}
+    I2S0.conf.tx_start = 0;
+  }
+}
+
+void I2SParallelBus::interruptHandler( void* arg ) {
+  I2SParallelBus* pThis = (I2SParallelBus*) arg;
+  const uint32_t status = I2S0.int_st.val;
+  I2S0.int_clr.val = status;
+  if( status & I2S_OUT_TOTAL_EOF_INT_ST ) {
+    portENTER_CRITICAL_ISR( &pThis->busyTimeLock );
+    pThis->busyTime += esp_timer_get_time() - pThis->startTime;
+    portEXIT_CRITICAL_ISR( &pThis->busyTimeLock );
+    pThis->busy = false;
+    lv_disp_drv_t* drv = pThis->displayDriver;
+    pThis->displayDriver = nullptr;
+    if( drv ) {
+      lv_disp_flush_ready( drv );
+    }
+  }
+}
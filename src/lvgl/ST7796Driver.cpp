@@ -1,4 +1,5 @@
 #include <SPI.h>
+#include <esp_timer.h>
 #include "lvgl/ST7796Driver.h"
 
 /* Public */
@@ -81,67 +82,76 @@ ST7796Driver::ST7796Driver() {
 	writeCommand( 0x29 );                 // Display on
   cs_high();
 
+  // Pixel data goes by DMA if the I2S peripheral is available.
+  if( ST7796_I2S_DMA ) {
+    bus = new I2SParallelBus( DATA_PINS, ST7796_WR_PIN );
+    if( !bus->begin( ST7796_I2S_CLOCK_DIV )) {
+      delete bus;
+      bus = nullptr;
+    }
+  }
+
   // Setup touch interface
-  pinMode( ST7796_TOUCH_IRQ_PIN, INPUT );
-  pinMode( ST7796_TOUCH_CS_PIN, OUTPUT );
+  touch = new XPT2046Touch();
 }
 
 ST7796Driver::~ST7796Driver() {
-  // Do nothing here
+  delete touch;
+  if( bus ) {
+    delete bus;
+  }
 }
 
 void ST7796Driver::flushArea( lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p ) {
+  // The address window is always bit-banged, the previous DMA transfer must be complete.
+  if( bus ) {
+    bus->release();
+  }
+  const uint32_t count = lv_area_get_size( area );
+  flushStats.flushes++;
+  flushStats.pixels += count;
+
   cs_low();
-  setWindow( area->x1, area->y1, area->x2, area->y2 );
 
-  for( int16_t y = area->y1; y <= area->y2; y++ ) {
-    for( int16_t x = area->x1; x <= area->x2; x++ ) {
-      write16( (*color_p).full );
-      color_p++;
+  if( bus ) {
+    // DMA sends 32-bit words, so an odd pixels count is padded with a copy of the first pixel:
+    // the display wraps the address to the window start and writes the same value again.
+    // It needs the exact window. There is always room for it as the LVGL buffer size is even.
+    const uint32_t padded = (count + 1) & ~1UL;
+    if( bus->canSend( color_p, padded * sizeof(lv_color_t) )) {
+      openWindow( area, padded != count );
+      if( padded != count ) {
+        color_p[count] = color_p[0];
+      }
+      // lv_disp_flush_ready() is called from the DMA interrupt.
+      if( bus->send( color_p, padded * sizeof(lv_color_t), drv )) {
+        return;
+      }
+      windowOpen = false;
     }
   }
 
+  const int64_t start = esp_timer_get_time();
+  openWindow( area, false );
+  writePixels( color_p, count );
+
   cs_high();
+  flushStats.busyTime += esp_timer_get_time() - start;
   // IMPORTANT!!!
   // Inform the graphics library that you are ready with the flushing.
   lv_disp_flush_ready( drv );
 }
 
 bool ST7796Driver::readTouch( lv_indev_drv_t* drv, lv_indev_data_t* data ) {
-  bool valid = true;
-  int16_t x = 0;
-  int16_t y = 0;
-
-  uint8_t irq = digitalRead( Config::ST7796_TOUCH_IRQ_PIN );
-  if( irq == 0 ) {
-    SPI.beginTransaction( SPISettings( TOUCH_SPI_CLOCK, MSBFIRST, SPI_MODE0 ));
-    digitalWrite( ST7796_TOUCH_CS_PIN, LOW );
-    x = read_spi( TOUCH_CMD_X_READ );
-    y = read_spi( TOUCH_CMD_Y_READ );
-    digitalWrite( ST7796_TOUCH_CS_PIN, HIGH );
-    SPI.endTransaction();
-
-    // Normalize Data back to 12-bits
-    x = x >> 4;
-    y = y >> 4;
-
-    xpt2046_corr( &x, &y );
-    xpt2046_avg( &x, &y );
-    last_x = x;
-    last_y = y;
-    //Log.verbose( "TFT touch (x=%d,y=%d)" CR, x, y );
-  } else {
-    x = last_x;
-    y = last_y;
-    avg_last = 0;
-    valid = false;
-  }
-  data->point.x = x;
-  data->point.y = y;
-  data->state = valid == false ? LV_INDEV_STATE_REL : LV_INDEV_STATE_PR;
+  return touch->read( data );
+}
 
-  // No buffering now so no more data read
-  return false;
+FlushStats ST7796Driver::takeFlushStats() {
+  FlushStats s = DisplayDriver::takeFlushStats();
+  if( bus ) {
+    s.busyTime += bus->takeBusyTime();
+  }
+  return s;
 }
 
 void ST7796Driver::setBacklight( bool enable ) {
@@ -152,6 +162,70 @@ void ST7796Driver::setBacklight( bool enable ) {
 
 /* Private */
 
+/**
+ * Set the address window for the area, unless the area continues the open window.
+ * The window is opened to the screen bottom when it's not required to be exact.
+ */
+void ST7796Driver::openWindow( const lv_area_t* area, bool exact ) {
+  if( !exact && windowOpen && area->x1 == windowX1 && area->x2 == windowX2 && area->y1 == windowNextY ) {
+    flushStats.continued++;
+  } else {
+    setWindow( area->x1, area->y1, area->x2, exact ? area->y2 : LV_VER_RES_MAX - 1 );
+    flushStats.windows++;
+  }
+  windowOpen = !exact && area->y2 < LV_VER_RES_MAX - 1;
+  windowX1 = area->x1;
+  windowX2 = area->x2;
+  windowNextY = area->y2 + 1;
+}
+
+/**
+ * Write pixels split to runs of the same color.
+ */
+void ST7796Driver::writePixels( const lv_color_t* color_p, uint32_t count ) {
+  uint32_t i = 0;
+  while( i < count ) {
+    const uint16_t color = color_p[i].full;
+    uint32_t run = 1;
+    while( i + run < count && color_p[i + run].full == color ) {
+      run++;
+    }
+    if( run == count ) {
+      flushStats.solidAreas++;
+    }
+    writeRun( color, run );
+    i += run;
+  }
+}
+
+/**
+ * Write the same color count times. If both color bytes are equal (black, white and
+ * other grays), the data bus is set once and only the WR strobe is toggled.
+ */
+void ST7796Driver::writeRun( uint16_t color, uint32_t count ) {
+  const uint32_t hi = xset_mask[(uint8_t) (color >> 8)];
+  const uint32_t lo = xset_mask[(uint8_t) color];
+  if( hi == lo && count > 1 ) {
+    GPIO.out_w1tc = CLR_MASK;
+    GPIO.out_w1ts = hi;
+    wr_h();
+    for( uint32_t n = count * 2 - 1; n > 0; n-- ) {
+      wr_l();
+      wr_h();
+    }
+    flushStats.runPixels += count;
+  } else {
+    while( count-- ) {
+      GPIO.out_w1tc = CLR_MASK;
+      GPIO.out_w1ts = hi;
+      wr_h();
+      GPIO.out_w1tc = CLR_MASK;
+      GPIO.out_w1ts = lo;
+      wr_h();
+    }
+  }
+}
+
 void ST7796Driver::setWindow( int16_t x0, int16_t y0, int16_t x1, int16_t y1 ) {
   dc_c();
   write8( 0x2A );            // CASET
@@ -170,6 +244,7 @@ void ST7796Driver::setWindow( int16_t x0, int16_t y0, int16_t x1, int16_t y1 ) {
  * Send an 8 bit command to the TFT
  */
 void ST7796Driver::writeCommand( uint8_t c ) {
+  windowOpen = false;                   // Any command ends the memory write
   cs_low();
   dc_c();
   write8( c );
@@ -266,69 +341,3 @@ void ST7796Driver::wr_l() {
 void ST7796Driver::wr_h() {
   GPIO.out_w1ts = (1 << ST7796_WR_PIN);
 }
-
-int16_t ST7796Driver::read_spi( uint8_t reg ) {
-  uint8_t buffer[2];
-  int16_t result;
-
-  SPI.transfer( reg );
-  buffer[0] = SPI.transfer( 0 );
-  buffer[1] = SPI.transfer( 0 );
-
-  result = (buffer[0] << 8) | buffer[1];
-  return result;
-}
-
-void ST7796Driver::xpt2046_avg( int16_t* x, int16_t* y ) {
-  // Shift out the oldest data
-  uint8_t i;
-  for( i = Config::ST7796_TOUCH_AVG - 1; i > 0 ; i-- ) {
-    avg_buf_x[i] = avg_buf_x[i - 1];
-    avg_buf_y[i] = avg_buf_y[i - 1];
-  }
-  // Insert the new point
-  avg_buf_x[0] = *x;
-  avg_buf_y[0] = *y;
-  if( avg_last < Config::ST7796_TOUCH_AVG ) avg_last++;
-  // Sum the x and y coordinates
-  int32_t x_sum = 0;
-  int32_t y_sum = 0;
-  for( i = 0; i < avg_last ; i++ ) {
-    x_sum += avg_buf_x[i];
-    y_sum += avg_buf_y[i];
-  }
-  // Normalize the sums
-  (*x) = (int32_t)x_sum / avg_last;
-  (*y) = (int32_t)y_sum / avg_last;
-}
-
-void ST7796Driver::xpt2046_corr( int16_t* x, int16_t* y ) {
-  if( Config::ST7796_TOUCH_XY_SWAP ) {
-    int16_t swap_tmp;
-    swap_tmp = *x;
-    *x = *y;
-    *y = swap_tmp;
-  }
-
-  if( (*x) > ST7796_TOUCH_X_MIN ) {
-    (*x) -= ST7796_TOUCH_X_MIN;
-  } else {
-    (*x) = 0;
-  }
-
-  if( (*y) > ST7796_TOUCH_Y_MIN ) {
-    (*y) -= ST7796_TOUCH_Y_MIN;
-  } else {
-    (*y) = 0;
-  }
-
-  (*x) = (uint32_t)((uint32_t)(*x) * LV_HOR_RES) / (ST7796_TOUCH_X_MAX - ST7796_TOUCH_X_MIN);
-  (*y) = (uint32_t)((uint32_t)(*y) * LV_VER_RES) / (ST7796_TOUCH_Y_MAX - ST7796_TOUCH_Y_MIN);
-
-  if( ST7796_TOUCH_INVERT_X ) {
-    (*x) = LV_HOR_RES - (*x);
-  }
-  if( ST7796_TOUCH_INVERT_Y ) {
-    (*y) = LV_VER_RES - (*y);
-  }
-}
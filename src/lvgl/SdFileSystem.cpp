@@ -0,0 +1,271 @@
+#include <new>
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "lvgl/SdFileSystem.h"
+
+SdFileSystem* SdFileSystem::instance = nullptr;
+
+/* Public */
+
+SdFileSystem::SdFileSystem( fs::FS& fs, size_t cacheBudget ) : fs(fs), cache(cacheBudget) {
+  instance = this;
+}
+
+SdFileSystem::~SdFileSystem() {
+  // LVGL has no API to unregister drivers, the callbacks check the instance.
+  instance = nullptr;
+}
+
+/**
+ * Register the file system driver and the image decoder in LVGL.
+ */
+void SdFileSystem::begin() {
+  lv_fs_drv_t drv;
+  lv_fs_drv_init( &drv );
+  drv.letter = LETTER;
+  drv.file_size = sizeof(FileHandle);
+  drv.ready_cb = readyCallback;
+  drv.open_cb = openCallback;
+  drv.close_cb = closeCallback;
+  drv.read_cb = readCallback;
+  drv.seek_cb = seekCallback;
+  drv.tell_cb = tellCallback;
+  drv.size_cb = sizeCallback;
+  lv_fs_drv_register( &drv );
+
+  // The decoders created last are asked first, so it goes before the built-in one.
+  lv_img_decoder_t* decoder = lv_img_decoder_create();
+  lv_img_decoder_set_info_cb( decoder, imageInfoCallback );
+  lv_img_decoder_set_open_cb( decoder, imageOpenCallback );
+  lv_img_decoder_set_close_cb( decoder, imageCloseCallback );
+}
+
+/**
+ * Cache hit rates per asset kind and the SD card read throughput.
+ */
+const String SdFileSystem::getStats() {
+  const AssetCache::Stats& s = cache.getStats();
+  const uint32_t pages = s.hits[AssetCache::PAGE] + s.misses[AssetCache::PAGE];
+  const uint32_t images = s.hits[AssetCache::IMAGE] + s.misses[AssetCache::IMAGE];
+  char buf[256];
+  snprintf( buf, sizeof(buf),
+    "{\"budget\":%u,\"used\":%u,\"page_hits\":%lu,\"page_rate\":%lu,\"image_hits\":%lu,\"image_rate\":%lu,"
+    "\"evictions\":%lu,\"read\":%lu,\"kbps\":%lu}",
+    cache.getBudget(), cache.getUsed(),
+    (unsigned long) s.hits[AssetCache::PAGE], (unsigned long) (pages ? s.hits[AssetCache::PAGE] * 100UL / pages : 0),
+    (unsigned long) s.hits[AssetCache::IMAGE], (unsigned long) (images ? s.hits[AssetCache::IMAGE] * 100UL / images : 0),
+    (unsigned long) s.evictions, (unsigned long) bytesRead,
+    (unsigned long) (readTime ? (uint64_t) bytesRead * 1000 / 1024 * 1000 / readTime : 0) );
+  return buf;
+}
+
+/* Private */
+
+/**
+ * Read from the current position. Whole pages at page boundaries are read straight
+ * into the buffer, the rest goes through the page cache.
+ */
+lv_fs_res_t SdFileSystem::read( FileHandle* fh, uint8_t* buf, uint32_t btr, uint32_t* br ) {
+  *br = 0;
+  if( fh->pos >= fh->size ) {
+    return LV_FS_RES_OK;
+  }
+  if( btr > fh->size - fh->pos ) {
+    btr = fh->size - fh->pos;
+  }
+
+  while( btr > 0 ) {
+    const uint32_t page = fh->pos / PAGE_SIZE;
+    const uint32_t offset = fh->pos % PAGE_SIZE;
+    uint32_t n;
+
+    if( offset == 0 && btr >= PAGE_SIZE ) {
+      n = btr - btr % PAGE_SIZE;
+      if( !readFromCard( fh->file, fh->pos, buf, n )) {
+        return LV_FS_RES_HW_ERR;
+      }
+    } else {
+      AssetCache::Entry* entry = cache.find( AssetCache::PAGE, fh->id, page );
+      if( entry == nullptr ) {
+        const uint32_t start = page * PAGE_SIZE;
+        const uint32_t len = min( (uint32_t) PAGE_SIZE, fh->size - start );
+        entry = cache.insert( AssetCache::PAGE, fh->id, page, len );
+        if( entry && !readFromCard( fh->file, start, entry->data, len )) {
+          cache.remove( entry );
+          return LV_FS_RES_HW_ERR;
+        }
+      }
+      n = min( btr, (uint32_t) PAGE_SIZE - offset );
+      if( entry ) {
+        n = min( n, entry->size - offset );
+        memcpy( buf, entry->data + offset, n );
+      } else if( !readFromCard( fh->file, fh->pos, buf, n )) {
+        // No room in the cache, e.g. all entries are in use.
+        return LV_FS_RES_HW_ERR;
+      }
+    }
+    fh->pos += n;
+    buf += n;
+    btr -= n;
+    *br += n;
+  }
+  return LV_FS_RES_OK;
+}
+
+bool SdFileSystem::readFromCard( fs::File& file, uint32_t offset, uint8_t* dst, uint32_t len ) {
+  const int64_t start = esp_timer_get_time();
+  if( file.position() != offset && !file.seek( offset )) {
+    return false;
+  }
+  const size_t n = file.read( dst, len );
+  readTime += esp_timer_get_time() - start;
+  bytesRead += n;
+  return n == len;
+}
+
+/**
+ * FNV-1a hash of the path.
+ */
+uint32_t SdFileSystem::hash( const char* path ) {
+  uint32_t h = 2166136261UL;
+  while( *path ) {
+    h = (h ^ (uint8_t) *path++) * 16777619UL;
+  }
+  return h;
+}
+
+/**
+ * LVGL paths come without the drive letter, the SD card paths start with the slash.
+ */
+String SdFileSystem::toCardPath( const char* path ) {
+  return path[0] == '/' ? String( path ) : "/" + String( path );
+}
+
+/* lv_fs driver callbacks */
+
+bool SdFileSystem::readyCallback( lv_fs_drv_t* drv ) {
+  return instance != nullptr;
+}
+
+lv_fs_res_t SdFileSystem::openCallback( lv_fs_drv_t* drv, void* file_p, const char* path, lv_fs_mode_t mode ) {
+  if( instance == nullptr ) return LV_FS_RES_NOT_EX;
+  if( mode != LV_FS_MODE_RD ) return LV_FS_RES_NOT_IMP;
+
+  fs::File file = instance->fs.open( toCardPath( path ), FILE_READ );
+  if( !file || file.isDirectory() ) {
+    return LV_FS_RES_NOT_EX;
+  }
+  new (file_p) FileHandle{ file, hash( path ), 0, (uint32_t) file.size() };
+  return LV_FS_RES_OK;
+}
+
+lv_fs_res_t SdFileSystem::closeCallback( lv_fs_drv_t* drv, void* file_p ) {
+  FileHandle* fh = (FileHandle*) file_p;
+  fh->file.close();
+  fh->~FileHandle();
+  return LV_FS_RES_OK;
+}
+
+lv_fs_res_t SdFileSystem::readCallback( lv_fs_drv_t* drv, void* file_p, void* buf, uint32_t btr, uint32_t* br ) {
+  if( instance == nullptr ) return LV_FS_RES_NOT_EX;
+  return instance->read( (FileHandle*) file_p, (uint8_t*) buf, btr, br );
+}
+
+lv_fs_res_t SdFileSystem::seekCallback( lv_fs_drv_t* drv, void* file_p, uint32_t pos ) {
+  FileHandle* fh = (FileHandle*) file_p;
+  fh->pos = min( pos, fh->size );
+  return LV_FS_RES_OK;
+}
+
+lv_fs_res_t SdFileSystem::tellCallback( lv_fs_drv_t* drv, void* file_p, uint32_t* pos_p ) {
+  *pos_p = ((FileHandle*) file_p)->pos;
+  return LV_FS_RES_OK;
+}
+
+lv_fs_res_t SdFileSystem::sizeCallback( lv_fs_drv_t* drv, void* file_p, uint32_t* size_p ) {
+  *size_p = ((FileHandle*) file_p)->size;
+  return LV_FS_RES_OK;
+}
+
+/* Image decoder callbacks */
+
+/**
+ * Accept the true color ".bin" images of the SD card drive, others are left to
+ * the built-in decoder.
+ */
+lv_res_t SdFileSystem::imageInfoCallback( lv_img_decoder_t* decoder, const void* src, lv_img_header_t* header ) {
+  if( instance == nullptr || lv_img_src_get_type( src ) != LV_IMG_SRC_FILE ) {
+    return LV_RES_INV;
+  }
+  const char* path = (const char*) src;
+  if( path[0] != LETTER || path[1] != ':' || strcmp( lv_fs_get_ext( path ), "bin" ) != 0 ) {
+    return LV_RES_INV;
+  }
+  lv_fs_file_t file;
+  if( lv_fs_open( &file, path, LV_FS_MODE_RD ) != LV_FS_RES_OK ) {
+    return LV_RES_INV;
+  }
+  uint32_t br;
+  const lv_fs_res_t rc = lv_fs_read( &file, header, sizeof(lv_img_header_t), &br );
+  lv_fs_close( &file );
+  if( rc != LV_FS_RES_OK || br != sizeof(lv_img_header_t) ) {
+    return LV_RES_INV;
+  }
+  switch( header->cf ) {
+    case LV_IMG_CF_TRUE_COLOR:
+    case LV_IMG_CF_TRUE_COLOR_ALPHA:
+    case LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED:
+      return LV_RES_OK;
+    default:
+      return LV_RES_INV;
+  }
+}
+
+/**
+ * Give LVGL the image pixels from the cache, loading the whole image on a miss.
+ * Images larger than a half of the cache are left to the built-in line by line decoder.
+ */
+lv_res_t SdFileSystem::imageOpenCallback( lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc ) {
+  if( instance == nullptr || dsc->src_type != LV_IMG_SRC_FILE ) {
+    return LV_RES_INV;
+  }
+  AssetCache& cache = instance->cache;
+  const char* path = (const char*) dsc->src;
+  const uint32_t key = hash( path + 2 );
+  AssetCache::Entry* entry = cache.find( AssetCache::IMAGE, key, 0 );
+
+  if( entry == nullptr ) {
+    fs::File file = instance->fs.open( toCardPath( path + 2 ), FILE_READ );
+    if( !file ) {
+      return LV_RES_INV;
+    }
+    const uint32_t size = file.size() - sizeof(lv_img_header_t);
+    if( file.size() < sizeof(lv_img_header_t) || size > cache.getBudget() / 2 ) {
+      file.close();
+      return LV_RES_INV;
+    }
+    entry = cache.insert( AssetCache::IMAGE, key, 0, size );
+    if( entry == nullptr ) {
+      file.close();
+      return LV_RES_INV;
+    }
+    const bool ok = instance->readFromCard( file, sizeof(lv_img_header_t), entry->data, size );
+    file.close();
+    if( !ok ) {
+      cache.remove( entry );
+      return LV_RES_INV;
+    }
+  }
+
+  cache.pin( entry );
+  dsc->img_data = entry->data;
+  dsc->user_data = entry;
+  return LV_RES_OK;
+}
+
+void SdFileSystem::imageCloseCallback( lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc ) {
+  if( instance && dsc->user_data ) {
+    instance->cache.unpin( (AssetCache::Entry*) dsc->user_data );
+    dsc->user_data = nullptr;
+  }
+}
@@ -0,0 +1,176 @@
+#include <Arduino.h>
+#include <SPI.h>
+#include "lvgl/XPT2046Touch.h"
+
+/* Public */
+
+XPT2046Touch::XPT2046Touch() {
+  calibration = getDefaultCalibration();
+
+  // The command frame: all X conversions, then all Y ones. Every command is followed
+  // by a zero byte, the 12-bit result comes in the two bytes after the command.
+  memset( command, 0, sizeof(command) );
+  for( uint8_t i = 0; i < SAMPLES; i++ ) {
+    command[i * 2] = CMD_X_READ;
+    command[(SAMPLES + i) * 2] = CMD_Y_READ;
+  }
+
+  pinMode( Config::ST7796_TOUCH_CS_PIN, OUTPUT );
+  digitalWrite( Config::ST7796_TOUCH_CS_PIN, HIGH );
+  pinMode( Config::ST7796_TOUCH_IRQ_PIN, INPUT );
+
+  queue = xQueueCreate( QUEUE_LENGTH, sizeof(Point) );
+  xTaskCreate( taskFunction, "touch", 2048, this, 2, &task );
+  attachInterruptArg( Config::ST7796_TOUCH_IRQ_PIN, penIrqHandler, this, FALLING );
+}
+
+XPT2046Touch::~XPT2046Touch() {
+  detachInterrupt( Config::ST7796_TOUCH_IRQ_PIN );
+  if( task ) {
+    vTaskDelete( task );
+  }
+  vQueueDelete( queue );
+}
+
+/**
+ * LVGL input read. Returns true if more points are waiting in the queue.
+ */
+bool XPT2046Touch::read( lv_indev_data_t* data ) {
+  Point p;
+  if( xQueueReceive( queue, &p, 0 ) == pdTRUE ) {
+    last = p;
+  }
+  data->point.x = last.x;
+  data->point.y = last.y;
+  data->state = last.pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+  return uxQueueMessagesWaiting( queue ) > 0;
+}
+
+/**
+ * The last raw coordinates, for the calibration. Returns true if the panel is pressed.
+ */
+bool XPT2046Touch::getRaw( int16_t* x, int16_t* y ) {
+  *x = rawX;
+  *y = rawY;
+  return sampling;
+}
+
+TouchCalibration XPT2046Touch::getDefaultCalibration() {
+  return {
+    Config::ST7796_TOUCH_X_MIN, Config::ST7796_TOUCH_Y_MIN, Config::ST7796_TOUCH_X_MAX, Config::ST7796_TOUCH_Y_MAX,
+    Config::ST7796_TOUCH_XY_SWAP, Config::ST7796_TOUCH_INVERT_X, Config::ST7796_TOUCH_INVERT_Y, 0
+  };
+}
+
+/* Private */
+
+/**
+ * Queue the point. If LVGL is late, the oldest point is dropped.
+ */
+void XPT2046Touch::push( const Point& p ) {
+  if( xQueueSend( queue, &p, 0 ) != pdTRUE ) {
+    Point dropped;
+    xQueueReceive( queue, &dropped, 0 );
+    xQueueSend( queue, &p, 0 );
+  }
+}
+
+void XPT2046Touch::run() {
+  Point p = {0, 0, false};
+  for( ;; ) {
+    ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    sampling = true;
+    while( digitalRead( Config::ST7796_TOUCH_IRQ_PIN ) == LOW ) {
+      if( sample( p )) {
+        push( p );
+      }
+      vTaskDelay( pdMS_TO_TICKS( Config::ST7796_TOUCH_PERIOD ));
+    }
+    p.pressed = false;
+    push( p );
+    sampling = false;
+    // The edge may come between the last check and the flag reset.
+    if( digitalRead( Config::ST7796_TOUCH_IRQ_PIN ) == LOW ) {
+      xTaskNotifyGive( task );
+    }
+  }
+}
+
+/**
+ * Take all samples in one SPI transfer and filter them with the median.
+ * Returns false if the panel has been released during the conversion.
+ */
+bool XPT2046Touch::sample( Point& p ) {
+  uint8_t response[FRAME_SIZE];
+  SPI.beginTransaction( SPISettings( SPI_CLOCK, MSBFIRST, SPI_MODE0 ));
+  digitalWrite( Config::ST7796_TOUCH_CS_PIN, LOW );
+  SPI.transferBytes( command, response, FRAME_SIZE );
+  digitalWrite( Config::ST7796_TOUCH_CS_PIN, HIGH );
+  SPI.endTransaction();
+
+  if( digitalRead( Config::ST7796_TOUCH_IRQ_PIN ) != LOW ) {
+    return false;
+  }
+
+  int16_t xs[SAMPLES];
+  int16_t ys[SAMPLES];
+  for( uint8_t i = 0; i < SAMPLES; i++ ) {
+    const uint8_t* x = &response[i * 2 + 1];
+    const uint8_t* y = &response[(SAMPLES + i) * 2 + 1];
+    xs[i] = ((x[0] << 8) | x[1]) >> 4;
+    ys[i] = ((y[0] << 8) | y[1]) >> 4;
+  }
+  rawX = median( xs, SAMPLES );
+  rawY = median( ys, SAMPLES );
+  toScreen( rawX, rawY, p );
+  return true;
+}
+
+/**
+ * Convert raw values to the screen coordinates.
+ */
+void XPT2046Touch::toScreen( int16_t x, int16_t y, Point& p ) {
+  if( calibration.swapXY ) {
+    const int16_t t = x;
+    x = y;
+    y = t;
+  }
+  x = x > calibration.xMin ? x - calibration.xMin : 0;
+  y = y > calibration.yMin ? y - calibration.yMin : 0;
+  x = (uint32_t) x * LV_HOR_RES / (calibration.xMax - calibration.xMin);
+  y = (uint32_t) y * LV_VER_RES / (calibration.yMax - calibration.yMin);
+  if( calibration.invertX ) x = LV_HOR_RES - x;
+  if( calibration.invertY ) y = LV_VER_RES - y;
+
+  p.x = constrain( x, 0, LV_HOR_RES - 1 );
+  p.y = constrain( y, 0, LV_VER_RES - 1 );
+  p.pressed = true;
+}
+
+int16_t XPT2046Touch::median( int16_t* values, uint8_t count ) {
+  for( uint8_t i = 1; i < count; i++ ) {
+    const int16_t v = values[i];
+    int8_t j = i - 1;
+    while( j >= 0 && values[j] > v ) {
+      values[j + 1] = values[j];
+      j--;
+    }
+    values[j + 1] = v;
+  }
+  return values[count / 2];
+}
+
+void XPT2046Touch::taskFunction( void* arg ) {
+  ((XPT2046Touch*) arg)->run();
+}
+
+void IRAM_ATTR XPT2046Touch::penIrqHandler( void* arg ) {
+  XPT2046Touch* pThis = (XPT2046Touch*) arg;
+  if( !pThis->sampling ) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR( pThis->task, &woken );
+    if( woken ) {
+      portYIELD_FROM_ISR();
+    }
+  }
+}
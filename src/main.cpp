@@ -5,6 +5,7 @@
 #include "ModulesManager.h"
 #include "Options.h"
 #include "Utils.h"
+#include "core/ScratchArena.h"
 
 #include "WiFiModule.h"
 
@@ -13,6 +14,7 @@ uint8_t        state_100mS_phase = 0;
 
 void setup() {
   Serial.begin( Config::APP_SERIAL_BAUDRATE );
+  Scratch::begin( Config::SCRATCH_ARENA_SIZE );
   Options::setupPreferences();
 
   // Configure modules.
@@ -29,6 +31,8 @@ void setup() {
 
 void loop() {
   const uint32_t timestamp = micros();
+  // Short-lived buffers allocated by the modules and event listeners are released after each pass.
+  Scratch::Scope scratch;
 
   Modules.iterator( [](Module* module) {
     Module::Properties properties = module->getProperties();
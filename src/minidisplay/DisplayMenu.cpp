@@ -1,180 +1,25 @@
+#include <algorithm>
 #include <ArduinoLog.h>
+#include <ArduinoJson.h>
 #include "Config.h"
+#include "str_switch.h"
 #include "Utils.h"
+#include "core/Tokenizer.h"
 #include "minidisplay/DisplayMenu.h"
 
 using namespace DisplayMenu;
 
-/* Menu entry (the base class) */
-
-Entry::Entry( const String& _id, const String& _title ) {
-  id.reserve( MAX_MENU_ID_LENGTH );
-  id = _id;
-  title = _title;
-  visible = true;
-}
-
-Entry::Entry( const String& _id, const String& _title, const String& _text ) {
-  id.reserve( MAX_MENU_ID_LENGTH );
-  id = _id;
-  title = _title;
-  text = _text;
-  visible = true;
-}
-
-/**
- * Draw an entry title + text on center. The title is drawn using a big font,
- * and the text - using a small one. The outer rectangle is always drawn to
- * indicate that it's an active entry.
- */
-void Entry::draw( Display_SSD1306& display ) {
-  bool draw_title = title.length() > 0 && title.charAt(0) != '~';
-  bool draw_text = text.length() > 0;
-  // Draw the title.
-  if( draw_title ) {
-    uint16_t h = TEXT_HEIGHT + ENTRY_PADDING + TITLE_OFFSET_Y;
-    if( !draw_text ) h += (DISPLAY_HEIGHT - TEXT_HEIGHT*2) / 4;
-    display.setFont( TITLE_FONT );
-    display.setCursor( ENTRY_PADDING, h );
-    display.printLine( title );
-  }
-  // Draw the text.
-  if( draw_text ) {
-    uint16_t h = TEXT_HEIGHT + ENTRY_PADDING + TEXT_OFFSET_Y;
-    if( draw_title ) h += TITLE_HEIGHT + 3;
-    display.setFont( TEXT_FONT );
-    display.setCursor( ENTRY_PADDING, h );
-    display.printLine( text );
-  }
-  // Draw a rectangular cursor around.
-  display.drawRect( 0, TEXT_HEIGHT, DISPLAY_WIDTH, DISPLAY_HEIGHT - TEXT_HEIGHT*2 - 1, WHITE );
-}
-
-/**
- * Draw an entry title on bottom using a small font.
- */
-void Entry::drawTitleOnTop( Display_SSD1306& display ) {
-  display.setFont( TEXT_FONT );
-  display.setCursor( ENTRY_PADDING, TEXT_OFFSET_Y );
-  if( !title.isEmpty() ) {
-    display.printLine( title );
-  } else {
-    display.printLine( id );
-  }
-}
-
-/**
- * Draw an entry title on bottom using a small font.
- */
-void Entry::drawTitleOnBottom( Display_SSD1306& display ) {
-  display.setFont( TEXT_FONT );
-  display.setCursor( ENTRY_PADDING, DISPLAY_HEIGHT-2 );
-  if( !title.isEmpty() ) {
-    display.printLine( title );
-  } else {
-    display.printLine( id );
-  }
-}
-
-uint8_t Entry::getHeight( Display_SSD1306& display ) {
-  uint8_t height = ENTRY_PADDING + ENTRY_PADDING;
-  if( title.length() > 0 ) {
-    height += TITLE_HEIGHT;
-  }
-  if( text.length() > 0 ) {
-    int16_t  x1, y1;
-    uint16_t w, h;
-    display.getTextBounds( text, 0, 0, &x1, &y1, &w, &h );
-    height += h;
-  }
-  return height;
-}
-
-void Entry::onKeyPress( const KeyEvent ev, Executor& executor ) {
-  switch( ev ) {
-    case UP:
-      executor.selectEntry( PREVIOUS_ENTRY_OR_VALUE );
-      break;
-    case DOWN:
-      executor.selectEntry( NEXT_ENTRY_OR_VALUE );
-      break;
-    default:
-      break;
-  }
-}
-
-/* Command menu entry */
-
-void Command::onKeyPress( const KeyEvent ev, Executor& executor ) {
-  if( ev == SELECT ) {
-    executor.executeEntryCommand( command );
-  } else {
-    // Parent class handles UP and DOWN events.
-    Entry::onKeyPress( ev, executor );
-  }
-}
-
-/* Link menu entry */
-
-void Link::onKeyPress( const KeyEvent ev, Executor& executor ) {
-  if( ev == SELECT ) {
-    // Try to split the target into menu ID and entry ID. It's also fine to have an empty entry ID.
-    auto pair = Utils::split( targetMenuId, '/' );
-    executor.showMenu( pair.first, pair.second );
-  } else {
-    // Parent class handles UP and DOWN events.
-    Entry::onKeyPress( ev, executor );
-  }
-}
-
-/* BaseEditor menu entry */
-
-void BaseEditor::onKeyPress( const KeyEvent ev, Executor& executor ) {
-  if( flags.editMode ) {
-    switch( ev ) {
-      case UP:
-        if( selectValue( PREVIOUS_ENTRY_OR_VALUE )) {
-          executor.showEntryEditor( false );
-        }
-        break;
-      case DOWN:
-        if( selectValue( NEXT_ENTRY_OR_VALUE )) {
-          executor.showEntryEditor( false );
-        }
-        break;
-      case SELECT:
-        executor.dismissEntryEditor( getValueAsString() );
-        flags.editMode = false;
-        break;
-    }
-  } else {
-    switch( ev ) {
-      case UP:
-        executor.selectEntry( PREVIOUS_ENTRY_OR_VALUE );
-        break;
-      case DOWN:
-        executor.selectEntry( NEXT_ENTRY_OR_VALUE );
-        break;
-      case SELECT:
-        executor.showEntryEditor( true );
-        break;
-    }
-  }
-}
-
-/* Number editor menu entry */
-
-void Number::drawEditor( Display_SSD1306& display ) {
-  drawTitleOnTop( display );
+/* Number editor */
 
+void NumberEditor::draw( Display_SSD1306& display ) {
   // Calc the max width of value that can be drawn.
   display.setFont( TITLE_FONT );
-  if( flags.needMeasureWidth ) {
+  if( needMeasureWidth ) {
     int16_t x1, y1;
     uint16_t w, h;
     display.getTextBounds( String( max ), 0, 0, &x1, &y1, &w, &h );
     valueMaxWidth = w + ENTRY_PADDING * 3;
-    flags.needMeasureWidth = false;
+    needMeasureWidth = false;
   }
 
   uint16_t x = DISPLAY_WIDTH - valueMaxWidth - ENTRY_PADDING * 2;
@@ -205,20 +50,16 @@ void Number::drawEditor( Display_SSD1306& display ) {
   }
 }
 
-void Number::setValue( int value, int min, int max, int step ) {
+void NumberEditor::setValue( int value, int min, int max, int step ) {
   this->value = value;
   this->min = min;
   this->max = max;
   this->step = step;
-  flags.needMeasureWidth = true;
-  flags.editMode = true;
+  needMeasureWidth = true;
+  editMode = true;
 }
 
-const String Number::getValueAsString() {
-  return String( value );
-}
-
-bool Number::selectValue( int8_t index ) {
+bool NumberEditor::selectValue( int8_t index ) {
   if( index == NEXT_ENTRY_OR_VALUE ) {
     if( value < max ) {
       value += step;
@@ -234,153 +75,490 @@ bool Number::selectValue( int8_t index ) {
   return false;
 }
 
-/* Choice editor menu entry */
+/* MenuImage: compilation */
 
-void Choice::drawEditor( Display_SSD1306& display ) {
-  //TODO
+/**
+ * Compile the menu JSON into the binary image. Returns false if the JSON cannot be decoded
+ * or there is no menu in it.
+ * Note: The ArduinoJson .as<char*>() cast is used to avoid applying "null" value to empty strings.
+ */
+bool MenuImage::compile( const String& json, std::vector<uint8_t>& out ) {
+  DynamicJsonDocument doc( Config::JSON_CONFIG_SIZE * 2 );
+  DeserializationError rc = deserializeJson( doc, json );
+  // If the menu JSON cannot be decoded.
+  if( rc != DeserializationError::Ok ) {
+    Log.error( "DISP Menu decode error. %s" CR, rc.c_str() );
+    return false;
+  }
+
+  std::vector<MenuRecord> menuRecords;
+  std::vector<EntryRecord> entryRecords;
+  std::vector<String> keys;
+  std::vector<char> pool( 1, '\0' );       // The offset 0 is an empty string.
+
+  // Add a string to the pool, identical strings are stored once.
+  auto addString = [&pool]( const char* s ) -> uint16_t {
+    const size_t length = s ? strlen( s ) : 0;
+    if( length == 0 ) return 0;
+    for( size_t i = 1; i + length < pool.size(); i++ ) {
+      if( memcmp( &pool[i], s, length + 1 ) == 0 ) return i;
+    }
+    const size_t offset = pool.size();
+    pool.insert( pool.end(), s, s + length + 1 );
+    return offset;
+  };
+  // Add a title or text, the template keys are moved to the keys table.
+  auto addLine = [&]( const char* s ) -> uint16_t {
+    String line;
+    compileLine( s ? s : "", line, [&keys, &addString]( const char* key, size_t length ) -> uint8_t {
+      const String k = String( key ).substring( 0, length );
+      for( size_t i = 0; i < keys.size(); i++ ) {
+        if( keys[i] == k ) return i + 1;
+      }
+      if( keys.size() >= 254 ) return 0;
+      keys.push_back( k );
+      return keys.size();
+    });
+    return addString( line.c_str() );
+  };
+
+  JsonObject root = doc.as<JsonObject>();
+  const uint16_t defaultMenu = addString( root["default"].as<char*>() );
+  const uint16_t topic = addString( root["topic"].as<char*>() );
+
+  for( JsonObject item : root["menu"].as<JsonArray>() ) {
+    // The menu or entry JSON object must have the "id" and "type" fields.
+    // Also they may have "title", "text", "payload" or "target" and "visible" fields.
+    const char* type = item["type"].as<char*>();
+    const char* title = item["title"].as<char*>();
+    EntryRecord entry = { ENTRY_TEXT, 0, 0, 0, 0, 0 };
+    SWITCH( type ? type : "" ) {
+      CASE( "menu" ): {
+        if( menuRecords.size() == 255 ) continue;
+        const uint16_t id = addString( item["id"].as<char*>() );
+        menuRecords.push_back({ id, addLine( title ), (uint16_t) entryRecords.size(), 0 });
+        continue;
+      }
+      CASE( "entry" ):
+        entry.kind = ENTRY_TEXT;
+        break;
+      CASE( "cmd" ):
+        entry.kind = ENTRY_COMMAND;
+        entry.payload = addString( item["payload"].as<char*>() );
+        break;
+      CASE( "link" ):
+        entry.kind = ENTRY_LINK;
+        entry.payload = addString( item["target"].as<char*>() );
+        break;
+      CASE( "number" ):
+        entry.kind = ENTRY_NUMBER;
+        break;
+      DEFAULT_CASE:
+        continue;
+    }
+    // Entries out of any menu are ignored.
+    if( menuRecords.empty() ) continue;
+    entry.id = addString( item["id"].as<char*>() );
+    entry.title = addLine( title );
+    entry.text = addLine( item["text"].as<char*>() );
+    if( title && title[0] == '~' ) entry.flags |= FLAG_HIDDEN_TITLE;
+    if( item["visible"].is<bool>() && !item["visible"].as<bool>() ) entry.flags |= FLAG_INVISIBLE;
+    entryRecords.push_back( entry );
+    menuRecords.back().entriesCount++;
+  }
+
+  if( menuRecords.empty() ) {
+    Log.notice( "DISP The menu config is empty" CR );
+    return false;
+  }
+
+  std::vector<uint16_t> keyOffsets;
+  for( const String& key : keys ) {
+    keyOffsets.push_back( addString( key.c_str() ));
+  }
+  if( pool.size() > UINT16_MAX ) {
+    Log.error( "DISP The menu config is too big" CR );
+    return false;
+  }
+
+  const ImageHeader header = {
+    { IMAGE_MAGIC[0], IMAGE_MAGIC[1] }, IMAGE_VERSION, (uint8_t) menuRecords.size(),
+    (uint16_t) entryRecords.size(), (uint16_t) keyOffsets.size(), defaultMenu, topic, (uint16_t) pool.size()
+  };
+  auto append = [&out]( const void* data, size_t size ) {
+    out.insert( out.end(), (const uint8_t*) data, (const uint8_t*) data + size );
+  };
+  out.clear();
+  append( &header, sizeof(header) );
+  append( menuRecords.data(), menuRecords.size() * sizeof(MenuRecord) );
+  append( entryRecords.data(), entryRecords.size() * sizeof(EntryRecord) );
+  append( keyOffsets.data(), keyOffsets.size() * sizeof(uint16_t) );
+  append( pool.data(), pool.size() );
+  return true;
 }
 
-void Choice::setValue( std::vector<String>& options, String& selectedKey ) {
-  this->options = options;
-  // Find the selected option, because it's need to obtain the selected option.
-  auto it = std::find_if( options.begin(), options.end(), [&selectedKey](String& kv) {
-    auto pair = Utils::split( kv, '/' );
-    return selectedKey == pair.first;
-  });
-  if( it != options.end() ) {
-    selectedPosition = std::distance( options.begin(), it );
-  } else {
-    selectedPosition = 0;
+/**
+ * Replace %KEY% parameters with PARAM_MARK and the key index + 1 provided by the callback,
+ * remove '~' characters. An unterminated key is dropped, as well as keys the callback
+ * returns 0 for.
+ */
+void MenuImage::compileLine( const char* source, String& out, const std::function<uint8_t(const char* key, size_t length)>& keyIndex ) {
+  out = "";
+  const char* key = nullptr;
+  for( const char* p = source; *p; p++ ) {
+    const char c = *p;
+    if( key ) {
+      if( c == '%' ) {
+        // SWITCH macro requires 9 chars max.
+        const size_t length = std::min( (size_t) (p - key), (size_t) TemplateParams::MAX_KEY_LENGTH );
+        const uint8_t index = length > 0 ? keyIndex( key, length ) : 0;
+        if( index > 0 ) {
+          out += PARAM_MARK;
+          out += (char) index;
+        }
+        key = nullptr;
+      }
+    } else if( c == '%' ) {
+      key = p + 1;
+    } else if( c != '~' && c != PARAM_MARK ) {
+      out += c;
+    }
   }
 }
 
-const String Choice::getValueAsString() {
-  String option = options.at( selectedPosition );
-  auto pair = Utils::split( option, '/' );
-  return pair.first;
+/* MenuImage: loading */
+
+/**
+ * Load the compiled image, the menu takes the image buffer over, so it's never copied.
+ * The template parameters of the image are bound to the table slots here, so lines are
+ * rendered without any lookups. A rejected image is left to the caller, the loaded one is kept.
+ */
+bool MenuImage::load( std::vector<uint8_t>&& data, TemplateParams& templateParams ) {
+  if( !validate( data.data(), data.size() )) {
+    Log.error( "DISP The menu image is corrupted" CR );
+    return false;
+  }
+  image = std::move( data );
+  header = (const ImageHeader*) image.data();
+  menus = (const MenuRecord*) (image.data() + sizeof(ImageHeader));
+  entries = (const EntryRecord*) (menus + header->menusCount);
+  strings = (const char*) (image.data() + image.size() - header->stringsSize);
+  params = &templateParams;
+
+  const uint16_t* keys = (const uint16_t*) (entries + header->entriesCount);
+  keySlots.clear();
+  for( uint16_t i = 0; i < header->keysCount; i++ ) {
+    const char* key = str( keys[i] );
+    keySlots.push_back( params->obtain( key, strlen( key )));
+  }
+  entryFlags.resize( header->entriesCount );
+  for( uint16_t i = 0; i < header->entriesCount; i++ ) {
+    entryFlags[i] = entries[i].flags;
+  }
+  overrides.clear();
+  return true;
 }
 
-bool Choice::selectValue( int8_t index ) {
-  if( index == NEXT_ENTRY_OR_VALUE ) {
-    //TODO
+/**
+ * Check the whole image, so a truncated or corrupted blob is rejected here and never read
+ * out of bounds later: the sizes, every string offset, the menus entries ranges (the menus
+ * cover all the entries in order, as compile() makes them) and the template key indexes.
+ */
+bool MenuImage::validate( const uint8_t* data, size_t size ) {
+  const ImageHeader* h = (const ImageHeader*) data;
+  if( !data || size < sizeof(ImageHeader) || h->magic[0] != IMAGE_MAGIC[0] || h->magic[1] != IMAGE_MAGIC[1] ||
+      h->version != IMAGE_VERSION || h->menusCount == 0 ) {
+    return false;
   }
-  else if( index == PREVIOUS_ENTRY_OR_VALUE ) {
-    //TODO
+  const size_t stringsOffset = sizeof(ImageHeader) + h->menusCount * sizeof(MenuRecord) +
+    h->entriesCount * sizeof(EntryRecord) + h->keysCount * sizeof(uint16_t);
+  if( stringsOffset + h->stringsSize != size || h->stringsSize == 0 || data[size - 1] != '\0' ) {
+    return false;
   }
-  return false;
+  const char* strings = (const char*) (data + stringsOffset);
+  const uint16_t stringsSize = h->stringsSize;
+  auto isString = [=]( uint16_t offset ) -> bool {
+    return offset < stringsSize;
+  };
+  // Every parameter mark must be followed by an image key index.
+  auto isLine = [=]( uint16_t offset ) -> bool {
+    if( !isString( offset )) return false;
+    for( const char* p = strings + offset; *p; p++ ) {
+      if( *p == PARAM_MARK && ((uint8_t) *++p == 0 || (uint8_t) *p > h->keysCount) ) return false;
+    }
+    return true;
+  };
+
+  if( !isString( h->defaultMenu ) || !isString( h->topic )) return false;
+  const MenuRecord* menus = (const MenuRecord*) (data + sizeof(ImageHeader));
+  uint32_t nextEntry = 0;
+  for( uint8_t i = 0; i < h->menusCount; i++ ) {
+    if( !isString( menus[i].id ) || !isLine( menus[i].title ) || menus[i].firstEntry != nextEntry ) return false;
+    nextEntry += menus[i].entriesCount;
+  }
+  if( nextEntry != h->entriesCount ) return false;
+  const EntryRecord* entries = (const EntryRecord*) (menus + h->menusCount);
+  for( uint16_t i = 0; i < h->entriesCount; i++ ) {
+    const EntryRecord& e = entries[i];
+    if( e.kind > ENTRY_NUMBER || !isString( e.id ) || !isLine( e.title ) || !isLine( e.text ) ||
+        !isString( e.payload )) {
+      return false;
+    }
+  }
+  const uint16_t* keys = (const uint16_t*) (entries + h->entriesCount);
+  for( uint16_t i = 0; i < h->keysCount; i++ ) {
+    if( !isString( keys[i] ) || keys[i] == 0 ) return false;
+  }
+  return true;
 }
 
-/* Menu */
+/* MenuImage: navigation */
 
-Menu::Menu( const String& id, const String& title ) {
-  this->menuId = id;
-  this->title = title;
+int16_t MenuImage::findMenu( const String& id ) {
+  for( uint8_t i = 0; i < getMenusCount(); i++ ) {
+    if( id == str( menus[i].id )) return i;
+  }
+  return NO_ENTRY;
 }
 
-Menu::Menu( const String& id, const String& title, const std::initializer_list<Entry*> &list )
-  : Menu( id, title ) {
-  for( auto x : list ) {
-    entries.push_back( x );
+int16_t MenuImage::findEntry( int16_t menu, const String& id ) {
+  if( menu == NO_ENTRY ) return NO_ENTRY;
+  const MenuRecord& m = menus[menu];
+  for( uint16_t i = m.firstEntry; i < m.firstEntry + m.entriesCount; i++ ) {
+    if( id == str( entries[i].id )) return i;
   }
+  return NO_ENTRY;
 }
 
-/**
- * The menu title is always drawn at top using a small font.
- */
-void Menu::drawTitleOnTop( Display_SSD1306& display ) {
-  display.setFont( TEXT_FONT );
-  display.setCursor( ENTRY_PADDING, TEXT_OFFSET_Y );
-  display.printLine( title );
+int16_t MenuImage::findEntry( const String& id ) {
+  for( uint16_t i = 0; i < getEntriesCount(); i++ ) {
+    if( id == str( entries[i].id )) return i;
+  }
+  return NO_ENTRY;
 }
 
-/* Menu entries management */
+int16_t MenuImage::getMenuOf( int16_t entry ) {
+  for( uint8_t i = 0; i < getMenusCount(); i++ ) {
+    if( entry >= menus[i].firstEntry && entry < menus[i].firstEntry + menus[i].entriesCount ) return i;
+  }
+  return NO_ENTRY;
+}
 
-void Menu::add( Entry* const entry ) {
-  entries.push_back( entry );
+int16_t MenuImage::getFirstVisibleEntry( int16_t menu ) {
+  const MenuRecord& m = menus[menu];
+  for( uint16_t i = m.firstEntry; i < m.firstEntry + m.entriesCount; i++ ) {
+    if( !(entryFlags[i] & FLAG_INVISIBLE) ) return i;
+  }
+  return NO_ENTRY;
 }
 
-void Menu::addAt( Entry* const entry, uint8_t position ) {
-  if( position >= 0 && position <= entries.size() ) {
-    entries.insert( entries.begin() + position, entry );
+int16_t MenuImage::getNextVisibleEntry( int16_t entry ) {
+  const MenuRecord& m = menus[getMenuOf( entry )];
+  for( uint16_t i = entry + 1; i < m.firstEntry + m.entriesCount; i++ ) {
+    if( !(entryFlags[i] & FLAG_INVISIBLE) ) return i;
   }
+  return NO_ENTRY;
 }
 
-Entry* Menu::getEntry( const uint8_t position ) {
-  if( position >= 0 && position <= entries.size() ) {
-    return entries.at( position );
+int16_t MenuImage::getPreviousVisibleEntry( int16_t entry ) {
+  const MenuRecord& m = menus[getMenuOf( entry )];
+  for( int16_t i = entry - 1; i >= m.firstEntry; i-- ) {
+    if( !(entryFlags[i] & FLAG_INVISIBLE) ) return i;
   }
-  return NULL;
+  return NO_ENTRY;
 }
 
-Entry* Menu::getEntry( const String& id ) {
-  auto it = std::find_if( entries.begin(), entries.end(), [&id](Entry* en) {
-    return en->getId() == id;
-  });
-  return it != entries.end() ? *it : nullptr;
+void MenuImage::setVisible( int16_t entry, bool visible ) {
+  if( visible ) {
+    entryFlags[entry] &= ~FLAG_INVISIBLE;
+  } else {
+    entryFlags[entry] |= FLAG_INVISIBLE;
+  }
 }
 
-Entry* Menu::getFirstVisibleEntry() {
-  for( std::vector<Entry*>::iterator it = entries.begin(); it != entries.end(); ++it ) {
-    Entry* entry = *it;
-    if( entry->isVisible() )
-      return entry;
+/* MenuImage: runtime changes */
+
+const char* MenuImage::getLine( int16_t entry, Field field ) {
+  for( const Override& o : overrides ) {
+    if( o.entry == entry && o.field == field ) return o.line.c_str();
   }
-  return NULL;
+  return str( field == FIELD_TITLE ? entries[entry].title : entries[entry].text );
 }
 
-Entry* Menu::getNextVisibleEntry( const String& id ) {
-  int8_t pos = getPosition( id );
-  if( pos != -1 ) {
-    int8_t size  = entries.size();
-    while( ++pos < size ) {
-      Entry* e = entries.at( pos );
-      if( e->isVisible() )
-        return e;
+/**
+ * Change an entry title or text. The runtime template keys are added after the image ones.
+ */
+void MenuImage::setLine( int16_t entry, Field field, const String& source ) {
+  String line;
+  compileLine( source.c_str(), line, [this]( const char* key, size_t length ) -> uint8_t {
+    const int8_t slot = params->obtain( key, length );
+    if( slot < 0 ) return 0;
+    for( size_t i = 0; i < keySlots.size(); i++ ) {
+      if( keySlots[i] == slot ) return i + 1;
+    }
+    if( keySlots.size() >= 254 ) return 0;
+    keySlots.push_back( slot );
+    return keySlots.size();
+  });
+  if( field == FIELD_TITLE ) {
+    if( source.charAt( 0 ) == '~' ) {
+      entryFlags[entry] |= FLAG_HIDDEN_TITLE;
+    } else {
+      entryFlags[entry] &= ~FLAG_HIDDEN_TITLE;
+    }
+  }
+  for( Override& o : overrides ) {
+    if( o.entry == entry && o.field == field ) {
+      o.line = line;
+      return;
     }
   }
-  return NULL;
+  overrides.push_back({ (uint16_t) entry, field, line });
 }
 
-Entry* Menu::getPreviousVisibleEntry( const String& id ) {
-  int8_t pos = getPosition( id );
-  if( pos > 0 ) {
-    while( --pos >= 0 ) {
-      Entry* e = entries.at( pos );
-      if( e->isVisible() )
-        return e;
-    }
+/* MenuImage: drawing */
+
+/**
+ * Draw an entry title + text on center. The title is drawn using a big font,
+ * and the text - using a small one. The outer rectangle is always drawn to
+ * indicate that it's an active entry.
+ */
+void MenuImage::draw( Display_SSD1306& display, int16_t entry ) {
+  const char* title = getLine( entry, FIELD_TITLE );
+  const char* text = getLine( entry, FIELD_TEXT );
+  bool draw_title = title[0] && !(entryFlags[entry] & FLAG_HIDDEN_TITLE);
+  bool draw_text = text[0];
+  // Draw the title.
+  if( draw_title ) {
+    uint16_t h = TEXT_HEIGHT + ENTRY_PADDING + TITLE_OFFSET_Y;
+    if( !draw_text ) h += (DISPLAY_HEIGHT - TEXT_HEIGHT*2) / 4;
+    display.setFont( TITLE_FONT );
+    display.setCursor( ENTRY_PADDING, h );
+    printLine( display, title );
   }
-  return NULL;
+  // Draw the text.
+  if( draw_text ) {
+    uint16_t h = TEXT_HEIGHT + ENTRY_PADDING + TEXT_OFFSET_Y;
+    if( draw_title ) h += TITLE_HEIGHT + 3;
+    display.setFont( TEXT_FONT );
+    display.setCursor( ENTRY_PADDING, h );
+    printLine( display, text );
+  }
+  // Draw a rectangular cursor around.
+  display.drawRect( 0, TEXT_HEIGHT, DISPLAY_WIDTH, DISPLAY_HEIGHT - TEXT_HEIGHT*2 - 1, WHITE );
 }
 
-int8_t Menu::getPosition( const String& id ) {
-  auto it = std::find_if( entries.begin(), entries.end(), [&id](Entry* en) {
-    return en->getId() == id;
-  });
-  return it != entries.end() ? std::distance( entries.begin(), it ) : -1;
+/**
+ * The menu title is always drawn at top using a small font.
+ */
+void MenuImage::drawMenuTitleOnTop( Display_SSD1306& display, int16_t menu ) {
+  display.setFont( TEXT_FONT );
+  display.setCursor( ENTRY_PADDING, TEXT_OFFSET_Y );
+  printLine( display, str( menus[menu].title ));
 }
 
-void Menu::remove( const String& id ) {
-  auto it = std::find_if( entries.begin(), entries.end(), [&id](Entry* en) {
-    return en->getId() == id;
-  });
-  if( it != entries.end() ) {
-    Entry* entry = *it;
-    entries.erase( it );
-    delete entry;
+/**
+ * Draw an entry title on top using a small font.
+ */
+void MenuImage::drawTitleOnTop( Display_SSD1306& display, int16_t entry ) {
+  const char* title = getLine( entry, FIELD_TITLE );
+  display.setFont( TEXT_FONT );
+  display.setCursor( ENTRY_PADDING, TEXT_OFFSET_Y );
+  if( title[0] || (entryFlags[entry] & FLAG_HIDDEN_TITLE) ) {
+    printLine( display, title );
+  } else {
+    display.printLine( getEntryId( entry ));
   }
 }
 
-void Menu::setVisible( const String& entry_id, bool value ) {
-  Entry* entry = getEntry( entry_id );
-  if( entry ) {
-    entry->setVisible( value );
+/**
+ * Draw an entry title on bottom using a small font.
+ */
+void MenuImage::drawTitleOnBottom( Display_SSD1306& display, int16_t entry ) {
+  const char* title = getLine( entry, FIELD_TITLE );
+  display.setFont( TEXT_FONT );
+  display.setCursor( ENTRY_PADDING, DISPLAY_HEIGHT-2 );
+  if( title[0] || (entryFlags[entry] & FLAG_HIDDEN_TITLE) ) {
+    printLine( display, title );
+  } else {
+    display.printLine( getEntryId( entry ));
   }
 }
 
-void Menu::setTitle( const String& entry_id, const String& txt ) {
-  Entry* entry = getEntry( entry_id );
-  if( entry ) {
-    entry->setTitle( txt );
+uint32_t MenuImage::getEntryStamp( int16_t entry ) {
+  return getStamp( getLine( entry, FIELD_TITLE )) + getStamp( getLine( entry, FIELD_TEXT ));
+}
+
+// Revisions only grow, so their sum changes whenever any parameter of the line changes.
+uint32_t MenuImage::getStamp( const char* line ) {
+  uint32_t stamp = 0;
+  for( const char* p = line; *p; p++ ) {
+    if( *p == PARAM_MARK ) {
+      const int8_t slot = keySlots[(uint8_t) *++p - 1];
+      if( slot >= 0 ) stamp += params->getRevision( slot );
+    }
+  }
+  return stamp;
+}
+
+size_t MenuImage::printLine( Display_SSD1306& display, const char* line ) {
+  size_t n = 0;
+  const char* literal = line;
+  const char* p = line;
+  for( ; *p; p++ ) {
+    if( *p == PARAM_MARK ) {
+      n += display.write( (const uint8_t*) literal, p - literal );
+      const int8_t slot = keySlots[(uint8_t) *++p - 1];
+      if( slot >= 0 ) n += display.print( params->get( slot ));
+      literal = p + 1;
+    }
+  }
+  n += display.write( (const uint8_t*) literal, p - literal );
+  n += display.println();
+  return n;
+}
+
+/* MenuImage: keyboard */
+
+void MenuImage::onKeyPress( int16_t entry, const KeyEvent ev, Executor& executor, NumberEditor& editor ) {
+  const EntryKind kind = getKind( entry );
+  // The editor in the edit mode handles all keys.
+  if( kind == ENTRY_NUMBER && editor.isEditMode() ) {
+    switch( ev ) {
+      case UP:
+        if( editor.selectValue( PREVIOUS_ENTRY_OR_VALUE )) {
+          executor.showEntryEditor( false );
+        }
+        break;
+      case DOWN:
+        if( editor.selectValue( NEXT_ENTRY_OR_VALUE )) {
+          executor.showEntryEditor( false );
+        }
+        break;
+      case SELECT:
+        executor.dismissEntryEditor( editor.getValueAsString() );
+        editor.setEditMode( false );
+        break;
+    }
+    return;
+  }
+  switch( ev ) {
+    case UP:
+      executor.selectEntry( PREVIOUS_ENTRY_OR_VALUE );
+      break;
+    case DOWN:
+      executor.selectEntry( NEXT_ENTRY_OR_VALUE );
+      break;
+    case SELECT:
+      if( kind == ENTRY_COMMAND ) {
+        executor.executeEntryCommand( str( entries[entry].payload ));
+      } else if( kind == ENTRY_LINK ) {
+        // Try to split the target into menu ID and entry ID. It's also fine to have an empty entry ID.
+        auto pair = Tokenizer::split( str( entries[entry].payload ), '/' );
+        executor.showMenu( pair.first, pair.second );
+      } else if( kind == ENTRY_NUMBER ) {
+        executor.showEntryEditor( true );
+      }
+      break;
   }
 }
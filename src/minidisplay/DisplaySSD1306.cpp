@@ -4,35 +4,87 @@
 
 /* Display_SSD1306 */
 
-size_t Display_SSD1306::printLine( const String& s ) {
-  size_t n = 0;
+#ifdef I2C_BUFFER_LENGTH
+static const uint8_t I2C_DATA_CHUNK = I2C_BUFFER_LENGTH - 1;    // The first byte is a control byte.
+#else
+static const uint8_t I2C_DATA_CHUNK = 31;
+#endif
 
-  String key;
-  bool have_key = false;
-  const char* content = s.c_str();
-  int length = s.length();
+bool Display_SSD1306::begin( uint8_t switchvcc, uint8_t i2caddr ) {
+  if( !Adafruit_SSD1306::begin( switchvcc, i2caddr )) return false;
+  i2cAddress = i2caddr ? i2caddr : (HEIGHT == 32 ? 0x3C : 0x3D);
+  // The controller RAM content is unknown after reset, so the first update sends everything.
+  if( !shadow ) {
+    shadow = (uint8_t*) malloc( WIDTH * ((HEIGHT + 7) / 8) );
+  }
+  shadowValid = false;
+  return true;
+}
 
-  while( length-- ) {
-    char c = *content++;
-    if( c == '~' ) continue;
-    if( have_key ) {
-      if( c == '%' ) {
-        n += print( resolveTemplateKey( key ));
-        have_key = false;
-        key = "";
-      } else if( key.length() < 9 ) {     // SWITCH macro requires 9 chars max
-        key += c;
+/**
+ * Send the changed parts of the buffer to the display. The buffer is compared with the
+ * shadow copy page by page, every dirty page is reduced to the range of changed columns.
+ * Adjacent dirty pages are sent as a single window when it is cheaper than opening
+ * a new window. Returns the number of bytes sent.
+ */
+uint16_t Display_SSD1306::update() {
+  const uint8_t* buffer = getBuffer();
+  const uint8_t pages = (HEIGHT + 7) / 8;
+  uint16_t bytes = 0;
+  stats.updates++;
+
+  // Full update if the shadow buffer cannot be trusted (or there is no memory for it).
+  if( !shadow || !shadowValid ) {
+    bytes = sendWindow( 0, pages - 1, 0, WIDTH - 1 );
+    if( shadow ) {
+      memcpy( shadow, buffer, WIDTH * pages );
+      shadowValid = true;
+    }
+    stats.fullUpdates++;
+  } else {
+    int16_t groupFirst = -1, groupLast = 0, groupLeft = 0, groupRight = 0;
+    for( uint8_t page = 0; page <= pages; page++ ) {
+      // Find the changed columns range of this page.
+      int16_t left = -1, right = -1;
+      if( page < pages ) {
+        const uint8_t* b = buffer + page * WIDTH;
+        const uint8_t* s = shadow + page * WIDTH;
+        for( int16_t x = 0; x < WIDTH; x++ ) {
+          if( b[x] != s[x] ) { left = x; break; }
+        }
+        if( left >= 0 ) {
+          for( right = WIDTH - 1; b[right] == s[right]; right-- );
+        }
       }
-    } else {
-      if( c == '%' ) {
-        have_key = true;
-      } else {
-        n += print( c );
+      // Extend the pending window with this page if it costs less than a separate window.
+      if( left >= 0 && groupFirst >= 0 && page == groupLast + 1 ) {
+        const int16_t l = min( left, groupLeft );
+        const int16_t r = max( right, groupRight );
+        const int16_t merged = (page - groupFirst + 1) * (r - l + 1);
+        const int16_t separate = (page - groupFirst) * (groupRight - groupLeft + 1) + (right - left + 1) + WINDOW_OVERHEAD;
+        if( merged <= separate ) {
+          groupLast = page;
+          groupLeft = l;
+          groupRight = r;
+          continue;
+        }
       }
+      // Flush the pending window, start a new one from this page.
+      if( groupFirst >= 0 ) {
+        bytes += sendWindow( groupFirst, groupLast, groupLeft, groupRight );
+        for( uint8_t p = groupFirst; p <= groupLast; p++ ) {
+          memcpy( shadow + p * WIDTH + groupLeft, buffer + p * WIDTH + groupLeft, groupRight - groupLeft + 1 );
+        }
+      }
+      groupFirst = left >= 0 ? page : -1;
+      groupLast = page;
+      groupLeft = left;
+      groupRight = right;
     }
   }
-  n += println();
-  return n;
+  stats.bytes += bytes;
+  stats.lastBytes = bytes;
+  return bytes;
 }
 
 // This write() method is mostly copy-pasted from the corresponding Adafruit_GFX one.
@@ -75,6 +127,35 @@ size_t Display_SSD1306::write( uint8_t c ) {
   return 1;
 }
 
-String Display_SSD1306::resolveTemplateKey( const String& key ) {
-  return templateParams.has( key ) ? templateParams.get( key ) : "";
-}
\ No newline at end of file
+uint16_t Display_SSD1306::sendWindow( uint8_t firstPage, uint8_t lastPage, uint8_t firstColumn, uint8_t lastColumn ) {
+  const uint8_t window[] = {
+    0x00,                                                   // Co = 0, D/C = 0: commands follow
+    SSD1306_COLUMNADDR, firstColumn, lastColumn,
+    SSD1306_PAGEADDR,   firstPage,   lastPage
+  };
+  uint16_t bytes = sizeof( window ) + 1;                    // Including the I2C address byte
+  Wire.setClock( I2C_CLOCK_DURING );
+  Wire.beginTransmission( i2cAddress );
+  Wire.write( window, sizeof( window ));
+  Wire.endTransmission();
+
+  // The horizontal addressing mode wraps columns within the window to the next page.
+  const uint8_t* buffer = getBuffer();
+  for( uint8_t page = firstPage; page <= lastPage; page++ ) {
+    const uint8_t* data = buffer + page * WIDTH + firstColumn;
+    uint16_t count = lastColumn - firstColumn + 1;
+    while( count > 0 ) {
+      const uint8_t chunk = min( count, (uint16_t) I2C_DATA_CHUNK );
+      Wire.beginTransmission( i2cAddress );
+      Wire.write( (uint8_t) 0x40 );                         // Co = 0, D/C = 1: data follows
+      Wire.write( data, chunk );
+      Wire.endTransmission();
+      bytes += chunk + 2;
+      data += chunk;
+      count -= chunk;
+    }
+  }
+  Wire.setClock( I2C_CLOCK_AFTER );
+  stats.windows++;
+  return bytes;
+}
@@ -0,0 +1,113 @@
+#include <Arduino.h>
+#include "Config.h"
+#include "minidisplay/Keypad.h"
+
+/* Keypad */
+
+// Pins in the DisplayMenu::KeyEvent order.
+const uint8_t Keypad::PINS[KEYS_COUNT] = {
+  Config::MINI_DISPLAY_SELECT_PIN,
+  Config::MINI_DISPLAY_UP_PIN,
+  Config::MINI_DISPLAY_DOWN_PIN
+};
+
+Keypad::Keypad() {
+  queue = xQueueCreate( QUEUE_LENGTH, sizeof(KeyPress) );
+  timer = xTimerCreate( "keypad", pdMS_TO_TICKS( Config::MINI_DISPLAY_DEBOUNCE ), pdFALSE, this, timerCallback );
+  for( uint8_t i = 0; i < KEYS_COUNT; i++ ) {
+    pinMode( PINS[i], INPUT );
+    attachInterruptArg( PINS[i], edgeIrqHandler, this, CHANGE );
+  }
+}
+
+Keypad::~Keypad() {
+  for( uint8_t i = 0; i < KEYS_COUNT; i++ ) {
+    detachInterrupt( PINS[i] );
+  }
+  xTimerDelete( timer, portMAX_DELAY );
+  vQueueDelete( queue );
+}
+
+/**
+ * Get the next key press, if any. Never blocks.
+ */
+bool Keypad::read( KeyPress& press ) {
+  return xQueueReceive( queue, &press, 0 ) == pdTRUE;
+}
+
+/* Private */
+
+/**
+ * Queue the key press. If the menu is late, the newest press is dropped.
+ */
+void Keypad::push( uint8_t key, Kind kind ) {
+  const KeyPress press = { (DisplayMenu::KeyEvent) key, kind };
+  xQueueSend( queue, &press, 0 );
+}
+
+// The buttons are active low.
+uint8_t Keypad::readState() {
+  uint8_t state = 0;
+  for( uint8_t i = 0; i < KEYS_COUNT; i++ ) {
+    if( digitalRead( PINS[i] ) == LOW ) {
+      state |= 1 << i;
+    }
+  }
+  return state;
+}
+
+/**
+ * Called when the buttons have settled after an edge, and periodically while a button is held.
+ * Only one button is classified at a time, others pressed meanwhile are ignored.
+ */
+void Keypad::sample() {
+  const uint8_t state = readState();
+  const uint32_t now = millis();
+
+  if( held == NO_KEY ) {
+    for( uint8_t i = 0; i < KEYS_COUNT; i++ ) {
+      if( (state & ~stable) & (1 << i) ) {
+        held = i;
+        longSent = false;
+        pressTime = now;
+        push( i, PRESS );
+        break;
+      }
+    }
+  } else if( !(state & (1 << held)) ) {
+    if( !longSent ) {
+      push( held, SHORT );
+    }
+    held = NO_KEY;
+  } else if( !longSent ) {
+    if( now - pressTime >= Config::MINI_DISPLAY_LONG_PRESS ) {
+      push( held, LONG );
+      longSent = true;
+      repeatTime = now + Config::MINI_DISPLAY_REPEAT;
+    }
+  } else if( (int32_t) (now - repeatTime) >= 0 ) {
+    push( held, REPEAT );
+    repeatTime += Config::MINI_DISPLAY_REPEAT;
+  }
+  stable = state;
+
+  // Keep sampling the held button, edge interrupts are enough otherwise.
+  if( held != NO_KEY ) {
+    xTimerReset( timer, 0 );
+  }
+}
+
+void Keypad::timerCallback( TimerHandle_t timer ) {
+  ((Keypad*) pvTimerGetTimerID( timer ))->sample();
+}
+
+/**
+ * Any edge restarts the debounce timer, so the state is read once the contacts have settled.
+ */
+void IRAM_ATTR Keypad::edgeIrqHandler( void* arg ) {
+  BaseType_t woken = pdFALSE;
+  xTimerResetFromISR( ((Keypad*) arg)->timer, &woken );
+  if( woken ) {
+    portYIELD_FROM_ISR();
+  }
+}
@@ -6,6 +6,7 @@
 #include "Options.h"
 #include "str_switch.h"
 #include "Utils.h"
+#include "core/Tokenizer.h"
 #include "minidisplay/DisplayMenu.h"
 #include "minidisplay/MiniDisplayModule.h"
 
@@ -15,15 +16,12 @@ using namespace DisplayMenu;
 
 MiniDisplayModule::MiniDisplayModule() : display( DISPLAY_WIDTH, DISPLAY_HEIGHT ) {
   properties.has_module_webpage = true;
+  properties.loop_required = true;
   properties.tick_100mS_required = true;
   flags.data = 0;
   flags.display_on = true;
   sleepTimeout = getSleepTimeout();
 
-  pinMode( Config::MINI_DISPLAY_SELECT_PIN, INPUT );
-  pinMode( Config::MINI_DISPLAY_UP_PIN, INPUT );
-  pinMode( Config::MINI_DISPLAY_DOWN_PIN, INPUT );
-
   // Declaration for an SSD1306 display connected to I2C (SDA, SCL pins)
   flags.initialized = display.begin( SSD1306_SWITCHCAPVCC, 0x3C );
   if( !flags.initialized ) {
@@ -37,7 +35,7 @@ MiniDisplayModule::MiniDisplayModule() : display( DISPLAY_WIDTH, DISPLAY_HEIGHT
     display.setTemplateParameter( "PROJECT", Config::PROJECT_NAME );
     display.setTemplateParameter( "VERSION", Utils::getSystemVersionName() );
 
-    buildJsonMenu();
+    loadMenu();
   }
 }
 
@@ -51,8 +49,8 @@ const String MiniDisplayModule::getModuleWebpage() {
 
 // A generic getData/setData interface
 
-const String MiniDisplayModule::getString( const String& key ) {
-  SWITCH( key.c_str() ) {
+const String MiniDisplayModule::getString( const StringView& key ) {
+  SWITCH( key ) {
     // Get the module export config (JSON string, the menuconfig + template parameters)
     CASE( Config::KEY_EXPORT_CONFIGURATION ):
       return getStringOption( "MenuData", "{}" );
@@ -64,42 +62,34 @@ const String MiniDisplayModule::getString( const String& key ) {
   }
 }
 
-ResultData MiniDisplayModule::setString( const String& key, const String& value ) {
-  SWITCH( key.c_str() ) {
+ResultData MiniDisplayModule::setString( const StringView& key, const String& value ) {
+  SWITCH( key ) {
     // Import the module config.
     CASE( Config::KEY_IMPORT_CONFIGURATION ):
       setStringOption( "MenuData", value );
+      saveMenuImage( value );
       return RESULT_OK;
     // Permanently store the new menu configuration (the string representation of JSON array).
+    // The compiled menu image is stored along with it and used from now on.
     CASE( Config::KEY_MENU_DATA ):
       setStringOption( key, value );
-      buildJsonMenu();
+      saveMenuImage( value );
+      loadMenu();
       return RESULT_OK;
     DEFAULT_CASE:
       return Module::setString( key, value );
   }
 }
 
-void MiniDisplayModule::tick_100mS( uint8_t phase ) {
-  // Detect keyboard buttons press and release.
-  if( !flags.any_key_pressed ) {
-    if( digitalRead( Config::MINI_DISPLAY_SELECT_PIN ) == LOW ) {
-      flags.any_key_pressed = true;
-      handleKeyPress( SELECT );
-    }
-    else if( digitalRead( Config::MINI_DISPLAY_UP_PIN ) == LOW ) {
-      flags.any_key_pressed = true;
-      handleKeyPress( UP );
-    }
-    else if( digitalRead( Config::MINI_DISPLAY_DOWN_PIN ) == LOW ) {
-        flags.any_key_pressed = true;
-      handleKeyPress( DOWN );
-    }
-  } else if( digitalRead( Config::MINI_DISPLAY_SELECT_PIN ) == HIGH &&
-             digitalRead( Config::MINI_DISPLAY_UP_PIN ) == HIGH &&
-             digitalRead( Config::MINI_DISPLAY_DOWN_PIN ) == HIGH ) {
-    flags.any_key_pressed = false;
+void MiniDisplayModule::loop() {
+  // Handle the debounced keyboard events as soon as they come.
+  Keypad::KeyPress press;
+  while( keypad.read( press )) {
+    handleKeypad( press );
   }
+}
+
+void MiniDisplayModule::tick_100mS( uint8_t phase ) {
   // Manage the display timeout
   if( flags.display_on && sleepTimeout > 0 ) {
     if( --sleepTimeout == 0 ) {
@@ -109,7 +99,7 @@ void MiniDisplayModule::tick_100mS( uint8_t phase ) {
   // Optimized menu redrawing if template parameters was changed
   if( needRedrawMenu ) {
     needRedrawMenu = false;
-    redrawMenu();
+    refreshMenu();
   }
 }
 
@@ -117,18 +107,18 @@ void MiniDisplayModule::tick_100mS( uint8_t phase ) {
 
 void MiniDisplayModule::selectEntry( int8_t index ) {
   if( index == NEXT_ENTRY_OR_VALUE ) {
-    if( selectedEntry ) {
-      Entry* e = activeMenu->getNextVisibleEntry( selectedEntry->getId() );
-      if( e ) {
+    if( selectedEntry != NO_ENTRY ) {
+      int16_t e = menu.getNextVisibleEntry( selectedEntry );
+      if( e != NO_ENTRY ) {
         selectedEntry = e;
         redrawMenu();
       }
     }
   }
   else if( index == PREVIOUS_ENTRY_OR_VALUE ) {
-    if( selectedEntry ) {
-      Entry* e = activeMenu->getPreviousVisibleEntry( selectedEntry->getId() );
-      if( e ) {
+    if( selectedEntry != NO_ENTRY ) {
+      int16_t e = menu.getPreviousVisibleEntry( selectedEntry );
+      if( e != NO_ENTRY ) {
         selectedEntry = e;
         redrawMenu();
       }
@@ -142,21 +132,21 @@ void MiniDisplayModule::executeEntryCommand( const String& cmd ) {
 }
 
 bool MiniDisplayModule::showMenu( const String& menuId, const String& entryId ) {
-  Menu* m = findMenu( menuId );
-  if( !m ) {
+  int16_t m = menu.findMenu( menuId );
+  if( m == NO_ENTRY ) {
     Log.warning( "DISP menu ID '%s' is not found" CR, menuId.c_str() );
   } else {
-    Entry* e = m->getEntry( entryId );
-    if( !e ) {
+    int16_t e = menu.findEntry( m, entryId );
+    if( e == NO_ENTRY ) {
       // The entry ID is not found. Get the 1st visible entry as a workaround.
       // Type a warning only when entry ID is not empty, because empty value
       // means to select the 1st visible entry.
       if( entryId.length() > 0 ) {
         Log.warning( "DISP entry ID '%s' is not found" CR, entryId.c_str() );
       }
-      e = m->getFirstVisibleEntry();
+      e = menu.getFirstVisibleEntry( m );
     }
-    if( e ) {
+    if( e != NO_ENTRY ) {
       activeMenu = m;
       selectedEntry = e;
       redrawMenu();
@@ -171,26 +161,26 @@ void MiniDisplayModule::showEntryEditor( bool requestData ) {
     // If callback is set, it's responsive to handle a request of value to be edited.
     // The returned value should be a JSON string.
     if( onRequestValueListener ) {
-      onRequestValueListener( activeMenu->getId(), selectedEntry->getId(), [this](const String& value){
+      onRequestValueListener( menu.getMenuId( activeMenu ), menu.getEntryId( selectedEntry ), [this](const String& value){
         dispatchRequestedValue( value );
       });
     }
     // Otherwise use the MQTT to resolve a value to be edited.
     // The returned value is provided via usual handleCommand() interface.
     // The MQTT topic should be like cmnd/<device topic>/display editvalue <value JSON object>.
-    else if( valuesResolveTopic.length() > 0 ) {
+    else if( menu.getTopic()[0] ) {
       Modules.execute( MQTT_MODULE, [this](Module* module) {
         MqttClientModule* mqtt = (MqttClientModule*) module;
         StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
         json["device"] = mqtt->getDeviceTopic();
-        json["menu"] = activeMenu->getId();
-        json["entry"] = selectedEntry->getId();
-        mqtt->publish( valuesResolveTopic, json.as<String>(), false );
+        json["menu"] = menu.getMenuId( activeMenu );
+        json["entry"] = menu.getEntryId( selectedEntry );
+        mqtt->publish( menu.getTopic(), json.as<String>(), false );
       });
     }
     // Neither callback nor MQTT topic are specified. Can't do anything.
     else {
-      selectedEntry->setText( "Can't resolve value" );
+      menu.setText( selectedEntry, "Can't resolve value" );
       redrawMenu();
     }
   } else {
@@ -204,22 +194,22 @@ void MiniDisplayModule::dismissEntryEditor( const String& value ) {
   // Callback is responsive to manage (store, send, etc..) the modified value.
   if( onChangeValueListener ) {
     StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
-    json["menu"] = activeMenu->getId();
-    json["entry"] = selectedEntry->getId();
+    json["menu"] = menu.getMenuId( activeMenu );
+    json["entry"] = menu.getEntryId( selectedEntry );
     json["value"] = value;
-    onChangeValueListener( activeMenu->getId(), selectedEntry->getId(), json.as<String>() );
+    onChangeValueListener( menu.getMenuId( activeMenu ), menu.getEntryId( selectedEntry ), json.as<String>() );
   }
   // Otherwise use the MQTT to resolve a value to be edited.
-  else if( valuesResolveTopic.length() > 0 ) {
+  else if( menu.getTopic()[0] ) {
     Modules.execute( MQTT_MODULE, [this,&value](Module* module) {
       MqttClientModule* mqtt = (MqttClientModule*) module;
       // Prepare a JSON string thet represents an edited value.
       StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
       json["device"] = mqtt->getDeviceTopic();
-      json["menu"] = activeMenu->getId();
-      json["entry"] = selectedEntry->getId();
+      json["menu"] = menu.getMenuId( activeMenu );
+      json["entry"] = menu.getEntryId( selectedEntry );
       json["value"] = value;
-      mqtt->publish( valuesResolveTopic, json.as<String>(), false );
+      mqtt->publish( menu.getTopic(), json.as<String>(), false );
     });
   }
   redrawMenu();
@@ -241,9 +231,9 @@ void MiniDisplayModule::setDisplayEnabled( bool value ) {
   }
 }
 
-bool MiniDisplayModule::setEntry( const String& menuId, const String& entryId, const std::function<void(Entry* entry)> func ) {
-  Entry* e = findEntry( menuId, entryId );
-  if( e ) {
+bool MiniDisplayModule::setEntry( const String& menuId, const String& entryId, const std::function<void(int16_t entry)> func ) {
+  int16_t e = menu.findEntry( menu.findMenu( menuId ), entryId );
+  if( e != NO_ENTRY ) {
     func( e );
     return true;
   }
@@ -251,17 +241,17 @@ bool MiniDisplayModule::setEntry( const String& menuId, const String& entryId, c
 }
 
 void MiniDisplayModule::setTemplateParameter( const String& key, const String& value ) {
-  display.setTemplateParameter( key, value );
-  needRedrawMenu = true;
+  if( display.setTemplateParameter( key, value )) {
+    needRedrawMenu = true;
+  }
 }
 
 void MiniDisplayModule::showDefaultMenuEntry() {
-  auto pair = Utils::split( defaultMenu, '/' );
+  auto pair = Tokenizer::split( menu.getDefaultMenu(), '/' );
   bool shown = showMenu( pair.first, pair.second );
   // If the default menu isn't defined, show the most 1st menu in the list.
-  if( !shown && menuList.size() ) {
-    Menu* menu = menuList[0];
-    showMenu( menu->getId() );
+  if( !shown && menu.getMenusCount() ) {
+    showMenu( menu.getMenuId( 0 ));
   }
 }
 
@@ -269,35 +259,77 @@ void MiniDisplayModule::redrawMenu() {
   if( !flags.display_on ) return;
 
   display.clearDisplay();
-  if( selectedEntry ) {
+  if( selectedEntry != NO_ENTRY ) {
     // If the current position is a 1st visible, draw the menu title on top.
     // Otherwise draw a previous entry title on top.
-    Entry* e = activeMenu->getPreviousVisibleEntry( selectedEntry->getId() );
-    if( e ) {
-      e->drawTitleOnTop( display );
+    int16_t e = menu.getPreviousVisibleEntry( selectedEntry );
+    if( e != NO_ENTRY ) {
+      menu.drawTitleOnTop( display, e );
+      drawnStamps[0] = menu.getTitleStamp( e );
     } else {
-      activeMenu->drawTitleOnTop( display );
+      menu.drawMenuTitleOnTop( display, activeMenu );
+      drawnStamps[0] = menu.getMenuTitleStamp( activeMenu );
     }
     // Draw the menu entry at current position.
-    selectedEntry->draw( display );
+    menu.draw( display, selectedEntry );
+    drawnStamps[1] = menu.getEntryStamp( selectedEntry );
     // if the current position is not a last visible, draw the next entry title on bottom.
     // Otherwise draw nothing.
-    e = activeMenu->getNextVisibleEntry( selectedEntry->getId() );
-    if( e ) {
-      e->drawTitleOnBottom( display );
+    e = menu.getNextVisibleEntry( selectedEntry );
+    if( e != NO_ENTRY ) {
+      menu.drawTitleOnBottom( display, e );
+      drawnStamps[2] = menu.getTitleStamp( e );
+    } else {
+      drawnStamps[2] = 0;
+    }
+  }
+  display.update();
+}
+
+/**
+ * Redraw only the parts of the menu whose template parameters have been changed:
+ * the title on top, the selected entry and the title on bottom.
+ */
+void MiniDisplayModule::refreshMenu() {
+  if( !flags.display_on || selectedEntry == NO_ENTRY ) return;
+
+  const int16_t previous = menu.getPreviousVisibleEntry( selectedEntry );
+  const int16_t next = menu.getNextVisibleEntry( selectedEntry );
+  const uint32_t stamps[3] = {
+    previous != NO_ENTRY ? menu.getTitleStamp( previous ) : menu.getMenuTitleStamp( activeMenu ),
+    menu.getEntryStamp( selectedEntry ),
+    next != NO_ENTRY ? menu.getTitleStamp( next ) : 0
+  };
+  if( memcmp( stamps, drawnStamps, sizeof(stamps) ) == 0 ) return;
+
+  if( stamps[0] != drawnStamps[0] ) {
+    display.fillRect( 0, 0, DISPLAY_WIDTH, TEXT_HEIGHT, BLACK );
+    if( previous != NO_ENTRY ) {
+      menu.drawTitleOnTop( display, previous );
+    } else {
+      menu.drawMenuTitleOnTop( display, activeMenu );
     }
   }
-  display.display();
+  if( stamps[1] != drawnStamps[1] ) {
+    display.fillRect( 0, TEXT_HEIGHT, DISPLAY_WIDTH, DISPLAY_HEIGHT - TEXT_HEIGHT*2 - 1, BLACK );
+    menu.draw( display, selectedEntry );
+  }
+  if( stamps[2] != drawnStamps[2] ) {
+    display.fillRect( 0, DISPLAY_HEIGHT - TEXT_HEIGHT - 1, DISPLAY_WIDTH, TEXT_HEIGHT + 1, BLACK );
+    menu.drawTitleOnBottom( display, next );
+  }
+  memcpy( drawnStamps, stamps, sizeof(stamps) );
+  display.update();
 }
 
 bool MiniDisplayModule::selectMenu( const String& menuId, const String& entryId ) {
-  auto menu = findMenu( menuId );
-  if( menu ) {
-    auto entry = entryId.length() > 0 ? findEntry( menuId, entryId ) : menu->getFirstVisibleEntry();
-    if( entry ) {
+  int16_t m = menu.findMenu( menuId );
+  if( m != NO_ENTRY ) {
+    int16_t e = entryId.length() > 0 ? menu.findEntry( m, entryId ) : menu.getFirstVisibleEntry( m );
+    if( e != NO_ENTRY ) {
       // Select the requested menu and entry.
-      activeMenu = menu;
-      selectedEntry = entry;
+      activeMenu = m;
+      selectedEntry = e;
       redrawMenu();
       // Turn on the display, if needed.
       sleepTimeout = getSleepTimeout();
@@ -311,132 +343,43 @@ bool MiniDisplayModule::selectMenu( const String& menuId, const String& entryId
 }
 
 bool MiniDisplayModule::selectMenu( const String& entryId ) {
-  for( std::vector<Menu*>::iterator it = menuList.begin(); it != menuList.end(); ++it ) {
-    Menu* menu = *it;
-    Entry* entry = menu->getEntry( entryId );
-    if( entry ) {
-      // Select the requested menu and entry.
-      activeMenu = menu;
-      selectedEntry = entry;
-      redrawMenu();
-      // Turn on the display, if needed.
-      sleepTimeout = getSleepTimeout();
-      if( !flags.display_on ) {
-        setDisplayEnabled( true );
-      }
-      return true;
+  int16_t e = menu.findEntry( entryId );
+  if( e != NO_ENTRY ) {
+    // Select the requested menu and entry.
+    activeMenu = menu.getMenuOf( e );
+    selectedEntry = e;
+    redrawMenu();
+    // Turn on the display, if needed.
+    sleepTimeout = getSleepTimeout();
+    if( !flags.display_on ) {
+      setDisplayEnabled( true );
     }
+    return true;
   }
   return false;
 }
 
 /* Protected */
 
+constexpr Commands::Entry<MiniDisplayModule> MiniDisplayModule::COMMANDS[] = {
+  { "disable",   Commands::text( true ),                  &MiniDisplayModule::cmdDisable,   "Disable the menu entry (not implemented)" },
+  { "editvalue", Commands::text(),                        &MiniDisplayModule::cmdEditValue, "Activate the value editor with the value data JSON" },
+  { "enable",    Commands::text( true ),                  &MiniDisplayModule::cmdEnable,    "Enable the menu entry (not implemented)" },
+  { "off",       Commands::none(),                        &MiniDisplayModule::cmdOff,       "Turn off the display" },
+  { "on",        Commands::none(),                        &MiniDisplayModule::cmdOn,        "Turn on the display" },
+  { "select",    Commands::text(),                        &MiniDisplayModule::cmdSelect,    "Select the menu entry, <menu>/<entry>" },
+  { "stats",     Commands::none(),                        &MiniDisplayModule::cmdStats,     "Display transfer statistics" },
+  { "text",      Commands::text(),                        &MiniDisplayModule::cmdText,      "Set the entry text, <menu>/<entry> <text>" },
+  { "timeout",   Commands::number( 0, INT16_MAX, true ),  &MiniDisplayModule::cmdTimeout,   "The display auto turn off timeout" },
+  { "title",     Commands::text(),                        &MiniDisplayModule::cmdTitle,     "Set the entry title, <menu>/<entry> <title>" },
+};
+
 bool MiniDisplayModule::handleCommand( const String& cmd, const String& args ) {
-  SWITCH( cmd.c_str() ) {
-    // ==========================================
-    CASE( "disable" ):
-      //TODO Disable the menu entry.
-      return true;
-    // ==========================================
-    CASE( "enable" ):
-      //TODO Enable the menu entry.
-      return true;
-    // ==========================================
-    // Activate a value editor with provided value data JSON.
-    CASE( "editvalue" ): {
-      bool rc = dispatchRequestedValue( args );
-      handleCommandResults( cmd, args, rc ? Messages::OK : Messages::UNKNOWN_MENU_ENTRY_ID );
-      return true;
-    }
-    // ==========================================
-    // Turn on the display.
-    CASE( "on" ):
-      setDisplayEnabled( true );
-      handleCommandResults( cmd, args, Messages::OK );
-      return true;
-    // ==========================================
-    // Turn off the display.
-    CASE( "off" ):
-      setDisplayEnabled( false );
-      handleCommandResults( cmd, args, Messages::OK );
-      return true;
-    // ==========================================
-    // Select some menu entry.
-    // Example: "display select root/status"
-    CASE( "select" ): {
-      // Split the payload into menu ID and entry ID.
-      auto pair = Utils::split( args, '/' );
-      bool rc = selectMenu( pair.first, pair.second );
-      handleCommandResults( cmd, args, rc ? Messages::OK : Messages::UNKNOWN_MENU_ENTRY_ID );
-      return true;
-    }
-    // ==========================================
-    // Apply a new text to some menu entry.
-    // Example: "display text root/status Status\nAccess point mode\n192.168.4.1"
-    // Where: <root> is the menu ID, <status> is the entry ID.
-    CASE( "text" ): {
-      // Split the payload into menu/entry IDs and text.
-      auto entry = Utils::split( args );
-      String text = entry.second;
-      text.replace( "\\n", "\n" );
-      // Split the menu/entry IDs.
-      auto menu_ids = Utils::split( entry.first, '/' );
-      String menuId = menu_ids.first;
-      String entryId = menu_ids.second;
-      // Apply the text to the menu.
-      bool rc = setEntry( menuId, entryId, [&](Entry* entry) {
-        entry->setText( text );
-        // Redraw the menu when necessary.
-        if( activeMenu && selectedEntry ) {
-          if( activeMenu->getId() == menuId && selectedEntry->getId() == entryId ) {
-            redrawMenu();
-          }
-        }
-      });
-      handleCommandResults( cmd, args, rc ? Messages::OK : Messages::UNKNOWN_MENU_ENTRY_ID );
-      return true;
-    }
-    // ==========================================
-    // Change the display auto turn off timeout.
-    CASE( "timeout" ):
-      if( args.length() > 0 ) {
-        int16_t value = args.toInt();
-        if( value >= 0 ) {
-          Options::setShort( getId(), "MenuTimeout", value );
-        }
-      }
-      handleCommandResults( cmd, args, String( getSleepTimeout() ));
-      return true;
-    // ==========================================
-    // Apply a new text to some menu entry.
-    // Example: "display title root/status Status OK"
-    // Where: <root> is the menu ID, <status> is the entry ID.
-    CASE( "title" ): {
-      // Split the payload into menu/entry IDs and title.
-      auto entry = Utils::split( args );
-      String title = entry.second;
-      // Split the menu/entry IDs.
-      auto menu_ids = Utils::split( entry.first, '/' );
-      String menuId = menu_ids.first;
-      String entryId = menu_ids.second;
-      // Apply the text to the menu.
-      bool rc = setEntry( menuId, entryId, [&](Entry* entry) {
-        entry->setTitle( title );
-        // Redraw the menu when necessary.
-        if( activeMenu && activeMenu->getId() == menuId ) {
-          redrawMenu();
-        }
-      });
-      handleCommandResults( cmd, args, rc ? Messages::OK : Messages::UNKNOWN_MENU_ENTRY_ID );
-      return true;
-    }
-  }
-  return false;
+  return dispatchCommandTable<COMMAND_TABLE(MiniDisplayModule, COMMANDS)>( *this, cmd, args );
 }
 
-void MiniDisplayModule::resolveTemplateKey( const String& key, String& out ) {
-  SWITCH( key.c_str() ) {
+void MiniDisplayModule::resolveTemplateKey( const StringView& key, String& out ) {
+  SWITCH( key ) {
     // ==========================================
     // Module template parameters
     CASE( "ID" ):
@@ -448,114 +391,162 @@ void MiniDisplayModule::resolveTemplateKey( const String& key, String& out ) {
   }
 }
 
-/* Private */
+/* Commands */
 
-// Note: The ArduinoJson .as<char*>() cast is used to avoid applying "null" value to empty strings.
-void MiniDisplayModule::buildJsonMenu() {
-  DynamicJsonDocument doc( Config::JSON_CONFIG_SIZE * 2 );
-  DeserializationError rc = deserializeJson( doc, getMenuData() );
-  // If the menu JSON cannot be decoded.
-  if( rc != DeserializationError::Ok ) {
-    Log.error( "DISP Menu decode error. %s" CR, rc.c_str() );
-    buildDefaultMenu();
-    showDefaultMenuEntry();
-    return;
-  }
-  // Read the menu options.
-  JsonObject json = doc.as<JsonObject>();
-  defaultMenu = json["default"].as<char*>();
-  valuesResolveTopic = json["topic"].as<char*>();
-  // Check if the menu is not empty.
-  JsonArray menuArray = json["menu"].as<JsonArray>();
-  const int count =  menuArray.size();
-  if( count == 0 ) {
-    Log.notice( "DISP The menu config is empty, default one is used" CR );
-    buildDefaultMenu();
-    showDefaultMenuEntry();
-    return;
-  }
-  // Build the menu from JSON.
-  menuList.clear();
-  Menu* currentMenu = nullptr;
-  for( JsonObject item : menuArray ) {
-    // The menu or entry JSON object must have the "id" and "type" fields.
-    // Also they may have "title", "text" and "payload" fields.
-    const String type = item["type"].as<char*>();
-    const String id = item["id"].as<char*>();
-    const String title = item["title"].as<char*>();
-    SWITCH( type.c_str() ) {
-      CASE( "menu" ): {
-        currentMenu = new Menu( id, title );
-        addMenu( currentMenu );
-        break;
-      }
-      CASE( "entry" ): {
-        const String text = item["text"].as<char*>();
-        Entry* entry = new Entry( id, title );
-        entry->setText( text );
-        if( currentMenu ) {
-          currentMenu->add( entry );
-        }
-        break;
-      }
-      CASE( "cmd" ): {
-        const String text = item["text"].as<char*>();
-        const String payload = item["payload"].as<char*>();
-        Command* cmd = new Command( id, title, payload );
-        cmd->setText( text );
-        if( currentMenu ) {
-          currentMenu->add( cmd );
-        }
-        break;
-      }
-      CASE( "link" ): {
-        const String text = item["text"].as<char*>();
-        const String payload = item["target"].as<char*>();
-        Link* link = new Link( id, title, payload );
-        link->setText( text );
-        if( currentMenu ) {
-          currentMenu->add( link );
-        }
-        break;
-      }
-      CASE( "number" ): {
-        const String text = item["text"].as<char*>();
-        Number* editor = new Number( id, title );
-        editor->setText( text );
-        if( currentMenu ) {
-          currentMenu->add( editor );
-        }
-        break;
-      }
+void MiniDisplayModule::cmdDisable( const Commands::Args& args ) {
+  //TODO Disable the menu entry.
+}
+
+// Activate a value editor with provided value data JSON.
+void MiniDisplayModule::cmdEditValue( const Commands::Args& args ) {
+  bool rc = dispatchRequestedValue( args.raw );
+  handleCommandResults( args.cmd, args.raw, rc ? Messages::OK : Messages::UNKNOWN_MENU_ENTRY_ID );
+}
+
+void MiniDisplayModule::cmdEnable( const Commands::Args& args ) {
+  //TODO Enable the menu entry.
+}
+
+void MiniDisplayModule::cmdOff( const Commands::Args& args ) {
+  setDisplayEnabled( false );
+  handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
+void MiniDisplayModule::cmdOn( const Commands::Args& args ) {
+  setDisplayEnabled( true );
+  handleCommandResults( args.cmd, args.raw, Messages::OK );
+}
+
+// Select some menu entry.
+// Example: "display select root/status"
+void MiniDisplayModule::cmdSelect( const Commands::Args& args ) {
+  // Split the payload into menu ID and entry ID.
+  auto pair = Tokenizer::split( args.raw, '/' );
+  bool rc = selectMenu( pair.first, pair.second );
+  handleCommandResults( args.cmd, args.raw, rc ? Messages::OK : Messages::UNKNOWN_MENU_ENTRY_ID );
+}
+
+// Display transfer statistics: bytes sent by the latest update and totals.
+void MiniDisplayModule::cmdStats( const Commands::Args& args ) {
+  const Display_SSD1306::UpdateStats& s = display.getUpdateStats();
+  StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
+  json["last"] = s.lastBytes;
+  json["updates"] = s.updates;
+  json["full"] = s.fullUpdates;
+  json["windows"] = s.windows;
+  json["bytes"] = s.bytes;
+  json["average"] = s.updates > 0 ? s.bytes / s.updates : 0;
+  handleCommandResults( args.cmd, args.raw, json.as<String>() );
+}
+
+// Apply a new text to some menu entry.
+// Example: "display text root/status Status\nAccess point mode\n192.168.4.1"
+// Where: <root> is the menu ID, <status> is the entry ID.
+void MiniDisplayModule::cmdText( const Commands::Args& args ) {
+  // Split the payload into menu/entry IDs and text.
+  auto entry = Tokenizer::split( args.raw );
+  String text = entry.second;
+  text.replace( "\\n", "\n" );
+  // Split the menu/entry IDs.
+  auto menu_ids = Tokenizer::split( entry.first, '/' );
+  String menuId = menu_ids.first;
+  String entryId = menu_ids.second;
+  // Apply the text to the menu.
+  bool rc = setEntry( menuId, entryId, [&](int16_t entry) {
+    menu.setText( entry, text );
+    // Redraw the menu when necessary.
+    if( entry == selectedEntry ) {
+      redrawMenu();
+    }
+  });
+  handleCommandResults( args.cmd, args.raw, rc ? Messages::OK : Messages::UNKNOWN_MENU_ENTRY_ID );
+}
+
+// Change the display auto turn off timeout.
+void MiniDisplayModule::cmdTimeout( const Commands::Args& args ) {
+  if( args.present ) {
+    Options::setShort( getId(), "MenuTimeout", args.number );
+  }
+  handleCommandResults( args.cmd, args.raw, String( getSleepTimeout() ));
+}
+
+// Apply a new title to some menu entry.
+// Example: "display title root/status Status OK"
+// Where: <root> is the menu ID, <status> is the entry ID.
+void MiniDisplayModule::cmdTitle( const Commands::Args& args ) {
+  // Split the payload into menu/entry IDs and title.
+  auto entry = Tokenizer::split( args.raw );
+  String title = entry.second;
+  // Split the menu/entry IDs.
+  auto menu_ids = Tokenizer::split( entry.first, '/' );
+  String menuId = menu_ids.first;
+  String entryId = menu_ids.second;
+  // Apply the title to the menu.
+  bool rc = setEntry( menuId, entryId, [&](int16_t entry) {
+    menu.setTitle( entry, title );
+    // Redraw the menu when necessary.
+    if( activeMenu != NO_ENTRY && menu.getMenuOf( entry ) == activeMenu ) {
+      redrawMenu();
     }
+  });
+  handleCommandResults( args.cmd, args.raw, rc ? Messages::OK : Messages::UNKNOWN_MENU_ENTRY_ID );
+}
+
+/* Private */
+
+/**
+ * Load the compiled menu image. If there is no image yet, or it's made by other firmware
+ * version, it's compiled from the menu JSON and stored. The default menu is used when
+ * the menu JSON is invalid or empty.
+ */
+void MiniDisplayModule::loadMenu() {
+  TemplateParams& params = display.getTemplateParams();
+  const size_t size = Options::getBlobLength( getId(), MENU_IMAGE_KEY );
+  bool loaded = false;
+  if( size > 0 ) {
+    std::vector<uint8_t> image( size );
+    loaded = Options::getBlob( getId(), MENU_IMAGE_KEY, image.data(), size ) == size && menu.load( std::move( image ), params );
+  }
+  if( !loaded ) {
+    std::vector<uint8_t> image;
+    loaded = saveMenuImage( getMenuData(), &image ) && menu.load( std::move( image ), params );
   }
-  // Show the menu.
-  if( menuList.size() == 0 ) {
+  if( !loaded ) {
     Log.notice( "DISP The menu config is invalid, default one is used" CR );
-    buildDefaultMenu();
+    std::vector<uint8_t> image;
+    MenuImage::compile( DEFAULT_MENU, image );
+    menu.load( std::move( image ), params );
   }
+  Log.trace( "DISP Menu: %d menus, %d entries, %d bytes" CR,
+    menu.getMenusCount(), menu.getEntriesCount(), menu.getImageSize() );
+  activeMenu = NO_ENTRY;
+  selectedEntry = NO_ENTRY;
   showDefaultMenuEntry();
 }
 
-void MiniDisplayModule::buildDefaultMenu() {
-  menuList.clear();
-  addMenu(
-    new Menu  {"root",   "", {
-    new Entry {"status", "",      "%STATUS%"},
-    new Link  {"about",  "About", "about"   }
-  }});
-  addMenu(
-    new Menu  {"about",  "About", {
-    new Link  {"info",   "",      "%PROJECT%\nVersion %VERSION%", "root/about"}
-  }});
+/**
+ * Compile the menu JSON and store the image. The image is removed if the JSON is invalid,
+ * so the default menu is used on the next start.
+ */
+bool MiniDisplayModule::saveMenuImage( const String& json, std::vector<uint8_t>* out ) {
+  std::vector<uint8_t> image;
+  if( !MenuImage::compile( json, image )) {
+    Options::remove( getId(), MENU_IMAGE_KEY );
+    return false;
+  }
+  Options::setBlob( getId(), MENU_IMAGE_KEY, image.data(), image.size() );
+  if( out ) {
+    out->swap( image );
+  }
+  return true;
 }
 
 bool MiniDisplayModule::dispatchRequestedValue( const String& jsonString ) {
   StaticJsonDocument<Config::JSON_MESSAGE_SIZE> json;
   DeserializationError rc = deserializeJson( json, jsonString );
-  if( rc == DeserializationError::Ok &&
-      json["menu"] == activeMenu->getId() &&
-      json["entry"] == selectedEntry->getId() ) {
+  if( rc == DeserializationError::Ok && selectedEntry != NO_ENTRY &&
+      json["menu"] == menu.getMenuId( activeMenu ) &&
+      json["entry"] == menu.getEntryId( selectedEntry ) ) {
     const String type = json["type"];
     SWITCH( type.c_str() ) {
       // Provide a value to the Number editor.
@@ -564,16 +555,13 @@ bool MiniDisplayModule::dispatchRequestedValue( const String& jsonString ) {
         const int min = json["min"];
         const int max = json["max"];
         const int step = json["step"];
-        if( Number* editor = dynamic_cast<Number*>(selectedEntry) ) {
-          editor->setValue( value, min, max, step );
+        if( menu.getKind( selectedEntry ) == ENTRY_NUMBER ) {
+          editor.setValue( value, min, max, step );
           redrawEditor();
           return true;
         }
         break;
       }
-      // Provide a value to the Choice editor.
-      CASE( "choice" ):
-        break;
     }
   }
   return false;
@@ -583,30 +571,6 @@ String MiniDisplayModule::getMenuData() {
   return getStringOption( "MenuData", "{}" );
 }
 
-/**
- * Find the menu entry by ID.
- */
-Entry* MiniDisplayModule::findEntry( const String& menuId, const String& entryId ) {
-  Menu* m = findMenu( menuId );
-  if( m ) {
-    Entry* e = m->getEntry( entryId );
-    if( e ) return e;
-  }
-  return nullptr;
-}
-
-/**
- * Find the menu by ID.
- */
-Menu* MiniDisplayModule::findMenu( const String& menuId ) {
-  for( std::vector<Menu*>::iterator it = menuList.begin(); it != menuList.end(); ++it ) {
-    Menu* menu = *it;
-    if( menu->getId() == menuId )
-      return menu;
-  }
-  return nullptr;
-}
-
 uint16_t MiniDisplayModule::getSleepTimeout() {
   return getShortOption( "Timeout", Config::MINI_DISPLAY_TIMEOUT * 10 );
 }
@@ -618,13 +582,42 @@ void MiniDisplayModule::handleKeyPress( KeyEvent ev ) {
     setDisplayEnabled( true );
   }
   // Handle a keypress.
-  else if( activeMenu && selectedEntry ) {
-    selectedEntry->onKeyPress( ev, *this );
+  else if( selectedEntry != NO_ENTRY ) {
+    menu.onKeyPress( selectedEntry, ev, *this, editor );
+  }
+}
+
+/**
+ * Translate the keypad events into menu key presses. UP and DOWN act right on press
+ * and repeat while held. SELECT acts on a short press, a long one returns to the
+ * default menu entry.
+ */
+void MiniDisplayModule::handleKeypad( const Keypad::KeyPress& press ) {
+  if( press.kind == Keypad::PRESS ) {
+    flags.skip_key = !flags.display_on;
+    if( flags.skip_key || press.key != SELECT ) {
+      handleKeyPress( press.key );
+    }
+  }
+  else if( flags.skip_key ) {
+    // The press has only woken up the display.
+  }
+  else if( press.key == SELECT ) {
+    if( press.kind == Keypad::SHORT ) {
+      handleKeyPress( SELECT );
+    } else if( press.kind == Keypad::LONG ) {
+      sleepTimeout = getSleepTimeout();
+      showDefaultMenuEntry();
+    }
+  }
+  else if( press.kind == Keypad::LONG || press.kind == Keypad::REPEAT ) {
+    handleKeyPress( press.key );
   }
 }
 
 void MiniDisplayModule::redrawEditor() {
   display.clearDisplay();
-  selectedEntry->drawEditor( display );
-  display.display();
+  menu.drawTitleOnTop( display, selectedEntry );
+  editor.draw( display );
+  display.update();
 }
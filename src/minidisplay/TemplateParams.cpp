@@ -0,0 +1,91 @@
+#include <string.h>
+#include "minidisplay/TemplateParams.h"
+
+/* TemplateParams */
+
+TemplateParams::TemplateParams() {
+  for( uint8_t i = 0; i < CAPACITY; i++ ) {
+    slots[i].key[0] = '\0';
+    slots[i].revision = 0;
+  }
+}
+
+/**
+ * Clear all values. The keys are kept because compiled lines refer to their slots.
+ */
+void TemplateParams::clear() {
+  for( uint8_t i = 0; i < CAPACITY; i++ ) {
+    if( slots[i].key[0] && slots[i].value.length() > 0 ) {
+      slots[i].value = "";
+      slots[i].revision++;
+    }
+  }
+}
+
+/**
+ * Find the slot of a key. Returns -1 if the key is not in the table.
+ */
+int8_t TemplateParams::find( const char* key, size_t length ) {
+  if( length > MAX_KEY_LENGTH ) length = MAX_KEY_LENGTH;
+  uint8_t i = hash( key, length );
+  for( uint8_t n = 0; n < CAPACITY; n++ ) {
+    const char* k = slots[i].key;
+    if( !k[0] ) return -1;
+    if( strncmp( k, key, length ) == 0 && k[length] == '\0' ) return i;
+    i = (i + 1) & (CAPACITY - 1);
+  }
+  return -1;
+}
+
+/**
+ * Find the slot of a key, or allocate a new one with an empty value.
+ * Returns -1 if the table is full.
+ */
+int8_t TemplateParams::obtain( const char* key, size_t length ) {
+  if( length > MAX_KEY_LENGTH ) length = MAX_KEY_LENGTH;
+  if( length == 0 ) return -1;
+  int8_t slot = find( key, length );
+  if( slot < 0 && used < CAPACITY ) {
+    uint8_t i = hash( key, length );
+    while( slots[i].key[0] ) {
+      i = (i + 1) & (CAPACITY - 1);
+    }
+    memcpy( slots[i].key, key, length );
+    slots[i].key[length] = '\0';
+    used++;
+    slot = i;
+  }
+  return slot;
+}
+
+bool TemplateParams::remove( const String& key ) {
+  const int8_t slot = find( key.c_str(), key.length() );
+  if( slot >= 0 && slots[slot].value.length() > 0 ) {
+    slots[slot].value = "";
+    slots[slot].revision++;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Set a parameter value. Returns true if the value has been changed.
+ */
+bool TemplateParams::set( const String& key, const String& value ) {
+  const int8_t slot = obtain( key.c_str(), key.length() );
+  if( slot >= 0 && slots[slot].value != value ) {
+    slots[slot].value = value;
+    slots[slot].revision++;
+    return true;
+  }
+  return false;
+}
+
+// FNV-1a hash folded to the table size.
+uint8_t TemplateParams::hash( const char* key, size_t length ) {
+  uint32_t h = 2166136261UL;
+  while( length-- ) {
+    h = (h ^ (uint8_t) *key++) * 16777619UL;
+  }
+  return (h ^ (h >> 16)) & (CAPACITY - 1);
+}
@@ -0,0 +1,49 @@
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include "Config.h"
+#include "relays/Backend.h"
+#include "relays/GpioBackend.h"
+#include "relays/Hc595Backend.h"
+#include "relays/Mcp23017Backend.h"
+#include "str_switch.h"
+
+using namespace Relays;
+
+/* The factory method to instantiate backends */
+
+Backend* Relays::createBackend( const String& type, const BackendConfig& config ) {
+  SWITCH( type.c_str() ) {
+    CASE( "gpio" ):      return new GpioBackend();
+    CASE( "mcp23017" ):  return new Mcp23017Backend( config );
+    CASE( "74hc595" ):   return isValidLatchPin( config.latchPin ) ? new Hc595Backend( config ) : nullptr;
+    DEFAULT_CASE:        return nullptr;
+  }
+}
+
+bool Relays::isValidBackend( const String& type ) {
+  SWITCH( type.c_str() ) {
+    CASE( "gpio" ):
+    CASE( "mcp23017" ):
+    CASE( "74hc595" ):
+      return true;
+    DEFAULT_CASE:
+      return false;
+  }
+}
+
+bool Relays::isValidLatchPin( const uint8_t pin ) {
+  static const uint8_t RESERVED[] = {
+    Config::ST7796_DC_PIN, Config::ST7796_WR_PIN, Config::ST7796_RD_PIN,
+    Config::ST7796_D0_PIN, Config::ST7796_D1_PIN, Config::ST7796_D2_PIN, Config::ST7796_D3_PIN,
+    Config::ST7796_D4_PIN, Config::ST7796_D5_PIN, Config::ST7796_D6_PIN, Config::ST7796_D7_PIN,
+    Config::ST7796_TOUCH_CS_PIN, Config::ST7796_TOUCH_IRQ_PIN, Config::ST7796_SDCARD_CS_PIN,
+    Config::ST7796_CLK_PIN, Config::ST7796_MOSI_PIN, Config::ST7796_MISO_PIN,
+    Config::WIRE_SDA, Config::WIRE_SCL, SDA, SCL
+  };
+  if( pin == 0 || !GPIO_IS_VALID_OUTPUT_GPIO( pin )) return false;
+  if( Config::ST7796_BACKLIGHT_PIN == pin || Config::ST7796_CS_PIN == pin || Config::ST7796_RST_PIN == pin ) return false;
+  for( uint8_t reserved : RESERVED ) {
+    if( reserved == pin ) return false;
+  }
+  return true;
+}
@@ -0,0 +1,37 @@
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <soc/gpio_struct.h>
+#include "relays/GpioBackend.h"
+
+using namespace Relays;
+
+bool GpioBackend::begin( uint64_t channels, uint64_t levels ) {
+  write( levels, channels );
+  for( uint8_t i = 0; i < MAX_CHANNELS; i++ ) {
+    if( channels & (1ULL << i) ) pinMode( i, OUTPUT );
+  }
+  return true;
+}
+
+void GpioBackend::write( uint64_t levels, uint64_t select ) {
+  const uint64_t set = levels & select;
+  const uint64_t clear = ~levels & select;
+  GPIO.out_w1ts = (uint32_t) set;
+  GPIO.out1_w1ts.val = (uint32_t) (set >> 32);
+  GPIO.out_w1tc = (uint32_t) clear;
+  GPIO.out1_w1tc.val = (uint32_t) (clear >> 32);
+}
+
+/**
+ * The output registers, not the pads, so the result doesn't depend on the load.
+ */
+uint64_t GpioBackend::read() {
+  return GPIO.out | ((uint64_t) GPIO.out1.val << 32);
+}
+
+/**
+ * GPIO0 is a strapping pin, so pin 0 means "no pin" as before. Input-only pins are rejected.
+ */
+int8_t GpioBackend::toChannel( uint8_t pin ) {
+  return pin != 0 && GPIO_IS_VALID_OUTPUT_GPIO( pin ) ? pin : NO_CHANNEL;
+}
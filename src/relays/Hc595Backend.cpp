@@ -0,0 +1,54 @@
+#include <SPI.h>
+#include "Config.h"
+#include "relays/Hc595Backend.h"
+
+using namespace Relays;
+
+Hc595Backend::Hc595Backend( const BackendConfig& config ) :
+  chips( config.chips == 0 ? 1 : (config.chips > MAX_CHIPS ? MAX_CHIPS : config.chips) ),
+  latchPin( config.latchPin ) {
+}
+
+/**
+ * The chain can't be read back, so it always responds.
+ */
+bool Hc595Backend::begin( uint64_t channels, uint64_t levels ) {
+  pinMode( latchPin, OUTPUT );
+  digitalWrite( latchPin, LOW );
+  SPI.begin();
+  this->levels = levels & channels;
+  transfer();
+  return true;
+}
+
+void Hc595Backend::write( uint64_t levels, uint64_t select ) {
+  const uint64_t v = (this->levels & ~select) | (levels & select);
+  if( v != this->levels ) {
+    this->levels = v;
+    transfer();
+  }
+}
+
+int8_t Hc595Backend::toChannel( uint8_t pin ) {
+  return pin != 0 && pin <= chips * OUTPUTS_PER_CHIP ? pin - 1 : NO_CHANNEL;
+}
+
+/* Private */
+
+/**
+ * Shifts all the chips in one transfer, the last chip of the chain goes first, then latches
+ * the outputs with the rising edge of the latch pin. The latch is pulsed while the bus is
+ * still taken, otherwise other SPI devices (touch, SD card) could clock their bytes into
+ * the chain before the latch.
+ */
+void Hc595Backend::transfer() {
+  uint8_t buffer[MAX_CHIPS];
+  for( uint8_t i = 0; i < chips; i++ ) {
+    buffer[i] = levels >> ((chips - 1 - i) * OUTPUTS_PER_CHIP);
+  }
+  SPI.beginTransaction( SPISettings( Config::RELAY_HC595_SPI_CLOCK, MSBFIRST, SPI_MODE0 ));
+  SPI.writeBytes( buffer, chips );
+  digitalWrite( latchPin, HIGH );
+  digitalWrite( latchPin, LOW );
+  SPI.endTransaction();
+}
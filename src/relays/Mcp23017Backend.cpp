@@ -0,0 +1,63 @@
+#include <ArduinoLog.h>
+#include <Wire.h>
+#include "relays/Mcp23017Backend.h"
+
+using namespace Relays;
+
+// Registers in the default IOCON.BANK = 0 mode. Port B registers follow port A ones, so both
+// ports are written in one transaction with the address auto-increment (IOCON.SEQOP = 0).
+static const uint8_t IODIRA = 0x00;
+static const uint8_t OLATA  = 0x14;
+
+Mcp23017Backend::Mcp23017Backend( const BackendConfig& config ) :
+  address( config.address ),
+  chips( config.chips == 0 ? 1 : (config.chips > MAX_CHIPS ? MAX_CHIPS : config.chips) ) {
+}
+
+bool Mcp23017Backend::begin( uint64_t channels, uint64_t levels ) {
+  Wire.begin();
+  this->levels = levels & channels;
+  bool ok = true;
+  for( uint8_t chip = 0; chip < chips; chip++ ) {
+    const uint8_t shift = chip * OUTPUTS_PER_CHIP;
+    // Latches first, so the outputs are enabled with the right levels. Unused pins stay inputs.
+    ok &= writeRegisters( chip, OLATA, this->levels >> shift );
+    ok &= writeRegisters( chip, IODIRA, ~(uint16_t) (channels >> shift) );
+  }
+  return ok;
+}
+
+/**
+ * The cached levels are updated for the written chips only, so the relay states don't
+ * show switched relays if the chip doesn't respond.
+ */
+void Mcp23017Backend::write( uint64_t levels, uint64_t select ) {
+  const uint64_t v = (this->levels & ~select) | (levels & select);
+  for( uint8_t chip = 0; chip < chips; chip++ ) {
+    const uint8_t shift = chip * OUTPUTS_PER_CHIP;
+    const uint16_t value = v >> shift;
+    if( value == (uint16_t) (this->levels >> shift) ) continue;
+    if( writeRegisters( chip, OLATA, value )) {
+      this->levels = (this->levels & ~((uint64_t) 0xFFFF << shift)) | ((uint64_t) value << shift);
+    } else {
+      Log.error( "REL MCP23017 0x%x write failed" CR, address + chip );
+    }
+  }
+}
+
+int8_t Mcp23017Backend::toChannel( uint8_t pin ) {
+  return pin != 0 && pin <= chips * OUTPUTS_PER_CHIP ? pin - 1 : NO_CHANNEL;
+}
+
+/* Private */
+
+/**
+ * Writes a pair of port A/B registers of the chip.
+ */
+bool Mcp23017Backend::writeRegisters( uint8_t chip, uint8_t reg, uint16_t value ) {
+  Wire.beginTransmission( address + chip );
+  Wire.write( reg );
+  Wire.write( (uint8_t) value );
+  Wire.write( (uint8_t) (value >> 8) );
+  return Wire.endTransmission() == 0;
+}
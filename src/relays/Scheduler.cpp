@@ -0,0 +1,353 @@
+#include <ArduinoLog.h>
+#include <string.h>
+#include "relays/Scheduler.h"
+
+using namespace Relays;
+
+// Bounds the field-by-field search of cron runs, enough to find Feb 29 four years ahead.
+static const uint16_t MAX_SEARCH_STEPS = 1000;
+
+static const uint32_t ALL_DAYS     = 0xFFFFFFFE;      // 1..31
+static const uint8_t  ALL_WEEKDAYS = 0x7F;            // 0..6
+
+/* Cron fields */
+
+static size_t indexOf( const StringView& s, char c ) {
+  for( size_t i = 0; i < s.length(); i++ ) {
+    if( s[i] == c ) return i;
+  }
+  return s.length();
+}
+
+static bool parseNumber( const StringView& s, uint32_t max, uint32_t& n ) {
+  if( s.isEmpty() ) return false;
+  n = 0;
+  for( size_t i = 0; i < s.length(); i++ ) {
+    if( s[i] < '0' || s[i] > '9' ) return false;
+    n = n * 10 + (s[i] - '0');
+    if( n > max ) return false;
+  }
+  return true;
+}
+
+/**
+ * Parses a comma separated list of "*", "<n>", "<from>-<to>", each with an optional "/<step>".
+ */
+static bool parseField( const StringView& field, uint8_t min, uint8_t max, uint64_t& bits ) {
+  bits = 0;
+  Tokenizer items( field, ',' );
+  StringView item;
+  while( items.next( item )) {
+    uint32_t from = min, to = max, step = 1;
+    const size_t slash = indexOf( item, '/' );
+    const StringView range = item.substring( 0, slash );
+    if( slash < item.length() && (!parseNumber( item.substring( slash + 1 ), max, step ) || step == 0) ) {
+      return false;
+    }
+    if( range != "*" ) {
+      const size_t dash = indexOf( range, '-' );
+      if( !parseNumber( range.substring( 0, dash ), max, from )) return false;
+      if( dash < range.length() ) {
+        if( !parseNumber( range.substring( dash + 1 ), max, to )) return false;
+      } else if( slash == item.length() ) {
+        to = from;            // A single value, "<n>/<step>" lasts until the max.
+      }
+    }
+    if( from < min || from > to ) return false;
+    for( uint32_t v = from; v <= to; v += step ) {
+      bits |= 1ULL << v;
+    }
+  }
+  return bits != 0;
+}
+
+static void formatField( uint64_t bits, uint8_t min, uint8_t max, String& out ) {
+  const uint64_t all = (max == 63 ? ~0ULL : (1ULL << (max + 1)) - 1) & ~((1ULL << min) - 1);
+  if( (bits & all) == all ) {
+    out += '*';
+    return;
+  }
+  bool first = true;
+  for( uint8_t v = min; v <= max; v++ ) {
+    if( (bits & (1ULL << v)) == 0 ) continue;
+    uint8_t to = v;
+    while( to < max && (bits & (1ULL << (to + 1))) ) to++;
+    if( !first ) out += ',';
+    out += v;
+    if( to > v ) {
+      out += '-';
+      out += to;
+    }
+    first = false;
+    v = to;
+  }
+}
+
+static uint64_t minutesOf( const Schedule& s ) {
+  return s.cron.minutes[0] | ((uint64_t) s.cron.minutes[1] << 32);
+}
+
+/**
+ * As in crontab, if both the day and the weekday are restricted, either of them matches.
+ */
+static bool isDayMatched( const Schedule& s, const tm& t ) {
+  const bool day = (s.cron.days & (1UL << t.tm_mday)) != 0;
+  const bool weekday = (s.cron.weekdays & (1 << t.tm_wday)) != 0;
+  if( s.cron.days == ALL_DAYS || s.cron.weekdays == ALL_WEEKDAYS ) {
+    return day && weekday;
+  }
+  return day || weekday;
+}
+
+static time_t normalize( tm& t ) {
+  t.tm_sec = 0;
+  t.tm_isdst = -1;
+  const time_t v = mktime( &t );
+  localtime_r( &v, &t );
+  return v;
+}
+
+/* Scheduler */
+
+void Scheduler::tick( time_t now, const RunCallback& run ) {
+  if( now == 0 ) return;
+  if( lastTime == 0 ) {
+    // The clock has become valid after a reboot, the runs since the last clock processed
+    // before it are missed.
+    if( resumeTime != 0 && now > resumeTime ) {
+      catchUp( resumeTime, now, run );
+    }
+    rebuild( now );
+  } else if( now < lastTime || now - lastTime > Config::RELAY_SCHEDULE_MAX_DRIFT ) {
+    // The clock has been stepped.
+    if( now > lastTime ) {
+      catchUp( lastTime, now, run );
+    } else {
+      Log.notice( "REL clock went back, schedules rebuilt" CR );
+    }
+    rebuild( now );
+  } else if( nextDue != 0 && now >= nextDue ) {
+    wheel.advance( now, [this, now, &run](uint8_t id) {
+      run( schedules[id] );
+      const time_t due = next( schedules[id], now );
+      if( due != 0 ) wheel.schedule( id, due );
+    });
+    nextDue = wheel.nextDue();
+  }
+  lastTime = now;
+}
+
+bool Scheduler::add( const Schedule& schedule ) {
+  if( count >= Config::RELAY_MAX_SCHEDULES ) return false;
+  schedules[count++] = schedule;
+  if( lastTime != 0 ) rebuild( lastTime );
+  return true;
+}
+
+bool Scheduler::remove( uint8_t index ) {
+  if( index >= count ) return false;
+  memmove( &schedules[index], &schedules[index + 1], (count - index - 1) * sizeof(Schedule) );
+  count -= 1;
+  if( lastTime != 0 ) rebuild( lastTime );
+  return true;
+}
+
+bool Scheduler::hasCatchUp() {
+  for( uint8_t i = 0; i < count; i++ ) {
+    if( schedules[i].flags & Schedule::CATCH_UP ) return true;
+  }
+  return false;
+}
+
+void Scheduler::clear() {
+  count = 0;
+  if( lastTime != 0 ) rebuild( lastTime );
+}
+
+void Scheduler::load( const void* data, size_t size ) {
+  const Schedule* p = (const Schedule*) data;
+  count = 0;
+  for( size_t i = 0; i < size / sizeof(Schedule) && count < Config::RELAY_MAX_SCHEDULES; i++ ) {
+    if( p[i].type == Schedule::CRON || p[i].type == Schedule::INTERVAL ) {
+      schedules[count++] = p[i];
+    }
+  }
+  if( lastTime != 0 ) rebuild( lastTime );
+}
+
+/* Static */
+
+bool Scheduler::parse( Tokenizer& tokens, Schedule& schedule ) {
+  StringView token, flag;
+  bool hasFlag;
+  if( !tokens.next( token )) return false;
+  if( token == "every" ) {
+    // "every <seconds> [<offset>]"
+    StringView period;
+    schedule.type = Schedule::INTERVAL;
+    schedule.interval.offset = 0;
+    if( !tokens.next( period ) || !parseNumber( period, Config::RELAY_SCHEDULE_MAX_PERIOD, schedule.interval.period )) {
+      return false;
+    }
+    if( schedule.interval.period == 0 ) return false;
+    hasFlag = tokens.next( flag );
+    if( hasFlag && parseNumber( flag, schedule.interval.period - 1, schedule.interval.offset )) {
+      hasFlag = tokens.next( flag );
+    }
+  } else {
+    // Five cron fields, quoted or not.
+    StringView fields[5];
+    fields[0] = token;
+    if( indexOf( token, ' ' ) < token.length() ) {
+      Tokenizer inner( token );
+      for( uint8_t i = 0; i < 5; i++ ) {
+        if( !inner.next( fields[i] )) return false;
+      }
+      if( !inner.atEnd() ) return false;
+    } else {
+      for( uint8_t i = 1; i < 5; i++ ) {
+        if( !tokens.next( fields[i] )) return false;
+      }
+    }
+    uint64_t minutes, hours, days, months, weekdays;
+    if( !parseField( fields[0], 0, 59, minutes ) || !parseField( fields[1], 0, 23, hours )
+     || !parseField( fields[2], 1, 31, days ) || !parseField( fields[3], 1, 12, months )
+     || !parseField( fields[4], 0, 7, weekdays )) {
+      return false;
+    }
+    schedule.type = Schedule::CRON;
+    schedule.cron.minutes[0] = minutes;
+    schedule.cron.minutes[1] = minutes >> 32;
+    schedule.cron.hours      = hours;
+    schedule.cron.days       = days;
+    schedule.cron.months     = months;
+    schedule.cron.weekdays   = (weekdays | (weekdays >> 7)) & ALL_WEEKDAYS;    // 7 is Sunday too.
+    hasFlag = tokens.next( flag );
+  }
+  if( hasFlag ) {
+    if( flag != "catchup" ) return false;
+    schedule.flags |= Schedule::CATCH_UP;
+  }
+  return tokens.atEnd();
+}
+
+void Scheduler::format( const Schedule& schedule, String& out ) {
+  if( schedule.type == Schedule::INTERVAL ) {
+    out += "every ";
+    out += schedule.interval.period;
+    if( schedule.interval.offset > 0 ) {
+      out += ' ';
+      out += schedule.interval.offset;
+    }
+  } else {
+    formatField( minutesOf( schedule ), 0, 59, out );
+    out += ' ';
+    formatField( schedule.cron.hours, 0, 23, out );
+    out += ' ';
+    formatField( schedule.cron.days, 1, 31, out );
+    out += ' ';
+    formatField( schedule.cron.months, 1, 12, out );
+    out += ' ';
+    formatField( schedule.cron.weekdays, 0, 6, out );
+  }
+  if( schedule.flags & Schedule::CATCH_UP ) {
+    out += " catchup";
+  }
+}
+
+/**
+ * Cron runs are searched field by field: a mismatched month skips to the next month,
+ * a mismatched day to the next day and so on.
+ */
+time_t Scheduler::next( const Schedule& schedule, time_t after ) {
+  if( schedule.type == Schedule::INTERVAL ) {
+    const uint32_t period = schedule.interval.period;
+    const uint32_t offset = schedule.interval.offset;
+    if( (uint32_t) after < offset ) return offset;
+    return offset + ((after - offset) / period + 1) * period;
+  }
+  const uint64_t minutes = minutesOf( schedule );
+  tm t;
+  time_t v = after - after % 60 + 60;
+  localtime_r( &v, &t );
+  for( uint16_t i = 0; i < MAX_SEARCH_STEPS; i++ ) {
+    if( (schedule.cron.months & (1 << (t.tm_mon + 1))) == 0 ) {
+      t.tm_mon += 1;  t.tm_mday = 1;  t.tm_hour = 0;  t.tm_min = 0;
+    } else if( !isDayMatched( schedule, t )) {
+      t.tm_mday += 1;  t.tm_hour = 0;  t.tm_min = 0;
+    } else if( (schedule.cron.hours & (1UL << t.tm_hour)) == 0 ) {
+      t.tm_hour += 1;  t.tm_min = 0;
+    } else if( (minutes & (1ULL << t.tm_min)) == 0 ) {
+      t.tm_min += 1;
+    } else {
+      return v;
+    }
+    v = normalize( t );
+  }
+  return 0;
+}
+
+time_t Scheduler::previous( const Schedule& schedule, time_t before, time_t limit ) {
+  if( schedule.type == Schedule::INTERVAL ) {
+    const uint32_t period = schedule.interval.period;
+    const uint32_t offset = schedule.interval.offset;
+    if( (uint32_t) before < offset ) return 0;
+    const time_t v = offset + ((before - offset) / period) * period;
+    return v > limit ? v : 0;
+  }
+  const uint64_t minutes = minutesOf( schedule );
+  tm t;
+  time_t v = before - before % 60;
+  localtime_r( &v, &t );
+  for( uint16_t i = 0; i < MAX_SEARCH_STEPS && v > limit; i++ ) {
+    if( (schedule.cron.months & (1 << (t.tm_mon + 1))) == 0 ) {
+      t.tm_mday = 0;  t.tm_hour = 23;  t.tm_min = 59;     // The last day of the previous month.
+    } else if( !isDayMatched( schedule, t )) {
+      t.tm_mday -= 1;  t.tm_hour = 23;  t.tm_min = 59;
+    } else if( (schedule.cron.hours & (1UL << t.tm_hour)) == 0 ) {
+      t.tm_hour -= 1;  t.tm_min = 59;
+    } else if( (minutes & (1ULL << t.tm_min)) == 0 ) {
+      t.tm_min -= 1;
+    } else {
+      return v;
+    }
+    v = normalize( t );
+  }
+  return 0;
+}
+
+/* Private */
+
+/**
+ * For each relay, performs the latest missed on/off run of CATCH_UP schedules. Toggles are
+ * never caught up, they aren't idempotent.
+ */
+void Scheduler::catchUp( time_t from, time_t to, const RunCallback& run ) {
+  const time_t limit = to - from > Config::RELAY_SCHEDULE_LOOKBACK ? to - Config::RELAY_SCHEDULE_LOOKBACK : from;
+  time_t runs[Config::RELAY_MAX_SCHEDULES];
+  for( uint8_t i = 0; i < count; i++ ) {
+    const Schedule& s = schedules[i];
+    runs[i] = (s.flags & Schedule::CATCH_UP) && s.action <= 1 ? previous( s, to, limit ) : 0;
+  }
+  for( uint8_t i = 0; i < count; i++ ) {
+    if( runs[i] == 0 ) continue;
+    bool latest = true;
+    for( uint8_t j = 0; j < count && latest; j++ ) {
+      if( j == i || schedules[j].relay != schedules[i].relay ) continue;
+      latest = runs[j] < runs[i] || (runs[j] == runs[i] && j < i);
+    }
+    if( latest ) {
+      Log.notice( "REL schedule %d missed, caught up" CR, i + 1 );
+      run( schedules[i] );
+    }
+  }
+}
+
+void Scheduler::rebuild( time_t now ) {
+  wheel.reset( now );
+  for( uint8_t i = 0; i < count; i++ ) {
+    const time_t due = next( schedules[i], now );
+    if( due != 0 ) wheel.schedule( i, due );
+  }
+  nextDue = wheel.nextDue();
+}
@@ -0,0 +1,138 @@
+#include "relays/TimerWheel.h"
+
+using namespace Relays;
+
+void TimerWheel::reset( time_t time ) {
+  now = time;
+  for( uint8_t i = 0; i < CAPACITY; i++ ) {
+    timers[i].slot = IDLE;
+  }
+  for( uint16_t i = 0; i <= OVERFLOW; i++ ) {
+    heads[i] = NONE;
+  }
+  for( uint8_t i = 0; i < LEVELS; i++ ) {
+    occupied[i] = 0;
+  }
+}
+
+void TimerWheel::schedule( uint8_t id, time_t due ) {
+  if( id >= CAPACITY ) return;
+  cancel( id );
+  timers[id].due = (uint32_t) due > now ? due : now + 1;
+  insert( id );
+}
+
+void TimerWheel::cancel( uint8_t id ) {
+  if( id >= CAPACITY || timers[id].slot == IDLE ) return;
+  const uint16_t slot = timers[id].slot;
+  uint8_t* p = &heads[slot];
+  while( *p != id ) p = &timers[*p].next;
+  *p = timers[id].next;
+  timers[id].slot = IDLE;
+  if( heads[slot] == NONE && slot < OVERFLOW ) {
+    occupied[slot / SLOTS] &= ~(1ULL << (slot % SLOTS));
+  }
+}
+
+void TimerWheel::advance( time_t time, const ExpiredCallback& expired ) {
+  const uint32_t target = time;
+  while( now < target ) {
+    // The next occupied level 0 slot of this round, or the next round.
+    const uint8_t index = now & (SLOTS - 1);
+    const uint64_t ahead = index == SLOTS - 1 ? 0 : occupied[0] & (~0ULL << (index + 1));
+    const uint32_t step = ahead ? __builtin_ctzll( ahead ) - index : SLOTS - index;
+    if( target - now < step ) {
+      now = target;
+      break;
+    }
+    now += step;
+    if( (now & (SLOTS - 1)) == 0 ) {
+      cascade();
+    }
+    // Timers of the slot are due now. The list is taken first, the callback may change timers.
+    uint8_t due[CAPACITY];
+    uint8_t count = 0;
+    for( uint8_t id = unlinkAll( now & (SLOTS - 1) ); id != NONE; id = timers[id].next ) {
+      timers[id].slot = IDLE;
+      due[count++] = id;
+    }
+    for( uint8_t i = 0; i < count; i++ ) {
+      expired( due[i] );
+    }
+  }
+}
+
+/**
+ * Only the first occupied slot is looked at: slots of lower levels are earlier than slots of
+ * upper ones, and all occupied slots of a level are ahead of the wheel time.
+ */
+time_t TimerWheel::nextDue() {
+  uint16_t slot = OVERFLOW;
+  for( uint8_t level = 0; level < LEVELS; level++ ) {
+    if( occupied[level] ) {
+      slot = level * SLOTS + __builtin_ctzll( occupied[level] );
+      break;
+    }
+  }
+  uint32_t due = 0;
+  for( uint8_t id = heads[slot]; id != NONE; id = timers[id].next ) {
+    if( due == 0 || timers[id].due < due ) due = timers[id].due;
+  }
+  return due;
+}
+
+/* Private */
+
+/**
+ * The wheel time has entered a new round, moves timers of the current slots of upper levels
+ * (and the overflow list if all levels have wrapped) down.
+ */
+void TimerWheel::cascade() {
+  for( uint8_t level = 1; level <= LEVELS; level++ ) {
+    const uint8_t index = (now >> (SLOT_BITS * level)) & (SLOTS - 1);
+    uint8_t id = unlinkAll( level < LEVELS ? level * SLOTS + index : OVERFLOW );
+    while( id != NONE ) {
+      const uint8_t next = timers[id].next;
+      insert( id );
+      id = next;
+    }
+    if( index != 0 ) break;
+  }
+}
+
+/**
+ * Puts the timer to the lowest level whose current window contains the due time.
+ */
+void TimerWheel::insert( uint8_t id ) {
+  const uint32_t due = timers[id].due;
+  for( uint8_t level = 0; level < LEVELS; level++ ) {
+    const uint8_t shift = SLOT_BITS * (level + 1);
+    if( (due >> shift) == (now >> shift) ) {
+      link( id, level * SLOTS + ((due >> (SLOT_BITS * level)) & (SLOTS - 1)) );
+      return;
+    }
+  }
+  link( id, OVERFLOW );
+}
+
+void TimerWheel::link( uint8_t id, uint16_t slot ) {
+  timers[id].slot = slot;
+  timers[id].next = heads[slot];
+  heads[slot] = id;
+  if( slot < OVERFLOW ) {
+    occupied[slot / SLOTS] |= 1ULL << (slot % SLOTS);
+  }
+}
+
+/**
+ * Empties the slot.
+ * @return the first timer of the slot list.
+ */
+uint8_t TimerWheel::unlinkAll( uint16_t slot ) {
+  const uint8_t head = heads[slot];
+  heads[slot] = NONE;
+  if( slot < OVERFLOW ) {
+    occupied[slot / SLOTS] &= ~(1ULL << (slot % SLOTS));
+  }
+  return head;
+}
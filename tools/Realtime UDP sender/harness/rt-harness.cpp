@@ -0,0 +1,62 @@
+/**
+ * rt-harness - runs the backlight realtime input on the host.
+ *
+ * Reads datagrams from stdin, each one prefixed with its 2-byte big-endian length, feeds them
+ * through Backlight::RealtimeInput into a strip frame buffer and prints the input counters,
+ * the number of the shown frames and the last frame pixels (R,G,B hex) at the end:
+ *   received=12 dropped=2 applied=10 shows=10 frame=ff0000...
+ *
+ * Usage: rt-harness <ddp|e131> <pixels> [<first universe>], see rt-sender.py --check.
+ *
+ * Build from this directory:
+ *   g++ -std=gnu++11 -I stubs -I ../../../include -o rt-harness rt-harness.cpp \
+ *     ../../../src/backlight/RealtimeInput.cpp ../../../src/backlight/NeoPixelWrapper.cpp \
+ *     ../../../src/backlight/MatrixLayout.cpp
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "backlight/NeoPixelWrapper.h"
+#include "backlight/RealtimeInput.h"
+
+using namespace Backlight;
+
+unsigned long millis() {
+  return 0;
+}
+
+int main( int argc, char* argv[] ) {
+  if( argc < 3 ) {
+    fprintf( stderr, "Usage: %s <ddp|e131> <pixels> [<first universe>]\n", argv[0] );
+    return 2;
+  }
+  const RealtimeInput::Protocol protocol = RealtimeInput::toProtocol( argv[1] );
+  if( protocol == RealtimeInput::NONE ) {
+    fprintf( stderr, "Unknown protocol %s\n", argv[1] );
+    return 2;
+  }
+  NeoPixelWrapper strip( atoi( argv[2] ), 0 );
+  RealtimeInput input( &strip, protocol, 2500, argc > 3 ? atoi( argv[3] ) : 1 );
+
+  uint32_t shows = 0;
+  uint8_t datagram[2048];
+  uint8_t prefix[2];
+  while( fread( prefix, 1, sizeof(prefix), stdin ) == sizeof(prefix) ) {
+    const size_t len = (prefix[0] << 8) | prefix[1];
+    if( len > sizeof(datagram) || fread( datagram, 1, len, stdin ) != len ) {
+      fprintf( stderr, "Truncated input\n" );
+      return 2;
+    }
+    input.receive( datagram, len );
+    if( input.takeShowRequest() ) shows++;
+  }
+
+  const RealtimeInput::Counters& counters = input.getCounters();
+  printf( "received=%u dropped=%u applied=%u shows=%u frame=",
+    (unsigned) counters.received, (unsigned) counters.dropped, (unsigned) counters.applied, (unsigned) shows );
+  for( uint16_t i = 0; i < strip.getPixelsCount(); i++ ) {
+    const RgbColor c = strip.getPixelColor( i );
+    printf( "%02x%02x%02x", c.R, c.G, c.B );
+  }
+  printf( "\n" );
+  return 0;
+}
@@ -0,0 +1,9 @@
+#pragma once
+// Host stub: the realtime input only needs the milliseconds clock.
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define LED_BUILTIN 2
+
+unsigned long millis();
@@ -0,0 +1,12 @@
+#pragma once
+// Host stub: Config.h needs the log levels only.
+#include <Arduino.h>
+
+#define CR "\n"
+#define LOG_LEVEL_SILENT  0
+#define LOG_LEVEL_FATAL   1
+#define LOG_LEVEL_ERROR   2
+#define LOG_LEVEL_WARNING 3
+#define LOG_LEVEL_NOTICE  4
+#define LOG_LEVEL_TRACE   5
+#define LOG_LEVEL_VERBOSE 6
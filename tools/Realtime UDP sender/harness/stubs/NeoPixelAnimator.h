@@ -0,0 +1,2 @@
+#pragma once
+// Host stub: not used by the realtime input.
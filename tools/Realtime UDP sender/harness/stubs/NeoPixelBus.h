@@ -0,0 +1,26 @@
+#pragma once
+// Host stub: a strip without the output, NeoPixelWrapper keeps its own frame buffer.
+#include <stdint.h>
+#include <vector>
+
+struct RgbColor {
+  uint8_t R, G, B;
+  RgbColor( uint8_t brightness = 0 ) : R( brightness ), G( brightness ), B( brightness ) {}
+  RgbColor( uint8_t r, uint8_t g, uint8_t b ) : R( r ), G( g ), B( b ) {}
+};
+
+struct NeoGrbFeature {};
+struct Neo800KbpsMethod {};
+
+template <typename F, typename M>
+class NeoPixelBus {
+private:
+  std::vector<uint8_t> pixels;
+public:
+  NeoPixelBus( uint16_t count, uint8_t pin ) : pixels( count * 3 ) {}
+  void     Begin()                  {}
+  bool     CanShow()                { return true; }
+  void     Show()                   {}
+  void     Dirty()                  {}
+  uint8_t* Pixels()                 { return pixels.data(); }
+};
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+# coding=utf-8
+"""
+rt-sender.py - DDP / E1.31 test sender for the backlight realtime input.
+
+Requirements:
+   - Python3
+
+Instructions:
+    Enable the realtime input in the backlight module config JSON, e.g.
+        {"Pin":23,"Pixels":45,...,"Realtime":"ddp","RtTimeout":2500}
+    and run the sender against the device:
+        python3 rt-sender.py -H 192.168.0.50 -p ddp -n 45
+    Check the counters with the "backlight realtime" console command.
+
+    Use --late N to resend every Nth datagram with an old sequence number;
+    those datagrams must be counted as dropped by the device.
+
+    The sender and the device decoder can be checked on the host alone: build the harness
+    (see harness/rt-harness.cpp) and run
+        python3 rt-sender.py --check -p ddp --late 7
+    The datagrams of --frames frames go through the device RealtimeInput code, the counters,
+    the shown frames and the last frame pixels are compared with the expected ones.
+"""
+
+import argparse
+import colorsys
+import os
+import socket
+import struct
+import subprocess
+import sys
+import time
+
+DDP_PORT = 4048
+E131_PORT = 5568
+E131_UNIVERSE_SIZE = 510        # 170 RGB pixels per universe
+
+
+def ddp_packets(seq, pixels):
+    # The DDP sequence number (1..15) is incremented per datagram.
+    data = bytes(pixels)
+    chunk = 1440                # 480 pixels per datagram
+    packets = []
+    for offset in range(0, len(data), chunk):
+        part = data[offset:offset + chunk]
+        last = offset + chunk >= len(data)
+        flags = 0x40 | (0x01 if last else 0x00)
+        header = struct.pack('>BBBBIH', flags, seq, 0x0B, 1, offset, len(part))
+        packets.append(header + part)
+        seq = (seq % 15) + 1
+    return packets
+
+
+def e131_packets(seq, pixels, universe):
+    data = bytes(pixels)
+    packets = []
+    for index, offset in enumerate(range(0, len(data), E131_UNIVERSE_SIZE)):
+        part = data[offset:offset + E131_UNIVERSE_SIZE]
+        slots = len(part) + 1
+        dmp = struct.pack('>HBBHHH', 0x7000 | (10 + slots), 0x02, 0xA1, 0x0000, 0x0001, slots) + b'\x00' + part
+        framing = struct.pack('>HI', 0x7000 | (77 + len(dmp)), 0x00000002) + b'rt-sender'.ljust(64, b'\x00') + \
+            struct.pack('>BHBBH', 100, 0, seq & 0xFF, 0, universe + index) + dmp
+        root = struct.pack('>HH', 0x0010, 0x0000) + b'ASC-E1.17\x00\x00\x00' + \
+            struct.pack('>HI', 0x7000 | (22 + len(framing)), 0x00000004) + b'rt-sender-cid-00' + framing
+        packets.append(root)
+    return packets
+
+
+def rainbow(count, phase):
+    pixels = []
+    for i in range(count):
+        r, g, b = colorsys.hsv_to_rgb(((i / count) + phase) % 1.0, 1.0, 1.0)
+        pixels += [int(r * 255), int(g * 255), int(b * 255)]
+    return pixels
+
+
+def frame_datagrams(args, seq, pixels, sent):
+    """The frame datagrams as (datagram, stale) pairs, the next sequence number and the sent count."""
+    if args.protocol == 'ddp':
+        packets = ddp_packets(seq, pixels)
+    else:
+        packets = e131_packets(seq, pixels, args.universe)
+    datagrams = []
+    for packet in packets:
+        datagrams.append((packet, False))
+        sent += 1
+        # Replay the datagram with a stale sequence number.
+        if args.late and sent % args.late == 0:
+            stale = ddp_packets(seq, pixels) if args.protocol == 'ddp' else e131_packets((seq - 1) % 256, pixels, args.universe)
+            datagrams.append((stale[0], True))
+    seq = (seq + 1) % 256 if args.protocol == 'e131' else ((seq - 1 + len(packets)) % 15) + 1
+    return datagrams, seq, sent
+
+
+def send(args):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    port = DDP_PORT if args.protocol == 'ddp' else E131_PORT
+    seq = 1
+    sent = 0
+    period = 1.0 / args.fps
+    started = time.time()
+    while args.seconds == 0 or time.time() - started < args.seconds:
+        pixels = rainbow(args.pixels, (time.time() - started) * args.speed)
+        datagrams, seq, sent = frame_datagrams(args, seq, pixels, sent)
+        for datagram, _ in datagrams:
+            sock.sendto(datagram, (args.host, port))
+        time.sleep(period)
+    print('sent %d datagrams' % sent)
+
+
+def check(args):
+    """Feeds the datagrams through the device decoder built for the host, see harness/rt-harness.cpp."""
+    seq = 1
+    sent = 0
+    stale = 0
+    stream = bytearray()
+    for i in range(args.frames):
+        pixels = rainbow(args.pixels, i / args.fps * args.speed)
+        datagrams, seq, sent = frame_datagrams(args, seq, pixels, sent)
+        for datagram, late in datagrams:
+            stream += struct.pack('>H', len(datagram)) + datagram
+            stale += late
+    harness = subprocess.run([args.harness, args.protocol, str(args.pixels), str(args.universe)],
+                             input=bytes(stream), stdout=subprocess.PIPE, check=True)
+    result = dict(item.split('=', 1) for item in harness.stdout.decode().split())
+    expected = {
+        'received': sent + stale,
+        'dropped': stale,
+        'applied': sent,
+        'shows': args.frames,
+        'frame': bytes(pixels).hex(),
+    }
+    failed = [key for key in expected if result.get(key) != str(expected[key])]
+    for key in expected:
+        if key != 'frame':
+            print('%-8s %s (expected %s)' % (key, result.get(key), expected[key]))
+    print('frame    %s' % ('matches' if 'frame' not in failed else 'differs'))
+    print('FAILED: ' + ', '.join(failed) if failed else 'OK')
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='DDP / E1.31 test sender')
+    parser.add_argument('-H', '--host', default='127.0.0.1', help='device address (default: loopback)')
+    parser.add_argument('-p', '--protocol', choices=['ddp', 'e131'], default='ddp')
+    parser.add_argument('-n', '--pixels', type=int, default=45)
+    parser.add_argument('-f', '--fps', type=float, default=40.0)
+    parser.add_argument('-u', '--universe', type=int, default=1, help='first E1.31 universe')
+    parser.add_argument('-s', '--seconds', type=float, default=0, help='0 means forever')
+    parser.add_argument('--speed', type=float, default=0.2, help='rainbow rotations per second')
+    parser.add_argument('--late', type=int, default=0, help='resend every Nth datagram with a stale sequence')
+    parser.add_argument('--check', action='store_true', help='run the datagrams through the host harness')
+    parser.add_argument('--frames', type=int, default=100, help='frames to check')
+    parser.add_argument('--harness', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), 'harness', 'rt-harness'))
+    args = parser.parse_args()
+    sys.exit(check(args)) if args.check else send(args)